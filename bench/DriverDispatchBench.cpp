@@ -0,0 +1,67 @@
+/**
+ *  Product:        Tolk
+ *  File:           DriverDispatchBench.cpp
+ *  Description:    Cost of calling a screen reader driver through its interface.
+ *  Copyright:      (c) 2026, Davy Kager <mail@davykager.nl>
+ *  License:        LGPLv3
+ */
+
+// Drivers do next to nothing here, so what is left is the call itself: Tolk
+// calls Output through the ScreenReaderDriver interface, and Output calls
+// Speak and Braille on its own class. That inner call is direct when the
+// class is final. Calling the class itself stands in for static dispatch.
+
+#include "ScreenReaderDriver.h"
+#include "TolkBench.h"
+
+namespace {
+
+template <typename Base>
+class CountingDriver : public Base {
+public:
+  bool Speak(const wchar_t *str, bool) override { spoken += (str != nullptr); return true; }
+  bool Braille(const wchar_t *str) override { brailled += (str != nullptr); return true; }
+  bool IsSpeaking() override { return false; }
+  bool Silence() override { return true; }
+  bool IsActive() override { return true; }
+  bool Output(const wchar_t *str, bool interrupt) override {
+    const bool spoke = this->Speak(str, interrupt);
+    const bool brailled = this->Braille(str);
+    return spoke || brailled;
+  }
+
+public:
+  unsigned long spoken = 0;
+  unsigned long brailled = 0;
+};
+
+class DriverBase : public ScreenReaderDriver {
+protected:
+  DriverBase() : ScreenReaderDriver(L"Bench", true, true, false) {}
+};
+
+class OpenDriver : public CountingDriver<DriverBase> {};
+class FinalDriver final : public CountingDriver<DriverBase> {};
+
+} // namespace
+
+int main() {
+  OpenDriver open;
+  FinalDriver closed;
+  ScreenReaderDriver *openDriver = &open;
+  ScreenReaderDriver *finalDriver = &closed;
+  // Escaped, so the compiler can't see which class is behind them.
+  BenchKeep(&openDriver);
+  BenchKeep(&finalDriver);
+  const wchar_t *const text = L"Saved";
+  BenchReport("Output through the interface", BenchTime(10000000, [&]() {
+    BenchKeep(openDriver->Output(text, false) ? openDriver : nullptr);
+  }));
+  BenchReport("Output through the interface, final class", BenchTime(10000000, [&]() {
+    BenchKeep(finalDriver->Output(text, false) ? finalDriver : nullptr);
+  }));
+  BenchReport("Output on the final class itself", BenchTime(10000000, [&]() {
+    BenchKeep(closed.Output(text, false) ? &closed : nullptr);
+  }));
+  return 0;
+}
@@ -0,0 +1,31 @@
+/**
+ *  Product:        Tolk
+ *  File:           DuplicateFilterBench.cpp
+ *  Description:    Cost of checking output against recent text.
+ *  Copyright:      (c) 2026, Davy Kager <mail@davykager.nl>
+ *  License:        LGPLv3
+ */
+
+#include <string>
+#include <vector>
+#include "DuplicateFilter.h"
+#include "TolkBench.h"
+
+int main() {
+  std::vector<std::wstring> messages;
+  for (int i = 0; i < 64; ++i) messages.push_back(L"Item " + std::to_wstring(i) + L" of 64, selected");
+  DuplicateFilter filter;
+  size_t next = 0;
+  // What Tolk_Output does with new text: check, deliver and record.
+  BenchReport("New message", BenchTime(1000000, [&]() {
+    const DWORD hash = DuplicateFilter::Hash(messages[next++ % messages.size()].c_str());
+    if (!filter.IsRepeat(hash, 500)) filter.Record(hash);
+  }));
+  // The same text again, dropped.
+  const DWORD repeated = DuplicateFilter::Hash(messages[0].c_str());
+  filter.Record(repeated);
+  BenchReport("Repeated message", BenchTime(1000000, [&]() {
+    BenchKeep(filter.IsRepeat(DuplicateFilter::Hash(messages[0].c_str()), 60000) ? &filter : nullptr);
+  }));
+  return 0;
+}
@@ -0,0 +1,66 @@
+/**
+ *  Product:        Tolk
+ *  File:           HedgingBench.cpp
+ *  Description:    Delivery latency of Tolk_Speak with and without hedging, against a screen reader with slow spells.
+ *  Copyright:      (c) 2026, Davy Kager <mail@davykager.nl>
+ *  License:        LGPLv3
+ */
+
+// Built with the mock drivers of the tests. The screen reader takes a few
+// milliseconds to accept text and now and then far longer, SAPI takes no time and
+// is the hedge. Auto-detection doesn't stay with SAPI while the screen reader is
+// running, so every text goes to the screen reader first unless a late call is
+// still inside it. The percentiles are what a caller waits for Tolk_Speak to
+// return, which is what a time-critical cue waits before it can be heard.
+
+#include <windows.h>
+#include <algorithm>
+#include <chrono>
+#include <vector>
+#include "Tolk.h"
+#include "FlakyDriver.h"
+#include "TolkBench.h"
+
+#define SPEAKS 500
+#define USUAL_DELAY 2
+#define SLOW_DELAY 80
+// One text in this many meets a slow spell.
+#define SLOW_EVERY 25
+#define BUDGET 10
+// Milliseconds between texts, a user moving through a list at speed.
+#define INTERVAL 10
+
+static void ReportLatencies(const char *name, std::vector<double> &latencies) {
+  std::sort(latencies.begin(), latencies.end());
+  const auto at = [&](double percentile) { return latencies[(size_t)(percentile * (latencies.size() - 1))]; };
+  printf("%-48s p50 %7.2f ms  p99 %7.2f ms  max %7.2f ms\n", name, at(0.5) / 1e6, at(0.99) / 1e6, latencies.back() / 1e6);
+}
+
+static void Measure(const char *name, unsigned int budget) {
+  Tolk_SetHedging(budget, L"SAPI");
+  Tolk_TrySAPI(true);
+  Tolk_Load();
+  FlakyDriver *primary = FlakyDriver::Find(L"First");
+  FlakyDriver::Find(L"Second")->active = false;
+  FlakyDriver::Find(L"Third")->active = false;
+  std::vector<double> latencies;
+  for (int i = 0; i < SPEAKS; ++i) {
+    primary->delay = (i % SLOW_EVERY == SLOW_EVERY - 1) ? SLOW_DELAY : USUAL_DELAY;
+    const std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+    Tolk_Speak(L"Saved", false);
+    latencies.push_back(std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count());
+    Sleep(INTERVAL);
+  }
+  // Lets an abandoned call finish, the driver can't be released while it is inside it.
+  Sleep(2 * SLOW_DELAY);
+  Tolk_Unload();
+  Tolk_TrySAPI(false);
+  Tolk_SetHedging(0, nullptr);
+  ReportLatencies(name, latencies);
+}
+
+int main() {
+  Measure("Tolk_Speak without hedging", 0);
+  Measure("Tolk_Speak hedged after 10 ms", BUDGET);
+  return 0;
+}
@@ -0,0 +1,47 @@
+/**
+ *  Product:        Tolk
+ *  File:           PronunciationDictionaryBench.cpp
+ *  Description:    Cost of compiling a large dictionary and of applying it to text.
+ *  Copyright:      (c) 2026, Davy Kager <mail@davykager.nl>
+ *  License:        LGPLv3
+ */
+
+#include <cstdio>
+#include <string>
+#include "PronunciationDictionary.h"
+#include "TolkBench.h"
+
+#define BENCH_DICTIONARY "PronunciationDictionaryBench.txt"
+#define BENCH_ENTRIES 100000
+
+// Made up words, so that the patterns share prefixes the way real words do.
+static std::string MakeWord(unsigned int n) {
+  static const char *const syllables[] = { "ka", "ro", "mi", "tes", "lun", "dor", "e", "vi" };
+  std::string word;
+  do {
+    word += syllables[n % 8];
+    n /= 8;
+  } while (n);
+  return word;
+}
+
+int main() {
+  FILE *file = fopen(BENCH_DICTIONARY, "wb");
+  if (!file) return 1;
+  for (unsigned int i = 0; i < BENCH_ENTRIES; ++i) fprintf(file, "%s\t%s\n", MakeWord(i).c_str(), MakeWord(i + BENCH_ENTRIES).c_str());
+  fclose(file);
+  std::shared_ptr<const PronunciationDictionary> dictionary;
+  BenchReport("Load of 100k entries", BenchTime(5, [&]() { dictionary = PronunciationDictionary::Load(L"" BENCH_DICTIONARY); }));
+  remove(BENCH_DICTIONARY);
+  if (!dictionary) return 1;
+  // Chat text in which about one word in eight has an entry.
+  std::wstring text;
+  for (unsigned int i = 0; text.size() < 64 * 1024; ++i) {
+    const std::string word = (i % 8) ? "the" : MakeWord(i * 7919 % BENCH_ENTRIES);
+    text += std::wstring(word.begin(), word.end()) + L' ';
+  }
+  BenchReport("Apply to 64k characters", BenchTime(100, [&]() { BenchKeep(dictionary->Apply(text.c_str())); }), text.size());
+  const std::wstring clean(64 * 1024, L'x');
+  BenchReport("Apply to 64k characters without matches", BenchTime(100, [&]() { BenchKeep(dictionary->Apply(clean.c_str())); }), clean.size());
+  return 0;
+}
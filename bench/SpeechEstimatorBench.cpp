@@ -0,0 +1,164 @@
+/**
+ *  Product:        Tolk
+ *  File:           SpeechEstimatorBench.cpp
+ *  Description:    Accuracy of the speaking time estimate against recorded timings, and its cost.
+ *  Copyright:      (c) 2026, Davy Kager <mail@davykager.nl>
+ *  License:        LGPLv3
+ */
+
+// Usage: SpeechEstimatorBench [timings [wordsPerMinute]]
+// Timings are recorded durations, one per line as milliseconds, a tab and the
+// text, in UTF-8, spoken at the given rate (the default rate if left out). On
+// Windows without a file, the sample texts below are recorded with the default
+// SAPI voice. Elsewhere without a file, only the cost is measured. Accuracy is
+// the error of the estimate as it starts out and with the scale calibration
+// settles on for the voice, the median ratio between recorded and estimated time.
+
+#include <windows.h>
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <utility>
+#include <vector>
+#include "MockDriver.h"
+#include "SpeechEstimator.h"
+#include "TolkBench.h"
+#ifdef _WIN32
+#include "SpeechSynthesizer.h"
+#endif
+
+// What screen readers are given: labels, status messages, numbers, sentences and paragraphs.
+static const wchar_t *const g_samples[] = {
+  L"OK",
+  L"Cancel button",
+  L"Saved",
+  L"File menu",
+  L"Edit, 3 of 12",
+  L"Downloading, 42 percent",
+  L"Version 10.0.19045",
+  L"You have 3 new messages.",
+  L"The file could not be saved because the disk is full.",
+  L"Are you sure you want to delete these 14 items? This cannot be undone.",
+  L"Press Enter to open the selected item, or Escape to go back to the list of folders.",
+  L"Speech is estimated from the words, digits and pauses in the text. Screen readers that "
+    L"report whether they are speaking are asked instead, and their answers calibrate the "
+    L"estimate for the ones that cannot.",
+  L"\x4F60\x6709\x4E09\x6761\x65B0\x6D88\x606F\x3002",
+  L"\xC800\xC7A5\xB418\xC5C8\xC2B5\xB2C8\xB2E4.",
+};
+
+typedef std::vector<std::pair<double, std::wstring>> Timings;
+
+static bool LoadTimings(const char *path, Timings &timings) {
+  FILE *file = fopen(path, "rb");
+  if (!file) return false;
+  char line[4096];
+  while (fgets(line, sizeof(line), file)) {
+    char *tab = strchr(line, '\t');
+    if (!tab) continue;
+    std::string text(tab + 1);
+    while (!text.empty() && (text.back() == '\n' || text.back() == '\r')) text.pop_back();
+    std::wstring wide(text.size(), L'\0');
+    wide.resize(MultiByteToWideChar(CP_UTF8, 0, text.data(), (int)text.size(), &wide[0], (int)wide.size()));
+    if (!wide.empty()) timings.emplace_back(atof(line), wide);
+  }
+  fclose(file);
+  return true;
+}
+
+#ifdef _WIN32
+static bool RecordTimings(Timings &timings) {
+  const HRESULT hr = CoInitializeEx(nullptr, COINIT_MULTITHREADED);
+  const WAVEFORMATEX format = MakePcmFormat(PHRASE_SAMPLES_PER_SECOND, PHRASE_BITS_PER_SAMPLE, PHRASE_CHANNELS);
+  std::vector<char> audio;
+  for (const wchar_t *sample : g_samples) {
+    if (!RenderSpeech(sample, format, audio)) {
+      timings.clear();
+      break;
+    }
+    timings.emplace_back(audio.size() * 1000.0 / format.nAvgBytesPerSec, sample);
+  }
+  if (SUCCEEDED(hr)) CoUninitialize();
+  return !timings.empty();
+}
+#endif
+
+// Mean and worst error relative to the recorded time.
+static void ReportError(const char *name, const Timings &timings, const std::vector<double> &estimates, double scale) {
+  double sum = 0.0, worst = 0.0;
+  for (size_t i = 0; i < timings.size(); ++i) {
+    const double error = fabs(estimates[i] * scale - timings[i].first) / timings[i].first;
+    sum += error;
+    worst = std::max(worst, error);
+  }
+  printf("%-48s mean %5.1f%%  worst %5.1f%%\n", name, 100.0 * sum / timings.size(), 100.0 * worst);
+}
+
+static void MeasureAccuracy(const Timings &timings, unsigned int wordsPerMinute) {
+  SpeechEstimator estimator;
+  MockDriver driver(L"Recorded");
+  estimator.SetRate(wordsPerMinute);
+  std::vector<double> estimates, ratios;
+  for (const auto &timing : timings) {
+    estimates.push_back(estimator.Estimate(&driver, timing.second.c_str()));
+    ratios.push_back(timing.first / estimates.back());
+  }
+  std::sort(ratios.begin(), ratios.end());
+  const double scale = std::min(std::max(ratios[ratios.size() / 2], 0.25), 4.0);
+  printf("%u recorded timings\n", (unsigned int)timings.size());
+  ReportError("Estimate error, uncalibrated", timings, estimates, 1.0);
+  char name[64];
+  sprintf(name, "Estimate error, calibrated to %.2f", scale);
+  ReportError(name, timings, estimates, scale);
+}
+
+static void MeasureCost() {
+  SpeechEstimator estimator;
+  MockDriver driver(L"Mock");
+  DWORD result = 0;
+  const std::wstring label = g_samples[1];
+  BenchReport("Estimate of a label", BenchTime(1000000, [&]() {
+    result = estimator.Estimate(&driver, label.c_str());
+    BenchKeep(&result);
+  }), label.size());
+  const std::wstring paragraph = g_samples[11];
+  BenchReport("Estimate of a paragraph", BenchTime(100000, [&]() {
+    result = estimator.Estimate(&driver, paragraph.c_str());
+    BenchKeep(&result);
+  }), paragraph.size());
+  std::wstring page;
+  while (page.size() < 64 * 1024) page += paragraph + L' ';
+  BenchReport("Estimate of 64k characters", BenchTime(100, [&]() {
+    result = estimator.Estimate(&driver, page.c_str());
+    BenchKeep(&result);
+  }), page.size());
+  // What Tolk adds to every output: recording the text, then asking for the time left.
+  BenchReport("Spoke and GetRemaining for a label", BenchTime(1000000, [&]() {
+    estimator.Spoke(&driver, label.c_str(), true);
+    result = estimator.GetRemaining(&driver);
+    BenchKeep(&result);
+  }), label.size());
+}
+
+int main(int argc, char *argv[]) {
+  Timings timings;
+  const unsigned int wordsPerMinute = (argc > 2) ? (unsigned int)atoi(argv[2]) : 0;
+  if (argc > 1) {
+    if (!LoadTimings(argv[1], timings) || timings.empty()) {
+      fprintf(stderr, "Can't read timings from %s\n", argv[1]);
+      return 1;
+    }
+  }
+#ifdef _WIN32
+  else if (!RecordTimings(timings)) {
+    fprintf(stderr, "Can't record timings with SAPI\n");
+  }
+#endif
+  if (!timings.empty()) MeasureAccuracy(timings, wordsPerMinute);
+  else printf("No recorded timings, accuracy not measured\n");
+  MeasureCost();
+  return 0;
+}
@@ -0,0 +1,40 @@
+/**
+ *  Product:        Tolk
+ *  File:           SpeechMarkupBench.cpp
+ *  Description:    Cost of speech markup parsed for every call and taken from the cache.
+ *  Copyright:      (c) 2026, Davy Kager <mail@davykager.nl>
+ *  License:        LGPLv3
+ */
+
+#include "MockDriver.h"
+#include "SpeechMarkup.h"
+#include "TolkBench.h"
+
+static const wchar_t *Prepare(const wchar_t *text) { return text; }
+
+static const wchar_t *const g_markup = L"Press {spell}F1{/spell} for help.{pause 300} Then {em}go{/em} {lang de}Guten Tag{/lang}";
+
+int main() {
+  MockDriver plain(L"Plain");
+  MockDriver ssml(L"SSML", true);
+  BenchReport("Parse and lower for text", BenchTime(100000, [&]() {
+    const std::unique_ptr<const SpeechMarkup> markup = SpeechMarkup::Parse(g_markup, Prepare);
+    const std::wstring lowered(markup->GetPlainText());
+    BenchKeep(lowered.c_str());
+  }));
+  BenchReport("Parse and lower for SSML", BenchTime(100000, [&]() {
+    const std::unique_ptr<const SpeechMarkup> markup = SpeechMarkup::Parse(g_markup, Prepare);
+    const std::wstring lowered = markup->ToSsml();
+    BenchKeep(lowered.c_str());
+  }));
+  SpeechMarkupCache cache;
+  BenchReport("Cached, lowered for text", BenchTime(100000, [&]() {
+    cache.Parse(g_markup, 0, Prepare);
+    BenchKeep(cache.Lower(g_markup, &plain));
+  }));
+  BenchReport("Cached, lowered for SSML", BenchTime(100000, [&]() {
+    cache.Parse(g_markup, 0, Prepare);
+    BenchKeep(cache.Lower(g_markup, &ssml));
+  }));
+  return 0;
+}
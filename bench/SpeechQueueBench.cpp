@@ -0,0 +1,39 @@
+/**
+ *  Product:        Tolk
+ *  File:           SpeechQueueBench.cpp
+ *  Description:    Time until long text can start being spoken, and to chunk all of it.
+ *  Copyright:      (c) 2026, Davy Kager <mail@davykager.nl>
+ *  License:        LGPLv3
+ */
+
+#include <string>
+#include "SpeechQueue.h"
+#include "TolkBench.h"
+
+static const wchar_t *const g_sentences[] = {
+  L"This is a sentence about help. ",
+  L"Another one, with a clause; and more words here! ",
+  L"Dr. Smith said \"hello.\" ",
+  L"Short? "
+};
+
+int main() {
+  std::wstring text;
+  for (size_t i = 0; text.size() < 1024 * 1024; ++i) text += g_sentences[i % 4];
+  std::wstring chunk;
+  // What Tolk_Output does before the screen reader gets anything.
+  BenchReport("First chunk of 1M characters", BenchTime(100, [&]() {
+    SpeechQueue queue;
+    queue.Add(text.c_str());
+    queue.Next(chunk, SPEECH_CHUNK_FIRST);
+    BenchKeep(chunk.c_str());
+  }));
+  BenchReport("All chunks of 1M characters", BenchTime(20, [&]() {
+    SpeechQueue queue;
+    queue.Add(text.c_str());
+    size_t maxLength = SPEECH_CHUNK_FIRST;
+    while (queue.Next(chunk, maxLength)) maxLength = SPEECH_CHUNK_MAX;
+    BenchKeep(chunk.c_str());
+  }), text.size());
+  return 0;
+}
@@ -0,0 +1,50 @@
+/**
+ *  Product:        Tolk
+ *  File:           SymbolNamesBench.cpp
+ *  Description:    Cost of naming emoji and symbols in text.
+ *  Copyright:      (c) 2026, Davy Kager <mail@davykager.nl>
+ *  License:        LGPLv3
+ */
+
+#include <string>
+#include "SymbolNames.h"
+#include "TolkBench.h"
+
+// Adds the code point to the text, as UTF-16 where wchar_t is.
+static void Append(std::wstring &text, char32_t c) {
+  if (sizeof(wchar_t) == 2 && c > 0xFFFF) {
+    text += (wchar_t)(0xD800 + ((c - 0x10000) >> 10));
+    text += (wchar_t)(0xDC00 + ((c - 0x10000) & 0x3FF));
+  }
+  else text += (wchar_t)c;
+}
+
+int main() {
+  const SymbolTable *table = FindSymbolTable(L"en");
+  if (!table) return 1;
+  // Chat messages with a thumbs up with skin tone, a family joined by ZWJ, a flag and a heart.
+  std::wstring chat, plain, chinese, russian;
+  while (chat.size() < 64 * 1024) {
+    chat += L"Great game ";
+    Append(chat, 0x1F44D);
+    Append(chat, 0x1F3FD);
+    chat += L" see you all tomorrow ";
+    for (char32_t c : { 0x1F468, 0x200D, 0x1F469, 0x200D, 0x1F467 }) Append(chat, c);
+    chat += L" from ";
+    Append(chat, 0x1F1F3);
+    Append(chat, 0x1F1F1);
+    chat += L" with ";
+    Append(chat, 0x2764);
+    Append(chat, 0xFE0F);
+    chat += L". ";
+    plain += L"Great game, see you all tomorrow from the Netherlands. ";
+    // The same without emoji, in scripts past Latin-1 that have no names.
+    chinese += L"\x6BD4\x8D5B\x5F88\x7CBE\x5F69\xFF0C\x660E\x5929\x89C1\x3002";
+    russian += L"\x0425\x043E\x0440\x043E\x0448\x0430\x044F \x0438\x0433\x0440\x0430, \x0434\x043E \x0437\x0430\x0432\x0442\x0440\x0430. ";
+  }
+  BenchReport("Emoji-heavy 64k characters", BenchTime(100, [&]() { BenchKeep(NameSymbols(*table, chat.c_str())); }), chat.size());
+  BenchReport("Plain 64k characters", BenchTime(100, [&]() { BenchKeep(NameSymbols(*table, plain.c_str())); }), plain.size());
+  BenchReport("Chinese without emoji", BenchTime(100, [&]() { BenchKeep(NameSymbols(*table, chinese.c_str())); }), chinese.size());
+  BenchReport("Russian without emoji", BenchTime(100, [&]() { BenchKeep(NameSymbols(*table, russian.c_str())); }), russian.size());
+  return 0;
+}
@@ -0,0 +1,34 @@
+/**
+ *  Product:        Tolk
+ *  File:           TextDiffBench.cpp
+ *  Description:    Cost of finding what changed in a status line.
+ *  Copyright:      (c) 2026, Davy Kager <mail@davykager.nl>
+ *  License:        LGPLv3
+ */
+
+#include <string>
+#include <vector>
+#include "TextDiff.h"
+#include "TolkBench.h"
+
+int main() {
+  std::vector<std::wstring> progress;
+  for (int i = 0; i < 100; ++i)
+    progress.push_back(L"Downloading update.zip: " + std::to_wstring(i) + L"% (" + std::to_wstring(i * 3) + L" MB of 300 MB), about " + std::to_wstring(100 - i) + L" seconds left");
+  TextDiff diff;
+  std::wstring changed;
+  size_t next = 0;
+  BenchReport("Progress update", BenchTime(1000000, [&]() {
+    BenchKeep(diff.Update(L"progress", progress[next++ % progress.size()].c_str(), changed) ? &changed : nullptr);
+  }));
+  BenchReport("Unchanged text", BenchTime(1000000, [&]() {
+    BenchKeep(diff.Update(L"progress", progress[0].c_str(), changed) ? &changed : nullptr);
+  }));
+  // Every key is new, so the least recently used are forgotten.
+  std::vector<std::wstring> keys;
+  for (int i = 0; i < TEXT_DIFF_MAX_KEYS * 2; ++i) keys.push_back(L"key " + std::to_wstring(i));
+  BenchReport("Update of a new key", BenchTime(1000000, [&]() {
+    BenchKeep(diff.Update(keys[next++ % keys.size()].c_str(), progress[0].c_str(), changed) ? &changed : nullptr);
+  }));
+  return 0;
+}
@@ -0,0 +1,25 @@
+/**
+ *  Product:        Tolk
+ *  File:           TextNormalizerBench.cpp
+ *  Description:    Cost of cleaning up text before output.
+ *  Copyright:      (c) 2026, Davy Kager <mail@davykager.nl>
+ *  License:        LGPLv3
+ */
+
+#include <string>
+#include "TextNormalizer.h"
+#include "TolkBench.h"
+
+int main() {
+  std::wstring clean, dirty;
+  while (clean.size() < 64 * 1024) {
+    clean += L"Clean text is passed on as it is. ";
+    dirty += L"Dirty  text\r\n has\tspaces,\x00AD soft hyphens and\x200B zero-width characters. ";
+  }
+  clean.pop_back();
+  BenchReport("Clean 64k characters", BenchTime(1000, [&]() { BenchKeep(NormalizeText(clean.c_str())); }), clean.size());
+  BenchReport("Dirty 64k characters", BenchTime(1000, [&]() { BenchKeep(NormalizeText(dirty.c_str())); }), dirty.size());
+  const wchar_t *const message = L"File saved.";
+  BenchReport("Short clean message", BenchTime(1000000, [&]() { BenchKeep(NormalizeText(message)); }));
+  return 0;
+}
@@ -0,0 +1,52 @@
+/**
+ *  Product:        Tolk
+ *  File:           TolkBench.h
+ *  Description:    Timing shared by the benchmark programs.
+ *  Copyright:      (c) 2026, Davy Kager <mail@davykager.nl>
+ *  License:        LGPLv3
+ */
+
+#ifndef _TOLK_BENCH_H_
+#define _TOLK_BENCH_H_
+
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+
+// Every benchmark program is a main that times its cases one after the other and
+// prints a line for each. The figures depend on the machine, the compiler and the
+// build type, so only compare runs of a Release build on the same machine.
+
+// Makes what a case computed escape, so the compiler can't leave the work out.
+inline void BenchKeep(const void *result) {
+#ifdef _MSC_VER
+  static std::atomic<const void *> sink;
+  sink.store(result, std::memory_order_relaxed);
+  std::atomic_signal_fence(std::memory_order_seq_cst);
+#else
+  asm volatile("" : : "g"(result) : "memory");
+#endif
+}
+
+// Runs the case once to warm up, then the given number of times. Returns the
+// nanoseconds one run took on average.
+template <typename Run>
+double BenchTime(size_t iterations, Run run) {
+  run();
+  const std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+  for (size_t i = 0; i < iterations; ++i) run();
+  const std::chrono::duration<double, std::nano> elapsed = std::chrono::steady_clock::now() - start;
+  return elapsed.count() / iterations;
+}
+
+// Prints the time of a run, and if it went over text the throughput.
+inline void BenchReport(const char *name, double nanoseconds, size_t characters = 0) {
+  if (nanoseconds >= 1e6) printf("%-48s %10.2f ms", name, nanoseconds / 1e6);
+  else if (nanoseconds >= 1e3) printf("%-48s %10.2f us", name, nanoseconds / 1e3);
+  else printf("%-48s %10.1f ns", name, nanoseconds);
+  // As UTF-16, the way Tolk is given text on Windows.
+  if (characters) printf("  %8.1f MB/s", characters * 2 * 1e3 / nanoseconds);
+  printf("\n");
+}
+
+#endif // _TOLK_BENCH_H_
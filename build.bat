@@ -55,6 +55,10 @@ copy build-x86\dist\x86\* dist\x86\
 :: x64 output
 copy build-x64\dist\x64\* dist\x64\
 
+:: 32-bit-only drivers for x64, hosted by the bridge helper
+if exist build-x86\dist\x86\TolkBridge32.exe copy build-x86\dist\x86\TolkBridge32.exe dist\x64\
+copy libs\x86\dolapi32.dll dist\x64\
+
 :: .NET wrapper
 if exist build-x64\src\dotnet\TolkDotNet.dll copy build-x64\src\dotnet\TolkDotNet.dll dist\
 
@@ -0,0 +1,57 @@
+/**
+ *  Product:        Tolk
+ *  File:           SamplePlugin.c
+ *  Description:    Screen reader driver plugin example.
+ *  Copyright:      (c) 2026, Davy Kager <mail@davykager.nl>
+ *  License:        LGPLv3
+ *  Depends:        None.
+ */
+
+// See README.md for general information.
+// See TolkPlugin.h for full documentation of the plugin interface.
+// Copy SamplePlugin.dll into the TolkPlugins directory next to Tolk.dll to try it.
+// It "speaks" and "brailles" by printing to the console, so it is always active.
+
+#define UNICODE
+
+#include <stdio.h>
+#include "..\..\src\TolkPlugin.h"
+
+static bool TOLK_PLUGIN_CALL Speak(const wchar_t *str, bool interrupt) {
+  if (interrupt) fwprintf_s(stderr, L"[SamplePlugin] (silence)\n");
+  return (fwprintf_s(stderr, L"[SamplePlugin] speak: %s\n", str) >= 0);
+}
+
+static bool TOLK_PLUGIN_CALL Braille(const wchar_t *str) {
+  return (fwprintf_s(stderr, L"[SamplePlugin] braille: %s\n", str) >= 0);
+}
+
+static bool TOLK_PLUGIN_CALL Silence(void) {
+  return (fwprintf_s(stderr, L"[SamplePlugin] (silence)\n") >= 0);
+}
+
+static bool TOLK_PLUGIN_CALL IsActive(void) {
+  return true;
+}
+
+static const TolkPluginDriver g_driver = {
+  TOLK_PLUGIN_ABI_VERSION,
+  sizeof(TolkPluginDriver),
+  L"Sample Plugin",
+  TOLK_PLUGIN_CAP_SPEECH | TOLK_PLUGIN_CAP_BRAILLE,
+  NULL, // Initialize
+  NULL, // Finalize
+  Speak,
+  Braille,
+  NULL, // IsSpeaking
+  Silence,
+  IsActive,
+  NULL, // Output, Tolk calls Speak and Braille
+  NULL // GetBrailleCells, the display width is unknown
+};
+
+TOLK_PLUGIN_EXPORT const TolkPluginDriver * TOLK_PLUGIN_CALL TolkPlugin_GetDriver(unsigned int hostAbiVersion) {
+  // Any host with our ABI version reads the members that fit in its own table and ignores the rest.
+  (void)hostAbiVersion;
+  return &g_driver;
+}
@@ -0,0 +1,3 @@
+@echo off
+cl /nologo /LD SamplePlugin.c
+del SamplePlugin.obj SamplePlugin.exp SamplePlugin.lib
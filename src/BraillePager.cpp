@@ -0,0 +1,84 @@
+/**
+ *  Product:        Tolk
+ *  File:           BraillePager.cpp
+ *  Description:    Braille messages split into pages that fit the display.
+ *  Copyright:      (c) 2026, Davy Kager <mail@davykager.nl>
+ *  License:        LGPLv3
+ */
+
+#include "BraillePager.h"
+#include "TextClasses.h"
+
+void BraillePager::Show(const wchar_t *str, unsigned int cells) {
+  page = 0;
+  for (auto message = messages.begin(); message != messages.end(); ++message) {
+    if (message->cells == cells && message->text == str) {
+      messages.splice(messages.begin(), messages, message);
+      return;
+    }
+  }
+  if (messages.size() >= BRAILLE_PAGER_CACHE_SIZE) messages.pop_back();
+  messages.push_front(Message());
+  Message &message = messages.front();
+  message.text = str;
+  message.cells = cells;
+  Segment(message.text.c_str(), message.text.size(), cells, message.pages);
+}
+
+bool BraillePager::Forward() {
+  if (messages.empty() || page + 1 >= messages.front().pages.size()) return false;
+  ++page;
+  return true;
+}
+
+bool BraillePager::Back() {
+  if (messages.empty() || !page) return false;
+  --page;
+  return true;
+}
+
+std::wstring BraillePager::GetPage() const {
+  if (messages.empty()) return std::wstring();
+  const Message &message = messages.front();
+  const std::pair<DWORD, DWORD> &range = message.pages[page];
+  return message.text.substr(range.first, range.second - range.first);
+}
+
+void BraillePager::GetPosition(unsigned int &page, unsigned int &count) const {
+  page = (unsigned int)this->page;
+  count = messages.empty() ? 0 : (unsigned int)messages.front().pages.size();
+}
+
+void BraillePager::Segment(const wchar_t *text, size_t length, unsigned int cells, std::vector<std::pair<DWORD, DWORD>> &pages) {
+  // Without a width there is nothing to split by, pages would never advance.
+  if (!cells) {
+    pages.emplace_back(0, (DWORD)length);
+    return;
+  }
+  size_t start = 0;
+  while (start < length && IsSpace(text[start])) ++start;
+  while (start < length) {
+    size_t end = start + cells;
+    const wchar_t *lineBreak = wmemchr(text + start, L'\n', ((end < length) ? end : length) - start);
+    if (lineBreak) {
+      end = lineBreak - text;
+    }
+    else if (end >= length) {
+      end = length;
+    }
+    else {
+      size_t space = end;
+      while (space > start && !IsSpace(text[space])) --space;
+      if (space > start) end = space;
+      // A word wider than the display is cut, but not inside a surrogate pair.
+      else if (IS_LOW_SURROGATE(text[end]) && end - 1 > start) --end;
+    }
+    size_t pageEnd = end;
+    while (pageEnd > start && IsSpace(text[pageEnd - 1])) --pageEnd;
+    pages.emplace_back((DWORD)start, (DWORD)pageEnd);
+    start = end;
+    while (start < length && IsSpace(text[start])) ++start;
+  }
+  // Empty text still clears the display.
+  if (pages.empty()) pages.emplace_back(0, 0);
+}
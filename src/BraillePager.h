@@ -0,0 +1,59 @@
+/**
+ *  Product:        Tolk
+ *  File:           BraillePager.h
+ *  Description:    Braille messages split into pages that fit the display.
+ *  Copyright:      (c) 2026, Davy Kager <mail@davykager.nl>
+ *  License:        LGPLv3
+ */
+
+#ifndef _BRAILLE_PAGER_H_
+#define _BRAILLE_PAGER_H_
+
+#include <windows.h>
+#include <list>
+#include <string>
+#include <utility>
+#include <vector>
+
+// Used when neither the application nor the screen reader gives the width of the display.
+#define BRAILLE_DEFAULT_CELLS 40
+// Messages whose pages are kept, shown again they need not be split again.
+#define BRAILLE_PAGER_CACHE_SIZE 16
+
+// Pages end at a line break or after the last word that fits, only a word that is
+// wider than the display is cut. A cell is taken to be a character. The message
+// shown is the first in the cache. Used under the global lock.
+class BraillePager {
+public:
+  BraillePager() : page(0) {}
+  BraillePager(const BraillePager&) = delete;
+  BraillePager& operator=(const BraillePager&) = delete;
+
+public:
+  // Makes the text the message shown, at its first page.
+  void Show(const wchar_t *str, unsigned int cells);
+  // Return false if there is no page in that direction.
+  bool Forward();
+  bool Back();
+  // The page shown, empty if there is no message.
+  std::wstring GetPage() const;
+  void GetPosition(unsigned int &page, unsigned int &count) const;
+
+public:
+  // Appends the start and end of each page.
+  static void Segment(const wchar_t *text, size_t length, unsigned int cells, std::vector<std::pair<DWORD, DWORD>> &pages);
+
+private:
+  struct Message {
+    std::wstring text;
+    unsigned int cells;
+    std::vector<std::pair<DWORD, DWORD>> pages;
+  };
+
+private:
+  // Most recently shown first.
+  std::list<Message> messages;
+  size_t page;
+};
+
+#endif // _BRAILLE_PAGER_H_
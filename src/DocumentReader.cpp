@@ -0,0 +1,240 @@
+/**
+ *  Product:        Tolk
+ *  File:           DocumentReader.cpp
+ *  Description:    Reads a document aloud, decoding it a chunk at a time.
+ *  Copyright:      (c) 2026, Davy Kager <mail@davykager.nl>
+ *  License:        LGPLv3
+ */
+
+#include "DocumentReader.h"
+#include "SpeechQueue.h"
+#include "TextClasses.h"
+
+namespace {
+
+// Returns the code point and its length in bytes. A malformed sequence decodes
+// to U+FFFD and takes one byte, so decoding never gets stuck.
+char32_t DecodeUtf8(const unsigned char *bytes, ULONGLONG available, unsigned int &length) {
+  const unsigned char lead = bytes[0];
+  length = 1;
+  if (lead < 0x80) return lead;
+  unsigned int count;
+  char32_t c;
+  if (lead >= 0xC2 && lead <= 0xDF) {
+    count = 2;
+    c = lead & 0x1F;
+  }
+  else if (lead >= 0xE0 && lead <= 0xEF) {
+    count = 3;
+    c = lead & 0x0F;
+  }
+  else if (lead >= 0xF0 && lead <= 0xF4) {
+    count = 4;
+    c = lead & 0x07;
+  }
+  else {
+    return 0xFFFD;
+  }
+  if (available < count) return 0xFFFD;
+  for (unsigned int i = 1; i < count; ++i) {
+    if ((bytes[i] & 0xC0) != 0x80) return 0xFFFD;
+    c = (c << 6) | (bytes[i] & 0x3F);
+  }
+  // Overlong forms, surrogates and code points beyond Unicode.
+  if ((count == 3 && c < 0x800) || (count == 4 && (c < 0x10000 || c > 0x10FFFF)) || (c >= 0xD800 && c <= 0xDFFF)) return 0xFFFD;
+  length = count;
+  return c;
+}
+
+} // namespace
+
+DocumentReader::DocumentReader() :
+  file(INVALID_HANDLE_VALUE),
+  mapping(nullptr),
+  data(nullptr),
+  size(0),
+  encoding(ENCODING_UTF8),
+  start(0),
+  position(0),
+  last(0)
+{}
+
+DocumentReader::~DocumentReader() {
+  if (mapping) {
+    UnmapViewOfFile(data);
+    CloseHandle(mapping);
+  }
+  if (file != INVALID_HANDLE_VALUE) CloseHandle(file);
+}
+
+std::unique_ptr<DocumentReader> DocumentReader::Open(const wchar_t *path) {
+  if (!path) return nullptr;
+  std::unique_ptr<DocumentReader> reader(new DocumentReader());
+  // Logs are often still open for writing, only what is there now is read.
+  reader->file = CreateFileW(path, GENERIC_READ, FILE_SHARE_READ | FILE_SHARE_WRITE | FILE_SHARE_DELETE, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+  if (reader->file == INVALID_HANDLE_VALUE) return nullptr;
+  LARGE_INTEGER fileSize;
+  if (!GetFileSizeEx(reader->file, &fileSize) || (ULONGLONG)fileSize.QuadPart > (SIZE_T)-1) return nullptr;
+  // An empty file can't be mapped, but it is a valid document.
+  if (fileSize.QuadPart) {
+    reader->mapping = CreateFileMappingW(reader->file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+    if (!reader->mapping) return nullptr;
+    reader->data = (const unsigned char *)MapViewOfFile(reader->mapping, FILE_MAP_READ, 0, 0, 0);
+    if (!reader->data) {
+      CloseHandle(reader->mapping);
+      reader->mapping = nullptr;
+      return nullptr;
+    }
+    reader->size = (ULONGLONG)fileSize.QuadPart;
+  }
+  reader->DetectEncoding();
+  return reader;
+}
+
+std::unique_ptr<DocumentReader> DocumentReader::Open(const void *data, size_t size) {
+  if (!data && size) return nullptr;
+  std::unique_ptr<DocumentReader> reader(new DocumentReader());
+  reader->copy.assign((const unsigned char *)data, (const unsigned char *)data + size);
+  reader->data = reader->copy.data();
+  reader->size = size;
+  reader->DetectEncoding();
+  return reader;
+}
+
+// From the byte order mark, documents without one are taken to be UTF-8.
+void DocumentReader::DetectEncoding() {
+  if (size >= 3 && data[0] == 0xEF && data[1] == 0xBB && data[2] == 0xBF) {
+    start = 3;
+  }
+  else if (size >= 2 && data[0] == 0xFF && data[1] == 0xFE) {
+    encoding = ENCODING_UTF16LE;
+    start = 2;
+  }
+  else if (size >= 2 && data[0] == 0xFE && data[1] == 0xFF) {
+    encoding = ENCODING_UTF16BE;
+    start = 2;
+  }
+  position = start;
+}
+
+void DocumentReader::Seek(ULONGLONG to) {
+  window.clear();
+  offsets.clear();
+  last = 0;
+  if (to < start) to = start;
+  if (to >= size) {
+    position = size;
+    return;
+  }
+  if (encoding == ENCODING_UTF8) {
+    // Continuation bytes, at most three of them.
+    for (int i = 0; i < 3 && to < size && (data[to] & 0xC0) == 0x80; ++i) ++to;
+  }
+  else {
+    to = start + ((to - start) & ~1ULL);
+    // A trailing odd byte is not a character, see Decode.
+    if (to + 1 >= size) {
+      position = size;
+      return;
+    }
+    const wchar_t unit = (encoding == ENCODING_UTF16LE) ? (wchar_t)(data[to] | (data[to + 1] << 8)) : (wchar_t)((data[to] << 8) | data[to + 1]);
+    if (IS_LOW_SURROGATE(unit)) to += 2;
+  }
+  position = to;
+}
+
+bool DocumentReader::Next(std::wstring &chunk, size_t maxLength) {
+  while (position < size) {
+    // One character more than fits, so the chunk can be cut where the text goes on.
+    Decode(position, maxLength + 1, window, offsets);
+    if (window.empty()) break;
+    // Spaces between chunks are not worth sending.
+    size_t spaces = 0;
+    while (spaces < window.size() && IsSpace(window[spaces])) ++spaces;
+    if (spaces) {
+      position = offsets[spaces];
+      continue;
+    }
+    // Unless the document ends in the window, its last character is left out so
+    // the chunk ends where the text goes on.
+    size_t limit = maxLength;
+    if (offsets.back() < size && window.size() <= limit && window.size() > 1) limit = window.size() - 1;
+    last = SpeechQueue::FindChunkEnd(window.c_str(), window.size(), 0, limit);
+    chunk.assign(window, 0, last);
+    position = offsets[last];
+    return true;
+  }
+  position = size;
+  window.clear();
+  offsets.clear();
+  last = 0;
+  return false;
+}
+
+ULONGLONG DocumentReader::GetChunkPosition(size_t index) const {
+  if (offsets.empty()) return position;
+  if (index >= last) return offsets[last];
+  while (index > 0 && !IsSpace(window[index - 1])) --index;
+  return offsets[index];
+}
+
+ULONGLONG DocumentReader::FindNext(ULONGLONG from, DocumentUnit unit) const {
+  std::wstring text;
+  std::vector<ULONGLONG> positions;
+  while (from < size) {
+    Decode(from, DOCUMENT_SCAN_WINDOW, text, positions);
+    if (text.size() < 2) return size;
+    // Both need to see the character after the boundary, so the window's last character is looked at again next time.
+    size_t end = text.size();
+    if (unit == DOCUMENT_SENTENCE) {
+      end = SpeechQueue::FindSentenceEnd(text.c_str(), text.size(), 0);
+    }
+    else {
+      const size_t lineBreak = text.find(L'\n');
+      if (lineBreak != std::wstring::npos) end = lineBreak;
+    }
+    if (end < text.size()) {
+      while (end < text.size() && IsSpace(text[end])) ++end;
+      // The spaces may go on past the window, the next chunk skips those.
+      return positions[end];
+    }
+    from = positions[text.size() - 1];
+  }
+  return size;
+}
+
+void DocumentReader::Decode(ULONGLONG from, size_t maxLength, std::wstring &text, std::vector<ULONGLONG> &offsets) const {
+  text.clear();
+  offsets.clear();
+  while (from < size && text.size() < maxLength) {
+    if (encoding == ENCODING_UTF8) {
+      unsigned int length;
+      const char32_t c = DecodeUtf8(data + from, size - from, length);
+      if (c >= 0x10000) {
+        // Both halves of the surrogate pair or neither.
+        if (text.size() + 2 > maxLength) break;
+        text += (wchar_t)(0xD800 + ((c - 0x10000) >> 10));
+        text += (wchar_t)(0xDC00 + ((c - 0x10000) & 0x3FF));
+        offsets.push_back(from);
+        offsets.push_back(from);
+      }
+      else {
+        text += (wchar_t)c;
+        offsets.push_back(from);
+      }
+      from += length;
+    }
+    else {
+      // A trailing odd byte is not a character.
+      if (size - from < 2) {
+        from = size;
+        break;
+      }
+      const wchar_t unit = (encoding == ENCODING_UTF16LE) ? (wchar_t)(data[from] | (data[from + 1] << 8)) : (wchar_t)((data[from] << 8) | data[from + 1]);
+      text += unit;
+      offsets.push_back(from);
+      from += 2;
+    }
+  }
+  offsets.push_back(from);
+}
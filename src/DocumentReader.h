@@ -0,0 +1,85 @@
+/**
+ *  Product:        Tolk
+ *  File:           DocumentReader.h
+ *  Description:    Reads a document aloud, decoding it a chunk at a time.
+ *  Copyright:      (c) 2026, Davy Kager <mail@davykager.nl>
+ *  License:        LGPLv3
+ */
+
+#ifndef _DOCUMENT_READER_H_
+#define _DOCUMENT_READER_H_
+
+#include <windows.h>
+#include <memory>
+#include <string>
+#include <vector>
+
+// Characters decoded at a time when looking for the next sentence or paragraph.
+#define DOCUMENT_SCAN_WINDOW 4096
+
+// Same values as the TOLK_DOCUMENT_* constants in Tolk.h.
+enum DocumentUnit {
+  DOCUMENT_SENTENCE = 0,
+  DOCUMENT_PARAGRAPH = 1
+};
+
+// A UTF-8 or UTF-16 document, mapped into memory or copied from a buffer. Only
+// the chunk being spoken is ever decoded, so documents of any size can be read
+// without converting them first. Positions are byte offsets into the document,
+// which stay valid between runs as long as the document does not change.
+// Used under the global lock.
+class DocumentReader {
+public:
+  // Return nullptr if the file can't be opened.
+  static std::unique_ptr<DocumentReader> Open(const wchar_t *path);
+  static std::unique_ptr<DocumentReader> Open(const void *data, size_t size);
+  ~DocumentReader();
+  DocumentReader(const DocumentReader&) = delete;
+  DocumentReader& operator=(const DocumentReader&) = delete;
+
+public:
+  ULONGLONG GetSize() const { return size; }
+  // Where the next chunk starts.
+  ULONGLONG GetPosition() const { return position; }
+  // Moves to the given position, or the start of the character it falls in.
+  void Seek(ULONGLONG to);
+  // Takes the chunk of at most maxLength characters at the position and moves past it.
+  // Returns false at the end of the document.
+  bool Next(std::wstring &chunk, size_t maxLength);
+  // Position of the word that holds the given character of the last chunk taken.
+  ULONGLONG GetChunkPosition(size_t index) const;
+  // Start of the next sentence or paragraph after the given position, the end of the document if there is none.
+  ULONGLONG FindNext(ULONGLONG from, DocumentUnit unit) const;
+
+private:
+  enum Encoding {
+    ENCODING_UTF8,
+    ENCODING_UTF16LE,
+    ENCODING_UTF16BE
+  };
+
+private:
+  DocumentReader();
+  void DetectEncoding();
+  // Decodes up to maxLength characters starting at from into text. offsets gets the
+  // position of every character plus the position after the last one.
+  void Decode(ULONGLONG from, size_t maxLength, std::wstring &text, std::vector<ULONGLONG> &offsets) const;
+
+private:
+  HANDLE file;
+  HANDLE mapping;
+  const unsigned char *data;
+  ULONGLONG size;
+  // Holds the document when it was passed as a buffer.
+  std::vector<unsigned char> copy;
+  Encoding encoding;
+  // Past the byte order mark.
+  ULONGLONG start;
+  ULONGLONG position;
+  // The last chunk taken is the start of the window up to last.
+  std::wstring window;
+  std::vector<ULONGLONG> offsets;
+  size_t last;
+};
+
+#endif // _DOCUMENT_READER_H_
@@ -0,0 +1,45 @@
+/**
+ *  Product:        Tolk
+ *  File:           DriverCall.h
+ *  Description:    Screen reader driver operations as data, for running them indirectly.
+ *  Copyright:      (c) 2026, Davy Kager <mail@davykager.nl>
+ *  License:        LGPLv3
+ */
+
+#ifndef _DRIVER_CALL_H_
+#define _DRIVER_CALL_H_
+
+#include "ScreenReaderDriver.h"
+
+enum DriverOperation {
+  DRIVER_SPEAK,
+  DRIVER_SPEAK_SSML,
+  // The text is markup as lowered for the driver by LowerMarkup.
+  DRIVER_SPEAK_MARKUP,
+  DRIVER_BRAILLE,
+  DRIVER_OUTPUT,
+  DRIVER_SILENCE,
+  DRIVER_IS_SPEAKING,
+  DRIVER_IS_ACTIVE
+};
+
+// A driver that throws has failed the call. Nothing may escape, on a worker thread it would end the process.
+inline bool CallDriver(ScreenReaderDriver *driver, DriverOperation operation, const wchar_t *str, bool interrupt) {
+  try {
+    switch (operation) {
+    case DRIVER_SPEAK: return driver->Speak(str, interrupt);
+    case DRIVER_SPEAK_SSML: return driver->SpeakSsml(str, interrupt);
+    case DRIVER_SPEAK_MARKUP: return driver->SpeakMarkup(str, interrupt);
+    case DRIVER_BRAILLE: return driver->Braille(str);
+    case DRIVER_OUTPUT: return driver->Output(str, interrupt);
+    case DRIVER_SILENCE: return driver->Silence();
+    case DRIVER_IS_SPEAKING: return driver->IsSpeaking();
+    case DRIVER_IS_ACTIVE: return driver->IsActive();
+    }
+  }
+  catch (...) {
+  }
+  return false;
+}
+
+#endif // _DRIVER_CALL_H_
@@ -0,0 +1,100 @@
+/**
+ *  Product:        Tolk
+ *  File:           DriverHealth.cpp
+ *  Description:    Per-driver failure tracking with a circuit breaker.
+ *  Copyright:      (c) 2026, Davy Kager <mail@davykager.nl>
+ *  License:        LGPLv3
+ */
+
+// After threshold consecutive failures a driver's circuit opens and the driver
+// is skipped, auto-detection included, for a backoff window. When the window
+// has passed the circuit is half-open: the driver is tried again, one success
+// closes the circuit and one failure opens it again for twice as long.
+
+#include "DriverHealth.h"
+
+void DriverHealth::Configure(unsigned int failureThreshold, DWORD backoff, DWORD backoffLimit) {
+  threshold = failureThreshold;
+  baseBackoff = backoff;
+  maxBackoff = (backoffLimit < backoff) ? backoff : backoffLimit;
+  // Start over, so a disabled breaker does not leave drivers locked out.
+  for (auto &entry : states) {
+    entry.second.circuit = CIRCUIT_CLOSED;
+    entry.second.consecutiveFailures = 0;
+    entry.second.backoff = baseBackoff;
+    entry.second.openUntil = 0;
+  }
+}
+
+bool DriverHealth::Allow(ScreenReaderDriver *driver) {
+  if (!threshold) return true;
+  const auto it = states.find(driver);
+  if (it == states.end()) return true;
+  State &state = it->second;
+  if (state.circuit != CIRCUIT_OPEN) return true;
+  if (GetTickCount64() < state.openUntil) {
+    ++state.stats.rejected;
+    return false;
+  }
+  state.circuit = CIRCUIT_HALF_OPEN;
+  return true;
+}
+
+bool DriverHealth::Record(ScreenReaderDriver *driver, DriverOperation operation, bool succeeded) {
+  // Only output counts. Not being active or not speaking is not a failure, and
+  // neither is failing to braille on a driver that has no braille support.
+  switch (operation) {
+  case DRIVER_SPEAK:
+  case DRIVER_SPEAK_SSML:
+  case DRIVER_SPEAK_MARKUP:
+  case DRIVER_SILENCE:
+    if (!driver->HasSpeech()) return false;
+    break;
+  case DRIVER_BRAILLE:
+    if (!driver->HasBraille()) return false;
+    break;
+  case DRIVER_OUTPUT:
+    break;
+  default:
+    return false;
+  }
+  auto it = states.find(driver);
+  if (it == states.end()) {
+    State state = {};
+    state.circuit = CIRCUIT_CLOSED;
+    state.backoff = baseBackoff;
+    it = states.emplace(driver, state).first;
+  }
+  State &state = it->second;
+  ++state.stats.calls;
+  if (succeeded) {
+    state.circuit = CIRCUIT_CLOSED;
+    state.consecutiveFailures = 0;
+    state.backoff = baseBackoff;
+    return false;
+  }
+  ++state.stats.failures;
+  ++state.consecutiveFailures;
+  if (!threshold) return false;
+  if (state.circuit == CIRCUIT_HALF_OPEN) {
+    // The probe failed, back off for longer.
+    state.backoff = (state.backoff > maxBackoff / 2) ? maxBackoff : state.backoff * 2;
+  }
+  else if (state.consecutiveFailures < threshold) {
+    return false;
+  }
+  state.circuit = CIRCUIT_OPEN;
+  state.openUntil = GetTickCount64() + state.backoff;
+  ++state.stats.trips;
+  return true;
+}
+
+bool DriverHealth::GetStats(const wchar_t *name, DriverStats &stats) const {
+  for (const auto &entry : states) {
+    if (wcscmp(entry.first->GetName(), name) == 0) {
+      stats = entry.second.stats;
+      return true;
+    }
+  }
+  return false;
+}
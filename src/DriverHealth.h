@@ -0,0 +1,60 @@
+/**
+ *  Product:        Tolk
+ *  File:           DriverHealth.h
+ *  Description:    Per-driver failure tracking with a circuit breaker.
+ *  Copyright:      (c) 2026, Davy Kager <mail@davykager.nl>
+ *  License:        LGPLv3
+ */
+
+#ifndef _DRIVER_HEALTH_H_
+#define _DRIVER_HEALTH_H_
+
+#include <windows.h>
+#include <map>
+#include "DriverCall.h"
+
+struct DriverStats {
+  unsigned int calls;
+  unsigned int failures;
+  unsigned int trips;
+  unsigned int rejected;
+};
+
+class DriverHealth {
+public:
+  DriverHealth() : threshold(0), baseBackoff(0), maxBackoff(0) {}
+  DriverHealth(const DriverHealth&) = delete;
+  DriverHealth& operator=(const DriverHealth&) = delete;
+
+public:
+  // A threshold of 0 disables the circuit breaker, counters are kept regardless.
+  void Configure(unsigned int failureThreshold, DWORD backoff, DWORD backoffLimit);
+  // Returns false while the driver's circuit is open, the call should then be skipped.
+  bool Allow(ScreenReaderDriver *driver);
+  // Returns true if this result opened the driver's circuit.
+  bool Record(ScreenReaderDriver *driver, DriverOperation operation, bool succeeded);
+  void Forget(ScreenReaderDriver *driver) { states.erase(driver); }
+  bool GetStats(const wchar_t *name, DriverStats &stats) const;
+
+private:
+  enum CircuitState {
+    CIRCUIT_CLOSED,
+    CIRCUIT_OPEN,
+    CIRCUIT_HALF_OPEN
+  };
+  struct State {
+    CircuitState circuit;
+    unsigned int consecutiveFailures;
+    DWORD backoff;
+    ULONGLONG openUntil;
+    DriverStats stats;
+  };
+
+private:
+  unsigned int threshold;
+  DWORD baseBackoff;
+  DWORD maxBackoff;
+  std::map<ScreenReaderDriver *, State> states;
+};
+
+#endif // _DRIVER_HEALTH_H_
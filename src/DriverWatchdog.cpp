@@ -0,0 +1,141 @@
+/**
+ *  Product:        Tolk
+ *  File:           DriverWatchdog.cpp
+ *  Description:    Runs screen reader driver calls on worker threads with a deadline.
+ *  Copyright:      (c) 2026, Davy Kager <mail@davykager.nl>
+ *  License:        LGPLv3
+ */
+
+// Every driver gets its own worker thread so that one hung screen reader
+// cannot block calls to the others. A call that misses its deadline is
+// abandoned: the caller returns, the worker stays stuck inside the driver,
+// and the driver counts as quarantined until the call finally returns.
+// Jobs are shared with the worker and own a copy of the text, so nothing on
+// the caller's stack is touched after it gave up. A caller that sends the
+// text elsewhere when the deadline passes abandons the job instead, the
+// state word decides whether the worker or the caller got there first.
+//
+// COM drivers are moved onto their worker. The interfaces they made on the
+// caller's thread are released before the worker starts, the worker's first
+// call creates them again in its own apartment and they are released there
+// when it stops. From then on every call to the driver has to go through
+// the worker, see HasWorker.
+
+#include "DriverWatchdog.h"
+
+bool DriverWatchdog::Run(ScreenReaderDriver *driver, DriverOperation operation, const wchar_t *str, bool interrupt, DWORD timeout, bool &result, bool abandonOnTimeout) {
+  result = false;
+  if (IsQuarantined(driver)) return false;
+  Worker *worker = GetWorker(driver);
+  if (!worker) return false;
+  auto job = std::make_shared<Job>();
+  job->operation = operation;
+  job->hasText = (str != nullptr);
+  if (str) job->text = str;
+  job->interrupt = interrupt;
+  job->result = false;
+  job->state = JOB_QUEUED;
+  job->done = CreateEventW(nullptr, TRUE, FALSE, nullptr);
+  if (!job->done) return false;
+  EnterCriticalSection(&worker->lock);
+  worker->job = job;
+  InterlockedExchange(&worker->busy, 1);
+  LeaveCriticalSection(&worker->lock);
+  SetEvent(worker->wake);
+  bool finished = (WaitForSingleObject(job->done, timeout) == WAIT_OBJECT_0);
+  if (!finished && abandonOnTimeout) {
+    LONG state = job->state;
+    while (state == JOB_QUEUED || state == JOB_RUNNING) {
+      const LONG previous = InterlockedCompareExchange(&job->state, JOB_ABANDONED, state);
+      if (previous == state) break;
+      state = previous;
+    }
+    // The call returned between the wait and the exchange.
+    finished = (state == JOB_FINISHED);
+  }
+  if (finished) result = job->result;
+  return finished;
+}
+
+bool DriverWatchdog::HasWorker(ScreenReaderDriver *driver) const {
+  return (workers.find(driver) != workers.end());
+}
+
+bool DriverWatchdog::IsQuarantined(ScreenReaderDriver *driver) const {
+  const auto it = workers.find(driver);
+  return (it != workers.end() && it->second->busy);
+}
+
+bool DriverWatchdog::Release(ScreenReaderDriver *driver) {
+  const auto it = workers.find(driver);
+  if (it == workers.end()) return true;
+  Worker *worker = it->second;
+  workers.erase(it);
+  InterlockedExchange(&worker->quit, 1);
+  SetEvent(worker->wake);
+  if (worker->busy) {
+    // Still inside the driver. The thread exits once the call returns, but
+    // the worker and the driver have to be leaked since it may still use them.
+    CloseHandle(worker->thread);
+    return false;
+  }
+  WaitForSingleObject(worker->thread, INFINITE);
+  CloseHandle(worker->thread);
+  CloseHandle(worker->wake);
+  DeleteCriticalSection(&worker->lock);
+  delete worker;
+  return true;
+}
+
+DWORD WINAPI DriverWatchdog::WorkerProc(LPVOID parameter) {
+  Worker *worker = (Worker *)parameter;
+  const HRESULT hr = CoInitializeEx(nullptr, COINIT_MULTITHREADED);
+  bool connected = false;
+  for (;;) {
+    WaitForSingleObject(worker->wake, INFINITE);
+    if (worker->quit) break;
+    EnterCriticalSection(&worker->lock);
+    std::shared_ptr<Job> job = std::move(worker->job);
+    LeaveCriticalSection(&worker->lock);
+    if (!job) continue;
+    if (InterlockedCompareExchange(&job->state, JOB_RUNNING, JOB_QUEUED) == JOB_QUEUED) {
+      // What Disconnect released is created again in this apartment.
+      if (!connected && job->operation != DRIVER_IS_ACTIVE) worker->driver->IsActive();
+      connected = true;
+      job->result = CallDriver(worker->driver, job->operation, job->hasText ? job->text.c_str() : nullptr, job->interrupt);
+      // Someone else has spoken the text by now, don't say it twice.
+      if (InterlockedCompareExchange(&job->state, JOB_FINISHED, JOB_RUNNING) == JOB_ABANDONED && job->result
+        && (job->operation == DRIVER_SPEAK || job->operation == DRIVER_SPEAK_SSML || job->operation == DRIVER_SPEAK_MARKUP || job->operation == DRIVER_OUTPUT) && worker->driver->HasSpeech())
+        CallDriver(worker->driver, DRIVER_SILENCE, nullptr, false);
+    }
+    // Cleared first, a caller woken by the event may call the driver again straight away.
+    InterlockedExchange(&worker->busy, 0);
+    SetEvent(job->done);
+    if (worker->quit) break;
+  }
+  worker->driver->Disconnect();
+  if (SUCCEEDED(hr)) CoUninitialize();
+  return 0;
+}
+
+DriverWatchdog::Worker *DriverWatchdog::GetWorker(ScreenReaderDriver *driver) {
+  const auto it = workers.find(driver);
+  if (it != workers.end()) return it->second;
+  // Its COM interfaces are released on this thread, the one that has been calling it.
+  driver->Disconnect();
+  Worker *worker = new Worker();
+  worker->driver = driver;
+  worker->busy = 0;
+  worker->quit = 0;
+  InitializeCriticalSection(&worker->lock);
+  worker->wake = CreateEventW(nullptr, FALSE, FALSE, nullptr);
+  worker->thread = worker->wake ? CreateThread(nullptr, 0, WorkerProc, worker, 0, nullptr) : nullptr;
+  if (!worker->thread) {
+    if (worker->wake) CloseHandle(worker->wake);
+    DeleteCriticalSection(&worker->lock);
+    delete worker;
+    return nullptr;
+  }
+  workers[driver] = worker;
+  return worker;
+}
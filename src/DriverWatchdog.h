@@ -0,0 +1,73 @@
+/**
+ *  Product:        Tolk
+ *  File:           DriverWatchdog.h
+ *  Description:    Runs screen reader driver calls on worker threads with a deadline.
+ *  Copyright:      (c) 2026, Davy Kager <mail@davykager.nl>
+ *  License:        LGPLv3
+ */
+
+#ifndef _DRIVER_WATCHDOG_H_
+#define _DRIVER_WATCHDOG_H_
+
+#include <windows.h>
+#include <map>
+#include <memory>
+#include <string>
+#include "DriverCall.h"
+
+class DriverWatchdog {
+public:
+  // Workers are only stopped through Release, never while the DLL is being unloaded.
+  DriverWatchdog() {}
+  DriverWatchdog(const DriverWatchdog&) = delete;
+  DriverWatchdog& operator=(const DriverWatchdog&) = delete;
+
+public:
+  // Runs the operation on the driver's own worker thread and waits at most timeout milliseconds.
+  // Returns false if the call did not finish in time, the driver is then quarantined until it does.
+  // An abandoned call is dropped if it has not started yet, and speech it delivers late is silenced.
+  bool Run(ScreenReaderDriver *driver, DriverOperation operation, const wchar_t *str, bool interrupt, DWORD timeout, bool &result, bool abandonOnTimeout = false);
+  // Once a driver has a worker all of its calls must be run there: the worker may still be
+  // inside an abandoned call, and COM drivers have moved their interfaces into its apartment.
+  bool HasWorker(ScreenReaderDriver *driver) const;
+  bool IsQuarantined(ScreenReaderDriver *driver) const;
+  // Stops the driver's worker thread. Returns false if the driver is stuck in a call,
+  // in which case it must not be destroyed.
+  bool Release(ScreenReaderDriver *driver);
+
+private:
+  enum JobState {
+    JOB_QUEUED,
+    JOB_RUNNING,
+    JOB_FINISHED,
+    JOB_ABANDONED
+  };
+  struct Job {
+    ~Job() { if (done) CloseHandle(done); }
+    DriverOperation operation;
+    std::wstring text;
+    bool hasText;
+    bool interrupt;
+    bool result;
+    volatile LONG state;
+    HANDLE done;
+  };
+  struct Worker {
+    ScreenReaderDriver *driver;
+    HANDLE thread;
+    HANDLE wake;
+    CRITICAL_SECTION lock;
+    std::shared_ptr<Job> job;
+    volatile LONG busy;
+    volatile LONG quit;
+  };
+
+private:
+  static DWORD WINAPI WorkerProc(LPVOID parameter);
+  Worker *GetWorker(ScreenReaderDriver *driver);
+
+private:
+  std::map<ScreenReaderDriver *, Worker *> workers;
+};
+
+#endif // _DRIVER_WATCHDOG_H_
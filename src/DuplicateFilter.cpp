@@ -0,0 +1,40 @@
+/**
+ *  Product:        Tolk
+ *  File:           DuplicateFilter.cpp
+ *  Description:    Drops text that repeats within a short time window.
+ *  Copyright:      (c) 2026, Davy Kager <mail@davykager.nl>
+ *  License:        LGPLv3
+ */
+
+#include "DuplicateFilter.h"
+
+DWORD DuplicateFilter::Hash(const wchar_t *str) {
+  if (!str) return 0;
+  // FNV-1a. The lowest bit is always set, so an empty slot never matches.
+  DWORD hash = 2166136261u;
+  for (; *str; ++str) {
+    hash ^= (DWORD)*str;
+    hash *= 16777619u;
+  }
+  return hash | 1;
+}
+
+bool DuplicateFilter::IsRepeat(DWORD hash, DWORD window) {
+  if (!hash || !window) return false;
+  // Only the low half of the tick count is kept, differences still come out right when it wraps.
+  const DWORD now = (DWORD)GetTickCount64();
+  for (const std::atomic<ULONGLONG> &slot : slots) {
+    const ULONGLONG seen = slot.load(std::memory_order_relaxed);
+    if ((DWORD)(seen >> 32) == hash && now - (DWORD)seen < window) {
+      dropped.fetch_add(1, std::memory_order_relaxed);
+      return true;
+    }
+  }
+  return false;
+}
+
+void DuplicateFilter::Record(DWORD hash) {
+  if (!hash) return;
+  const unsigned long slot = next.fetch_add(1, std::memory_order_relaxed) % DUPLICATE_FILTER_SLOTS;
+  slots[slot].store(((ULONGLONG)hash << 32) | (DWORD)GetTickCount64(), std::memory_order_relaxed);
+}
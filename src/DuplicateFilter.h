@@ -0,0 +1,46 @@
+/**
+ *  Product:        Tolk
+ *  File:           DuplicateFilter.h
+ *  Description:    Drops text that repeats within a short time window.
+ *  Copyright:      (c) 2026, Davy Kager <mail@davykager.nl>
+ *  License:        LGPLv3
+ */
+
+#ifndef _DUPLICATE_FILTER_H_
+#define _DUPLICATE_FILTER_H_
+
+#include <windows.h>
+#include <atomic>
+
+// Texts remembered at once, more than this many different ones within the window are let through.
+#define DUPLICATE_FILTER_SLOTS 16
+
+// Ring of the hashes of recent texts, each slot packing a hash with the tick
+// count it was delivered at into one atomic word, so callers on any thread check
+// and record text without a lock. Text is only recorded once it has been
+// delivered, so a failed attempt can be retried right away. Two threads
+// passing the same text at the same moment may both get through.
+class DuplicateFilter {
+public:
+  DuplicateFilter() : next(0), dropped(0) {
+    for (std::atomic<ULONGLONG> &slot : slots) slot.store(0, std::memory_order_relaxed);
+  }
+  DuplicateFilter(const DuplicateFilter&) = delete;
+  DuplicateFilter& operator=(const DuplicateFilter&) = delete;
+
+public:
+  // Never 0, except for no text.
+  static DWORD Hash(const wchar_t *str);
+  // Returns true, and counts the text as dropped, if the same text was recorded
+  // less than window milliseconds ago. Repeats don't extend the window.
+  bool IsRepeat(DWORD hash, DWORD window);
+  void Record(DWORD hash);
+  unsigned long GetDropped() const { return dropped.load(std::memory_order_relaxed); }
+
+private:
+  std::atomic<ULONGLONG> slots[DUPLICATE_FILTER_SLOTS];
+  std::atomic<unsigned long> next;
+  std::atomic<unsigned long> dropped;
+};
+
+#endif // _DUPLICATE_FILTER_H_
@@ -0,0 +1,267 @@
+/**
+ *  Product:        Tolk
+ *  File:           PhraseCache.cpp
+ *  Description:    Cache of rendered audio for frequently spoken phrases.
+ *  Copyright:      (c) 2026, Davy Kager <mail@davykager.nl>
+ *  License:        LGPLv3
+ */
+
+#include "PhraseCache.h"
+
+// Bump the version when the layout below changes, older stores are then ignored.
+#define PHRASE_STORE_MAGIC 0x43485054
+#define PHRASE_STORE_VERSION 1
+
+namespace {
+
+struct StoreHeader {
+  DWORD magic;
+  DWORD version;
+};
+
+// Followed by the key and the audio, padded to a multiple of 4 bytes.
+// Records are stored least recently used first.
+struct StoreRecord {
+  DWORD keyLength;
+  DWORD audioSize;
+};
+
+size_t Padded(size_t size) { return (size + 3) & ~(size_t)3; }
+
+// Read-only view of the store, kept alive by the phrases loaded from it.
+class StoreView {
+public:
+  explicit StoreView(const wchar_t *path) : file(INVALID_HANDLE_VALUE), mapping(nullptr), data(nullptr), size(0) {
+    // Deleting is shared, so the store can be replaced while it is mapped.
+    file = CreateFileW(path, GENERIC_READ, FILE_SHARE_READ | FILE_SHARE_DELETE, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+    LARGE_INTEGER fileSize;
+    if (file == INVALID_HANDLE_VALUE || !GetFileSizeEx(file, &fileSize) || !fileSize.QuadPart || fileSize.QuadPart > MAXDWORD) return;
+    mapping = CreateFileMappingW(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+    if (mapping) data = (const char *)MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+    if (data) size = (size_t)fileSize.QuadPart;
+  }
+  ~StoreView() {
+    if (data) UnmapViewOfFile(data);
+    if (mapping) CloseHandle(mapping);
+    if (file != INVALID_HANDLE_VALUE) CloseHandle(file);
+  }
+  StoreView(const StoreView&) = delete;
+  StoreView& operator=(const StoreView&) = delete;
+
+public:
+  const char *GetData() const { return data; }
+  size_t GetSize() const { return size; }
+
+private:
+  HANDLE file;
+  HANDLE mapping;
+  const char *data;
+  size_t size;
+};
+
+bool WriteAll(HANDLE file, const void *data, size_t size) {
+  DWORD written = 0;
+  return (!size || (WriteFile(file, data, (DWORD)size, &written, nullptr) && written == size));
+}
+
+} // namespace
+
+PhraseCache::PhraseCache(const wchar_t *path, size_t capacity, const std::wstring &voice, Renderer renderer) :
+  path(path ? path : L""),
+  capacity(capacity),
+  voice(voice),
+  renderer(renderer),
+  size(0),
+  hits(0),
+  misses(0),
+  dirty(false),
+  thread(nullptr),
+  wake(nullptr),
+  quit(false)
+{
+  InitializeCriticalSection(&lock);
+  if (!this->path.empty()) Load();
+}
+
+PhraseCache::~PhraseCache() {
+  EnterCriticalSection(&lock);
+  quit = true;
+  LeaveCriticalSection(&lock);
+  if (thread) {
+    // The phrase being rendered is finished first, they are short.
+    SetEvent(wake);
+    WaitForSingleObject(thread, INFINITE);
+    CloseHandle(thread);
+  }
+  if (wake) CloseHandle(wake);
+  if (dirty && !path.empty()) Save();
+  DeleteCriticalSection(&lock);
+}
+
+std::shared_ptr<const PhraseAudio> PhraseCache::Find(const wchar_t *text, const WAVEFORMATEX &format) {
+  if (!IsCacheable(text)) return nullptr;
+  const std::wstring key = MakeKey(text, format);
+  std::shared_ptr<const PhraseAudio> audio;
+  EnterCriticalSection(&lock);
+  const auto found = index.find(key);
+  if (found != index.end()) {
+    entries.splice(entries.begin(), entries, found->second);
+    audio = found->second->second;
+    ++hits;
+    dirty = true;
+  }
+  else {
+    ++misses;
+  }
+  LeaveCriticalSection(&lock);
+  return audio;
+}
+
+void PhraseCache::Insert(const wchar_t *text, const WAVEFORMATEX &format, std::vector<char> &&audio) {
+  if (!IsCacheable(text) || audio.empty()) return;
+  const std::wstring key = MakeKey(text, format);
+  const auto phrase = std::make_shared<const PhraseAudio>(std::move(audio));
+  EnterCriticalSection(&lock);
+  Add(key, phrase);
+  dirty = true;
+  LeaveCriticalSection(&lock);
+}
+
+void PhraseCache::Prefetch(const wchar_t *text, const WAVEFORMATEX &format) {
+  if (!IsCacheable(text)) return;
+  Request request = { MakeKey(text, format), text, format };
+  EnterCriticalSection(&lock);
+  bool queue = (!quit && pending.size() < PHRASE_CACHE_MAX_PENDING && !index.count(request.key));
+  for (auto it = pending.begin(); queue && it != pending.end(); ++it) {
+    if (it->key == request.key) queue = false;
+  }
+  if (queue && !thread) {
+    wake = CreateEventW(nullptr, FALSE, FALSE, nullptr);
+    if (wake) thread = CreateThread(nullptr, 0, ThreadProc, this, 0, nullptr);
+    if (!thread) queue = false;
+  }
+  if (queue) {
+    pending.push_back(std::move(request));
+    SetEvent(wake);
+  }
+  LeaveCriticalSection(&lock);
+}
+
+void PhraseCache::GetStats(unsigned long &hits, unsigned long &misses) {
+  EnterCriticalSection(&lock);
+  hits = this->hits;
+  misses = this->misses;
+  LeaveCriticalSection(&lock);
+}
+
+bool PhraseCache::IsCacheable(const wchar_t *text) {
+  if (!text || !*text) return false;
+  return (wcsnlen(text, PHRASE_CACHE_MAX_TEXT + 1) <= PHRASE_CACHE_MAX_TEXT);
+}
+
+DWORD WINAPI PhraseCache::ThreadProc(LPVOID parameter) {
+  ((PhraseCache *)parameter)->Run();
+  return 0;
+}
+
+void PhraseCache::Run() {
+  for (;;) {
+    WaitForSingleObject(wake, INFINITE);
+    for (;;) {
+      EnterCriticalSection(&lock);
+      if (quit) {
+        LeaveCriticalSection(&lock);
+        return;
+      }
+      if (pending.empty()) {
+        LeaveCriticalSection(&lock);
+        break;
+      }
+      Request request = std::move(pending.front());
+      pending.pop_front();
+      const bool cached = !!index.count(request.key);
+      LeaveCriticalSection(&lock);
+      // Rendered outside the lock, lookups must not wait for the engine.
+      std::vector<char> audio;
+      if (cached || !renderer(request.text.c_str(), request.format, audio) || audio.empty()) continue;
+      const auto phrase = std::make_shared<const PhraseAudio>(std::move(audio));
+      EnterCriticalSection(&lock);
+      Add(request.key, phrase);
+      dirty = true;
+      LeaveCriticalSection(&lock);
+    }
+  }
+}
+
+std::wstring PhraseCache::MakeKey(const wchar_t *text, const WAVEFORMATEX &format) const {
+  std::wstring key = voice;
+  key += L'|';
+  key += std::to_wstring(format.nSamplesPerSec) + L'/' + std::to_wstring(format.wBitsPerSample) + L'/' + std::to_wstring(format.nChannels);
+  key += L'|';
+  key += text;
+  return key;
+}
+
+void PhraseCache::Add(const std::wstring &key, const std::shared_ptr<const PhraseAudio> &audio) {
+  if (audio->GetSize() > capacity) return;
+  const auto found = index.find(key);
+  if (found != index.end()) {
+    size -= found->second->second->GetSize();
+    entries.erase(found->second);
+    index.erase(found);
+  }
+  entries.emplace_front(key, audio);
+  index[key] = entries.begin();
+  size += audio->GetSize();
+  while (size > capacity) {
+    size -= entries.back().second->GetSize();
+    index.erase(entries.back().first);
+    entries.pop_back();
+  }
+}
+
+void PhraseCache::Load() {
+  const auto view = std::make_shared<const StoreView>(path.c_str());
+  const char *position = view->GetData();
+  if (!position || view->GetSize() < sizeof(StoreHeader)) return;
+  const char *end = position + view->GetSize();
+  const StoreHeader *header = (const StoreHeader *)position;
+  if (header->magic != PHRASE_STORE_MAGIC || header->version != PHRASE_STORE_VERSION) return;
+  position += sizeof(StoreHeader);
+  while ((size_t)(end - position) >= sizeof(StoreRecord)) {
+    const StoreRecord *record = (const StoreRecord *)position;
+    const ULONGLONG keySize = (ULONGLONG)record->keyLength * sizeof(wchar_t);
+    const ULONGLONG length = sizeof(StoreRecord) + ((keySize + record->audioSize + 3) & ~3ULL);
+    // A store that was cut short keeps the records before the damage.
+    if (length > (ULONGLONG)(end - position)) break;
+    const wchar_t *key = (const wchar_t *)(record + 1);
+    const char *audio = (const char *)key + keySize;
+    Add(std::wstring(key, record->keyLength), std::make_shared<const PhraseAudio>(view, audio, record->audioSize));
+    position += length;
+  }
+}
+
+void PhraseCache::Save() {
+  // Written next to the store and moved over it, so a failure leaves the old one intact.
+  const std::wstring temporary = path + L".tmp";
+  HANDLE file = CreateFileW(temporary.c_str(), GENERIC_WRITE, 0, nullptr, CREATE_ALWAYS, FILE_ATTRIBUTE_NORMAL, nullptr);
+  if (file == INVALID_HANDLE_VALUE) return;
+  const StoreHeader header = { PHRASE_STORE_MAGIC, PHRASE_STORE_VERSION };
+  static const char padding[3] = {};
+  bool written = WriteAll(file, &header, sizeof(header));
+  for (auto it = entries.rbegin(); written && it != entries.rend(); ++it) {
+    const StoreRecord record = { (DWORD)it->first.size(), (DWORD)it->second->GetSize() };
+    const size_t length = record.keyLength * sizeof(wchar_t) + record.audioSize;
+    written = (WriteAll(file, &record, sizeof(record))
+      && WriteAll(file, it->first.data(), record.keyLength * sizeof(wchar_t))
+      && WriteAll(file, it->second->GetData(), record.audioSize)
+      && WriteAll(file, padding, Padded(length) - length));
+  }
+  CloseHandle(file);
+  // Phrases loaded from the old store still map it.
+  entries.clear();
+  index.clear();
+  size = 0;
+  if (!written || !MoveFileExW(temporary.c_str(), path.c_str(), MOVEFILE_REPLACE_EXISTING))
+    DeleteFileW(temporary.c_str());
+}
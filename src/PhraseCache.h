@@ -0,0 +1,109 @@
+/**
+ *  Product:        Tolk
+ *  File:           PhraseCache.h
+ *  Description:    Cache of rendered audio for frequently spoken phrases.
+ *  Copyright:      (c) 2026, Davy Kager <mail@davykager.nl>
+ *  License:        LGPLv3
+ */
+
+#ifndef _PHRASE_CACHE_H_
+#define _PHRASE_CACHE_H_
+
+#include <windows.h>
+#include <deque>
+#include <list>
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+// Longer text is rarely repeated word for word, so it is not cached.
+#define PHRASE_CACHE_MAX_TEXT 256
+// Phrases waiting to be rendered in the background, more are dropped.
+#define PHRASE_CACHE_MAX_PENDING 256
+
+// Rendered audio of one phrase, either owned or a view into the on-disk store.
+class PhraseAudio {
+public:
+  explicit PhraseAudio(std::vector<char> &&samples) : samples(std::move(samples)), data(this->samples.data()), size(this->samples.size()) {}
+  PhraseAudio(const std::shared_ptr<const void> &store, const char *data, size_t size) : store(store), data(data), size(size) {}
+  PhraseAudio(const PhraseAudio&) = delete;
+  PhraseAudio& operator=(const PhraseAudio&) = delete;
+
+public:
+  const char *GetData() const { return data; }
+  size_t GetSize() const { return size; }
+
+private:
+  std::vector<char> samples;
+  // Keeps the store mapped while the audio is in use.
+  std::shared_ptr<const void> store;
+  const char *data;
+  size_t size;
+};
+
+// LRU cache keyed by text, voice and audio format. Phrases are looked up from the
+// speaking thread, rendered on a background thread of the cache's own, and kept
+// in a file that is mapped into memory when the cache is created and rewritten
+// when it is destroyed.
+class PhraseCache {
+public:
+  // Renders the text in the given format, called on the background thread.
+  typedef bool (*Renderer)(const wchar_t *text, const WAVEFORMATEX &format, std::vector<char> &audio);
+
+public:
+  // The voice identifies the voice and its settings, phrases of other voices in the store are never found.
+  // The store is left out if path is nullptr.
+  PhraseCache(const wchar_t *path, size_t capacity, const std::wstring &voice, Renderer renderer);
+  ~PhraseCache();
+  PhraseCache(const PhraseCache&) = delete;
+  PhraseCache& operator=(const PhraseCache&) = delete;
+
+public:
+  // Returns nullptr on a miss.
+  std::shared_ptr<const PhraseAudio> Find(const wchar_t *text, const WAVEFORMATEX &format);
+  void Insert(const wchar_t *text, const WAVEFORMATEX &format, std::vector<char> &&audio);
+  // Queues the phrase to be rendered in the background, unless it is cached already.
+  void Prefetch(const wchar_t *text, const WAVEFORMATEX &format);
+  void GetStats(unsigned long &hits, unsigned long &misses);
+
+public:
+  static bool IsCacheable(const wchar_t *text);
+
+private:
+  struct Request {
+    std::wstring key;
+    std::wstring text;
+    WAVEFORMATEX format;
+  };
+  typedef std::list<std::pair<std::wstring, std::shared_ptr<const PhraseAudio>>> Entries;
+
+private:
+  static DWORD WINAPI ThreadProc(LPVOID parameter);
+  void Run();
+  std::wstring MakeKey(const wchar_t *text, const WAVEFORMATEX &format) const;
+  // The methods below expect the lock to be held.
+  void Add(const std::wstring &key, const std::shared_ptr<const PhraseAudio> &audio);
+  void Load();
+  void Save();
+
+private:
+  const std::wstring path;
+  const size_t capacity;
+  const std::wstring voice;
+  const Renderer renderer;
+  CRITICAL_SECTION lock;
+  // Most recently used first.
+  Entries entries;
+  std::unordered_map<std::wstring, Entries::iterator> index;
+  size_t size;
+  unsigned long hits;
+  unsigned long misses;
+  bool dirty;
+  std::deque<Request> pending;
+  HANDLE thread;
+  HANDLE wake;
+  bool quit;
+};
+
+#endif // _PHRASE_CACHE_H_
@@ -0,0 +1,99 @@
+/**
+ *  Product:        Tolk
+ *  File:           PresenceWatcher.cpp
+ *  Description:    Watches for screen readers starting and stopping.
+ *  Copyright:      (c) 2026, Davy Kager <mail@davykager.nl>
+ *  License:        LGPLv3
+ */
+
+// Screen readers show up as top-level windows (and their processes as
+// owners of those), so an out-of-context WinEvent hook on window creation
+// and destruction tells us when one may have started or stopped. Events
+// arrive in bursts, so they only (re)start a short timer and the listener
+// runs once things have settled. The hook is delivered through the message
+// loop of the watcher's own thread. A destroyed window can no longer be
+// asked for its parent, so the watcher keeps the top-level windows it has
+// seen and only counts destroys of those.
+
+#include "PresenceWatcher.h"
+
+// WinEvent procedures get no context pointer.
+static PresenceWatcher *g_watcher = nullptr;
+
+PresenceWatcher::PresenceWatcher(Listener listener) : listener(listener), thread(nullptr), threadId(0), ready(nullptr), settleTimer(0), serial(0) {
+  if (g_watcher) return;
+  ready = CreateEventW(nullptr, TRUE, FALSE, nullptr);
+  if (!ready) return;
+  g_watcher = this;
+  thread = CreateThread(nullptr, 0, ThreadProc, this, 0, &threadId);
+  if (thread) {
+    // The thread needs a message queue before it can be told to quit.
+    WaitForSingleObject(ready, INFINITE);
+  }
+  else {
+    g_watcher = nullptr;
+  }
+  CloseHandle(ready);
+  ready = nullptr;
+}
+
+PresenceWatcher::~PresenceWatcher() {
+  if (!thread) return;
+  PostThreadMessageW(threadId, WM_QUIT, 0, 0);
+  WaitForSingleObject(thread, INFINITE);
+  CloseHandle(thread);
+  g_watcher = nullptr;
+}
+
+DWORD WINAPI PresenceWatcher::ThreadProc(LPVOID parameter) {
+  // Drivers are called from the listener, see Tolk_SetDriverTimeout for the same reasoning.
+  const HRESULT hr = CoInitializeEx(nullptr, COINIT_MULTITHREADED);
+  ((PresenceWatcher *)parameter)->Run();
+  if (SUCCEEDED(hr)) CoUninitialize();
+  return 0;
+}
+
+void PresenceWatcher::Run() {
+  MSG msg;
+  PeekMessageW(&msg, nullptr, WM_USER, WM_USER, PM_NOREMOVE);
+  SetEvent(ready);
+  const HWINEVENTHOOK hook = SetWinEventHook(EVENT_OBJECT_CREATE, EVENT_OBJECT_DESTROY, nullptr, EventProc, 0, 0, WINEVENT_OUTOFCONTEXT | WINEVENT_SKIPOWNPROCESS);
+  // After the hook, so no window slips in between. One created in the meantime is added twice, which is harmless.
+  EnumWindows(EnumProc, (LPARAM)this);
+  const UINT_PTR refreshTimer = SetTimer(nullptr, 0, PRESENCE_REFRESH_INTERVAL, nullptr);
+  while (GetMessageW(&msg, nullptr, 0, 0) > 0) {
+    if (msg.message == WM_TIMER && (msg.wParam == settleTimer || msg.wParam == refreshTimer)) {
+      if (msg.wParam == settleTimer) {
+        KillTimer(nullptr, settleTimer);
+        settleTimer = 0;
+      }
+      InterlockedIncrement(&serial);
+      listener();
+      continue;
+    }
+    TranslateMessage(&msg);
+    DispatchMessageW(&msg);
+  }
+  if (settleTimer) KillTimer(nullptr, settleTimer);
+  if (refreshTimer) KillTimer(nullptr, refreshTimer);
+  if (hook) UnhookWinEvent(hook);
+}
+
+BOOL CALLBACK PresenceWatcher::EnumProc(HWND hwnd, LPARAM lParam) {
+  ((PresenceWatcher *)lParam)->windows.insert(hwnd);
+  return TRUE;
+}
+
+void CALLBACK PresenceWatcher::EventProc(HWINEVENTHOOK, DWORD event, HWND hwnd, LONG idObject, LONG idChild, DWORD, DWORD) {
+  if (!g_watcher || idObject != OBJID_WINDOW || idChild != CHILDID_SELF || !hwnd) return;
+  // Destroyed windows can't be inspected any more, they count if they were seen as top-level.
+  if (event == EVENT_OBJECT_CREATE) {
+    if (GetAncestor(hwnd, GA_PARENT) != GetDesktopWindow()) return;
+    g_watcher->windows.insert(hwnd);
+  }
+  else if (!g_watcher->windows.erase(hwnd)) {
+    return;
+  }
+  // Restarting the timer keeps bursts of events down to a single notification.
+  g_watcher->settleTimer = SetTimer(nullptr, g_watcher->settleTimer, PRESENCE_SETTLE_DELAY, nullptr);
+}
@@ -0,0 +1,56 @@
+/**
+ *  Product:        Tolk
+ *  File:           PresenceWatcher.h
+ *  Description:    Watches for screen readers starting and stopping.
+ *  Copyright:      (c) 2026, Davy Kager <mail@davykager.nl>
+ *  License:        LGPLv3
+ */
+
+#ifndef _PRESENCE_WATCHER_H_
+#define _PRESENCE_WATCHER_H_
+
+#include <windows.h>
+#include <unordered_set>
+
+// Time for a screen reader that just opened its windows to get its API ready.
+#define PRESENCE_SETTLE_DELAY 500
+// Not every driver has a window to watch, so the watcher reports a change now and then regardless.
+#define PRESENCE_REFRESH_INTERVAL 5000
+
+class PresenceWatcher {
+public:
+  typedef void (*Listener)();
+
+public:
+  // The listener is called on the watcher's thread, some time after top-level
+  // windows were created or destroyed. Other windows come and go all the time
+  // and don't count. Only one watcher can run at a time.
+  explicit PresenceWatcher(Listener listener);
+  // Stops the thread. Must not be called from the listener or while the loader lock is held.
+  ~PresenceWatcher();
+  PresenceWatcher(const PresenceWatcher&) = delete;
+  PresenceWatcher& operator=(const PresenceWatcher&) = delete;
+
+public:
+  bool IsRunning() const { return (thread != nullptr); }
+  // Changes every time the listener is about to be called.
+  LONG GetSerial() const { return serial; }
+
+private:
+  static DWORD WINAPI ThreadProc(LPVOID parameter);
+  static BOOL CALLBACK EnumProc(HWND hwnd, LPARAM lParam);
+  static void CALLBACK EventProc(HWINEVENTHOOK hook, DWORD event, HWND hwnd, LONG idObject, LONG idChild, DWORD eventThread, DWORD eventTime);
+  void Run();
+
+private:
+  Listener listener;
+  HANDLE thread;
+  DWORD threadId;
+  HANDLE ready;
+  UINT_PTR settleTimer;
+  // The top-level windows known to exist, only touched on the watcher's thread.
+  std::unordered_set<HWND> windows;
+  volatile LONG serial;
+};
+
+#endif // _PRESENCE_WATCHER_H_
@@ -0,0 +1,201 @@
+/**
+ *  Product:        Tolk
+ *  File:           PronunciationDictionary.cpp
+ *  Description:    Substitution dictionary applied to text before it is spoken.
+ *  Copyright:      (c) 2026, Davy Kager <mail@davykager.nl>
+ *  License:        LGPLv3
+ */
+
+#include <algorithm>
+#include "PronunciationDictionary.h"
+#include "TextClasses.h"
+
+// Edges of a state are searched one by one up to this many, by halving beyond.
+#define DICTIONARY_LINEAR_EDGES 8
+
+namespace {
+
+wchar_t Fold(wchar_t c) {
+  if (c < 0x80) return (c >= L'A' && c <= L'Z') ? (wchar_t)(c + (L'a' - L'A')) : c;
+  // With the high word zero, CharLowerW converts the single character in the low word.
+  return (wchar_t)(ULONG_PTR)CharLowerW((LPWSTR)(ULONG_PTR)c);
+}
+
+bool ReadFileContents(const wchar_t *path, std::string &contents) {
+  HANDLE file = CreateFileW(path, GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+  if (file == INVALID_HANDLE_VALUE) return false;
+  LARGE_INTEGER size;
+  bool result = (GetFileSizeEx(file, &size) && size.QuadPart < MAXLONG);
+  if (result) {
+    contents.resize((size_t)size.QuadPart);
+    DWORD read = 0;
+    result = (contents.empty() || (ReadFile(file, &contents[0], (DWORD)contents.size(), &read, nullptr) && read == contents.size()));
+  }
+  CloseHandle(file);
+  return result;
+}
+
+} // namespace
+
+std::shared_ptr<const PronunciationDictionary> PronunciationDictionary::Load(const wchar_t *path) {
+  std::string contents;
+  if (!path || !ReadFileContents(path, contents)) return nullptr;
+  size_t skip = 0;
+  if (contents.compare(0, 3, "\xEF\xBB\xBF") == 0) skip = 3;
+  std::wstring text;
+  if (contents.size() > skip) {
+    const int length = MultiByteToWideChar(CP_UTF8, 0, contents.data() + skip, (int)(contents.size() - skip), nullptr, 0);
+    if (length <= 0) return nullptr;
+    text.resize(length);
+    MultiByteToWideChar(CP_UTF8, 0, contents.data() + skip, (int)(contents.size() - skip), &text[0], length);
+  }
+  std::vector<std::pair<std::wstring, std::wstring>> patterns;
+  for (size_t start = 0; start < text.size();) {
+    size_t end = text.find(L'\n', start);
+    if (end == std::wstring::npos) end = text.size();
+    size_t lineEnd = end;
+    if (lineEnd > start && text[lineEnd - 1] == L'\r') --lineEnd;
+    const size_t tab = text.find(L'\t', start);
+    if (text[start] != L'#' && tab > start && tab < lineEnd) {
+      // Fields after the replacement are ignored.
+      const size_t replacementEnd = std::min(text.find(L'\t', tab + 1), lineEnd);
+      std::wstring pattern = text.substr(start, tab - start);
+      std::transform(pattern.begin(), pattern.end(), pattern.begin(), Fold);
+      patterns.emplace_back(std::move(pattern), text.substr(tab + 1, replacementEnd - tab - 1));
+    }
+    start = end + 1;
+  }
+  std::shared_ptr<PronunciationDictionary> dictionary(new PronunciationDictionary());
+  dictionary->Build(patterns);
+  return dictionary;
+}
+
+void PronunciationDictionary::Build(std::vector<std::pair<std::wstring, std::wstring>> &patterns) {
+  // Sorted, so the trie can be built by only ever looking at the last child of a node.
+  // Of patterns listed twice the last one wins.
+  std::stable_sort(patterns.begin(), patterns.end(), [](const std::pair<std::wstring, std::wstring> &a, const std::pair<std::wstring, std::wstring> &b) { return a.first < b.first; });
+  struct Node {
+    std::vector<std::pair<wchar_t, DWORD>> children;
+    LONG entry;
+  };
+  std::vector<Node> nodes(1);
+  nodes[0].entry = -1;
+  for (size_t i = 0; i < patterns.size(); ++i) {
+    const std::wstring &pattern = patterns[i].first;
+    if (i + 1 < patterns.size() && patterns[i + 1].first == pattern) continue;
+    DWORD node = 0;
+    for (const wchar_t c : pattern) {
+      const std::vector<std::pair<wchar_t, DWORD>> &children = nodes[node].children;
+      if (!children.empty() && children.back().first == c) {
+        node = children.back().second;
+        continue;
+      }
+      const DWORD child = (DWORD)nodes.size();
+      nodes.push_back(Node());
+      nodes[child].entry = -1;
+      nodes[node].children.emplace_back(c, child);
+      node = child;
+    }
+    Entry entry;
+    entry.replacement = std::move(patterns[i].second);
+    entry.length = (DWORD)pattern.size();
+    entry.wordStart = IsWordChar(pattern.front());
+    entry.wordEnd = IsWordChar(pattern.back());
+    nodes[node].entry = (LONG)entries.size();
+    entries.push_back(std::move(entry));
+  }
+  // Renumbered breadth first into the flat tables, which also orders the states
+  // for working out the fail links below.
+  std::vector<DWORD> order(1, 0);
+  order.reserve(nodes.size());
+  states.resize(nodes.size());
+  edges.reserve(nodes.size() - 1);
+  for (size_t i = 0; i < order.size(); ++i) {
+    Node &node = nodes[order[i]];
+    State &state = states[i];
+    state.firstEdge = (DWORD)edges.size();
+    state.edgeCount = (DWORD)node.children.size();
+    state.fail = 0;
+    state.outputLink = 0;
+    state.entry = node.entry;
+    for (const auto &child : node.children) {
+      edges.push_back({ child.first, (DWORD)order.size() });
+      order.push_back(child.second);
+    }
+    std::vector<std::pair<wchar_t, DWORD>>().swap(node.children);
+  }
+  std::fill(std::begin(rootAscii), std::end(rootAscii), 0);
+  for (DWORD i = 0; i < states[0].edgeCount; ++i) {
+    const Edge &edge = edges[states[0].firstEdge + i];
+    if (edge.character < 0x80) rootAscii[edge.character] = edge.next;
+  }
+  for (size_t i = 0; i < states.size(); ++i) {
+    for (DWORD j = 0; j < states[i].edgeCount; ++j) {
+      const Edge &edge = edges[states[i].firstEdge + j];
+      State &next = states[edge.next];
+      next.fail = i ? Next(states[i].fail, edge.character) : 0;
+      const State &fail = states[next.fail];
+      next.outputLink = (fail.entry >= 0) ? next.fail : fail.outputLink;
+    }
+  }
+}
+
+DWORD PronunciationDictionary::Next(DWORD state, wchar_t c) const {
+  for (;;) {
+    if (!state && c < 0x80) return rootAscii[c];
+    const State &current = states[state];
+    const Edge *first = edges.data() + current.firstEdge;
+    const Edge *last = first + current.edgeCount;
+    const Edge *found = first;
+    if (current.edgeCount <= DICTIONARY_LINEAR_EDGES) {
+      while (found != last && found->character < c) ++found;
+    }
+    else {
+      found = std::lower_bound(first, last, c, [](const Edge &edge, wchar_t character) { return edge.character < character; });
+    }
+    if (found != last && found->character == c) return found->next;
+    if (!state) return 0;
+    state = current.fail;
+  }
+}
+
+const wchar_t *PronunciationDictionary::Apply(const wchar_t *str) const {
+  if (entries.empty()) return str;
+  struct Match {
+    DWORD length;
+    LONG entry;
+  };
+  // Per thread, like the buffers of NormalizeText.
+  thread_local std::vector<Match> matches;
+  thread_local std::wstring buffer;
+  const size_t length = wcslen(str);
+  bool matched = false;
+  DWORD state = 0;
+  for (size_t i = 0; i < length; ++i) {
+    state = Next(state, Fold(str[i]));
+    // Every pattern ending here, longest first. Per start position only the longest is kept.
+    for (DWORD output = (states[state].entry >= 0) ? state : states[state].outputLink; output; output = states[output].outputLink) {
+      const Entry &entry = entries[states[output].entry];
+      const size_t start = i + 1 - entry.length;
+      if (entry.wordStart && start > 0 && IsWordChar(str[start - 1])) continue;
+      if (entry.wordEnd && i + 1 < length && IsWordChar(str[i + 1])) continue;
+      if (!matched) {
+        matches.assign(length, Match{ 0, -1 });
+        matched = true;
+      }
+      if (entry.length > matches[start].length) matches[start] = { entry.length, states[output].entry };
+    }
+  }
+  if (!matched) return str;
+  buffer.clear();
+  for (size_t i = 0; i < length;) {
+    if (matches[i].length) {
+      buffer += entries[matches[i].entry].replacement;
+      i += matches[i].length;
+    }
+    else {
+      buffer += str[i++];
+    }
+  }
+  return buffer.c_str();
+}
@@ -0,0 +1,72 @@
+/**
+ *  Product:        Tolk
+ *  File:           PronunciationDictionary.h
+ *  Description:    Substitution dictionary applied to text before it is spoken.
+ *  Copyright:      (c) 2026, Davy Kager <mail@davykager.nl>
+ *  License:        LGPLv3
+ */
+
+#ifndef _PRONUNCIATION_DICTIONARY_H_
+#define _PRONUNCIATION_DICTIONARY_H_
+
+#include <windows.h>
+#include <memory>
+#include <string>
+#include <vector>
+
+// Patterns are matched case-insensitively by an Aho-Corasick automaton, in one
+// pass over the text. Where patterns overlap the leftmost one wins, and of those
+// the longest. A pattern that starts or ends with a letter or digit only matches
+// at a word boundary on that side. Immutable once loaded, so it can be shared
+// between threads and replaced while it is in use.
+class PronunciationDictionary {
+public:
+  // Reads a UTF-8 file with one entry per line, the pattern and its replacement
+  // separated by a tab. Empty lines and lines starting with # are skipped.
+  // Returns nullptr if the file can't be read.
+  static std::shared_ptr<const PronunciationDictionary> Load(const wchar_t *path);
+  PronunciationDictionary(const PronunciationDictionary&) = delete;
+  PronunciationDictionary& operator=(const PronunciationDictionary&) = delete;
+
+public:
+  // Returns str itself if nothing matched, otherwise a buffer of the calling
+  // thread that is valid until its next call.
+  const wchar_t *Apply(const wchar_t *str) const;
+  size_t GetSize() const { return entries.size(); }
+
+private:
+  struct Entry {
+    std::wstring replacement;
+    DWORD length;
+    bool wordStart;
+    bool wordEnd;
+  };
+  // The edges of a state are consecutive in one array, sorted by character.
+  struct State {
+    DWORD firstEdge;
+    DWORD edgeCount;
+    DWORD fail;
+    // Nearest state down the fail chain that ends a pattern, 0 if there is none.
+    DWORD outputLink;
+    // The pattern ending in this state, -1 if none does.
+    LONG entry;
+  };
+  struct Edge {
+    wchar_t character;
+    DWORD next;
+  };
+
+private:
+  PronunciationDictionary() {}
+  void Build(std::vector<std::pair<std::wstring, std::wstring>> &patterns);
+  DWORD Next(DWORD state, wchar_t c) const;
+
+private:
+  std::vector<Entry> entries;
+  std::vector<State> states;
+  std::vector<Edge> edges;
+  // Transitions out of the root for ASCII, the most common case, without a search.
+  DWORD rootAscii[128];
+};
+
+#endif // _PRONUNCIATION_DICTIONARY_H_
@@ -9,15 +9,32 @@
 #ifndef _SCREEN_READER_DRIVER_H_
 #define _SCREEN_READER_DRIVER_H_
 
+#include <string>
+
+class SpeechMarkup;
+
 class ScreenReaderDriver {
 protected:
-  ScreenReaderDriver(const wchar_t *screenReaderName, bool speech, bool braille) :
+  ScreenReaderDriver(const wchar_t *screenReaderName, bool speech, bool braille, bool status) :
     name(screenReaderName),
     hasSpeech(speech),
-    hasBraille(braille)
+    hasBraille(braille),
+    hasStatus(status),
+    progressListener(nullptr)
     {}
   ScreenReaderDriver(const ScreenReaderDriver&) = delete;
   ScreenReaderDriver& operator=(const ScreenReaderDriver&) = delete;
+  // For drivers that only learn their name and capabilities after construction.
+  void Describe(const wchar_t *screenReaderName, bool speech, bool braille, bool status) {
+    name = screenReaderName;
+    hasSpeech = speech;
+    hasBraille = braille;
+    hasStatus = status;
+  }
+  // May be called on any thread.
+  void ReportProgress(int event, unsigned long position, unsigned long length) {
+    if (progressListener) progressListener(this, event, position, length);
+  }
 
 public:
   virtual ~ScreenReaderDriver() {}
@@ -29,16 +46,47 @@ public:
   virtual bool Silence() = 0;
   virtual bool IsActive() = 0;
   virtual bool Output(const wchar_t *str, bool interrupt) = 0;
+  // An auto-reset event handle the driver signals when speech may have ended, if it has one.
+  // Tolk still asks IsSpeaking to be sure.
+  virtual void *GetSpeechEvent() { return nullptr; }
+  // Drivers holding COM interfaces, which only work in the apartment they were created in,
+  // release them here. The next IsActive creates them again on the thread it is called on.
+  virtual void Disconnect() {}
+  // Utterances the screen reader has been given and not finished speaking, false if the driver
+  // can't tell. Only reads state the driver keeps, so it may run while another call is in progress.
+  virtual bool GetQueuedUtterances(unsigned int &) { return false; }
+  // Cells of the braille display, 0 if the driver can't tell. Must return quickly.
+  virtual unsigned int GetBrailleCells() { return 0; }
+  // Speaks the content of an SSML speak element, the driver wraps it in the element itself.
+  // Marks in it are reported as bookmarks, numbered by their name, if HasBookmarks.
+  // Only called if HasSsml.
+  virtual bool SpeakSsml(const wchar_t *, bool) { return false; }
+  virtual bool HasSsml() const { return false; }
+  virtual bool HasBookmarks() const { return false; }
+  // Turns speech markup into what SpeakMarkup takes, once per text, the result is cached.
+  // Drivers with a form of their own return true. For the others SpeechMarkupCache
+  // makes SSML if the driver has it, the plain text approximation otherwise.
+  virtual bool LowerMarkup(const SpeechMarkup &, std::wstring &) const { return false; }
+  virtual bool SpeakMarkup(const wchar_t *lowered, bool interrupt) { return HasSsml() ? SpeakSsml(lowered, interrupt) : Speak(lowered, interrupt); }
 
 public:
   const wchar_t * GetName() const { return name; }
   bool HasSpeech() const { return hasSpeech; }
   bool HasBraille() const { return hasBraille; }
+  // Whether IsSpeaking reflects the screen reader's state, Tolk estimates it otherwise.
+  bool HasStatus() const { return hasStatus; }
+
+public:
+  // Receives SpeechProgressEvent values from drivers that know how far they got.
+  typedef void (*ProgressListener)(ScreenReaderDriver *driver, int event, unsigned long position, unsigned long length);
+  void SetProgressListener(ProgressListener listener) { progressListener = listener; }
 
 private:
   const wchar_t *name;
-  const bool hasSpeech;
-  const bool hasBraille;
+  bool hasSpeech;
+  bool hasBraille;
+  bool hasStatus;
+  ProgressListener progressListener;
 };
 
 #endif // _SCREEN_READER_DRIVER_H_
@@ -8,21 +8,91 @@
 
 #include "ScreenReaderDriverBOY.h"
 #include <windows.h>
+#include <array>
+#include <utility>
+
+// BoyCtrlSpeak's completion callback carries no context, so utterances are
+// tracked in a ring of slots that each have a callback function of their
+// own. An utterance takes a free slot from its sequence number on and is
+// pending until that slot's callback runs, or until it is interrupted or
+// silenced. The slot isn't free again before BOY calls back for it, even if
+// Tolk gave up on the utterance earlier, or a late callback would complete
+// the utterance that took the slot next. Slots are only touched through
+// interlocked operations because callbacks arrive on BOY's threads.
+#define BOY_COMPLETION_SLOTS 32
+
+#define BOY_SLOT_FREE 0
+#define BOY_SLOT_PENDING 1
+// Completed by Tolk, BOY's callback is still to come.
+#define BOY_SLOT_ABANDONED 2
+
+namespace {
+
+// One of the BOY_SLOT_ states.
+volatile LONG g_slots[BOY_COMPLETION_SLOTS];
+volatile LONG g_sequence = 0;
+// Number of pending utterances, in other words the depth of BOY's queue.
+volatile LONG g_pending = 0;
+// Shared by all instances, like the slots, and closed with the last of them.
+HANDLE g_speakCompleteEvent = nullptr;
+LONG g_instances = 0;
+
+bool Complete(volatile LONG& slot)
+{
+    if (InterlockedCompareExchange(&slot, BOY_SLOT_ABANDONED, BOY_SLOT_PENDING) != BOY_SLOT_PENDING)
+        return false;
+    InterlockedDecrement(&g_pending);
+    return true;
+}
 
-int ScreenReaderDriverBOY::g_speakCompleteReason = -1;
+// Returns whether the utterance was still pending.
+bool Release(volatile LONG& slot)
+{
+    if (InterlockedExchange(&slot, BOY_SLOT_FREE) != BOY_SLOT_PENDING)
+        return false;
+    InterlockedDecrement(&g_pending);
+    return true;
+}
 
-void __stdcall ScreenReaderDriverBOY::SpeakCompleteCallback(int reason)
+void CompleteAll()
 {
-    g_speakCompleteReason = reason;
+    bool completed = false;
+    for (volatile LONG& slot : g_slots)
+        completed |= Complete(slot);
+    if (completed && g_speakCompleteEvent)
+        SetEvent(g_speakCompleteEvent);
 }
 
+// BOY's reason tells a finished utterance from an interrupted one, but Tolk
+// interrupts utterances itself and completes them right then.
+template <size_t Slot>
+void __stdcall SpeakCompleteCallback(int /*reason*/)
+{
+    // Late callbacks for interrupted utterances find their slot completed already.
+    if (Release(g_slots[Slot]) && g_speakCompleteEvent)
+        SetEvent(g_speakCompleteEvent);
+}
+
+template <size_t... Slots>
+constexpr std::array<BoyCtrlSpeakCompleteFunc, sizeof...(Slots)> MakeCallbacks(std::index_sequence<Slots...>)
+{
+    return {{ &SpeakCompleteCallback<Slots>... }};
+}
+
+const std::array<BoyCtrlSpeakCompleteFunc, BOY_COMPLETION_SLOTS> g_callbacks = MakeCallbacks(std::make_index_sequence<BOY_COMPLETION_SLOTS>());
+
+} // namespace
+
 ScreenReaderDriverBOY::ScreenReaderDriverBOY()
-    : ScreenReaderDriver(L"BoyPCReader", true, false),
+    : ScreenReaderDriver(L"BoyPCReader", true, false, true),
       controller(nullptr),
       BoyInit(nullptr), BoyUninit(nullptr),
       BoyIsRunning(nullptr), BoySpeak(nullptr),
       BoyStopSpeak(nullptr)
 {
+    if (g_instances++ == 0)
+        g_speakCompleteEvent = CreateEventW(nullptr, FALSE, FALSE, nullptr);
+
 #ifdef _WIN64
     controller = LoadLibraryW(L"byctrl-x64.dll");
 #else
@@ -59,6 +129,15 @@ ScreenReaderDriverBOY::~ScreenReaderDriverBOY()
         FreeLibrary(controller);
         controller = nullptr;
     }
+    // No more callbacks can come in once BOY has been uninitialized.
+    if (--g_instances == 0 && g_speakCompleteEvent)
+    {
+        CompleteAll();
+        for (volatile LONG& slot : g_slots)
+            Release(slot);
+        CloseHandle(g_speakCompleteEvent);
+        g_speakCompleteEvent = nullptr;
+    }
 }
 
 bool ScreenReaderDriverBOY::Speak(const wchar_t* str, bool interrupt)
@@ -66,10 +145,35 @@ bool ScreenReaderDriverBOY::Speak(const wchar_t* str, bool interrupt)
     if (!controller || !BoySpeak || !str || str[0] == L'\0')
         return false;
 
-    g_speakCompleteReason = -1;
-    int err = BoySpeak(str, true, SpeakCompleteCallback);
+    // Not appending makes BOY drop whatever it was still saying.
+    if (interrupt)
+        CompleteAll();
 
-    return (err == e_bcerr_success);
+    const ULONG sequence = (ULONG)InterlockedIncrement(&g_sequence);
+    ULONG slotIndex = BOY_COMPLETION_SLOTS;
+    for (ULONG i = 0; i < BOY_COMPLETION_SLOTS; ++i)
+    {
+        const ULONG index = (sequence + i) % BOY_COMPLETION_SLOTS;
+        if (InterlockedCompareExchange(&g_slots[index], BOY_SLOT_PENDING, BOY_SLOT_FREE) == BOY_SLOT_FREE)
+        {
+            slotIndex = index;
+            break;
+        }
+    }
+    // With a callback outstanding for every slot, the utterance is spoken untracked.
+    if (slotIndex == BOY_COMPLETION_SLOTS)
+        return BoySpeak(str, !interrupt, nullptr) == e_bcerr_success;
+    volatile LONG& slot = g_slots[slotIndex];
+    InterlockedIncrement(&g_pending);
+
+    int err = BoySpeak(str, !interrupt, g_callbacks[slotIndex]);
+    if (err != e_bcerr_success)
+    {
+        // No callback comes for text BOY didn't take.
+        Release(slot);
+        return false;
+    }
+    return true;
 }
 
 bool ScreenReaderDriverBOY::Braille(const wchar_t* /*str*/)
@@ -79,7 +183,19 @@ bool ScreenReaderDriverBOY::Braille(const wchar_t* /*str*/)
 
 bool ScreenReaderDriverBOY::IsSpeaking()
 {
-    return (g_speakCompleteReason == -1);
+    return (g_pending > 0);
+}
+
+bool ScreenReaderDriverBOY::GetQueuedUtterances(unsigned int& count)
+{
+    const LONG pending = g_pending;
+    count = (pending > 0) ? (unsigned int)pending : 0;
+    return (controller != nullptr);
+}
+
+void* ScreenReaderDriverBOY::GetSpeechEvent()
+{
+    return g_speakCompleteEvent;
 }
 
 bool ScreenReaderDriverBOY::Silence()
@@ -90,7 +206,7 @@ bool ScreenReaderDriverBOY::Silence()
     int err = BoyStopSpeak();
     if (err == e_bcerr_success)
     {
-        g_speakCompleteReason = e_bcerr_unavailable;
+        CompleteAll();
         return true;
     }
     return false;
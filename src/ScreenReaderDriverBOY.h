@@ -21,7 +21,7 @@ enum BoyCtrlError {
     e_bcerr_unavailable = 3
 };
 
-class ScreenReaderDriverBOY : public ScreenReaderDriver
+class ScreenReaderDriverBOY final : public ScreenReaderDriver
 {
 public:
     ScreenReaderDriverBOY();
@@ -33,9 +33,8 @@ public:
     bool Silence() override;
     bool IsActive() override;
     bool Output(const wchar_t *str, bool interrupt) override;
-
-    static int g_speakCompleteReason;
-    static void __stdcall SpeakCompleteCallback(int reason);
+    void *GetSpeechEvent() override;
+    bool GetQueuedUtterances(unsigned int &count) override;
 
 private:
     HINSTANCE controller;
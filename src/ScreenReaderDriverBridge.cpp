@@ -0,0 +1,148 @@
+/**
+ *  Product:        Tolk
+ *  File:           ScreenReaderDriverBridge.cpp
+ *  Description:    Driver that hosts another driver in a helper process of the other bitness.
+ *  Copyright:      (c) 2026, Davy Kager <mail@davykager.nl>
+ *  License:        LGPLv3
+ */
+
+// Some screen readers only ship a 32-bit API DLL. To use them from a 64-bit
+// process, the real driver runs in TolkBridge32.exe and every call is forwarded
+// through a single-slot request/response channel in shared memory. The helper
+// is started the first time auto-detection reaches this driver.
+
+#include <cstring>
+#include "ScreenReaderDriverBridge.h"
+
+// Generous, the helper has to start and load the screen reader API.
+#define TOLK_BRIDGE_START_TIMEOUT 5000
+// A helper that takes longer than this is considered hung and is killed.
+#define TOLK_BRIDGE_CALL_TIMEOUT 2000
+// Don't restart a helper that died more often than this.
+#define TOLK_BRIDGE_RESTART_INTERVAL 10000
+
+ScreenReaderDriverBridge::ScreenReaderDriverBridge(const wchar_t *bridgedDriver, const std::wstring &helper) :
+  ScreenReaderDriver(L"", false, false, false),
+  driver(bridgedDriver),
+  helperPath(helper),
+  bridgedName(bridgedDriver),
+  mapping(nullptr),
+  channel(nullptr),
+  requestEvent(nullptr),
+  responseEvent(nullptr),
+  helper(nullptr),
+  lastStart(0)
+{
+  // Replaced by the bridged driver's own name once the helper is running.
+  Describe(bridgedName.c_str(), false, false, false);
+}
+
+ScreenReaderDriverBridge::~ScreenReaderDriverBridge() {
+  Finalize();
+}
+
+bool ScreenReaderDriverBridge::IsActive() {
+  if (helper && WaitForSingleObject(helper, 0) != WAIT_TIMEOUT) Finalize();
+  if (!helper && !Initialize()) return false;
+  return Call(TOLK_BRIDGE_OP_IS_ACTIVE, nullptr, false);
+}
+
+bool ScreenReaderDriverBridge::Initialize() {
+  const ULONGLONG now = GetTickCount64();
+  if (lastStart && now - lastStart < TOLK_BRIDGE_RESTART_INTERVAL) return false;
+  lastStart = now;
+  // Unique per driver instance, the helper derives the event names from it.
+  wchar_t name[128];
+  swprintf_s(name, L"Local\\TolkBridge-%lu-%p", GetCurrentProcessId(), (void *)this);
+  const std::wstring base(name);
+  mapping = CreateFileMappingW(INVALID_HANDLE_VALUE, nullptr, PAGE_READWRITE, 0, sizeof(TolkBridgeChannel), base.c_str());
+  if (!mapping) return false;
+  channel = (TolkBridgeChannel *)MapViewOfFile(mapping, FILE_MAP_ALL_ACCESS, 0, 0, sizeof(TolkBridgeChannel));
+  requestEvent = CreateEventW(nullptr, FALSE, FALSE, (base + L"-Request").c_str());
+  responseEvent = CreateEventW(nullptr, FALSE, FALSE, (base + L"-Response").c_str());
+  if (!channel || !requestEvent || !responseEvent) {
+    Finalize();
+    return false;
+  }
+  channel->version = TOLK_BRIDGE_VERSION;
+  channel->state = TOLK_BRIDGE_STATE_IDLE;
+  wchar_t arguments[64];
+  swprintf_s(arguments, L" %lu", GetCurrentProcessId());
+  std::wstring commandLine = L"\"" + helperPath + L"\" " + driver + L" " + base + arguments;
+  STARTUPINFOW startupInfo = {};
+  startupInfo.cb = sizeof(startupInfo);
+  PROCESS_INFORMATION processInfo = {};
+  if (!CreateProcessW(helperPath.c_str(), &commandLine[0], nullptr, nullptr, FALSE, CREATE_NO_WINDOW, nullptr, nullptr, &startupInfo, &processInfo)) {
+    Finalize();
+    return false;
+  }
+  CloseHandle(processInfo.hThread);
+  helper = processInfo.hProcess;
+  // The helper answers once it has created the driver.
+  if (!TolkBridgeWait(channel, TOLK_BRIDGE_STATE_RESPONSE, &channel->clientWaiting, responseEvent, helper, TOLK_BRIDGE_START_TIMEOUT) || !channel->result) {
+    Finalize();
+    return false;
+  }
+  channel->name[TOLK_BRIDGE_MAX_NAME - 1] = L'\0';
+  bridgedName = channel->name;
+  Describe(bridgedName.c_str(), !!channel->hasSpeech, !!channel->hasBraille, !!channel->hasStatus);
+  channel->state = TOLK_BRIDGE_STATE_IDLE;
+  return true;
+}
+
+void ScreenReaderDriverBridge::Finalize() {
+  if (helper) {
+    if (channel && channel->state == TOLK_BRIDGE_STATE_IDLE) {
+      channel->operation = TOLK_BRIDGE_OP_QUIT;
+      TolkBridgeSignal(channel, TOLK_BRIDGE_STATE_REQUEST, &channel->helperWaiting, requestEvent);
+    }
+    if (WaitForSingleObject(helper, TOLK_BRIDGE_CALL_TIMEOUT) != WAIT_OBJECT_0) TerminateProcess(helper, 1);
+    CloseHandle(helper);
+    helper = nullptr;
+  }
+  if (responseEvent) {
+    CloseHandle(responseEvent);
+    responseEvent = nullptr;
+  }
+  if (requestEvent) {
+    CloseHandle(requestEvent);
+    requestEvent = nullptr;
+  }
+  if (channel) {
+    UnmapViewOfFile(channel);
+    channel = nullptr;
+  }
+  if (mapping) {
+    CloseHandle(mapping);
+    mapping = nullptr;
+  }
+}
+
+bool ScreenReaderDriverBridge::RoundTrip(LONG operation, const wchar_t *str, size_t length, bool interrupt) {
+  channel->operation = operation;
+  channel->interrupt = interrupt;
+  channel->length = (LONG)length;
+  if (length) memcpy(channel->text, str, length * sizeof(wchar_t));
+  channel->text[length] = L'\0';
+  TolkBridgeSignal(channel, TOLK_BRIDGE_STATE_REQUEST, &channel->helperWaiting, requestEvent);
+  if (!TolkBridgeWait(channel, TOLK_BRIDGE_STATE_RESPONSE, &channel->clientWaiting, responseEvent, helper, TOLK_BRIDGE_CALL_TIMEOUT)) {
+    // The helper hung or died, start over on the next detection.
+    TerminateProcess(helper, 1);
+    Finalize();
+    return false;
+  }
+  const bool result = !!channel->result;
+  channel->state = TOLK_BRIDGE_STATE_IDLE;
+  return result;
+}
+
+bool ScreenReaderDriverBridge::Call(LONG operation, const wchar_t *str, bool interrupt) {
+  if (!helper) return false;
+  size_t length = str ? wcslen(str) : 0;
+  while (length > TOLK_BRIDGE_MAX_TEXT - 1) {
+    if (!RoundTrip(TOLK_BRIDGE_OP_APPEND, str, TOLK_BRIDGE_MAX_TEXT - 1, false)) return false;
+    str += TOLK_BRIDGE_MAX_TEXT - 1;
+    length -= TOLK_BRIDGE_MAX_TEXT - 1;
+  }
+  return RoundTrip(operation, str, length, interrupt);
+}
@@ -0,0 +1,47 @@
+/**
+ *  Product:        Tolk
+ *  File:           ScreenReaderDriverBridge.h
+ *  Description:    Driver that hosts another driver in a helper process of the other bitness.
+ *  Copyright:      (c) 2026, Davy Kager <mail@davykager.nl>
+ *  License:        LGPLv3
+ */
+
+#ifndef _SCREEN_READER_DRIVER_BRIDGE_H_
+#define _SCREEN_READER_DRIVER_BRIDGE_H_
+
+#include <string>
+#include "TolkBridge.h"
+#include "ScreenReaderDriver.h"
+
+class ScreenReaderDriverBridge final : public ScreenReaderDriver {
+public:
+  ScreenReaderDriverBridge(const wchar_t *bridgedDriver, const std::wstring &helper);
+  ~ScreenReaderDriverBridge();
+
+public:
+  bool Speak(const wchar_t *str, bool interrupt) override { return Call(TOLK_BRIDGE_OP_SPEAK, str, interrupt); }
+  bool Braille(const wchar_t *str) override { return Call(TOLK_BRIDGE_OP_BRAILLE, str, false); }
+  bool IsSpeaking() override { return Call(TOLK_BRIDGE_OP_IS_SPEAKING, nullptr, false); }
+  bool Silence() override { return Call(TOLK_BRIDGE_OP_SILENCE, nullptr, false); }
+  bool IsActive() override;
+  bool Output(const wchar_t *str, bool interrupt) override { return Call(TOLK_BRIDGE_OP_OUTPUT, str, interrupt); }
+
+private:
+  bool Initialize();
+  void Finalize();
+  bool RoundTrip(LONG operation, const wchar_t *str, size_t length, bool interrupt);
+  bool Call(LONG operation, const wchar_t *str, bool interrupt);
+
+private:
+  const std::wstring driver;
+  const std::wstring helperPath;
+  std::wstring bridgedName;
+  HANDLE mapping;
+  TolkBridgeChannel *channel;
+  HANDLE requestEvent;
+  HANDLE responseEvent;
+  HANDLE helper;
+  ULONGLONG lastStart;
+};
+
+#endif // _SCREEN_READER_DRIVER_BRIDGE_H_
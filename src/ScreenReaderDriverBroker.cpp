@@ -0,0 +1,151 @@
+/**
+ *  Product:        Tolk
+ *  File:           ScreenReaderDriverBroker.cpp
+ *  Description:    Driver that forwards output to the Tolk broker process.
+ *  Copyright:      (c) 2026, Davy Kager <mail@davykager.nl>
+ *  License:        LGPLv3
+ */
+
+// Requests are written straight into a slot of the broker's shared memory ring,
+// so apart from that one copy nothing is marshalled. The wakeup event is only
+// there to get the broker out of its wait.
+
+#include <cstring>
+#include "ScreenReaderDriverBroker.h"
+
+// How long to wait for a free slot when the broker is falling behind.
+#define TOLK_BROKER_ENQUEUE_TIMEOUT 100
+
+ScreenReaderDriverBroker::ScreenReaderDriverBroker() :
+  ScreenReaderDriver(L"Tolk Broker", true, true, true),
+  mapping(nullptr),
+  ring(nullptr),
+  wakeup(nullptr),
+  broker(nullptr),
+  priority(0),
+  nameSerial(-1)
+{
+  Initialize();
+}
+
+ScreenReaderDriverBroker::~ScreenReaderDriverBroker() {
+  Finalize();
+}
+
+bool ScreenReaderDriverBroker::IsSpeaking() {
+  if (!IsBrokerRunning()) return false;
+  return (ring->speaking != 0);
+}
+
+bool ScreenReaderDriverBroker::IsActive() {
+  // The broker may have been started (or restarted) after we were loaded.
+  if (!IsBrokerRunning()) {
+    Finalize();
+    Initialize();
+    if (!IsBrokerRunning()) return false;
+  }
+  if (!ring->active) return false;
+  UpdateDescription();
+  return true;
+}
+
+void ScreenReaderDriverBroker::Initialize() {
+  if (mapping) return;
+  mapping = OpenFileMappingW(FILE_MAP_ALL_ACCESS, FALSE, TOLK_BROKER_MAPPING_NAME);
+  if (!mapping) return;
+  ring = (TolkBrokerRing *)MapViewOfFile(mapping, FILE_MAP_ALL_ACCESS, 0, 0, sizeof(TolkBrokerRing));
+  // The broker creates the wakeup event only after the ring has been set up.
+  wakeup = OpenEventW(EVENT_MODIFY_STATE, FALSE, TOLK_BROKER_WAKEUP_NAME);
+  if (!ring || !wakeup || ring->version != TOLK_BROKER_VERSION) {
+    Finalize();
+    return;
+  }
+  broker = OpenProcess(SYNCHRONIZE, FALSE, ring->brokerProcessId);
+  if (!broker) Finalize();
+}
+
+void ScreenReaderDriverBroker::Finalize() {
+  if (broker) {
+    CloseHandle(broker);
+    broker = nullptr;
+  }
+  if (wakeup) {
+    CloseHandle(wakeup);
+    wakeup = nullptr;
+  }
+  if (ring) {
+    UnmapViewOfFile(ring);
+    ring = nullptr;
+  }
+  if (mapping) {
+    CloseHandle(mapping);
+    mapping = nullptr;
+  }
+  nameSerial = -1;
+}
+
+bool ScreenReaderDriverBroker::IsBrokerRunning() {
+  return (broker && WaitForSingleObject(broker, 0) == WAIT_TIMEOUT);
+}
+
+void ScreenReaderDriverBroker::UpdateDescription() {
+  // The broker bumps the serial before and after writing the name (odd while writing).
+  const LONG serial = ring->nameSerial;
+  if (serial == nameSerial || (serial & 1)) return;
+  wchar_t copy[TOLK_BROKER_MAX_NAME];
+  memcpy(copy, ring->name, sizeof(copy));
+  if (ring->nameSerial != serial) return;
+  copy[TOLK_BROKER_MAX_NAME - 1] = L'\0';
+  nameSerial = serial;
+  Describe(names.insert(copy).first->c_str(), ring->hasSpeech != 0, ring->hasBraille != 0, true);
+}
+
+bool ScreenReaderDriverBroker::Enqueue(LONG operation, LONG flags, const wchar_t *str, LONG length) {
+  const DWORD start = GetTickCount();
+  LONG position = ring->enqueuePosition;
+  for (;;) {
+    TolkBrokerSlot &slot = ring->slots[position & (TOLK_BROKER_SLOT_COUNT - 1)];
+    const LONG difference = slot.sequence - position;
+    if (difference == 0) {
+      const LONG previous = InterlockedCompareExchange(&ring->enqueuePosition, position + 1, position);
+      if (previous == position) {
+        // Given back by the broker if we take too long, see TOLK_BROKER_CLAIM_TIMEOUT.
+        slot.processId = GetCurrentProcessId();
+        slot.priority = priority;
+        slot.operation = operation;
+        slot.flags = flags;
+        slot.length = length;
+        memcpy(slot.text, str, length * sizeof(wchar_t));
+        slot.text[length] = L'\0';
+        // Publishes the slot to the broker, this is a full barrier.
+        return (InterlockedCompareExchange(&slot.sequence, position + 1, position) == position);
+      }
+      position = previous;
+    }
+    else if (difference < 0) {
+      // The ring is full, give the broker a chance to catch up.
+      if (!IsBrokerRunning() || GetTickCount() - start > TOLK_BROKER_ENQUEUE_TIMEOUT) return false;
+      SetEvent(wakeup);
+      Sleep(1);
+      position = ring->enqueuePosition;
+    }
+    else {
+      position = ring->enqueuePosition;
+    }
+  }
+}
+
+bool ScreenReaderDriverBroker::Submit(LONG operation, const wchar_t *str, bool interrupt) {
+  if (!IsBrokerRunning() || !str) return false;
+  LONG flags = TOLK_BROKER_FLAG_FIRST | (interrupt ? TOLK_BROKER_FLAG_INTERRUPT : 0);
+  size_t remaining = wcslen(str);
+  do {
+    const LONG length = (LONG)(remaining < TOLK_BROKER_SLOT_TEXT - 1 ? remaining : TOLK_BROKER_SLOT_TEXT - 1);
+    remaining -= length;
+    if (!Enqueue(operation, remaining ? flags | TOLK_BROKER_FLAG_MORE : flags, str, length)) return false;
+    flags &= ~TOLK_BROKER_FLAG_FIRST;
+    str += length;
+  } while (remaining);
+  SetEvent(wakeup);
+  return true;
+}
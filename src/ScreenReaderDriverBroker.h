@@ -0,0 +1,53 @@
+/**
+ *  Product:        Tolk
+ *  File:           ScreenReaderDriverBroker.h
+ *  Description:    Driver that forwards output to the Tolk broker process.
+ *  Copyright:      (c) 2026, Davy Kager <mail@davykager.nl>
+ *  License:        LGPLv3
+ */
+
+#ifndef _SCREEN_READER_DRIVER_BROKER_H_
+#define _SCREEN_READER_DRIVER_BROKER_H_
+
+#include <set>
+#include <string>
+#include "TolkBroker.h"
+#include "ScreenReaderDriver.h"
+
+class ScreenReaderDriverBroker final : public ScreenReaderDriver {
+public:
+  ScreenReaderDriverBroker();
+  ~ScreenReaderDriverBroker();
+
+public:
+  bool Speak(const wchar_t *str, bool interrupt) override { return Submit(TOLK_BROKER_OP_SPEAK, str, interrupt); }
+  bool Braille(const wchar_t *str) override { return Submit(TOLK_BROKER_OP_BRAILLE, str, false); }
+  bool IsSpeaking() override;
+  bool Silence() override { return Submit(TOLK_BROKER_OP_SILENCE, L"", true); }
+  bool IsActive() override;
+  bool Output(const wchar_t *str, bool interrupt) override { return Submit(TOLK_BROKER_OP_OUTPUT, str, interrupt); }
+
+public:
+  void SetPriority(int value) { priority = value; }
+
+private:
+  void Initialize();
+  void Finalize();
+  bool IsBrokerRunning();
+  void UpdateDescription();
+  bool Enqueue(LONG operation, LONG flags, const wchar_t *str, LONG length);
+  bool Submit(LONG operation, const wchar_t *str, bool interrupt);
+
+private:
+  HANDLE mapping;
+  TolkBrokerRing *ring;
+  HANDLE wakeup;
+  HANDLE broker;
+  LONG priority;
+  LONG nameSerial;
+  // Every name the broker has published. Callers keep what GetName returned, so a
+  // name is never overwritten or freed while the driver lives.
+  std::set<std::wstring> names;
+};
+
+#endif // _SCREEN_READER_DRIVER_BROKER_H_
@@ -6,11 +6,13 @@
  *  License:        LGPLv3
  */
 
+#include <algorithm>
 #include <string>
 #include "ScreenReaderDriverJAWS.h"
+#include "SpeechMarkup.h"
 
 ScreenReaderDriverJAWS::ScreenReaderDriverJAWS() :
-  ScreenReaderDriver(L"JAWS", true, true),
+  ScreenReaderDriver(L"JAWS", true, true, false),
   controller(nullptr)
 {
   if (IsRunning()) Initialize();
@@ -33,20 +35,7 @@ bool ScreenReaderDriverJAWS::Speak(const wchar_t *str, bool interrupt) {
 
 bool ScreenReaderDriverJAWS::Braille(const wchar_t *str) {
   if (!controller) return false;
-  std::wstring wstr(str);
-  std::wstring::size_type i = wstr.find_first_of(L"\"");
-  while (i != std::wstring::npos) {
-    wstr[i] = L'\'';
-    i = wstr.find_first_of(L"\"", i + 1);
-  }
-  wstr.insert(0, L"BrailleString(\"");
-  wstr.append(L"\")");
-  const BSTR bstr = SysAllocString(wstr.c_str());
-  if (!bstr) return false;
-  VARIANT_BOOL result = VARIANT_FALSE;
-  const bool succeeded = SUCCEEDED(controller->RunFunction(bstr, &result));
-  SysFreeString(bstr);
-  return (succeeded && result == VARIANT_TRUE);
+  return RunFunction(MakeCall(L"BrailleString", str));
 }
 
 bool ScreenReaderDriverJAWS::Silence() {
@@ -70,6 +59,79 @@ bool ScreenReaderDriverJAWS::Output(const wchar_t *str, bool interrupt) {
   return (speak || braille);
 }
 
+bool ScreenReaderDriverJAWS::LowerMarkup(const SpeechMarkup &markup, std::wstring &calls) const {
+  calls.clear();
+  const auto append = [&calls](const wchar_t *function, const std::wstring &argument) {
+    if (argument.find_first_not_of(L" \t\r\n") == std::wstring::npos) return;
+    std::wstring call = MakeCall(function, argument);
+    // A line break would end the call.
+    std::replace_if(call.begin(), call.end(), [](wchar_t c) { return c == L'\r' || c == L'\n'; }, L' ');
+    calls += call;
+    calls += L'\n';
+  };
+  std::wstring text;
+  SpeechMarkup::Instruction instruction;
+  for (size_t position = 0; markup.Next(position, instruction);) {
+    switch (instruction.op) {
+    case MARKUP_TEXT:
+      text.append(instruction.text, instruction.length);
+      break;
+    case MARKUP_PAUSE:
+      SpeechMarkup::AppendPause(text, instruction.value);
+      break;
+    case MARKUP_SPELL:
+      append(L"SayString", text);
+      text.clear();
+      append(L"SpellString", std::wstring(instruction.text, instruction.length));
+      break;
+    default:
+      // Emphasis and language switches are left to JAWS.
+      break;
+    }
+  }
+  append(L"SayString", text);
+  return true;
+}
+
+bool ScreenReaderDriverJAWS::SpeakMarkup(const wchar_t *lowered, bool interrupt) {
+  if (!controller) return false;
+  if (interrupt && !Silence()) return false;
+  // Nothing was said if no line was run, markup of only whitespace has none.
+  bool ran = false;
+  bool result = true;
+  for (const wchar_t *line = lowered; *line;) {
+    const wchar_t *end = wcschr(line, L'\n');
+    // The last line need not end in a line break.
+    if (!end) end = line + wcslen(line);
+    if (end > line) {
+      // Beware short-circuiting.
+      result = RunFunction(std::wstring(line, end - line)) && result;
+      ran = true;
+    }
+    line = *end ? end + 1 : end;
+  }
+  return (ran && result);
+}
+
+std::wstring ScreenReaderDriverJAWS::MakeCall(const wchar_t *function, const std::wstring &argument) {
+  // Script strings can't hold double quotes.
+  std::wstring call(argument);
+  std::replace(call.begin(), call.end(), L'"', L'\'');
+  call.insert(0, L"(\"");
+  call.insert(0, function);
+  call.append(L"\")");
+  return call;
+}
+
+bool ScreenReaderDriverJAWS::RunFunction(const std::wstring &call) {
+  const BSTR bstr = SysAllocString(call.c_str());
+  if (!bstr) return false;
+  VARIANT_BOOL result = VARIANT_FALSE;
+  const bool succeeded = SUCCEEDED(controller->RunFunction(bstr, &result));
+  SysFreeString(bstr);
+  return (succeeded && result == VARIANT_TRUE);
+}
+
 void ScreenReaderDriverJAWS::Initialize() {
   if (controller || FAILED(CoCreateInstance(CLSID_JawsApi, nullptr, CLSCTX_INPROC_SERVER, IID_IJawsApi, (void **)&controller))) {
     // This is here for symmetry with other drivers
@@ -12,7 +12,7 @@
 #include "fsapi.h"
 #include "ScreenReaderDriver.h"
 
-class ScreenReaderDriverJAWS : public ScreenReaderDriver {
+class ScreenReaderDriverJAWS final : public ScreenReaderDriver {
 public:
   ScreenReaderDriverJAWS();
   ~ScreenReaderDriverJAWS();
@@ -24,8 +24,14 @@ public:
   bool Silence() override;
   bool IsActive() override;
   bool Output(const wchar_t *str, bool interrupt) override;
+  void Disconnect() override { Finalize(); }
+  // One script function call per line, spelled text goes to SpellString and the rest to SayString.
+  bool LowerMarkup(const SpeechMarkup &markup, std::wstring &calls) const override;
+  bool SpeakMarkup(const wchar_t *lowered, bool interrupt) override;
 
 private:
+  static std::wstring MakeCall(const wchar_t *function, const std::wstring &argument);
+  bool RunFunction(const std::wstring &call);
   void Initialize();
   void Finalize();
   bool IsRunning() { return (!!FindWindow(L"JFWUI2", nullptr)); }
@@ -9,10 +9,19 @@
 // The NVDA Project provides a header and libraries,
 // but we don't use these in order to support running even if the DLL is missing.
 
+#include <string>
 #include "ScreenReaderDriverNVDA.h"
+#include "SpeechProgress.h"
+
+// Values of the SYMBOL_LEVEL and SPEECH_PRIORITY enums in the controller client's header.
+#define NVDA_SYMBOL_LEVEL_UNCHANGED -1
+#define NVDA_SPEECH_PRIORITY_NORMAL 0
+
+SRWLOCK ScreenReaderDriverNVDA::markLock = SRWLOCK_INIT;
+ScreenReaderDriverNVDA *ScreenReaderDriverNVDA::markListener = nullptr;
 
 ScreenReaderDriverNVDA::ScreenReaderDriverNVDA() :
-  ScreenReaderDriver(L"NVDA", true, true),
+  ScreenReaderDriver(L"NVDA", true, true, false),
   #ifdef _WIN64
   controller(LoadLibrary(L"nvdaControllerClient64.dll")),
   #else
@@ -21,17 +30,39 @@ ScreenReaderDriverNVDA::ScreenReaderDriverNVDA() :
   nvdaController_speakText(nullptr),
   nvdaController_brailleMessage(nullptr),
   nvdaController_cancelSpeech(nullptr),
-  nvdaController_testIfRunning(nullptr)
+  nvdaController_testIfRunning(nullptr),
+  nvdaController_speakSsml(nullptr),
+  nvdaController_setOnSsmlMarkReachedCallback(nullptr),
+  listening(false)
 {
   if (controller) {
     nvdaController_speakText = (NVDAController_speakText)GetProcAddress(controller, "nvdaController_speakText");
     nvdaController_brailleMessage = (NVDAController_brailleMessage)GetProcAddress(controller, "nvdaController_brailleMessage");
     nvdaController_cancelSpeech = (NVDAController_cancelSpeech)GetProcAddress(controller, "nvdaController_cancelSpeech");
     nvdaController_testIfRunning = (NVDAController_testIfRunning)GetProcAddress(controller, "nvdaController_testIfRunning");
+    nvdaController_speakSsml = (NVDAController_speakSsml)GetProcAddress(controller, "nvdaController_speakSsml");
+    nvdaController_setOnSsmlMarkReachedCallback = (NVDAController_setOnSsmlMarkReachedCallback)GetProcAddress(controller, "nvdaController_setOnSsmlMarkReachedCallback");
+  }
+  // The controller client listens for NVDA's calls from then on, NVDA need not be running yet.
+  if (nvdaController_speakSsml && nvdaController_setOnSsmlMarkReachedCallback) {
+    AcquireSRWLockExclusive(&markLock);
+    if (!markListener) {
+      markListener = this;
+      listening = (nvdaController_setOnSsmlMarkReachedCallback(OnSsmlMarkReached) == 0);
+      if (!listening) markListener = nullptr;
+    }
+    ReleaseSRWLockExclusive(&markLock);
   }
 }
 
 ScreenReaderDriverNVDA::~ScreenReaderDriverNVDA() {
+  if (listening) {
+    nvdaController_setOnSsmlMarkReachedCallback(nullptr);
+    // An RPC thread may already be in the callback, this waits for it to report its mark.
+    AcquireSRWLockExclusive(&markLock);
+    markListener = nullptr;
+    ReleaseSRWLockExclusive(&markLock);
+  }
   if (controller) FreeLibrary(controller);
 }
 
@@ -41,6 +72,27 @@ bool ScreenReaderDriverNVDA::Speak(const wchar_t *str, bool interrupt) {
   return false;
 }
 
+bool ScreenReaderDriverNVDA::SpeakSsml(const wchar_t *ssml, bool interrupt) {
+  if (!nvdaController_speakSsml || (interrupt && !Silence())) return false;
+  std::wstring document = L"<speak version=\"1.0\" xmlns=\"http://www.w3.org/2001/10/synthesis\">";
+  document += ssml;
+  document += L"</speak>";
+  // Symbol level unchanged, normal priority, and don't wait for NVDA to finish speaking.
+  return (nvdaController_speakSsml(document.c_str(), NVDA_SYMBOL_LEVEL_UNCHANGED, NVDA_SPEECH_PRIORITY_NORMAL, TRUE) == 0);
+}
+
+// Called on an RPC thread of the controller client. Tolk names marks after their bookmark.
+error_status_t __stdcall ScreenReaderDriverNVDA::OnSsmlMarkReached(const wchar_t *name) {
+  if (!name) return 0;
+  wchar_t *end = nullptr;
+  const unsigned long bookmark = wcstoul(name, &end, 10);
+  if (end == name || *end) return 0;
+  AcquireSRWLockShared(&markLock);
+  if (markListener) markListener->ReportProgress(SPEECH_PROGRESS_BOOKMARK, bookmark, 0);
+  ReleaseSRWLockShared(&markLock);
+  return 0;
+}
+
 bool ScreenReaderDriverNVDA::Braille(const wchar_t *str) {
   if (nvdaController_brailleMessage) return (nvdaController_brailleMessage(str) == 0);
   return false;
@@ -12,7 +12,7 @@
 #include <windows.h>
 #include "ScreenReaderDriver.h"
 
-class ScreenReaderDriverNVDA : public ScreenReaderDriver {
+class ScreenReaderDriverNVDA final : public ScreenReaderDriver {
 public:
   ScreenReaderDriverNVDA();
   ~ScreenReaderDriverNVDA();
@@ -24,19 +24,38 @@ public:
   bool Silence() override;
   bool IsActive() override;
   bool Output(const wchar_t *str, bool interrupt) override;
+  bool SpeakSsml(const wchar_t *ssml, bool interrupt) override;
+  // Controller clients of NVDA 2024.1 and later.
+  bool HasSsml() const override { return !!nvdaController_speakSsml; }
+  // Marks are reported through a callback registered with the controller client.
+  bool HasBookmarks() const override { return listening; }
 
 private:
   typedef error_status_t (__stdcall *NVDAController_speakText)(const wchar_t *);
   typedef error_status_t (__stdcall *NVDAController_brailleMessage)(const wchar_t *);
   typedef error_status_t (__stdcall *NVDAController_cancelSpeech)();
   typedef error_status_t (__stdcall *NVDAController_testIfRunning)();
+  typedef error_status_t (__stdcall *NVDAController_speakSsml)(const wchar_t *, int, int, BOOL);
+  typedef error_status_t (__stdcall *NVDAController_onSsmlMarkReached)(const wchar_t *);
+  typedef error_status_t (__stdcall *NVDAController_setOnSsmlMarkReachedCallback)(NVDAController_onSsmlMarkReached);
 
 private:
+  static error_status_t __stdcall OnSsmlMarkReached(const wchar_t *name);
+
+private:
+  // The callback has no context of its own, and there is only one NVDA driver.
+  // The callback holds the lock shared while it reports a mark, the driver takes
+  // it exclusively to stop listening.
+  static SRWLOCK markLock;
+  static ScreenReaderDriverNVDA *markListener;
   HINSTANCE controller;
   NVDAController_speakText nvdaController_speakText;
   NVDAController_brailleMessage nvdaController_brailleMessage;
   NVDAController_cancelSpeech nvdaController_cancelSpeech;
   NVDAController_testIfRunning nvdaController_testIfRunning;
+  NVDAController_speakSsml nvdaController_speakSsml;
+  NVDAController_setOnSsmlMarkReachedCallback nvdaController_setOnSsmlMarkReachedCallback;
+  bool listening;
 };
 
 #endif // _SCREEN_READER_DRIVER_NVDA_H_
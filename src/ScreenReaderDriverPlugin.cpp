@@ -0,0 +1,107 @@
+/**
+ *  Product:        Tolk
+ *  File:           ScreenReaderDriverPlugin.cpp
+ *  Description:    Driver for external screen reader driver plugins.
+ *  Copyright:      (c) 2026, Davy Kager <mail@davykager.nl>
+ *  License:        LGPLv3
+ */
+
+// The plugin DLL is only loaded the first time auto-detection asks if it is active,
+// so plugins that are never reached in the detection list cost nothing.
+
+#include <cstddef>
+#include "ScreenReaderDriverPlugin.h"
+
+// Size of the first version of TolkPluginDriver, the minimum we accept.
+#define TOLK_PLUGIN_MIN_STRUCT_SIZE (offsetof(TolkPluginDriver, Output) + sizeof(TolkPluginDriver::Output))
+// Members added by later versions are only read if the table is big enough to have them.
+#define TOLK_PLUGIN_HAS_MEMBER(table, member) ((table)->structSize >= offsetof(TolkPluginDriver, member) + sizeof(TolkPluginDriver::member))
+
+ScreenReaderDriverPlugin::ScreenReaderDriverPlugin(const std::wstring &pluginPath) :
+  ScreenReaderDriver(L"", false, false, false),
+  path(pluginPath),
+  controller(nullptr),
+  driver(nullptr),
+  failed(false)
+{
+  // Until the plugin is loaded, its file name (without extension) is its name.
+  const std::wstring::size_type start = path.find_last_of(L"\\/");
+  pluginName = path.substr(start == std::wstring::npos ? 0 : start + 1);
+  const std::wstring::size_type dot = pluginName.find_last_of(L'.');
+  if (dot != std::wstring::npos) pluginName.erase(dot);
+  Describe(pluginName.c_str(), false, false, false);
+}
+
+ScreenReaderDriverPlugin::~ScreenReaderDriverPlugin() {
+  Finalize();
+}
+
+bool ScreenReaderDriverPlugin::Speak(const wchar_t *str, bool interrupt) {
+  if (!driver || !driver->Speak) return false;
+  return driver->Speak(str, interrupt);
+}
+
+bool ScreenReaderDriverPlugin::Braille(const wchar_t *str) {
+  if (!driver || !driver->Braille) return false;
+  return driver->Braille(str);
+}
+
+bool ScreenReaderDriverPlugin::IsSpeaking() {
+  if (!driver || !driver->IsSpeaking) return false;
+  return driver->IsSpeaking();
+}
+
+bool ScreenReaderDriverPlugin::Silence() {
+  if (!driver || !driver->Silence) return false;
+  return driver->Silence();
+}
+
+bool ScreenReaderDriverPlugin::IsActive() {
+  if (!driver && !Initialize()) return false;
+  return driver->IsActive();
+}
+
+bool ScreenReaderDriverPlugin::Output(const wchar_t *str, bool interrupt) {
+  if (!driver) return false;
+  if (driver->Output) return driver->Output(str, interrupt);
+  // Beware short-circuiting.
+  const bool speak = Speak(str, interrupt);
+  const bool braille = Braille(str);
+  return (speak || braille);
+}
+
+unsigned int ScreenReaderDriverPlugin::GetBrailleCells() {
+  if (!driver || !TOLK_PLUGIN_HAS_MEMBER(driver, GetBrailleCells) || !driver->GetBrailleCells) return 0;
+  return driver->GetBrailleCells();
+}
+
+bool ScreenReaderDriverPlugin::Initialize() {
+  // Do not retry plugins that failed to load, that would hit the disk on every detection.
+  if (failed) return false;
+  failed = true;
+  controller = LoadLibraryExW(path.c_str(), nullptr, LOAD_WITH_ALTERED_SEARCH_PATH);
+  if (!controller) return false;
+  const TolkPlugin_GetDriverFunc getDriver = (TolkPlugin_GetDriverFunc)GetProcAddress(controller, TOLK_PLUGIN_ENTRY_POINT);
+  const TolkPluginDriver *table = getDriver ? getDriver(TOLK_PLUGIN_ABI_VERSION) : nullptr;
+  if (!table || table->abiVersion == 0 || table->abiVersion > TOLK_PLUGIN_ABI_VERSION || table->structSize < TOLK_PLUGIN_MIN_STRUCT_SIZE || !table->Speak || !table->IsActive || (table->Initialize && !table->Initialize())) {
+    FreeLibrary(controller);
+    controller = nullptr;
+    return false;
+  }
+  driver = table;
+  if (driver->name && driver->name[0]) pluginName = driver->name;
+  Describe(pluginName.c_str(), !!(driver->capabilities & TOLK_PLUGIN_CAP_SPEECH), !!(driver->capabilities & TOLK_PLUGIN_CAP_BRAILLE), !!(driver->capabilities & TOLK_PLUGIN_CAP_STATUS));
+  failed = false;
+  return true;
+}
+
+void ScreenReaderDriverPlugin::Finalize() {
+  if (driver) {
+    if (driver->Finalize) driver->Finalize();
+    driver = nullptr;
+  }
+  if (controller) {
+    FreeLibrary(controller);
+    controller = nullptr;
+  }
+}
@@ -0,0 +1,43 @@
+/**
+ *  Product:        Tolk
+ *  File:           ScreenReaderDriverPlugin.h
+ *  Description:    Driver for external screen reader driver plugins.
+ *  Copyright:      (c) 2026, Davy Kager <mail@davykager.nl>
+ *  License:        LGPLv3
+ */
+
+#ifndef _SCREEN_READER_DRIVER_PLUGIN_H_
+#define _SCREEN_READER_DRIVER_PLUGIN_H_
+
+#include <windows.h>
+#include <string>
+#include "TolkPlugin.h"
+#include "ScreenReaderDriver.h"
+
+class ScreenReaderDriverPlugin final : public ScreenReaderDriver {
+public:
+  explicit ScreenReaderDriverPlugin(const std::wstring &pluginPath);
+  ~ScreenReaderDriverPlugin();
+
+public:
+  bool Speak(const wchar_t *str, bool interrupt) override;
+  bool Braille(const wchar_t *str) override;
+  bool IsSpeaking() override;
+  bool Silence() override;
+  bool IsActive() override;
+  bool Output(const wchar_t *str, bool interrupt) override;
+  unsigned int GetBrailleCells() override;
+
+private:
+  bool Initialize();
+  void Finalize();
+
+private:
+  const std::wstring path;
+  std::wstring pluginName;
+  HINSTANCE controller;
+  const TolkPluginDriver *driver;
+  bool failed;
+};
+
+#endif // _SCREEN_READER_DRIVER_PLUGIN_H_
@@ -9,7 +9,7 @@
 #include "ScreenReaderDriverSA.h"
 
 ScreenReaderDriverSA::ScreenReaderDriverSA() :
-  ScreenReaderDriver(L"System Access", true, true),
+  ScreenReaderDriver(L"System Access", true, true, false),
   #ifdef _WIN64
   controller(LoadLibrary(L"SAAPI64.dll")),
   #else
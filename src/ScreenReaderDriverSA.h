@@ -12,7 +12,7 @@
 #include <windows.h>
 #include "ScreenReaderDriver.h"
 
-class ScreenReaderDriverSA : public ScreenReaderDriver {
+class ScreenReaderDriverSA final : public ScreenReaderDriver {
 public:
   ScreenReaderDriverSA();
   ~ScreenReaderDriverSA();
@@ -7,10 +7,90 @@
  */
 
 #include "ScreenReaderDriverSAPI.h"
+#include "SpeechSynthesizer.h"
+
+// Events are taken from the voice through a free-threaded notify sink. The
+// window message based notifications (SetNotifyCallbackFunction and friends)
+// need a message loop on the thread that set them up, which Tolk can't count on.
+class ScreenReaderDriverSAPI::NotifySink final : public ISpNotifySink {
+public:
+  explicit NotifySink(ScreenReaderDriverSAPI *owner) : references(1), owner(owner) { InitializeCriticalSection(&lock); }
+  ~NotifySink() { DeleteCriticalSection(&lock); }
+
+public:
+  // Waits for a notification that is being handled, after that the owner is never called again.
+  void Detach() {
+    EnterCriticalSection(&lock);
+    owner = nullptr;
+    LeaveCriticalSection(&lock);
+  }
+
+public:
+  HRESULT STDMETHODCALLTYPE QueryInterface(REFIID riid, void **object) override {
+    if (!object) return E_POINTER;
+    if (IsEqualIID(riid, IID_IUnknown) || IsEqualIID(riid, IID_ISpNotifySink)) {
+      *object = static_cast<ISpNotifySink *>(this);
+      AddRef();
+      return S_OK;
+    }
+    *object = nullptr;
+    return E_NOINTERFACE;
+  }
+  ULONG STDMETHODCALLTYPE AddRef() override { return InterlockedIncrement(&references); }
+  ULONG STDMETHODCALLTYPE Release() override {
+    const ULONG count = InterlockedDecrement(&references);
+    if (!count) delete this;
+    return count;
+  }
+  HRESULT STDMETHODCALLTYPE Notify() override {
+    EnterCriticalSection(&lock);
+    if (owner) owner->OnNotify();
+    LeaveCriticalSection(&lock);
+    return S_OK;
+  }
+
+private:
+  volatile LONG references;
+  CRITICAL_SECTION lock;
+  ScreenReaderDriverSAPI *owner;
+};
+
+// Frees what SAPI attached to an event, like SpClearEvent from sphelper.h.
+static void ClearEvent(SPEVENT &event) {
+  switch (event.elParamType) {
+  case SPET_LPARAM_IS_POINTER:
+  case SPET_LPARAM_IS_STRING:
+    CoTaskMemFree((void *)event.lParam);
+    break;
+  case SPET_LPARAM_IS_TOKEN:
+  case SPET_LPARAM_IS_OBJECT:
+    ((IUnknown *)event.lParam)->Release();
+    break;
+  }
+}
+
+// The language of the voice's token, which SAPI keeps as hexadecimal LCIDs.
+static std::wstring GetVoiceLanguage(ISpVoice *voice) {
+  std::wstring language = L"en-US";
+  ISpObjectToken *token = nullptr;
+  ISpDataKey *attributes = nullptr;
+  wchar_t *value = nullptr;
+  wchar_t name[LOCALE_NAME_MAX_LENGTH];
+  if (SUCCEEDED(voice->GetVoice(&token)) && SUCCEEDED(token->OpenKey(L"Attributes", &attributes))
+    && SUCCEEDED(attributes->GetStringValue(L"Language", &value))
+    && LCIDToLocaleName((LCID)wcstoul(value, nullptr, 16), name, LOCALE_NAME_MAX_LENGTH, 0))
+    language = name;
+  if (value) CoTaskMemFree(value);
+  if (attributes) attributes->Release();
+  if (token) token->Release();
+  return language;
+}
 
 ScreenReaderDriverSAPI::ScreenReaderDriverSAPI() :
-  ScreenReaderDriver(L"SAPI", true, false),
-  controller(nullptr)
+  ScreenReaderDriver(L"SAPI", true, false, true),
+  controller(nullptr),
+  sink(nullptr),
+  speechEvent(nullptr)
 {
   Initialize();
 }
@@ -23,23 +103,44 @@ bool ScreenReaderDriverSAPI::Speak(const wchar_t *str, bool interrupt) {
   if (!controller) return false;
   DWORD flags = SPF_ASYNC | SPF_IS_NOT_XML;
   if (interrupt) flags |= SPF_PURGEBEFORESPEAK;
-  return SUCCEEDED(controller->Speak(str, flags, nullptr));
+  ULONG stream = 0;
+  const WAVEFORMATEX format = MakePcmFormat(PHRASE_SAMPLES_PER_SECOND, PHRASE_BITS_PER_SAMPLE, PHRASE_CHANNELS);
+  const std::shared_ptr<PhraseCache> cache = std::atomic_load(&phraseCache);
+  const std::shared_ptr<const PhraseAudio> audio = cache ? cache->Find(str, format) : nullptr;
+  if (audio) {
+    ISpStreamFormat *phrase = CreatePhraseStream(audio, format);
+    const HRESULT hr = controller->SpeakStream(phrase, flags & ~SPF_IS_NOT_XML, &stream);
+    phrase->Release();
+    if (FAILED(hr)) return false;
+  }
+  else {
+    if (FAILED(controller->Speak(str, flags, &stream))) return false;
+    if (cache) cache->Prefetch(str, format);
+  }
+  progress.Queued(stream, interrupt);
+  return true;
 }
 
-bool ScreenReaderDriverSAPI::IsSpeaking() {
+bool ScreenReaderDriverSAPI::SpeakSsml(const wchar_t *ssml, bool interrupt) {
   if (!controller) return false;
-  SPVOICESTATUS status;
-  // The second parameter to GetStatus() can be NULL,
-  // suppress warning when compiling with /analyze.
-#pragma warning(suppress:6387)
-  if (FAILED(controller->GetStatus(&status, nullptr))) return false;
-  return (status.dwRunningState == SPRS_IS_SPEAKING);
+  std::wstring document = L"<speak version=\"1.0\" xmlns=\"http://www.w3.org/2001/10/synthesis\" xml:lang=\"" + language + L"\">";
+  document += ssml;
+  document += L"</speak>";
+  DWORD flags = SPF_ASYNC | SPF_IS_XML | SPF_PARSE_SSML;
+  if (interrupt) flags |= SPF_PURGEBEFORESPEAK;
+  ULONG stream = 0;
+  if (FAILED(controller->Speak(document.c_str(), flags, &stream))) return false;
+  progress.Queued(stream, interrupt);
+  return true;
 }
 
 bool ScreenReaderDriverSAPI::Silence() {
   if (!controller) return false;
   const DWORD flags = SPF_ASYNC | SPF_IS_NOT_XML | SPF_PURGEBEFORESPEAK;
-  return SUCCEEDED(controller->Speak(nullptr, flags, nullptr));
+  if (FAILED(controller->Speak(nullptr, flags, nullptr))) return false;
+  progress.Purged();
+  SetEvent(speechEvent);
+  return true;
 }
 
 void ScreenReaderDriverSAPI::Initialize() {
@@ -48,11 +149,57 @@ void ScreenReaderDriverSAPI::Initialize() {
     // and so compiling /analyze won't throw a warning.
     return;
   }
+  speechEvent = CreateEventW(nullptr, FALSE, FALSE, nullptr);
+  language = GetVoiceLanguage(controller);
+  sink = new NotifySink(this);
+  const ULONGLONG interest = SPFEI(SPEI_START_INPUT_STREAM) | SPFEI(SPEI_END_INPUT_STREAM) | SPFEI(SPEI_WORD_BOUNDARY) | SPFEI(SPEI_TTS_BOOKMARK);
+  if (!speechEvent || FAILED(controller->SetInterest(interest, interest)) || FAILED(controller->SetNotifySink(sink)))
+    Finalize();
 }
 
 void ScreenReaderDriverSAPI::Finalize() {
+  // Detached first, so a notification can't find the voice half torn down.
+  if (sink) sink->Detach();
   if (controller) {
+    controller->SetNotifySink(nullptr);
     controller->Release();
     controller = nullptr;
   }
+  if (sink) {
+    sink->Release();
+    sink = nullptr;
+  }
+  if (speechEvent) {
+    CloseHandle(speechEvent);
+    speechEvent = nullptr;
+  }
+}
+
+void ScreenReaderDriverSAPI::OnNotify() {
+  SPEVENT event;
+  ULONG fetched = 0;
+  while (controller && controller->GetEvents(1, &event, &fetched) == S_OK && fetched) {
+    switch (event.eEventId) {
+    case SPEI_START_INPUT_STREAM:
+      if (progress.Started(event.ulStreamNum)) ReportProgress(SPEECH_PROGRESS_STARTED, 0, 0);
+      break;
+    case SPEI_END_INPUT_STREAM:
+      if (progress.Ended(event.ulStreamNum)) {
+        SetEvent(speechEvent);
+        ReportProgress(SPEECH_PROGRESS_FINISHED, 0, 0);
+      }
+      break;
+    case SPEI_WORD_BOUNDARY:
+      // The character position is in lParam, the length in wParam.
+      if (progress.Word(event.ulStreamNum, (unsigned long)event.lParam, (unsigned long)event.wParam))
+        ReportProgress(SPEECH_PROGRESS_WORD, progress.GetWordPosition(), progress.GetWordLength());
+      break;
+    case SPEI_TTS_BOOKMARK:
+      // The bookmark name is in lParam, its numeric value in wParam.
+      if (progress.Bookmark(event.ulStreamNum, (unsigned long)event.wParam))
+        ReportProgress(SPEECH_PROGRESS_BOOKMARK, progress.GetBookmark(), 0);
+      break;
+    }
+    ClearEvent(event);
+  }
 }
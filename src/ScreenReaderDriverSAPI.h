@@ -10,9 +10,13 @@
 #define _SCREEN_READER_DRIVER_SAPI_H_
 
 #include <sapi.h>
+#include <memory>
+#include <string>
+#include "PhraseCache.h"
 #include "ScreenReaderDriver.h"
+#include "SpeechProgress.h"
 
-class ScreenReaderDriverSAPI : public ScreenReaderDriver {
+class ScreenReaderDriverSAPI final : public ScreenReaderDriver {
 public:
   ScreenReaderDriverSAPI();
   ~ScreenReaderDriverSAPI();
@@ -20,17 +24,37 @@ public:
 public:
   bool Speak(const wchar_t *str, bool interrupt) override;
   bool Braille(const wchar_t *) override { return false; }
-  bool IsSpeaking() override;
+  bool IsSpeaking() override { return progress.IsSpeaking(); }
   bool Silence() override;
   bool IsActive() override { return (!!controller); }
   bool Output(const wchar_t *str, bool interrupt) override { return Speak(str, interrupt); }
+  void *GetSpeechEvent() override { return speechEvent; }
+  bool SpeakSsml(const wchar_t *ssml, bool interrupt) override;
+  bool HasSsml() const override { return true; }
+  bool HasBookmarks() const override { return true; }
+
+public:
+  // Cached phrases are played from the cache, others are queued to be rendered for next time.
+  void SetPhraseCache(const std::shared_ptr<PhraseCache> &cache) { std::atomic_store(&phraseCache, cache); }
+
+private:
+  class NotifySink;
 
 private:
   void Initialize();
   void Finalize();
+  // Called by the notify sink on a SAPI thread.
+  void OnNotify();
 
 private:
   ISpVoice *controller;
+  NotifySink *sink;
+  HANDLE speechEvent;
+  // Locale name of the voice, SSML documents have to state their language.
+  std::wstring language;
+  SpeechProgress progress;
+  // Swapped atomically, an abandoned call may still be speaking on another thread.
+  std::shared_ptr<PhraseCache> phraseCache;
 };
 
 #endif // _SCREEN_READER_DRIVER_SAPI_H_
@@ -26,7 +26,7 @@
 #define CMD_mute_ 141
 
 ScreenReaderDriverSNova::ScreenReaderDriverSNova() :
-  ScreenReaderDriver(L"SuperNova", true, false),
+  ScreenReaderDriver(L"SuperNova", true, false, false),
   #ifdef _WIN64
   // Dolphin is not currently providing this library.
   controller(LoadLibrary(L"dolapi64.dll")),
@@ -12,7 +12,7 @@
 #include <windows.h>
 #include "ScreenReaderDriver.h"
 
-class ScreenReaderDriverSNova : public ScreenReaderDriver {
+class ScreenReaderDriverSNova final : public ScreenReaderDriver {
 public:
   ScreenReaderDriverSNova();
   ~ScreenReaderDriverSNova();
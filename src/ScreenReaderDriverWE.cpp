@@ -9,7 +9,7 @@
 #include "ScreenReaderDriverWE.h"
 
 ScreenReaderDriverWE::ScreenReaderDriverWE() :
-  ScreenReaderDriver(L"Window-Eyes", true, true),
+  ScreenReaderDriver(L"Window-Eyes", true, true, false),
   controller(nullptr),
   speech(nullptr),
   braille(nullptr)
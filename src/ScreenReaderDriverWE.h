@@ -12,7 +12,7 @@
 #include "wineyes.h"
 #include "ScreenReaderDriver.h"
 
-class ScreenReaderDriverWE : public ScreenReaderDriver {
+class ScreenReaderDriverWE final : public ScreenReaderDriver {
 public:
   ScreenReaderDriverWE();
   ~ScreenReaderDriverWE();
@@ -24,6 +24,7 @@ public:
   bool Silence() override;
   bool IsActive() override;
   bool Output(const wchar_t *str, bool interrupt) override;
+  void Disconnect() override { Finalize(); }
 
 private:
   void Initialize();
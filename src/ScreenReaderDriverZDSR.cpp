@@ -12,7 +12,7 @@
 #include "ScreenReaderDriverZDSR.h"
 
 ScreenReaderDriverZDSR::ScreenReaderDriverZDSR() :
-  ScreenReaderDriver(L"ZDSR", true, false),
+  ScreenReaderDriver(L"ZDSR", true, false, true),
   #ifdef _WIN64
   controller(LoadLibrary(L"ZDSRAPI_x64.dll")),
   #else
@@ -12,7 +12,7 @@
 #include <windows.h>
 #include "ScreenReaderDriver.h"
 
-class ScreenReaderDriverZDSR : public ScreenReaderDriver {
+class ScreenReaderDriverZDSR final : public ScreenReaderDriver {
 public:
   ScreenReaderDriverZDSR();
   ~ScreenReaderDriverZDSR();
@@ -9,7 +9,7 @@
 #include "ScreenReaderDriverZT.h"
 
 ScreenReaderDriverZT::ScreenReaderDriverZT() :
-  ScreenReaderDriver(L"ZoomText", true, false),
+  ScreenReaderDriver(L"ZoomText", true, false, true),
   controller(nullptr),
   speech(nullptr)
 {
@@ -12,7 +12,7 @@
 #include "zt.h"
 #include "ScreenReaderDriver.h"
 
-class ScreenReaderDriverZT : public ScreenReaderDriver {
+class ScreenReaderDriverZT final : public ScreenReaderDriver {
 public:
   ScreenReaderDriverZT();
   ~ScreenReaderDriverZT();
@@ -24,6 +24,7 @@ public:
   bool Silence() override;
   bool IsActive() override;
   bool Output(const wchar_t *str, bool interrupt) override { return Speak(str, interrupt); }
+  void Disconnect() override { Finalize(); }
 
 private:
   void Initialize();
@@ -0,0 +1,140 @@
+/**
+ *  Product:        Tolk
+ *  File:           SpeechEstimator.cpp
+ *  Description:    Estimates speaking time for drivers that cannot report it.
+ *  Copyright:      (c) 2026, Davy Kager <mail@davykager.nl>
+ *  License:        LGPLv3
+ */
+
+// The model counts what a synthesizer actually spends time on: words of
+// alphabetic scripts (a fixed cost plus a cost per letter), digits, CJK and
+// Hangul characters (roughly a syllable each) and pauses at punctuation.
+// Costs are in milliseconds at SPEECH_DEFAULT_RATE. Drivers that report
+// their state are used to calibrate it: when one is seen to stop speaking an
+// utterance that had the synthesizer to itself, the actual duration updates
+// a running ratio for that driver. Each screen reader has its own synthesizer
+// and rate, so a driver that has been observed is estimated with its own ratio
+// only. Drivers that can't be observed are estimated with a ratio shared by all
+// observations, the best there is to go on for them.
+
+#include <cwctype>
+#include "SpeechEstimator.h"
+
+#define SPEECH_LEAD_COST 80
+#define SPEECH_WORD_COST 90
+#define SPEECH_LETTER_COST 50
+#define SPEECH_DIGIT_COST 120
+#define SPEECH_SYLLABLE_COST 210
+#define SPEECH_CLAUSE_COST 150
+#define SPEECH_SENTENCE_COST 300
+// A transition is only trusted if the previous poll saw speech this recently.
+#define SPEECH_OBSERVATION_WINDOW 150
+#define SPEECH_MIN_SCALE 0.25
+#define SPEECH_MAX_SCALE 4.0
+
+static bool IsSyllabic(wchar_t c) {
+  return (c >= 0x3040 && c <= 0x30FF) // Hiragana and Katakana
+    || (c >= 0x3400 && c <= 0x4DBF) // CJK Extension A
+    || (c >= 0x4E00 && c <= 0x9FFF) // CJK Unified Ideographs
+    || (c >= 0xAC00 && c <= 0xD7AF) // Hangul Syllables
+    || (c >= 0xF900 && c <= 0xFAFF); // CJK Compatibility Ideographs
+}
+
+DWORD SpeechEstimator::Cost(const wchar_t *str, const size_t *positions, size_t count, DWORD *costs) const {
+  ULONGLONG cost = SPEECH_LEAD_COST;
+  bool inWord = false;
+  size_t next = 0;
+  for (const wchar_t *p = str; *p; ++p) {
+    for (; next < count && positions[next] <= (size_t)(p - str); ++next) costs[next] = AtRate(cost);
+    const wchar_t c = *p;
+    if (IsSyllabic(c)) {
+      cost += SPEECH_SYLLABLE_COST;
+      inWord = false;
+    }
+    else if (iswdigit(c)) {
+      cost += SPEECH_DIGIT_COST;
+      inWord = false;
+    }
+    else if (iswalpha(c)) {
+      if (!inWord) cost += SPEECH_WORD_COST;
+      cost += SPEECH_LETTER_COST;
+      inWord = true;
+    }
+    else {
+      inWord = false;
+      if (c == L'.' || c == L'!' || c == L'?' || c == 0x3002 || c == 0xFF01 || c == 0xFF1F) cost += SPEECH_SENTENCE_COST;
+      else if (c == L',' || c == L';' || c == L':' || c == 0x3001 || c == 0xFF0C) cost += SPEECH_CLAUSE_COST;
+    }
+  }
+  for (; next < count; ++next) costs[next] = AtRate(cost);
+  return AtRate(cost);
+}
+
+DWORD SpeechEstimator::AtRate(ULONGLONG cost) const {
+  cost = cost * SPEECH_DEFAULT_RATE / wordsPerMinute;
+  return (cost > MAXDWORD) ? MAXDWORD : (DWORD)cost;
+}
+
+double SpeechEstimator::GetScale(ScreenReaderDriver *driver) const {
+  const auto it = states.find(driver);
+  return (it != states.end() && it->second.calibrated) ? it->second.scale : scale;
+}
+
+DWORD SpeechEstimator::Estimate(ScreenReaderDriver *driver, const wchar_t *str) const {
+  return (DWORD)(Cost(str) * GetScale(driver));
+}
+
+void SpeechEstimator::EstimatePositions(ScreenReaderDriver *driver, const wchar_t *str, const size_t *positions, size_t count, DWORD *offsets) const {
+  Cost(str, positions, count, offsets);
+  const double scale = GetScale(driver);
+  for (size_t i = 0; i < count; ++i) offsets[i] = (DWORD)(offsets[i] * scale);
+}
+
+void SpeechEstimator::Spoke(ScreenReaderDriver *driver, const wchar_t *str, bool interrupt) {
+  const ULONGLONG now = GetTickCount64();
+  const DWORD cost = Cost(str);
+  State &state = states[driver];
+  // Queued text only starts once the previous text is done.
+  const bool queued = (!interrupt && state.end > now);
+  state.start = queued ? state.end : now;
+  state.end = state.start + (ULONGLONG)(cost * (state.calibrated ? state.scale : scale));
+  state.cost = queued ? 0 : cost;
+  state.lastSpeaking = 0;
+}
+
+void SpeechEstimator::Silenced(ScreenReaderDriver *driver) {
+  const auto it = states.find(driver);
+  if (it == states.end()) return;
+  it->second.end = GetTickCount64();
+  it->second.cost = 0;
+}
+
+DWORD SpeechEstimator::GetRemaining(ScreenReaderDriver *driver) const {
+  const auto it = states.find(driver);
+  if (it == states.end()) return 0;
+  const ULONGLONG now = GetTickCount64();
+  return (it->second.end > now) ? (DWORD)(it->second.end - now) : 0;
+}
+
+void SpeechEstimator::Observe(ScreenReaderDriver *driver, bool speaking) {
+  const auto it = states.find(driver);
+  if (it == states.end() || !it->second.cost) return;
+  State &state = it->second;
+  const ULONGLONG now = GetTickCount64();
+  if (speaking) {
+    state.lastSpeaking = now;
+    return;
+  }
+  // Speech ended somewhere between the last two polls.
+  if (state.lastSpeaking && now - state.lastSpeaking <= SPEECH_OBSERVATION_WINDOW) {
+    const double actual = (double)((state.lastSpeaking + now) / 2 - state.start);
+    double ratio = actual / state.cost;
+    if (ratio < SPEECH_MIN_SCALE) ratio = SPEECH_MIN_SCALE;
+    else if (ratio > SPEECH_MAX_SCALE) ratio = SPEECH_MAX_SCALE;
+    state.scale = state.scale * 0.8 + ratio * 0.2;
+    state.calibrated = true;
+    scale = scale * 0.8 + ratio * 0.2;
+  }
+  state.end = now;
+  state.cost = 0;
+}
@@ -0,0 +1,70 @@
+/**
+ *  Product:        Tolk
+ *  File:           SpeechEstimator.h
+ *  Description:    Estimates speaking time for drivers that cannot report it.
+ *  Copyright:      (c) 2026, Davy Kager <mail@davykager.nl>
+ *  License:        LGPLv3
+ */
+
+#ifndef _SPEECH_ESTIMATOR_H_
+#define _SPEECH_ESTIMATOR_H_
+
+#include <windows.h>
+#include <map>
+#include "ScreenReaderDriver.h"
+
+// Screen readers default to roughly this rate.
+#define SPEECH_DEFAULT_RATE 180
+
+class SpeechEstimator {
+public:
+  SpeechEstimator() : wordsPerMinute(SPEECH_DEFAULT_RATE), scale(1.0) {}
+  SpeechEstimator(const SpeechEstimator&) = delete;
+  SpeechEstimator& operator=(const SpeechEstimator&) = delete;
+
+public:
+  // Rate in words per minute, 0 restores the default.
+  void SetRate(unsigned int rate) { wordsPerMinute = rate ? rate : SPEECH_DEFAULT_RATE; }
+  // Milliseconds it takes the driver to speak the text at the current rate.
+  DWORD Estimate(ScreenReaderDriver *driver, const wchar_t *str) const;
+  // Milliseconds from the start of the text until each of the positions in it is reached.
+  // Positions are in characters, in ascending order.
+  void EstimatePositions(ScreenReaderDriver *driver, const wchar_t *str, const size_t *positions, size_t count, DWORD *offsets) const;
+  // Call after the driver accepted text for speech.
+  void Spoke(ScreenReaderDriver *driver, const wchar_t *str, bool interrupt);
+  void Silenced(ScreenReaderDriver *driver);
+  bool IsSpeaking(ScreenReaderDriver *driver) const { return (GetRemaining(driver) > 0); }
+  // Milliseconds until the driver is expected to be done speaking.
+  DWORD GetRemaining(ScreenReaderDriver *driver) const;
+  // Feeds the state reported by a driver that has status information back into the model.
+  void Observe(ScreenReaderDriver *driver, bool speaking);
+  void Forget(ScreenReaderDriver *driver) { states.erase(driver); }
+
+private:
+  struct State {
+    State() : start(0), end(0), cost(0), lastSpeaking(0), scale(1.0), calibrated(false) {}
+    ULONGLONG start;
+    ULONGLONG end;
+    // Uncalibrated estimate of the last utterance, 0 if it can't be used for calibration.
+    DWORD cost;
+    ULONGLONG lastSpeaking;
+    // Learned ratio between actual and estimated speaking time for this driver.
+    double scale;
+    // Whether scale has been learned, the shared ratio is used until then.
+    bool calibrated;
+  };
+
+private:
+  // Also stores the cost up to each of the positions in costs, if given.
+  DWORD Cost(const wchar_t *str, const size_t *positions = nullptr, size_t count = 0, DWORD *costs = nullptr) const;
+  DWORD AtRate(ULONGLONG cost) const;
+  double GetScale(ScreenReaderDriver *driver) const;
+
+private:
+  unsigned int wordsPerMinute;
+  // Learned ratio between actual and estimated speaking time over all drivers.
+  double scale;
+  std::map<ScreenReaderDriver *, State> states;
+};
+
+#endif // _SPEECH_ESTIMATOR_H_
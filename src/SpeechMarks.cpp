@@ -0,0 +1,103 @@
+/**
+ *  Product:        Tolk
+ *  File:           SpeechMarks.cpp
+ *  Description:    Marks in spoken text that are reported as speech reaches them.
+ *  Copyright:      (c) 2026, Davy Kager <mail@davykager.nl>
+ *  License:        LGPLv3
+ */
+
+#include "SpeechMarks.h"
+
+// SAPI hands the bookmark to us as the number in its name, which it reads as a signed long.
+#define SPEECH_MAX_BOOKMARK 0x7FFFFFFF
+
+unsigned long SpeechMarks::AddBookmarked(unsigned int count, Callback callback, void *userData) {
+  EnterCriticalSection(&lock);
+  if (count > SPEECH_MAX_BOOKMARK - nextBookmark) nextBookmark = 1;
+  const unsigned long bookmark = nextBookmark;
+  nextBookmark += count;
+  utterances.push_back({ callback, userData, count, 0, bookmark, 0, {} });
+  LeaveCriticalSection(&lock);
+  return bookmark;
+}
+
+void SpeechMarks::AddTimed(ULONGLONG start, std::vector<DWORD> &&offsets, Callback callback, void *userData) {
+  EnterCriticalSection(&lock);
+  utterances.push_back({ callback, userData, (unsigned int)offsets.size(), 0, 0, start, std::move(offsets) });
+  LeaveCriticalSection(&lock);
+}
+
+void SpeechMarks::RemoveLast() {
+  EnterCriticalSection(&lock);
+  if (!utterances.empty()) utterances.pop_back();
+  LeaveCriticalSection(&lock);
+}
+
+void SpeechMarks::Clear() {
+  EnterCriticalSection(&lock);
+  utterances.clear();
+  LeaveCriticalSection(&lock);
+}
+
+bool SpeechMarks::Bookmark(unsigned long bookmark, std::vector<Reached> &reached) {
+  EnterCriticalSection(&lock);
+  size_t i = 0;
+  while (i < utterances.size() && !(utterances[i].bookmark && bookmark - utterances[i].bookmark < utterances[i].count)) ++i;
+  const bool found = (i < utterances.size());
+  if (found) {
+    for (size_t j = 0; j < i; ++j) Reach(utterances[j], utterances[j].count, reached);
+    utterances.erase(utterances.begin(), utterances.begin() + i);
+    Utterance &utterance = utterances.front();
+    Reach(utterance, bookmark - utterance.bookmark + 1, reached);
+    if (utterance.next == utterance.count) utterances.pop_front();
+  }
+  LeaveCriticalSection(&lock);
+  return found;
+}
+
+DWORD SpeechMarks::Due(std::vector<Reached> &reached) {
+  const ULONGLONG now = GetTickCount64();
+  DWORD wait = INFINITE;
+  EnterCriticalSection(&lock);
+  for (size_t i = 0; i < utterances.size();) {
+    Utterance &utterance = utterances[i];
+    if (utterance.bookmark) {
+      ++i;
+      continue;
+    }
+    unsigned int end = utterance.next;
+    while (end < utterance.count && utterance.start + utterance.offsets[end] <= now) ++end;
+    Reach(utterance, end, reached);
+    if (utterance.next == utterance.count) {
+      utterances.erase(utterances.begin() + i);
+      continue;
+    }
+    const ULONGLONG remaining = utterance.start + utterance.offsets[utterance.next] - now;
+    if (remaining < wait) wait = (DWORD)remaining;
+    ++i;
+  }
+  LeaveCriticalSection(&lock);
+  return wait;
+}
+
+void SpeechMarks::Finished(std::vector<Reached> &reached) {
+  EnterCriticalSection(&lock);
+  for (Utterance &utterance : utterances) Reach(utterance, utterance.count, reached);
+  utterances.clear();
+  LeaveCriticalSection(&lock);
+}
+
+bool SpeechMarks::IsEmpty() {
+  EnterCriticalSection(&lock);
+  const bool empty = utterances.empty();
+  LeaveCriticalSection(&lock);
+  return empty;
+}
+
+void SpeechMarks::Report(const std::vector<Reached> &reached) {
+  for (const Reached &mark : reached) mark.callback(mark.mark, mark.userData);
+}
+
+void SpeechMarks::Reach(Utterance &utterance, unsigned int end, std::vector<Reached> &reached) {
+  for (; utterance.next < end; ++utterance.next) reached.push_back({ utterance.callback, utterance.userData, utterance.next });
+}
@@ -0,0 +1,82 @@
+/**
+ *  Product:        Tolk
+ *  File:           SpeechMarks.h
+ *  Description:    Marks in spoken text that are reported as speech reaches them.
+ *  Copyright:      (c) 2026, Davy Kager <mail@davykager.nl>
+ *  License:        LGPLv3
+ */
+
+#ifndef _SPEECH_MARKS_H_
+#define _SPEECH_MARKS_H_
+
+#include <windows.h>
+#include <deque>
+#include <vector>
+
+// Marks of the utterances being spoken, oldest first, until each of their marks
+// has been reached. A mark is reached either when the driver reports a bookmark
+// for it or, for drivers that can't, when the time estimated for it has come.
+// Bookmarks arrive on the speech engine's thread while the global lock may be
+// held, so the table has a lock of its own. Reached marks are collected under
+// it and reported by the caller afterwards, with no lock held.
+class SpeechMarks {
+public:
+  typedef void (*Callback)(unsigned int mark, void *userData);
+  struct Reached {
+    Callback callback;
+    void *userData;
+    unsigned int mark;
+  };
+
+public:
+  SpeechMarks() : nextBookmark(1) { InitializeCriticalSection(&lock); }
+  ~SpeechMarks() { DeleteCriticalSection(&lock); }
+  SpeechMarks(const SpeechMarks&) = delete;
+  SpeechMarks& operator=(const SpeechMarks&) = delete;
+
+public:
+  // Adds an utterance whose marks are reported as bookmarks. Returns the bookmark of
+  // its first mark, the bookmarks of the others follow on from it.
+  unsigned long AddBookmarked(unsigned int count, Callback callback, void *userData);
+  // Adds an utterance whose marks are reached the given number of milliseconds after start.
+  void AddTimed(ULONGLONG start, std::vector<DWORD> &&offsets, Callback callback, void *userData);
+  // Takes back the utterance added last, for when no driver accepted it.
+  void RemoveLast();
+  // Speech was interrupted, the marks not reached so far never will be.
+  void Clear();
+  // Returns false if the bookmark is not one of ours. Marks of the same utterance the
+  // engine passed over and marks of the utterances before it are reached as well.
+  bool Bookmark(unsigned long bookmark, std::vector<Reached> &reached);
+  // Collects the timed marks that are due. Returns the milliseconds until the next one, INFINITE if there is none.
+  DWORD Due(std::vector<Reached> &reached);
+  // Speech has ended, so every mark that is left has been reached.
+  void Finished(std::vector<Reached> &reached);
+  bool IsEmpty();
+
+public:
+  static void Report(const std::vector<Reached> &reached);
+
+private:
+  struct Utterance {
+    Callback callback;
+    void *userData;
+    unsigned int count;
+    // The next mark to be reached.
+    unsigned int next;
+    // Bookmark of the first mark, 0 for timed marks.
+    unsigned long bookmark;
+    ULONGLONG start;
+    // Per mark for timed marks, empty otherwise.
+    std::vector<DWORD> offsets;
+  };
+
+private:
+  static void Reach(Utterance &utterance, unsigned int end, std::vector<Reached> &reached);
+
+private:
+  CRITICAL_SECTION lock;
+  std::deque<Utterance> utterances;
+  unsigned long nextBookmark;
+};
+
+#endif // _SPEECH_MARKS_H_
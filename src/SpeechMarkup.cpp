@@ -0,0 +1,288 @@
+/**
+ *  Product:        Tolk
+ *  File:           SpeechMarkup.cpp
+ *  Description:    Speech markup compiled once and lowered to what each driver takes.
+ *  Copyright:      (c) 2026, Davy Kager <mail@davykager.nl>
+ *  License:        LGPLv3
+ */
+
+#include <cwctype>
+#include "ScreenReaderDriver.h"
+#include "SpeechMarkup.h"
+
+// Pauses up to this long are spoken as a comma in plain text, longer ones as a full stop.
+#define SPEECH_MARKUP_SHORT_PAUSE 300
+#define SPEECH_MARKUP_MAX_LANGUAGE 35
+
+namespace {
+
+ULONGLONG HashMarkup(const wchar_t *markup) {
+  ULONGLONG hash = 14695981039346656037ull;
+  for (; *markup; ++markup) {
+    hash ^= (ULONGLONG)*markup;
+    hash *= 1099511628211ull;
+  }
+  return hash;
+}
+
+bool IsLanguageTag(const std::wstring &language) {
+  if (language.empty() || language.size() > SPEECH_MARKUP_MAX_LANGUAGE) return false;
+  for (const wchar_t c : language) {
+    if (!((c >= L'a' && c <= L'z') || (c >= L'A' && c <= L'Z') || (c >= L'0' && c <= L'9') || c == L'-')) return false;
+  }
+  return true;
+}
+
+// Reads the tag name and its argument from between the braces at markup[start].
+// Returns the position after the closing brace, 0 if there is none.
+size_t ReadTag(const wchar_t *markup, size_t start, std::wstring &name, std::wstring &argument) {
+  size_t end = start + 1;
+  while (markup[end] && markup[end] != L'}') ++end;
+  if (!markup[end]) return 0;
+  const std::wstring tag(markup + start + 1, end - start - 1);
+  const size_t space = tag.find(L' ');
+  name = tag.substr(0, space);
+  argument = (space == std::wstring::npos) ? std::wstring() : tag.substr(space + 1);
+  return end + 1;
+}
+
+void AppendEscaped(std::wstring &ssml, const wchar_t *str, size_t length) {
+  for (size_t i = 0; i < length; ++i) {
+    switch (str[i]) {
+    case L'&': ssml += L"&amp;"; break;
+    case L'<': ssml += L"&lt;"; break;
+    case L'>': ssml += L"&gt;"; break;
+    default: ssml += (str[i] < 0x20) ? L' ' : str[i]; break;
+    }
+  }
+}
+
+} // namespace
+
+std::unique_ptr<const SpeechMarkup> SpeechMarkup::Parse(const wchar_t *markup, Preparer prepare) {
+  std::unique_ptr<SpeechMarkup> program(new SpeechMarkup());
+  // Open emphasis and language tags, innermost last.
+  std::vector<SpeechMarkupOp> open;
+  std::wstring run;
+  const auto flush = [&]() {
+    if (run.empty()) return;
+    std::wstring text = prepare ? prepare(run.c_str()) : run;
+    // Preparation trims the run, but the space between it and the tags next to it is kept.
+    if (iswspace(run.front()) && (text.empty() || !iswspace(text.front()))) text.insert(text.begin(), L' ');
+    if (iswspace(run.back()) && (text.empty() || !iswspace(text.back()))) text += L' ';
+    program->Emit(MARKUP_TEXT, text);
+    run.clear();
+  };
+  std::wstring name, argument;
+  for (size_t i = 0; markup[i];) {
+    if (markup[i] != L'{') {
+      run += markup[i++];
+      continue;
+    }
+    if (markup[i + 1] == L'{') {
+      run += L'{';
+      i += 2;
+      continue;
+    }
+    i = ReadTag(markup, i, name, argument);
+    if (!i) return nullptr;
+    flush();
+    if (name == L"pause") {
+      DWORD milliseconds = SPEECH_MARKUP_DEFAULT_PAUSE;
+      if (!argument.empty()) {
+        wchar_t *end = nullptr;
+        const unsigned long value = wcstoul(argument.c_str(), &end, 10);
+        if (*end || !iswdigit(argument.front()) || value > SPEECH_MARKUP_MAX_PAUSE) return nullptr;
+        milliseconds = value;
+      }
+      program->Emit(MARKUP_PAUSE, milliseconds);
+    }
+    else if (name == L"spell" && argument.empty()) {
+      // The text to spell is taken as it is, up to the closing tag.
+      std::wstring text;
+      for (;;) {
+        if (!markup[i]) return nullptr;
+        if (markup[i] == L'{' && markup[i + 1] == L'{') {
+          text += L'{';
+          i += 2;
+        }
+        else if (markup[i] == L'{') {
+          i = ReadTag(markup, i, name, argument);
+          if (!i || name != L"/spell" || !argument.empty()) return nullptr;
+          break;
+        }
+        else {
+          text += markup[i++];
+        }
+      }
+      program->Emit(MARKUP_SPELL, text);
+    }
+    else if (name == L"em" && argument.empty()) {
+      program->Emit(MARKUP_EMPHASIS_BEGIN);
+      open.push_back(MARKUP_EMPHASIS_END);
+    }
+    else if (name == L"lang" && IsLanguageTag(argument)) {
+      program->Emit(MARKUP_LANGUAGE_BEGIN, argument);
+      open.push_back(MARKUP_LANGUAGE_END);
+    }
+    else if ((name == L"/em" || name == L"/lang") && argument.empty()) {
+      const SpeechMarkupOp op = (name == L"/em") ? MARKUP_EMPHASIS_END : MARKUP_LANGUAGE_END;
+      if (open.empty() || open.back() != op) return nullptr;
+      open.pop_back();
+      program->Emit(op);
+    }
+    else {
+      return nullptr;
+    }
+  }
+  if (!open.empty()) return nullptr;
+  flush();
+  program->plainText = program->ToPlainText();
+  return std::unique_ptr<const SpeechMarkup>(program.release());
+}
+
+void SpeechMarkup::Emit(SpeechMarkupOp op, DWORD value) {
+  code.push_back(op);
+  code.push_back(value);
+}
+
+void SpeechMarkup::Emit(SpeechMarkupOp op, const std::wstring &text) {
+  code.push_back(op);
+  code.push_back((DWORD)strings.size());
+  code.push_back((DWORD)text.size());
+  strings += text;
+}
+
+bool SpeechMarkup::Next(size_t &position, Instruction &instruction) const {
+  if (position >= code.size()) return false;
+  instruction.op = (SpeechMarkupOp)code[position++];
+  instruction.value = 0;
+  instruction.text = nullptr;
+  instruction.length = 0;
+  switch (instruction.op) {
+  case MARKUP_PAUSE:
+    instruction.value = code[position++];
+    break;
+  case MARKUP_TEXT:
+  case MARKUP_SPELL:
+  case MARKUP_LANGUAGE_BEGIN:
+    instruction.text = strings.c_str() + code[position];
+    instruction.length = code[position + 1];
+    position += 2;
+    break;
+  default:
+    break;
+  }
+  return true;
+}
+
+std::wstring SpeechMarkup::ToPlainText() const {
+  std::wstring text;
+  Instruction instruction;
+  for (size_t position = 0; Next(position, instruction);) {
+    switch (instruction.op) {
+    case MARKUP_TEXT:
+      // A pause before it has left a space already.
+      if (instruction.length && iswspace(*instruction.text) && !text.empty() && iswspace(text.back())) text.append(instruction.text + 1, instruction.length - 1);
+      else text.append(instruction.text, instruction.length);
+      break;
+    case MARKUP_PAUSE: AppendPause(text, instruction.value); break;
+    case MARKUP_SPELL: AppendSpelled(text, instruction.text, instruction.length); break;
+    default: break;
+    }
+  }
+  return text;
+}
+
+std::wstring SpeechMarkup::ToSsml() const {
+  std::wstring ssml;
+  Instruction instruction;
+  for (size_t position = 0; Next(position, instruction);) {
+    switch (instruction.op) {
+    case MARKUP_TEXT:
+      AppendEscaped(ssml, instruction.text, instruction.length);
+      break;
+    case MARKUP_PAUSE:
+      ssml += L"<break time=\"" + std::to_wstring(instruction.value) + L"ms\"/>";
+      break;
+    case MARKUP_SPELL:
+      ssml += L"<say-as interpret-as=\"characters\">";
+      AppendEscaped(ssml, instruction.text, instruction.length);
+      ssml += L"</say-as>";
+      break;
+    case MARKUP_EMPHASIS_BEGIN: ssml += L"<emphasis>"; break;
+    case MARKUP_EMPHASIS_END: ssml += L"</emphasis>"; break;
+    case MARKUP_LANGUAGE_BEGIN:
+      ssml += L"<voice xml:lang=\"";
+      ssml.append(instruction.text, instruction.length);
+      ssml += L"\">";
+      break;
+    case MARKUP_LANGUAGE_END: ssml += L"</voice>"; break;
+    }
+  }
+  return ssml;
+}
+
+void SpeechMarkup::AppendPause(std::wstring &text, DWORD milliseconds) {
+  while (!text.empty() && iswspace(text.back())) text.pop_back();
+  // Punctuation already there makes the pause by itself.
+  if (!text.empty() && !iswpunct(text.back())) text += (milliseconds <= SPEECH_MARKUP_SHORT_PAUSE) ? L',' : L'.';
+  if (!text.empty()) text += L' ';
+}
+
+void SpeechMarkup::AppendSpelled(std::wstring &text, const wchar_t *str, size_t length) {
+  for (size_t i = 0; i < length; ++i) {
+    if (iswspace(str[i])) continue;
+    if (!text.empty() && !iswspace(text.back())) text += L' ';
+    text += str[i];
+  }
+}
+
+const SpeechMarkup *SpeechMarkupCache::Parse(const wchar_t *markup, unsigned long generation, SpeechMarkup::Preparer prepare) {
+  Entries::iterator entry = Find(markup);
+  if (entry != entries.end() && entry->generation == generation) return entry->program.get();
+  std::unique_ptr<const SpeechMarkup> program = SpeechMarkup::Parse(markup, prepare);
+  if (!program) return nullptr;
+  if (entry == entries.end()) {
+    // Of two texts with the same hash only the last one is kept.
+    const ULONGLONG hash = HashMarkup(markup);
+    const auto found = index.find(hash);
+    if (found != index.end()) entries.erase(found->second);
+    if (entries.size() >= SPEECH_MARKUP_CACHE_SIZE) {
+      index.erase(HashMarkup(entries.back().markup.c_str()));
+      entries.pop_back();
+    }
+    entries.push_front(Entry());
+    entry = entries.begin();
+    entry->markup = markup;
+    index[hash] = entry;
+  }
+  entry->generation = generation;
+  entry->program = std::move(program);
+  entry->lowered.clear();
+  return entry->program.get();
+}
+
+const std::wstring *SpeechMarkupCache::Lower(const wchar_t *markup, ScreenReaderDriver *driver) {
+  const Entries::iterator entry = Find(markup);
+  if (entry == entries.end()) return nullptr;
+  auto lowered = entry->lowered.find(driver);
+  if (lowered == entry->lowered.end()) {
+    const SpeechMarkup &program = *entry->program;
+    std::wstring text;
+    if (!driver->LowerMarkup(program, text)) text = driver->HasSsml() ? program.ToSsml() : std::wstring(program.GetPlainText());
+    lowered = entry->lowered.emplace(driver, std::move(text)).first;
+  }
+  return &lowered->second;
+}
+
+void SpeechMarkupCache::Forget(ScreenReaderDriver *driver) {
+  for (Entry &entry : entries) entry.lowered.erase(driver);
+}
+
+SpeechMarkupCache::Entries::iterator SpeechMarkupCache::Find(const wchar_t *markup) {
+  const auto found = index.find(HashMarkup(markup));
+  if (found == index.end() || found->second->markup != markup) return entries.end();
+  entries.splice(entries.begin(), entries, found->second);
+  return found->second;
+}
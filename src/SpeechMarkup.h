@@ -0,0 +1,121 @@
+/**
+ *  Product:        Tolk
+ *  File:           SpeechMarkup.h
+ *  Description:    Speech markup compiled once and lowered to what each driver takes.
+ *  Copyright:      (c) 2026, Davy Kager <mail@davykager.nl>
+ *  License:        LGPLv3
+ */
+
+#ifndef _SPEECH_MARKUP_H_
+#define _SPEECH_MARKUP_H_
+
+#include <windows.h>
+#include <list>
+#include <map>
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+// Markup that has been parsed and lowered for a driver is kept for this many texts.
+#define SPEECH_MARKUP_CACHE_SIZE 128
+#define SPEECH_MARKUP_DEFAULT_PAUSE 500
+#define SPEECH_MARKUP_MAX_PAUSE 10000
+
+class ScreenReaderDriver;
+
+enum SpeechMarkupOp {
+  // Operands: offset and length of the text.
+  MARKUP_TEXT,
+  // Operand: milliseconds.
+  MARKUP_PAUSE,
+  // Operands: offset and length of the text to spell.
+  MARKUP_SPELL,
+  MARKUP_EMPHASIS_BEGIN,
+  MARKUP_EMPHASIS_END,
+  // Operands: offset and length of the language tag.
+  MARKUP_LANGUAGE_BEGIN,
+  MARKUP_LANGUAGE_END
+};
+
+// Text with {pause 300}, {spell}F1{/spell}, {em}...{/em} and {lang de}...{/lang}
+// tags, {{ stands for {. Compiled into a flat array of instructions with the text
+// they refer to in one string next to it. Immutable once parsed.
+class SpeechMarkup {
+public:
+  // Prepares text runs for speech, the result is valid until the next call on the thread.
+  typedef const wchar_t *(*Preparer)(const wchar_t *text);
+  struct Instruction {
+    SpeechMarkupOp op;
+    DWORD value;
+    const wchar_t *text;
+    size_t length;
+  };
+
+public:
+  // Returns nullptr if the markup is malformed. Spelled text and language tags are not prepared.
+  static std::unique_ptr<const SpeechMarkup> Parse(const wchar_t *markup, Preparer prepare);
+  SpeechMarkup(const SpeechMarkup&) = delete;
+  SpeechMarkup& operator=(const SpeechMarkup&) = delete;
+
+public:
+  // Decodes the instruction at position and moves past it, returns false at the end.
+  bool Next(size_t &position, Instruction &instruction) const;
+  // Plain text approximation for drivers that take nothing else, also used to estimate speaking time.
+  const wchar_t *GetPlainText() const { return plainText.c_str(); }
+  // The content of an SSML speak element.
+  std::wstring ToSsml() const;
+
+public:
+  static void AppendPause(std::wstring &text, DWORD milliseconds);
+  static void AppendSpelled(std::wstring &text, const wchar_t *str, size_t length);
+
+private:
+  SpeechMarkup() {}
+  void Emit(SpeechMarkupOp op) { code.push_back(op); }
+  void Emit(SpeechMarkupOp op, DWORD value);
+  void Emit(SpeechMarkupOp op, const std::wstring &text);
+  std::wstring ToPlainText() const;
+
+private:
+  std::vector<DWORD> code;
+  std::wstring strings;
+  std::wstring plainText;
+};
+
+// Parsed markup by its hash, least recently used dropped first, and per markup
+// the form it was lowered to for each driver. Used under the global lock.
+class SpeechMarkupCache {
+public:
+  SpeechMarkupCache() {}
+  SpeechMarkupCache(const SpeechMarkupCache&) = delete;
+  SpeechMarkupCache& operator=(const SpeechMarkupCache&) = delete;
+
+public:
+  // Returns nullptr if the markup is malformed. Markup parsed with another
+  // generation of text preparation is parsed again.
+  const SpeechMarkup *Parse(const wchar_t *markup, unsigned long generation, SpeechMarkup::Preparer prepare);
+  // Returns nullptr unless the markup has been parsed. Valid until the next Parse or Forget.
+  const std::wstring *Lower(const wchar_t *markup, ScreenReaderDriver *driver);
+  void Forget(ScreenReaderDriver *driver);
+
+private:
+  struct Entry {
+    std::wstring markup;
+    unsigned long generation;
+    std::unique_ptr<const SpeechMarkup> program;
+    std::map<ScreenReaderDriver *, std::wstring> lowered;
+  };
+  typedef std::list<Entry> Entries;
+
+private:
+  // Moves the entry to the front, returns entries.end() if it is not cached.
+  Entries::iterator Find(const wchar_t *markup);
+
+private:
+  // Most recently used first.
+  Entries entries;
+  std::unordered_map<ULONGLONG, Entries::iterator> index;
+};
+
+#endif // _SPEECH_MARKUP_H_
@@ -0,0 +1,53 @@
+/**
+ *  Product:        Tolk
+ *  File:           SpeechMonitor.cpp
+ *  Description:    Waits for speech to end in the background.
+ *  Copyright:      (c) 2026, Davy Kager <mail@davykager.nl>
+ *  License:        LGPLv3
+ */
+
+// The thread sleeps until either it is woken, the driver signals an event
+// (SAPI, BOY) or the time returned by the check has passed, which is the
+// polling interval for drivers that only report their state on request
+// and the estimated end of speech for drivers that can't report it at all.
+// When nothing is being spoken it waits for the wakeup event only.
+
+#include "SpeechMonitor.h"
+
+SpeechMonitor::SpeechMonitor(Check check) : check(check), thread(nullptr), wake(nullptr), quit(0) {
+  wake = CreateEventW(nullptr, FALSE, FALSE, nullptr);
+  if (!wake) return;
+  thread = CreateThread(nullptr, 0, ThreadProc, this, 0, nullptr);
+  if (!thread) {
+    CloseHandle(wake);
+    wake = nullptr;
+  }
+}
+
+SpeechMonitor::~SpeechMonitor() {
+  if (thread) {
+    InterlockedExchange(&quit, 1);
+    SetEvent(wake);
+    WaitForSingleObject(thread, INFINITE);
+    CloseHandle(thread);
+  }
+  if (wake) CloseHandle(wake);
+}
+
+DWORD WINAPI SpeechMonitor::ThreadProc(LPVOID parameter) {
+  SpeechMonitor *monitor = (SpeechMonitor *)parameter;
+  // Drivers are called from the check, see Tolk_SetDriverTimeout for the same reasoning.
+  const HRESULT hr = CoInitializeEx(nullptr, COINIT_MULTITHREADED);
+  // Check once at startup, speech may already be going on.
+  DWORD wait = 0;
+  HANDLE event = nullptr;
+  for (;;) {
+    const HANDLE handles[] = { monitor->wake, event };
+    WaitForMultipleObjects(event ? 2 : 1, handles, FALSE, wait);
+    if (monitor->quit) break;
+    event = nullptr;
+    wait = monitor->check(event);
+  }
+  if (SUCCEEDED(hr)) CoUninitialize();
+  return 0;
+}
@@ -0,0 +1,49 @@
+/**
+ *  Product:        Tolk
+ *  File:           SpeechMonitor.h
+ *  Description:    Waits for speech to end in the background.
+ *  Copyright:      (c) 2026, Davy Kager <mail@davykager.nl>
+ *  License:        LGPLv3
+ */
+
+#ifndef _SPEECH_MONITOR_H_
+#define _SPEECH_MONITOR_H_
+
+#include <windows.h>
+
+// How often to ask drivers that have no speech event whether they are still speaking.
+#define SPEECH_POLL_INTERVAL 50
+// Speech events are not fully trusted either, so drivers that have one are still asked now and then.
+#define SPEECH_EVENT_RECHECK 1000
+// Time a screen reader gets to start speaking new text before "not speaking" is believed.
+#define SPEECH_START_GRACE 300
+
+class SpeechMonitor {
+public:
+  // Called on the monitor's thread. Returns how long to wait before checking again, INFINITE
+  // once speech has ended, and may set an event that ends the wait early.
+  typedef DWORD (*Check)(HANDLE &event);
+
+public:
+  explicit SpeechMonitor(Check check);
+  // Stops the thread. Must not be called while the loader lock is held.
+  ~SpeechMonitor();
+  SpeechMonitor(const SpeechMonitor&) = delete;
+  SpeechMonitor& operator=(const SpeechMonitor&) = delete;
+
+public:
+  bool IsRunning() const { return (thread != nullptr); }
+  // Makes the monitor check again right away, for instance because new text was spoken.
+  void Wake() { SetEvent(wake); }
+
+private:
+  static DWORD WINAPI ThreadProc(LPVOID parameter);
+
+private:
+  Check check;
+  HANDLE thread;
+  HANDLE wake;
+  volatile LONG quit;
+};
+
+#endif // _SPEECH_MONITOR_H_
@@ -0,0 +1,54 @@
+/**
+ *  Product:        Tolk
+ *  File:           SpeechProgress.cpp
+ *  Description:    Speaking state and progress built from speech engine events.
+ *  Copyright:      (c) 2026, Davy Kager <mail@davykager.nl>
+ *  License:        LGPLv3
+ */
+
+// Speaking means that the highest utterance known to have ended is below
+// the highest one queued. Both only ever go up, so an end event that is
+// handled before the call that queued the utterance has returned still
+// leaves the right answer.
+
+#include "SpeechProgress.h"
+
+void SpeechProgress::Queued(unsigned long utterance, bool purged) {
+  if (purged && utterance > 0) Raise(ended, utterance - 1);
+  Raise(queued, utterance);
+}
+
+bool SpeechProgress::Started(unsigned long utterance) {
+  if (!IsCurrent(utterance)) return false;
+  stream = utterance;
+  wordPosition = 0;
+  wordLength = 0;
+  return true;
+}
+
+bool SpeechProgress::Ended(unsigned long utterance) {
+  return Raise(ended, utterance);
+}
+
+bool SpeechProgress::Word(unsigned long utterance, unsigned long position, unsigned long length) {
+  if (!IsCurrent(utterance)) return false;
+  stream = utterance;
+  wordPosition = position;
+  wordLength = length;
+  return true;
+}
+
+bool SpeechProgress::Bookmark(unsigned long utterance, unsigned long id) {
+  if (!IsCurrent(utterance)) return false;
+  stream = utterance;
+  bookmark = id;
+  return true;
+}
+
+bool SpeechProgress::Raise(std::atomic<unsigned long> &value, unsigned long to) {
+  unsigned long current = value.load();
+  while (current < to) {
+    if (value.compare_exchange_weak(current, to)) return true;
+  }
+  return false;
+}
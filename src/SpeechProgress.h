@@ -0,0 +1,64 @@
+/**
+ *  Product:        Tolk
+ *  File:           SpeechProgress.h
+ *  Description:    Speaking state and progress built from speech engine events.
+ *  Copyright:      (c) 2026, Davy Kager <mail@davykager.nl>
+ *  License:        LGPLv3
+ */
+
+#ifndef _SPEECH_PROGRESS_H_
+#define _SPEECH_PROGRESS_H_
+
+#include <atomic>
+
+// Same values as the TOLK_SPEECH_* constants in Tolk.h.
+enum SpeechProgressEvent {
+  SPEECH_PROGRESS_STARTED = 0,
+  SPEECH_PROGRESS_WORD = 1,
+  SPEECH_PROGRESS_BOOKMARK = 2,
+  SPEECH_PROGRESS_FINISHED = 3
+};
+
+// Engine independent, it only sees stream numbers and positions. Utterances are
+// numbered in the order they are queued, starting at 1, which is what SAPI does.
+// Queue and purge calls come from the speaking thread, the others from the engine's
+// event thread, and may arrive in any order relative to each other.
+class SpeechProgress {
+public:
+  SpeechProgress() : queued(0), ended(0), stream(0), wordPosition(0), wordLength(0), bookmark(0) {}
+  SpeechProgress(const SpeechProgress&) = delete;
+  SpeechProgress& operator=(const SpeechProgress&) = delete;
+
+public:
+  // The utterance was queued. A purging utterance drops everything queued before it.
+  void Queued(unsigned long utterance, bool purged);
+  // Everything queued so far was dropped.
+  void Purged() { Raise(ended, queued.load()); }
+  // The methods below return false for events of utterances that were dropped or have ended.
+  bool Started(unsigned long utterance);
+  bool Ended(unsigned long utterance);
+  bool Word(unsigned long utterance, unsigned long position, unsigned long length);
+  bool Bookmark(unsigned long utterance, unsigned long id);
+
+public:
+  bool IsSpeaking() const { return (ended.load() < queued.load()); }
+  unsigned long GetStream() const { return stream.load(); }
+  unsigned long GetWordPosition() const { return wordPosition.load(); }
+  unsigned long GetWordLength() const { return wordLength.load(); }
+  unsigned long GetBookmark() const { return bookmark.load(); }
+
+private:
+  // Returns true if the value was raised.
+  static bool Raise(std::atomic<unsigned long> &value, unsigned long to);
+  bool IsCurrent(unsigned long utterance) const { return (utterance > ended.load()); }
+
+private:
+  std::atomic<unsigned long> queued;
+  std::atomic<unsigned long> ended;
+  std::atomic<unsigned long> stream;
+  std::atomic<unsigned long> wordPosition;
+  std::atomic<unsigned long> wordLength;
+  std::atomic<unsigned long> bookmark;
+};
+
+#endif // _SPEECH_PROGRESS_H_
@@ -0,0 +1,94 @@
+/**
+ *  Product:        Tolk
+ *  File:           SpeechQueue.cpp
+ *  Description:    Long text waiting to be spoken, handed to the screen reader a chunk at a time.
+ *  Copyright:      (c) 2026, Davy Kager <mail@davykager.nl>
+ *  License:        LGPLv3
+ */
+
+#include "SpeechQueue.h"
+#include "TextClasses.h"
+
+namespace {
+
+bool IsSentenceEnd(wchar_t c) { return (c == L'.' || c == L'!' || c == L'?' || c == 0x2026); }
+
+// Sentences in Chinese and Japanese end without a space.
+bool IsFullWidthSentenceEnd(wchar_t c) { return (c == 0x3002 || c == 0xFF01 || c == 0xFF1F); }
+
+bool IsClauseEnd(wchar_t c) { return (c == L',' || c == L';' || c == L':' || c == 0x2014 || c == 0x3001 || c == 0xFF0C || c == 0xFF1B); }
+
+// Closing quotes and brackets after the punctuation that ends a sentence or clause.
+bool IsClosing(wchar_t c) { return (c == L'"' || c == L'\'' || c == L')' || c == L']' || c == 0xBB || c == 0x2019 || c == 0x201D); }
+
+// A full stop after a short capitalized word or a single letter, as in "Dr." or "e.g.".
+bool IsAbbreviation(const wchar_t *text, size_t position, size_t stop) {
+  if (text[stop] != L'.') return false;
+  size_t start = stop;
+  while (start > position && ((text[start - 1] >= L'a' && text[start - 1] <= L'z') || (text[start - 1] >= L'A' && text[start - 1] <= L'Z'))) --start;
+  const size_t letters = stop - start;
+  if (!letters || letters > 3 || (start > position && !IsSpace(text[start - 1]) && text[start - 1] != L'.')) return false;
+  return (letters == 1 || (text[start] >= L'A' && text[start] <= L'Z'));
+}
+
+// Whether a sentence ends before text[i], text[i] exists.
+bool EndsSentence(const wchar_t *text, size_t position, size_t i) {
+  if (IsFullWidthSentenceEnd(text[i - 1])) return true;
+  if (!IsSpace(text[i])) return false;
+  if (text[i] == L'\n') return true;
+  size_t last = i - 1;
+  while (last > position && IsClosing(text[last])) --last;
+  return (IsSentenceEnd(text[last]) && !IsAbbreviation(text, position, last));
+}
+
+} // namespace
+
+void SpeechQueue::Clear() {
+  texts.clear();
+  position = 0;
+}
+
+bool SpeechQueue::Next(std::wstring &chunk, size_t maxLength) {
+  while (!texts.empty()) {
+    const std::wstring &text = texts.front();
+    // Spaces between chunks are not worth sending.
+    while (position < text.size() && IsSpace(text[position])) ++position;
+    if (position == text.size()) {
+      texts.pop_front();
+      position = 0;
+      continue;
+    }
+    const size_t end = FindChunkEnd(text.c_str(), text.size(), position, maxLength);
+    chunk.assign(text, position, end - position);
+    position = end;
+    return true;
+  }
+  return false;
+}
+
+size_t SpeechQueue::FindChunkEnd(const wchar_t *text, size_t length, size_t position, size_t maxLength) {
+  if (length - position <= maxLength) return length;
+  const size_t limit = position + maxLength;
+  size_t clause = 0;
+  size_t space = 0;
+  // Looks for the last boundary that fits, each i is the end of a possible chunk.
+  for (size_t i = limit; i > position + SPEECH_CHUNK_MIN; --i) {
+    if (EndsSentence(text, position, i)) return i;
+    if (!IsSpace(text[i])) continue;
+    size_t last = i - 1;
+    while (last > position && IsClosing(text[last])) --last;
+    if (!clause && IsClauseEnd(text[last])) clause = i;
+    if (!space) space = i;
+  }
+  if (clause) return clause;
+  if (space) return space;
+  // Surrogate pairs stay together.
+  return IS_LOW_SURROGATE(text[limit]) ? limit - 1 : limit;
+}
+
+size_t SpeechQueue::FindSentenceEnd(const wchar_t *text, size_t length, size_t position) {
+  for (size_t i = position + 1; i < length; ++i) {
+    if (EndsSentence(text, position, i)) return i;
+  }
+  return length;
+}
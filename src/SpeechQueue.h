@@ -0,0 +1,54 @@
+/**
+ *  Product:        Tolk
+ *  File:           SpeechQueue.h
+ *  Description:    Long text waiting to be spoken, handed to the screen reader a chunk at a time.
+ *  Copyright:      (c) 2026, Davy Kager <mail@davykager.nl>
+ *  License:        LGPLv3
+ */
+
+#ifndef _SPEECH_QUEUE_H_
+#define _SPEECH_QUEUE_H_
+
+#include <windows.h>
+#include <deque>
+#include <string>
+
+// The first chunk of a text is kept short so the screen reader starts speaking
+// quickly, the chunks after it are handed over while the one before is spoken.
+#define SPEECH_CHUNK_FIRST 200
+#define SPEECH_CHUNK_MAX 1000
+// Boundaries this close to the start of a chunk are passed over, so chunks
+// don't end after an abbreviation such as "Dr.".
+#define SPEECH_CHUNK_MIN 40
+
+// Chunks end after a sentence if one fits, otherwise after a clause, otherwise
+// at a space. Only text without any of these is cut in the middle of a word.
+// Used under the global lock.
+class SpeechQueue {
+public:
+  SpeechQueue() : position(0) {}
+  SpeechQueue(const SpeechQueue&) = delete;
+  SpeechQueue& operator=(const SpeechQueue&) = delete;
+
+public:
+  // Queues the text after what is queued already.
+  void Add(const wchar_t *str) { texts.emplace_back(str); }
+  void Clear();
+  bool IsEmpty() const { return texts.empty(); }
+  // Takes the next chunk of at most maxLength characters, returns false if nothing is left.
+  bool Next(std::wstring &chunk, size_t maxLength);
+
+public:
+  // Returns the end of the chunk that starts at position.
+  static size_t FindChunkEnd(const wchar_t *text, size_t length, size_t position, size_t maxLength);
+  // Returns the end of the sentence that starts at position, or length if it does not end
+  // before the end of the text.
+  static size_t FindSentenceEnd(const wchar_t *text, size_t length, size_t position);
+
+private:
+  std::deque<std::wstring> texts;
+  // Where the next chunk of the first text starts.
+  size_t position;
+};
+
+#endif // _SPEECH_QUEUE_H_
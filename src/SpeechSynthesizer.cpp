@@ -0,0 +1,202 @@
+/**
+ *  Product:        Tolk
+ *  File:           SpeechSynthesizer.cpp
+ *  Description:    Renders speech to PCM audio handed to the caller.
+ *  Copyright:      (c) 2026, Davy Kager <mail@davykager.nl>
+ *  License:        LGPLv3
+ */
+
+#include "SpeechSynthesizer.h"
+
+namespace {
+
+// Raw PCM stream in a fixed format, the parts of IStream that SAPI does not
+// use for audio are left out.
+class AudioStream : public ISpStreamFormat {
+public:
+  explicit AudioStream(const WAVEFORMATEX &format) : references(1), format(format) {}
+  virtual ~AudioStream() {}
+
+public:
+  HRESULT STDMETHODCALLTYPE QueryInterface(REFIID riid, void **object) override {
+    if (!object) return E_POINTER;
+    if (IsEqualIID(riid, IID_IUnknown) || IsEqualIID(riid, IID_ISequentialStream) || IsEqualIID(riid, IID_IStream) || IsEqualIID(riid, IID_ISpStreamFormat)) {
+      *object = static_cast<ISpStreamFormat *>(this);
+      AddRef();
+      return S_OK;
+    }
+    *object = nullptr;
+    return E_NOINTERFACE;
+  }
+  ULONG STDMETHODCALLTYPE AddRef() override { return InterlockedIncrement(&references); }
+  ULONG STDMETHODCALLTYPE Release() override {
+    const ULONG count = InterlockedDecrement(&references);
+    if (!count) delete this;
+    return count;
+  }
+
+public:
+  HRESULT STDMETHODCALLTYPE SetSize(ULARGE_INTEGER) override { return E_NOTIMPL; }
+  HRESULT STDMETHODCALLTYPE CopyTo(IStream *, ULARGE_INTEGER, ULARGE_INTEGER *, ULARGE_INTEGER *) override { return E_NOTIMPL; }
+  HRESULT STDMETHODCALLTYPE Commit(DWORD) override { return S_OK; }
+  HRESULT STDMETHODCALLTYPE Revert() override { return E_NOTIMPL; }
+  HRESULT STDMETHODCALLTYPE LockRegion(ULARGE_INTEGER, ULARGE_INTEGER, DWORD) override { return E_NOTIMPL; }
+  HRESULT STDMETHODCALLTYPE UnlockRegion(ULARGE_INTEGER, ULARGE_INTEGER, DWORD) override { return E_NOTIMPL; }
+  HRESULT STDMETHODCALLTYPE Clone(IStream **) override { return E_NOTIMPL; }
+  HRESULT STDMETHODCALLTYPE GetFormat(GUID *formatId, WAVEFORMATEX **waveFormat) override {
+    if (!formatId || !waveFormat) return E_POINTER;
+    *waveFormat = (WAVEFORMATEX *)CoTaskMemAlloc(sizeof(WAVEFORMATEX));
+    if (!*waveFormat) return E_OUTOFMEMORY;
+    **waveFormat = format;
+    *formatId = SPDFID_WaveFormatEx;
+    return S_OK;
+  }
+
+protected:
+  HRESULT GetStat(STATSTG *stat, ULONGLONG size, DWORD mode) {
+    if (!stat) return E_POINTER;
+    ZeroMemory(stat, sizeof(*stat));
+    stat->type = STGTY_STREAM;
+    stat->cbSize.QuadPart = size;
+    stat->grfMode = mode;
+    return S_OK;
+  }
+
+private:
+  volatile LONG references;
+  const WAVEFORMATEX format;
+};
+
+// Output stream for the voice. SAPI converts to the format we report and writes
+// the samples here, they are passed on from its buffer without being copied.
+class CallbackStream final : public AudioStream {
+public:
+  CallbackStream(const WAVEFORMATEX &format, SpeechSynthesizerCallback callback, void *userData) :
+    AudioStream(format), callback(callback), userData(userData), position(0), stopped(false) {}
+
+public:
+  bool IsStopped() const { return stopped; }
+
+public:
+  HRESULT STDMETHODCALLTYPE Read(void *, ULONG, ULONG *) override { return E_NOTIMPL; }
+  HRESULT STDMETHODCALLTYPE Write(const void *data, ULONG size, ULONG *written) override {
+    if (written) *written = 0;
+    if (stopped) return E_ABORT;
+    if (size && !callback(data, size, userData)) {
+      // Failing the write makes the voice give up on the rest of the text.
+      stopped = true;
+      return E_ABORT;
+    }
+    position += size;
+    if (written) *written = size;
+    return S_OK;
+  }
+  // The voice only asks for the current position, there is nothing to seek in.
+  HRESULT STDMETHODCALLTYPE Seek(LARGE_INTEGER move, DWORD origin, ULARGE_INTEGER *newPosition) override {
+    if (origin != STREAM_SEEK_CUR || move.QuadPart) return STG_E_INVALIDFUNCTION;
+    if (newPosition) newPosition->QuadPart = position;
+    return S_OK;
+  }
+  HRESULT STDMETHODCALLTYPE Stat(STATSTG *stat, DWORD) override { return GetStat(stat, position, STGM_WRITE); }
+
+private:
+  const SpeechSynthesizerCallback callback;
+  void *const userData;
+  ULONGLONG position;
+  bool stopped;
+};
+
+// Input stream for ISpVoice::SpeakStream, read straight from the cached audio.
+class PhraseStream final : public AudioStream {
+public:
+  PhraseStream(const std::shared_ptr<const PhraseAudio> &audio, const WAVEFORMATEX &format) : AudioStream(format), audio(audio), position(0) {}
+
+public:
+  HRESULT STDMETHODCALLTYPE Read(void *data, ULONG size, ULONG *read) override {
+    const size_t remaining = audio->GetSize() - position;
+    const size_t count = (size < remaining) ? size : remaining;
+    memcpy(data, audio->GetData() + position, count);
+    position += count;
+    if (read) *read = (ULONG)count;
+    return (count == size) ? S_OK : S_FALSE;
+  }
+  HRESULT STDMETHODCALLTYPE Write(const void *, ULONG, ULONG *) override { return STG_E_ACCESSDENIED; }
+  HRESULT STDMETHODCALLTYPE Seek(LARGE_INTEGER move, DWORD origin, ULARGE_INTEGER *newPosition) override {
+    long long target = move.QuadPart;
+    if (origin == STREAM_SEEK_CUR) target += (long long)position;
+    else if (origin == STREAM_SEEK_END) target += (long long)audio->GetSize();
+    else if (origin != STREAM_SEEK_SET) return STG_E_INVALIDFUNCTION;
+    if (target < 0 || (ULONGLONG)target > audio->GetSize()) return STG_E_INVALIDFUNCTION;
+    position = (size_t)target;
+    if (newPosition) newPosition->QuadPart = position;
+    return S_OK;
+  }
+  HRESULT STDMETHODCALLTYPE Stat(STATSTG *stat, DWORD) override { return GetStat(stat, audio->GetSize(), STGM_READ); }
+
+private:
+  const std::shared_ptr<const PhraseAudio> audio;
+  size_t position;
+};
+
+bool Collect(const void *data, unsigned int size, void *userData) {
+  std::vector<char> &audio = *(std::vector<char> *)userData;
+  audio.insert(audio.end(), (const char *)data, (const char *)data + size);
+  return true;
+}
+
+} // namespace
+
+WAVEFORMATEX MakePcmFormat(DWORD samplesPerSecond, WORD bitsPerSample, WORD channels) {
+  WAVEFORMATEX format = {};
+  format.wFormatTag = WAVE_FORMAT_PCM;
+  format.nChannels = channels;
+  format.nSamplesPerSec = samplesPerSecond;
+  format.wBitsPerSample = bitsPerSample;
+  format.nBlockAlign = (WORD)(channels * bitsPerSample / 8);
+  format.nAvgBytesPerSec = samplesPerSecond * format.nBlockAlign;
+  return format;
+}
+
+bool SynthesizeSpeech(const wchar_t *str, const WAVEFORMATEX &format, SpeechSynthesizerCallback callback, void *userData) {
+  // Works in either apartment, the voice is only used from this thread.
+  const HRESULT hr = CoInitializeEx(nullptr, COINIT_MULTITHREADED);
+  bool result = false;
+  ISpVoice *voice = nullptr;
+  if (SUCCEEDED(CoCreateInstance(CLSID_SpVoice, nullptr, CLSCTX_INPROC_SERVER, IID_ISpVoice, (void **)&voice))) {
+    CallbackStream *stream = new CallbackStream(format, callback, userData);
+    // Without format changes, so SAPI converts to what the caller asked for.
+    if (SUCCEEDED(voice->SetOutput(stream, FALSE)))
+      result = (SUCCEEDED(voice->Speak(str, SPF_IS_NOT_XML, nullptr)) && !stream->IsStopped());
+    voice->Release();
+    stream->Release();
+  }
+  if (SUCCEEDED(hr)) CoUninitialize();
+  return result;
+}
+
+bool RenderSpeech(const wchar_t *str, const WAVEFORMATEX &format, std::vector<char> &audio) {
+  audio.clear();
+  return SynthesizeSpeech(str, format, Collect, &audio);
+}
+
+std::wstring GetDefaultVoiceKey() {
+  const HRESULT hr = CoInitializeEx(nullptr, COINIT_MULTITHREADED);
+  std::wstring key;
+  ISpVoice *voice = nullptr;
+  if (SUCCEEDED(CoCreateInstance(CLSID_SpVoice, nullptr, CLSCTX_INPROC_SERVER, IID_ISpVoice, (void **)&voice))) {
+    ISpObjectToken *token = nullptr;
+    wchar_t *id = nullptr;
+    long rate = 0;
+    if (SUCCEEDED(voice->GetVoice(&token)) && SUCCEEDED(token->GetId(&id)) && SUCCEEDED(voice->GetRate(&rate)))
+      key = std::wstring(id) + L'@' + std::to_wstring(rate);
+    if (id) CoTaskMemFree(id);
+    if (token) token->Release();
+    voice->Release();
+  }
+  if (SUCCEEDED(hr)) CoUninitialize();
+  return key;
+}
+
+ISpStreamFormat *CreatePhraseStream(const std::shared_ptr<const PhraseAudio> &audio, const WAVEFORMATEX &format) {
+  return new PhraseStream(audio, format);
+}
@@ -0,0 +1,42 @@
+/**
+ *  Product:        Tolk
+ *  File:           SpeechSynthesizer.h
+ *  Description:    Renders speech to PCM audio handed to the caller.
+ *  Copyright:      (c) 2026, Davy Kager <mail@davykager.nl>
+ *  License:        LGPLv3
+ */
+
+#ifndef _SPEECH_SYNTHESIZER_H_
+#define _SPEECH_SYNTHESIZER_H_
+
+#include <windows.h>
+#include <sapi.h>
+#include <memory>
+#include <string>
+#include <vector>
+#include "PhraseCache.h"
+
+// Format of the phrases the SAPI driver plays from the phrase cache.
+#define PHRASE_SAMPLES_PER_SECOND 22050
+#define PHRASE_BITS_PER_SAMPLE 16
+#define PHRASE_CHANNELS 1
+
+// Receives each chunk of audio as the engine writes it, returns false to stop.
+typedef bool (*SpeechSynthesizerCallback)(const void *data, unsigned int size, void *userData);
+
+WAVEFORMATEX MakePcmFormat(DWORD samplesPerSecond, WORD bitsPerSample, WORD channels);
+
+// Speaks the text with a SAPI voice of its own, so nothing reaches the audio device
+// and the queue of the SAPI driver is left alone. Returns after the last chunk has
+// been handed over, false if synthesis failed or the callback stopped it.
+bool SynthesizeSpeech(const wchar_t *str, const WAVEFORMATEX &format, SpeechSynthesizerCallback callback, void *userData);
+// Same as above, collecting all audio. Has the signature of PhraseCache::Renderer.
+bool RenderSpeech(const wchar_t *str, const WAVEFORMATEX &format, std::vector<char> &audio);
+
+// Identifies the default voice and its rate, empty if there is no voice.
+std::wstring GetDefaultVoiceKey();
+
+// A stream for ISpVoice::SpeakStream that plays cached audio.
+ISpStreamFormat *CreatePhraseStream(const std::shared_ptr<const PhraseAudio> &audio, const WAVEFORMATEX &format);
+
+#endif // _SPEECH_SYNTHESIZER_H_
@@ -0,0 +1,156 @@
+/**
+ *  Product:        Tolk
+ *  File:           SymbolNames.cpp
+ *  Description:    Names of emoji and symbols, spoken in place of the characters.
+ *  Copyright:      (c) 2026, Davy Kager <mail@davykager.nl>
+ *  License:        LGPLv3
+ */
+
+#include <windows.h>
+#include <string>
+#include "SymbolNames.h"
+#include "SymbolTables.h"
+#include "TextClasses.h"
+
+// Longest sequence looked up, in code points and in emoji joined by ZWJ.
+// Longer sequences are named in parts.
+#define SYMBOL_MAX_LENGTH 16
+#define SYMBOL_MAX_PARTS 4
+
+namespace {
+
+bool IsRegionalIndicator(char32_t c) { return (c >= 0x1F1E6 && c <= 0x1F1FF); }
+bool IsSkinTone(char32_t c) { return (c >= 0x1F3FB && c <= 0x1F3FF); }
+bool IsTag(char32_t c) { return (c >= 0xE0020 && c <= 0xE007F); }
+// Whether a name needs a space before the text that follows it.
+bool NeedsSpaceBefore(wchar_t c) { return (!IsSpace(c) && !wcschr(L".,;:!?)]}", c)); }
+
+// Reads the code point at position, returns the position after it.
+size_t Decode(const wchar_t *str, size_t length, size_t position, char32_t &c) {
+  c = str[position];
+  if (IS_HIGH_SURROGATE(str[position]) && position + 1 < length && IS_LOW_SURROGATE(str[position + 1])) {
+    c = 0x10000 + ((c - 0xD800) << 10) + (str[position + 1] - 0xDC00);
+    return position + 2;
+  }
+  return position + 1;
+}
+
+const SymbolEntry *Lookup(const SymbolTable &table, const char32_t *key, size_t length) {
+  const unsigned int bucket = HashSymbol(key, length, 0) % table.size;
+  const SymbolEntry &entry = table.entries[HashSymbol(key, length, table.displacements[bucket]) % table.size];
+  if (entry.length != length || memcmp(table.codePoints + entry.first, key, length * sizeof(char32_t))) return nullptr;
+  return &entry;
+}
+
+// Most text has no names, the table's bitmap rules out nearly all of it for the
+// price of a load, ASCII included. ASCII and Latin-1 letters never have names,
+// only the keycap bases do when a keycap follows.
+bool MayStartSymbol(const SymbolTable &table, const wchar_t *str, size_t length, char32_t c, size_t next) {
+  if (!SymbolStartsName(table, c)) return false;
+  if (c >= 0xA0) return true;
+  if (c != L'#' && c != L'*' && (c < L'0' || c > L'9')) return false;
+  if (next < length && str[next] == 0xFE0F) ++next;
+  return (next < length && str[next] == 0x20E3);
+}
+
+// Reads one emoji into the key: the base with the regional indicator of a flag,
+// a keycap or the tags of a subdivision flag. Variation selectors and skin tones
+// are left out of the key, the first skin tone is kept separately.
+size_t ReadPart(const wchar_t *str, size_t length, size_t position, char32_t *key, size_t &keyLength, char32_t &tone) {
+  char32_t c;
+  position = Decode(str, length, position, c);
+  key[keyLength++] = c;
+  if (IsRegionalIndicator(c) && position < length) {
+    char32_t second;
+    const size_t next = Decode(str, length, position, second);
+    if (IsRegionalIndicator(second)) {
+      key[keyLength++] = second;
+      position = next;
+    }
+  }
+  while (position < length) {
+    const size_t next = Decode(str, length, position, c);
+    if (c == 0xFE0E || c == 0xFE0F) {}
+    else if (IsSkinTone(c)) {
+      if (!tone) tone = c;
+    }
+    else if ((c == 0x20E3 || IsTag(c)) && keyLength < SYMBOL_MAX_LENGTH) key[keyLength++] = c;
+    else break;
+    position = next;
+  }
+  return position;
+}
+
+} // namespace
+
+const SymbolTable *FindSymbolTable(const wchar_t *language) {
+  if (!language) return nullptr;
+  for (const SymbolTable &table : g_symbolTables) {
+    if (!_wcsicmp(table.language, language)) return &table;
+  }
+  const wchar_t *separator = wcspbrk(language, L"-_");
+  if (!separator) return nullptr;
+  const std::wstring base(language, separator - language);
+  return FindSymbolTable(base.c_str());
+}
+
+const wchar_t *NameSymbols(const SymbolTable &table, const wchar_t *str) {
+  // Per thread, like the buffers of NormalizeText.
+  thread_local std::wstring buffer;
+  const size_t length = wcslen(str);
+  bool named = false;
+  // The text up to here is in the buffer.
+  size_t copied = 0;
+  for (size_t i = 0; i < length;) {
+    char32_t c;
+    const size_t next = Decode(str, length, i, c);
+    if (!MayStartSymbol(table, str, length, c, next)) {
+      i = next;
+      continue;
+    }
+    // Reads emoji joined by ZWJ, then looks up the longest run of them that has a name.
+    char32_t key[SYMBOL_MAX_LENGTH + 2];
+    size_t keyLength = 0;
+    size_t keyEnds[SYMBOL_MAX_PARTS];
+    size_t ends[SYMBOL_MAX_PARTS];
+    size_t parts = 0;
+    char32_t tone = 0;
+    size_t position = i;
+    for (;;) {
+      position = ReadPart(str, length, position, key, keyLength, tone);
+      keyEnds[parts] = keyLength;
+      ends[parts++] = position;
+      if (parts == SYMBOL_MAX_PARTS || keyLength >= SYMBOL_MAX_LENGTH || position + 1 >= length || str[position] != 0x200D) break;
+      key[keyLength++] = 0x200D;
+      ++position;
+    }
+    const SymbolEntry *entry = nullptr;
+    while (parts && !(entry = Lookup(table, key, keyEnds[parts - 1]))) --parts;
+    if (!entry) {
+      i = next;
+      continue;
+    }
+    if (!named) buffer.clear();
+    named = true;
+    if (i > copied) {
+      if (!buffer.empty() && !IsSpace(buffer.back()) && NeedsSpaceBefore(str[copied])) buffer += L' ';
+      buffer.append(str + copied, i - copied);
+    }
+    if (!buffer.empty() && !IsSpace(buffer.back())) buffer += L' ';
+    buffer += entry->name;
+    const SymbolEntry *toneEntry = tone ? Lookup(table, &tone, 1) : nullptr;
+    if (toneEntry) {
+      buffer += L": ";
+      buffer += toneEntry->name;
+    }
+    i = copied = ends[parts - 1];
+    // What is left of a longer sequence is named on its own.
+    if (i < length && str[i] == 0x200D) i = copied = i + 1;
+  }
+  if (!named) return str;
+  if (copied < length) {
+    if (NeedsSpaceBefore(str[copied])) buffer += L' ';
+    buffer.append(str + copied, length - copied);
+  }
+  return buffer.c_str();
+}
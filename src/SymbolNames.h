@@ -0,0 +1,59 @@
+/**
+ *  Product:        Tolk
+ *  File:           SymbolNames.h
+ *  Description:    Names of emoji and symbols, spoken in place of the characters.
+ *  Copyright:      (c) 2026, Davy Kager <mail@davykager.nl>
+ *  License:        LGPLv3
+ */
+
+#ifndef _SYMBOL_NAMES_H_
+#define _SYMBOL_NAMES_H_
+
+#include <stddef.h>
+
+// One name, its code points are codePoints[first] up to codePoints[first + length].
+struct SymbolEntry {
+  unsigned int first;
+  unsigned int length;
+  const wchar_t *name;
+};
+
+// Names of one language in a perfect hash table, generated at build time from
+// the files in the symbols directory by GenerateSymbolTables.py.
+struct SymbolTable {
+  const wchar_t *language;
+  const char32_t *codePoints;
+  const SymbolEntry *entries;
+  const unsigned int *displacements;
+  // Bitmap of the UTF-16 code units that start a name, see SymbolStartsName.
+  const unsigned int *starts;
+  unsigned int size;
+};
+
+// FNV-1a over the code points, must match hash_symbol in GenerateSymbolTables.py.
+inline unsigned int HashSymbol(const char32_t *codePoints, size_t length, unsigned int seed) {
+  unsigned int hash = 2166136261u ^ seed;
+  for (size_t i = 0; i < length; ++i) {
+    hash ^= codePoints[i];
+    hash *= 16777619u;
+  }
+  return hash;
+}
+
+// Whether a name in the table starts with the code point, judged by its first
+// UTF-16 code unit. False positives are possible past the BMP.
+inline bool SymbolStartsName(const SymbolTable &table, char32_t c) {
+  const unsigned int unit = (c > 0xFFFF) ? 0xD800 + ((c - 0x10000) >> 10) : c;
+  return (unit <= 0xFFFF && (table.starts[unit >> 5] >> (unit & 31)) & 1);
+}
+
+// Returns nullptr if there are no names for the language. A language with a
+// region, such as en-US, falls back to the language alone.
+const SymbolTable *FindSymbolTable(const wchar_t *language);
+
+// Replaces emoji, including sequences joined by ZWJ, flags and keycaps, and
+// other symbols with their names. Returns str itself if there were none,
+// otherwise a buffer of the calling thread that is valid until its next call.
+const wchar_t *NameSymbols(const SymbolTable &table, const wchar_t *str);
+
+#endif // _SYMBOL_NAMES_H_
@@ -0,0 +1,24 @@
+/**
+ *  Product:        Tolk
+ *  File:           TextClasses.h
+ *  Description:    Character classes shared by the passes over text.
+ *  Copyright:      (c) 2026, Davy Kager <mail@davykager.nl>
+ *  License:        LGPLv3
+ */
+
+#ifndef _TEXT_CLASSES_H_
+#define _TEXT_CLASSES_H_
+
+#include <windows.h>
+
+// ASCII whitespace and the ideographic space. No-break spaces are left out on
+// purpose, the text on either side of one belongs together.
+inline bool IsSpace(wchar_t c) { return (c == L' ' || (c >= L'\t' && c <= L'\r') || c == 0x3000); }
+
+// Letters and digits in any script, ASCII without a call into User32.
+inline bool IsWordChar(wchar_t c) {
+  if (c < 0x80) return ((c >= L'0' && c <= L'9') || (c >= L'a' && c <= L'z') || (c >= L'A' && c <= L'Z'));
+  return !!IsCharAlphaNumericW(c);
+}
+
+#endif // _TEXT_CLASSES_H_
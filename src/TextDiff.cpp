@@ -0,0 +1,94 @@
+/**
+ *  Product:        Tolk
+ *  File:           TextDiff.cpp
+ *  Description:    Last text output per key and the part of the next one that changed.
+ *  Copyright:      (c) 2026, Davy Kager <mail@davykager.nl>
+ *  License:        LGPLv3
+ */
+
+#include "TextClasses.h"
+#include "TextDiff.h"
+
+bool TextDiff::Update(const wchar_t *key, const wchar_t *str, std::wstring &changed) {
+  const size_t length = wcslen(str);
+  Tokenize(str, length, newTokens);
+  const size_t newCount = newTokens.size();
+  const auto found = index.find(key);
+  if (found == index.end()) {
+    changed = str;
+    if (length > TEXT_DIFF_MAX_TEXT) return (newCount > 0);
+    if (entries.size() >= TEXT_DIFF_MAX_KEYS) {
+      index.erase(entries.back().first);
+      entries.pop_back();
+    }
+    entries.emplace_front(key, str);
+    index[key] = entries.begin();
+    return (newCount > 0);
+  }
+  entries.splice(entries.begin(), entries, found->second);
+  std::wstring &old = found->second->second;
+  if (!newCount) {
+    // Blank, the next text is compared with nothing.
+    changed.clear();
+    old.clear();
+    return false;
+  }
+  Tokenize(old.c_str(), old.size(), oldTokens);
+  const size_t oldCount = oldTokens.size();
+  size_t prefix = 0;
+  while (prefix < oldCount && prefix < newCount && SameToken(old.c_str(), oldTokens[prefix], str, newTokens[prefix])) ++prefix;
+  if (prefix == oldCount && prefix == newCount) {
+    // Spacing may differ, but there is nothing new to say.
+    old = str;
+    return false;
+  }
+  size_t suffix = 0;
+  while (suffix < oldCount - prefix && suffix < newCount - prefix
+    && SameToken(old.c_str(), oldTokens[oldCount - 1 - suffix], str, newTokens[newCount - 1 - suffix])) ++suffix;
+  size_t end = newCount - suffix;
+  if (end == prefix) {
+    // Tokens were taken away, what is left is read out as a whole.
+    changed = str;
+  }
+  else {
+    // "42" alone is unclear, "42%" is not. Longer endings such as "of 100" are left out.
+    size_t words = 0;
+    for (size_t i = end; i < newCount && words < 2; ++i) words += newTokens[i].word;
+    if (words < 2) end = newCount;
+    changed.assign(str + newTokens[prefix].start, newTokens[end - 1].end - newTokens[prefix].start);
+  }
+  if (length > TEXT_DIFF_MAX_TEXT) {
+    index.erase(found);
+    entries.pop_front();
+  }
+  else {
+    old = str;
+  }
+  return true;
+}
+
+void TextDiff::Clear() {
+  index.clear();
+  entries.clear();
+}
+
+void TextDiff::Tokenize(const wchar_t *str, size_t length, std::vector<Token> &tokens) {
+  tokens.clear();
+  for (size_t i = 0; i < length;) {
+    if (IsSpace(str[i])) {
+      ++i;
+      continue;
+    }
+    const size_t start = i;
+    if (!IsWordChar(str[i])) {
+      tokens.push_back({ start, ++i, false });
+      continue;
+    }
+    while (i < length && (IsWordChar(str[i]) || (!IsSpace(str[i]) && i + 1 < length && IsWordChar(str[i + 1])))) ++i;
+    tokens.push_back({ start, i, true });
+  }
+}
+
+bool TextDiff::SameToken(const wchar_t *a, const Token &x, const wchar_t *b, const Token &y) {
+  return (x.end - x.start == y.end - y.start && wmemcmp(a + x.start, b + y.start, x.end - x.start) == 0);
+}
@@ -0,0 +1,64 @@
+/**
+ *  Product:        Tolk
+ *  File:           TextDiff.h
+ *  Description:    Last text output per key and the part of the next one that changed.
+ *  Copyright:      (c) 2026, Davy Kager <mail@davykager.nl>
+ *  License:        LGPLv3
+ */
+
+#ifndef _TEXT_DIFF_H_
+#define _TEXT_DIFF_H_
+
+#include <windows.h>
+#include <list>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+// Keys beyond this many are forgotten, least recently used first.
+#define TEXT_DIFF_MAX_KEYS 64
+// Longer text is not remembered, the next text for its key is spoken whole.
+#define TEXT_DIFF_MAX_TEXT 4096
+
+// Texts are compared a token at a time, a token being a word or a single
+// punctuation mark. Punctuation between two letters or digits belongs to the
+// word, so 41.5 and file.txt are one token each. What changed is what lies
+// between the tokens the two texts start and end with, which takes one pass
+// over both. Used under the global lock.
+class TextDiff {
+public:
+  TextDiff() {}
+  TextDiff(const TextDiff&) = delete;
+  TextDiff& operator=(const TextDiff&) = delete;
+
+public:
+  // Remembers the text for the key. Returns false if it has the same tokens as the
+  // text before it, otherwise sets changed to the part of it to speak: the changed
+  // tokens, up to the end if only a unit such as % follows them, or the whole text
+  // if tokens were only taken away. Also returns false for text without tokens,
+  // after which the next text is said whole.
+  bool Update(const wchar_t *key, const wchar_t *str, std::wstring &changed);
+  void Clear();
+
+private:
+  struct Token {
+    size_t start;
+    size_t end;
+    bool word;
+  };
+  typedef std::list<std::pair<std::wstring, std::wstring>> Entries;
+
+private:
+  static void Tokenize(const wchar_t *str, size_t length, std::vector<Token> &tokens);
+  static bool SameToken(const wchar_t *a, const Token &x, const wchar_t *b, const Token &y);
+
+private:
+  // Most recently used first.
+  Entries entries;
+  std::unordered_map<std::wstring, Entries::iterator> index;
+  // Kept to save allocations between updates.
+  std::vector<Token> oldTokens;
+  std::vector<Token> newTokens;
+};
+
+#endif // _TEXT_DIFF_H_
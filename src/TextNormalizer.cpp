@@ -0,0 +1,120 @@
+/**
+ *  Product:        Tolk
+ *  File:           TextNormalizer.cpp
+ *  Description:    Clean-up of text before it is handed to a screen reader.
+ *  Copyright:      (c) 2026, Davy Kager <mail@davykager.nl>
+ *  License:        LGPLv3
+ */
+
+#include <windows.h>
+#include <string>
+#include "TextNormalizer.h"
+
+#if defined(_M_IX86) || defined(_M_X64)
+#include <emmintrin.h>
+#define TEXT_NORMALIZER_SSE2
+#endif
+
+namespace {
+
+enum CharClass {
+  CHAR_KEEP,
+  CHAR_SPACE,
+  CHAR_DROP,
+  CHAR_COMBINING
+};
+
+CharClass Classify(wchar_t c) {
+  if (c > L' ' && c < 0x7F) return CHAR_KEEP;
+  if (c == L' ' || (c >= 0x09 && c <= 0x0D)) return CHAR_SPACE;
+  // The rest of C0, DEL and C1.
+  if (c < 0xA0) return CHAR_DROP;
+  if (c == 0xA0 || (c >= 0x2000 && c <= 0x200A) || c == 0x2028 || c == 0x2029 || c == 0x202F || c == 0x205F || c == 0x3000)
+    return CHAR_SPACE;
+  // Soft hyphen and the zero-width characters, word joiner and byte order mark.
+  if (c == 0xAD || (c >= 0x200B && c <= 0x200D) || c == 0x2060 || c == 0xFEFF) return CHAR_DROP;
+  if (c >= 0x0300 && c <= 0x036F) return CHAR_COMBINING;
+  return CHAR_KEEP;
+}
+
+// ZWJ between emoji is kept so the sequence can still be named, the emoji
+// before it is outside the BMP or ends in a variation selector.
+bool JoinsEmoji(const wchar_t *str, size_t i) {
+  return (str[i] == 0x200D && i > 0 && (IS_LOW_SURROGATE(str[i - 1]) || str[i - 1] == 0xFE0F));
+}
+
+bool IsClean(const wchar_t *str, size_t i) { return (str[i] == L' ' || Classify(str[i]) == CHAR_KEEP || JoinsEmoji(str, i)); }
+
+// Clean text has single spaces between words and nothing to drop or compose.
+bool NeedsNormalizing(const wchar_t *str, size_t length) {
+  if (!length) return false;
+  if (str[0] == L' ' || str[length - 1] == L' ') return true;
+  size_t i = 0;
+#ifdef TEXT_NORMALIZER_SSE2
+  // Printable ASCII is settled 8 characters at a time, blocks with anything
+  // else in them are looked at one character at a time.
+  const __m128i low = _mm_set1_epi16(L' ');
+  const __m128i high = _mm_set1_epi16(0x7E);
+  for (; i + 9 <= length; i += 8) {
+    const __m128i chars = _mm_loadu_si128((const __m128i *)(str + i));
+    const __m128i next = _mm_loadu_si128((const __m128i *)(str + i + 1));
+    if (_mm_movemask_epi8(_mm_and_si128(_mm_cmpeq_epi16(chars, low), _mm_cmpeq_epi16(next, low)))) return true;
+    // Signed compares, so characters from 0x8000 up count as below the space.
+    if (!_mm_movemask_epi8(_mm_or_si128(_mm_cmplt_epi16(chars, low), _mm_cmpgt_epi16(chars, high)))) continue;
+    for (size_t j = i; j < i + 8; ++j) {
+      if (!IsClean(str, j)) return true;
+    }
+  }
+#endif
+  for (; i < length; ++i) {
+    if (!IsClean(str, i) || (str[i] == L' ' && str[i + 1] == L' ')) return true;
+  }
+  return false;
+}
+
+} // namespace
+
+const wchar_t *NormalizeText(const wchar_t *str) {
+  const size_t length = wcslen(str);
+  if (!NeedsNormalizing(str, length)) return str;
+  // Kept per thread so the output functions need no lock for this and, once
+  // grown to fit, don't allocate.
+  thread_local std::wstring buffer;
+  thread_local std::wstring composed;
+  buffer.clear();
+  bool space = false;
+  bool combining = false;
+  for (size_t i = 0; i < length; ++i) {
+    switch (Classify(str[i])) {
+    case CHAR_SPACE:
+      space = !buffer.empty();
+      break;
+    case CHAR_DROP:
+      if (JoinsEmoji(str, i)) buffer += str[i];
+      break;
+    case CHAR_COMBINING:
+      combining = true;
+      // Fall through.
+    case CHAR_KEEP:
+      if (space) {
+        buffer += L' ';
+        space = false;
+      }
+      buffer += str[i];
+      break;
+    }
+  }
+  if (combining) {
+    // Composing never makes the text longer than the estimate.
+    const int estimate = NormalizeString(NormalizationC, buffer.c_str(), (int)buffer.size(), nullptr, 0);
+    if (estimate > 0) {
+      composed.resize(estimate);
+      const int size = NormalizeString(NormalizationC, buffer.c_str(), (int)buffer.size(), &composed[0], estimate);
+      if (size > 0) {
+        composed.resize(size);
+        buffer.swap(composed);
+      }
+    }
+  }
+  return buffer.c_str();
+}
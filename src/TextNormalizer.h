@@ -0,0 +1,19 @@
+/**
+ *  Product:        Tolk
+ *  File:           TextNormalizer.h
+ *  Description:    Clean-up of text before it is handed to a screen reader.
+ *  Copyright:      (c) 2026, Davy Kager <mail@davykager.nl>
+ *  License:        LGPLv3
+ */
+
+#ifndef _TEXT_NORMALIZER_H_
+#define _TEXT_NORMALIZER_H_
+
+// Collapses runs of whitespace into one space and trims the ends, drops control
+// and zero-width characters (except ZWJ between emoji), and composes combining
+// marks (NFC). Returns str itself when there is nothing to change, which is
+// checked without copying. Otherwise returns a buffer of the calling thread,
+// valid until its next call.
+const wchar_t *NormalizeText(const wchar_t *str);
+
+#endif // _TEXT_NORMALIZER_H_
@@ -7,34 +7,752 @@
  */
 
 #include <windows.h>
+#include <algorithm>
+#include <atomic>
+#include <cwctype>
 #include <vector>
 #include <memory>
+#include <string>
 #include "Tolk.h"
-#include "ScreenReaderDriverBOY.h"
-#include "ScreenReaderDriverJAWS.h"
-#include "ScreenReaderDriverNVDA.h"
-#include "ScreenReaderDriverSA.h"
-#include "ScreenReaderDriverSAPI.h"
-#include "ScreenReaderDriverSNova.h"
-#include "ScreenReaderDriverWE.h"
-#include "ScreenReaderDriverZDSR.h"
-#include "ScreenReaderDriverZT.h"
+#include "TolkDrivers.h"
+#include "BraillePager.h"
+#include "DocumentReader.h"
+#include "DriverHealth.h"
+#include "DuplicateFilter.h"
+#include "DriverWatchdog.h"
+#include "PhraseCache.h"
+#include "PresenceWatcher.h"
+#include "PronunciationDictionary.h"
+#include "SpeechEstimator.h"
+#include "SpeechMarks.h"
+#include "SpeechMarkup.h"
+#include "SpeechMonitor.h"
+#include "SpeechProgress.h"
+#include "SpeechQueue.h"
+#include "SymbolNames.h"
+#include "TextDiff.h"
+#include "TextNormalizer.h"
+#include "ScreenReaderDriverBridge.h"
+#include "ScreenReaderDriverBroker.h"
+#include "ScreenReaderDriverPlugin.h"
+#ifdef TOLK_WITH_SAPI
+#include "SpeechSynthesizer.h"
+#endif
 
 static CRITICAL_SECTION g_cs;
 static bool g_comInitializedByUs = false;
 static bool g_isLoaded = false;
 static std::vector<std::unique_ptr<ScreenReaderDriver>> g_screenReaderDrivers;
-static std::unique_ptr<ScreenReaderDriverSAPI> g_sapi;
+static std::unique_ptr<ScreenReaderDriver> g_sapi;
 static ScreenReaderDriver *g_currentScreenReaderDriver = nullptr;
 static bool g_trySAPI = false;
 static bool g_preferSAPI = false;
+static std::wstring g_pluginDirectory;
+static bool g_useBroker = false;
+static int g_brokerPriority = 0;
+static ScreenReaderDriverBroker *g_broker = nullptr;
+static DWORD g_driverTimeout = 0;
+static DriverWatchdog g_watchdog;
+static DriverHealth g_health;
+static SpeechEstimator g_speech;
+// Manual-reset, signaled while nothing is being spoken.
+static HANDLE g_speechDone = nullptr;
+static std::unique_ptr<SpeechMonitor> g_speechMonitor;
+static SpeechMarks g_speechMarks;
+static SpeechMarkupCache g_markupCache;
+static ScreenReaderDriver *g_speakingDriver = nullptr;
+static unsigned int g_longTextThreshold = 0;
+static SpeechQueue g_speechQueue;
+static TextDiff g_textDiff;
+static bool g_braillePaging = false;
+// Set by the application, 0 to use the width the screen reader reports.
+static unsigned int g_brailleCells = 0;
+static BraillePager g_braillePager;
+static std::unique_ptr<DocumentReader> g_document;
+static bool g_documentPaused = false;
+// Set while a chunk of the document has been handed to the driver and not yet spoken.
+static bool g_documentSpeaking = false;
+static ULONGLONG g_documentChunkStart = 0;
+static DWORD g_documentChunkDuration = 0;
+static size_t g_documentChunkLength = 0;
+// Word positions only match the chunk if it was spoken as it is in the document.
+static bool g_documentExact = false;
+// Position of the last word the driver reported plus one, 0 if it reported none. Set on the driver's thread.
+static std::atomic<unsigned long> g_documentWord(0);
+static ULONGLONG g_speechSince = 0;
+static bool g_speechStarted = false;
+static bool g_failover = false;
+static DWORD g_failoverBudget = 0;
+static ScreenReaderDriver *g_deliveringDriver = nullptr;
+static DWORD g_hedgingBudget = 0;
+static std::wstring g_hedgingDriverName;
+static bool g_watchPresence = false;
+static std::unique_ptr<PresenceWatcher> g_presenceWatcher;
+static bool g_detectionValid = false;
+static LONG g_detectedSerial = 0;
+static Tolk_ScreenReaderChangedCallback g_changedCallback = nullptr;
+static void *g_changedUserData = nullptr;
+static std::wstring g_announcedName;
+// Read before taking the lock, text is prepared outside of it.
+static std::atomic<bool> g_normalizeText(false);
+#ifdef _WITH_SYMBOL_NAMES
+static std::atomic<const SymbolTable *> g_symbolTable(nullptr);
+#endif
+static std::shared_ptr<const PronunciationDictionary> g_dictionary;
+static std::atomic<bool> g_dictionaryForBraille(false);
+// Checked before taking the lock, repeats are dropped without waiting for it.
+static std::atomic<DWORD> g_duplicateWindow(0);
+static DuplicateFilter g_speechRepeats;
+static DuplicateFilter g_brailleRepeats;
+// Bumped when the way text is prepared for speech changes, cached markup is then parsed again.
+static std::atomic<unsigned long> g_textGeneration(0);
+// Read without the lock by Tolk_Synthesize, so always swapped atomically.
+static std::shared_ptr<PhraseCache> g_phraseCache;
+// What Tolk_SetPhraseCache was last given, Tolk_Load sets the cache up again from it.
+static unsigned int g_phraseCacheKilobytes = 0;
+static bool g_phraseCacheInFile = false;
+static std::wstring g_phraseCachePath;
+
+static CRITICAL_SECTION g_progressLock;
+static Tolk_SpeechProgressCallback g_progressCallback = nullptr;
+static void *g_progressUserData = nullptr;
+
+static_assert(TOLK_SPEECH_STARTED == SPEECH_PROGRESS_STARTED && TOLK_SPEECH_WORD == SPEECH_PROGRESS_WORD
+  && TOLK_SPEECH_BOOKMARK == SPEECH_PROGRESS_BOOKMARK && TOLK_SPEECH_FINISHED == SPEECH_PROGRESS_FINISHED, "speech progress events differ");
+static_assert(TOLK_DOCUMENT_SENTENCE == DOCUMENT_SENTENCE && TOLK_DOCUMENT_PARAGRAPH == DOCUMENT_PARAGRAPH, "document units differ");
+
+// Called on whatever thread the driver reports progress on. Only the callback's
+// own lock is taken, the driver may be reporting from inside a call made under g_cs.
+static void OnDriverProgress(ScreenReaderDriver *, int event, unsigned long position, unsigned long length) {
+  if (event == SPEECH_PROGRESS_WORD) g_documentWord = position + 1;
+  if (event == SPEECH_PROGRESS_BOOKMARK) {
+    // Marks of Tolk_SpeakWithMarks only go to the callback passed with them.
+    std::vector<SpeechMarks::Reached> reached;
+    if (g_speechMarks.Bookmark(position, reached)) {
+      SpeechMarks::Report(reached);
+      return;
+    }
+  }
+  EnterCriticalSection(&g_progressLock);
+  const Tolk_SpeechProgressCallback callback = g_progressCallback;
+  void *userData = g_progressUserData;
+  LeaveCriticalSection(&g_progressLock);
+  if (callback) callback(event, position, length, userData);
+}
+
+#ifdef TOLK_WITH_SAPI
+// Passes audio on to a Tolk_Synthesize caller while keeping a copy for the phrase cache.
+struct PhraseRecording {
+  Tolk_AudioCallback callback;
+  void *userData;
+  std::vector<char> audio;
+};
+
+static bool RecordPhrase(const void *data, unsigned int size, void *userData) {
+  PhraseRecording &recording = *(PhraseRecording *)userData;
+  recording.audio.insert(recording.audio.end(), (const char *)data, (const char *)data + size);
+  return recording.callback(data, size, recording.userData);
+}
+#endif
+
+// Returns nullptr if the SAPI driver was left out of the build.
+static std::unique_ptr<ScreenReaderDriver> CreateSAPIDriver() {
+#ifdef TOLK_WITH_SAPI
+  auto driver = std::make_unique<ScreenReaderDriverSAPI>();
+  driver->SetProgressListener(OnDriverProgress);
+  driver->SetPhraseCache(g_phraseCache);
+  return driver;
+#else
+  return nullptr;
+#endif
+}
+
+// The directory Tolk.dll was loaded from, including the trailing backslash.
+static std::wstring GetModuleDirectory() {
+  HMODULE module = nullptr;
+  if (!GetModuleHandleExW(GET_MODULE_HANDLE_EX_FLAG_FROM_ADDRESS | GET_MODULE_HANDLE_EX_FLAG_UNCHANGED_REFCOUNT, (LPCWSTR)&GetModuleDirectory, &module))
+    return std::wstring();
+  wchar_t path[MAX_PATH];
+  const DWORD length = GetModuleFileNameW(module, path, MAX_PATH);
+  if (length == 0 || length == MAX_PATH) return std::wstring();
+  std::wstring directory(path, length);
+  directory.erase(directory.find_last_of(L'\\') + 1);
+  return directory;
+}
+
+// Plugins live in the TolkPlugins directory next to Tolk.dll unless the client says otherwise.
+static std::wstring GetPluginDirectory() {
+  if (!g_pluginDirectory.empty()) return g_pluginDirectory;
+  const std::wstring directory = GetModuleDirectory();
+  if (directory.empty()) return directory;
+  return directory + L"TolkPlugins";
+}
+
+// Only enumerates file names, the plugins themselves are loaded on demand.
+static void AddPluginDrivers() {
+  const std::wstring directory = GetPluginDirectory();
+  if (directory.empty()) return;
+  WIN32_FIND_DATAW data;
+  const HANDLE find = FindFirstFileW((directory + L"\\*.dll").c_str(), &data);
+  if (find == INVALID_HANDLE_VALUE) return;
+  do {
+    if (!(data.dwFileAttributes & FILE_ATTRIBUTE_DIRECTORY))
+      g_screenReaderDrivers.push_back(std::make_unique<ScreenReaderDriverPlugin>(directory + L"\\" + data.cFileName));
+  } while (FindNextFileW(find, &data));
+  FindClose(find);
+}
+
+// Auto-detection starts over on the next call.
+static void ForgetCurrentDriver() {
+  g_currentScreenReaderDriver = nullptr;
+  g_detectionValid = false;
+}
+
+// Markup is lowered for each driver it is handed to, so failover and hedging get the form they take.
+static const wchar_t *GetDriverText(ScreenReaderDriver *driver, DriverOperation operation, const wchar_t *str) {
+  if (operation != DRIVER_SPEAK_MARKUP) return str;
+  const std::wstring *lowered = g_markupCache.Lower(str, driver);
+  return lowered ? lowered->c_str() : nullptr;
+}
+
+// Calls the driver directly, or on its worker thread if a deadline has been set or it has
+// one already. Drivers that are hung or whose circuit is open are skipped.
+static bool InvokeWithin(ScreenReaderDriver *driver, DriverOperation operation, const wchar_t *str, bool interrupt, DWORD timeout) {
+  str = GetDriverText(driver, operation, str);
+  if (operation == DRIVER_SPEAK_MARKUP && !str) return false;
+  const bool onWorker = timeout || g_watchdog.HasWorker(driver);
+  bool skip = !g_health.Allow(driver) || (onWorker && g_watchdog.IsQuarantined(driver));
+  bool result = false;
+  if (!skip) {
+    if (!onWorker) {
+      result = CallDriver(driver, operation, str, interrupt);
+      skip = g_health.Record(driver, operation, result);
+    }
+    else if (g_watchdog.Run(driver, operation, str, interrupt, timeout ? timeout : INFINITE, result)) {
+      skip = g_health.Record(driver, operation, result);
+    }
+    else {
+      // A hang counts as a failed output call, whatever the operation was.
+      g_health.Record(driver, DRIVER_OUTPUT, false);
+      skip = true;
+    }
+  }
+  // Let auto-detection move on to the next driver.
+  if (skip && driver == g_currentScreenReaderDriver) ForgetCurrentDriver();
+  return result;
+}
+
+static bool Invoke(ScreenReaderDriver *driver, DriverOperation operation, const wchar_t *str = nullptr, bool interrupt = false) {
+  return InvokeWithin(driver, operation, str, interrupt, g_driverTimeout);
+}
+
+static bool CanDeliver(const ScreenReaderDriver *driver, DriverOperation operation) {
+  if (operation == DRIVER_SPEAK || operation == DRIVER_SPEAK_MARKUP) return driver->HasSpeech();
+  // Only marked text is sent as SSML.
+  if (operation == DRIVER_SPEAK_SSML) return driver->HasSsml() && driver->HasBookmarks();
+  if (operation == DRIVER_BRAILLE) return driver->HasBraille();
+  return true;
+}
+
+// Same order as auto-detection, but leaves the current driver alone.
+static ScreenReaderDriver *FindFailoverDriver(DriverOperation operation, const std::vector<ScreenReaderDriver *> &failed) {
+  std::vector<ScreenReaderDriver *> candidates;
+  if (g_trySAPI && g_preferSAPI && g_sapi) candidates.push_back(g_sapi.get());
+  for (const auto &driver : g_screenReaderDrivers) candidates.push_back(driver.get());
+  if (g_trySAPI && !g_preferSAPI && g_sapi) candidates.push_back(g_sapi.get());
+  for (ScreenReaderDriver *driver : candidates) {
+    if (std::find(failed.begin(), failed.end(), driver) != failed.end()) continue;
+    if (CanDeliver(driver, operation) && Invoke(driver, DRIVER_IS_ACTIVE)) return driver;
+  }
+  return nullptr;
+}
+
+// The named driver if one has been chosen, the next active driver otherwise.
+static ScreenReaderDriver *FindHedgingDriver(ScreenReaderDriver *primary, DriverOperation operation) {
+  const std::vector<ScreenReaderDriver *> excluded(1, primary);
+  if (g_hedgingDriverName.empty()) return FindFailoverDriver(operation, excluded);
+  std::vector<ScreenReaderDriver *> candidates;
+  if (g_sapi) candidates.push_back(g_sapi.get());
+  for (const auto &driver : g_screenReaderDrivers) candidates.push_back(driver.get());
+  for (ScreenReaderDriver *driver : candidates) {
+    if (driver != primary && _wcsicmp(driver->GetName(), g_hedgingDriverName.c_str()) == 0)
+      return (CanDeliver(driver, operation) && Invoke(driver, DRIVER_IS_ACTIVE)) ? driver : nullptr;
+  }
+  return nullptr;
+}
+
+// Gives the primary driver the hedging budget, then sends the text to a secondary driver.
+// A secondary that fails is added to the failed drivers for failover.
+static bool InvokeHedged(ScreenReaderDriver *driver, DriverOperation operation, const wchar_t *str, bool interrupt, std::vector<ScreenReaderDriver *> &failed) {
+  // Looked up first, the primary's call cannot be taken back once it has been abandoned.
+  ScreenReaderDriver *secondary = FindHedgingDriver(driver, operation);
+  if (!secondary) {
+    if (!Invoke(driver, operation, str, interrupt)) return false;
+    g_deliveringDriver = driver;
+    return true;
+  }
+  const wchar_t *text = GetDriverText(driver, operation, str);
+  // Run on the primary's worker even without a deadline. From then on all of its calls go
+  // there, and while an abandoned call is still inside it they skip it, see InvokeWithin.
+  if (text && g_health.Allow(driver) && !g_watchdog.IsQuarantined(driver)) {
+    bool result = false;
+    if (g_watchdog.Run(driver, operation, text, interrupt, g_hedgingBudget, result, true)) {
+      if (g_health.Record(driver, operation, result) && driver == g_currentScreenReaderDriver)
+        ForgetCurrentDriver();
+      if (result) {
+        g_deliveringDriver = driver;
+        return true;
+      }
+    }
+  }
+  if (Invoke(secondary, operation, str, interrupt)) {
+    g_deliveringDriver = secondary;
+    return true;
+  }
+  failed.push_back(secondary);
+  return false;
+}
+
+// Sends text through the current driver. In failover mode a failed call is retried
+// on the next active driver, each driver at most once, until the budget runs out.
+static bool Dispatch(DriverOperation operation, const wchar_t *str, bool interrupt) {
+  g_deliveringDriver = nullptr;
+  if (!Tolk_DetectScreenReader()) return false;
+  ScreenReaderDriver *driver = g_currentScreenReaderDriver;
+  std::vector<ScreenReaderDriver *> failed(1, driver);
+  // Braille is not worth hedging, it is instantaneous.
+  if (g_hedgingBudget && operation != DRIVER_BRAILLE) {
+    if (InvokeHedged(driver, operation, str, interrupt, failed)) return true;
+  }
+  else if (Invoke(driver, operation, str, interrupt)) {
+    g_deliveringDriver = driver;
+    return true;
+  }
+  if (!g_failover) return false;
+  const ULONGLONG start = GetTickCount64();
+  for (;;) {
+    DWORD timeout = g_driverTimeout;
+    if (g_failoverBudget) {
+      const ULONGLONG elapsed = GetTickCount64() - start;
+      if (elapsed >= g_failoverBudget) return false;
+      // Don't let a slow driver eat more than what is left of the budget.
+      const DWORD remaining = (DWORD)(g_failoverBudget - elapsed);
+      if (timeout && remaining < timeout) timeout = remaining;
+    }
+    driver = FindFailoverDriver(operation, failed);
+    if (!driver) return false;
+    if (InvokeWithin(driver, operation, str, interrupt, timeout)) {
+      g_deliveringDriver = driver;
+      return true;
+    }
+    failed.push_back(driver);
+  }
+}
+
+// Tracks the driver that was last given text to speak, for Tolk_WaitForSpeechEnd.
+static void SpeechStarted(ScreenReaderDriver *driver) {
+  g_speakingDriver = driver;
+  g_speechSince = GetTickCount64();
+  g_speechStarted = false;
+  if (!g_speechMonitor) return;
+  ResetEvent(g_speechDone);
+  g_speechMonitor->Wake();
+}
+
+// The text as it is spoken and as it is brailled, these differ when the dictionary only applies to speech.
+struct PreparedText {
+  const wchar_t *speech;
+  const wchar_t *braille;
+};
+
+// Runs before the lock is taken. The result is valid until the calling thread prepares more text.
+static PreparedText PrepareText(const wchar_t *str, DriverOperation operation) {
+  PreparedText text = { str, str };
+  if (!str) return text;
+  if (g_normalizeText.load(std::memory_order_relaxed)) text.speech = text.braille = NormalizeText(str);
+#ifdef _WITH_SYMBOL_NAMES
+  // The tables are static, so there is nothing to keep alive.
+  const SymbolTable *symbols = g_symbolTable.load(std::memory_order_relaxed);
+  if (symbols) text.speech = text.braille = NameSymbols(*symbols, text.speech);
+#endif
+  const bool braille = g_dictionaryForBraille.load(std::memory_order_relaxed);
+  if (operation == DRIVER_BRAILLE && !braille) return text;
+  // Held for the whole call, a dictionary that is being replaced stays usable until then.
+  const std::shared_ptr<const PronunciationDictionary> dictionary = std::atomic_load(&g_dictionary);
+  if (!dictionary) return text;
+  const wchar_t *substituted = dictionary->Apply(text.speech);
+  if (operation != DRIVER_BRAILLE) text.speech = substituted;
+  if (braille) text.braille = substituted;
+  return text;
+}
+
+// Prepares the text runs of speech markup.
+static const wchar_t *PrepareMarkup(const wchar_t *str) {
+  return PrepareText(str, DRIVER_SPEAK).speech;
+}
+
+// For markup, spoken is the text it speaks, which speaking time is estimated from.
+static bool Deliver(DriverOperation operation, const wchar_t *str, bool interrupt, const wchar_t *spoken = nullptr) {
+  if (!Dispatch(operation, str, interrupt)) return false;
+  if (operation != DRIVER_BRAILLE && g_deliveringDriver->HasSpeech()) {
+    g_speech.Spoke(g_deliveringDriver, spoken ? spoken : str, interrupt);
+    SpeechStarted(g_deliveringDriver);
+  }
+  return true;
+}
+
+// With paging the screen reader gets the first page of the text, the others are panned to.
+static bool DeliverBraille(const wchar_t *str) {
+  if (!g_braillePaging) return Deliver(DRIVER_BRAILLE, str, false);
+  unsigned int cells = g_brailleCells;
+  if (!cells && Tolk_DetectScreenReader() && !g_watchdog.IsQuarantined(g_currentScreenReaderDriver))
+    cells = g_currentScreenReaderDriver->GetBrailleCells();
+  if (!cells) cells = BRAILLE_DEFAULT_CELLS;
+  g_braillePager.Show(str, cells);
+  return Deliver(DRIVER_BRAILLE, g_braillePager.GetPage().c_str(), false);
+}
+
+static void StartSpeechMonitor();
+
+// Takes the next chunk from the speech queue, the queue is dropped if no driver accepts it.
+static bool SpeakNextChunk(bool interrupt, size_t maxLength) {
+  static std::wstring chunk;
+  if (!g_speechQueue.Next(chunk, maxLength)) return false;
+  if (!Deliver(DRIVER_SPEAK, chunk.c_str(), interrupt)) {
+    g_speechQueue.Clear();
+    return false;
+  }
+  // Feeds the rest of the queue once the chunk has been spoken.
+  StartSpeechMonitor();
+  return true;
+}
+
+// Where reading has got to in the chunk being spoken, from the words the driver
+// reports or estimated from the time it has been speaking.
+static ULONGLONG GetDocumentReadPosition() {
+  if (!g_documentSpeaking) return g_document->GetPosition();
+  size_t index = 0;
+  const unsigned long word = g_documentWord;
+  if (word && g_documentExact) {
+    index = word - 1;
+  }
+  else if (g_documentChunkDuration && g_documentChunkLength) {
+    // Rather the last word again than skipping it when the estimate runs out early.
+    const ULONGLONG elapsed = GetTickCount64() - g_documentChunkStart;
+    index = (elapsed >= g_documentChunkDuration) ? g_documentChunkLength - 1 : (size_t)(g_documentChunkLength * elapsed / g_documentChunkDuration);
+  }
+  return g_document->GetChunkPosition(index);
+}
+
+// Keeps the position, so reading can be resumed where it stopped.
+static void PauseDocument() {
+  if (!g_document || g_documentPaused) return;
+  g_document->Seek(GetDocumentReadPosition());
+  g_documentPaused = true;
+  g_documentSpeaking = false;
+}
+
+// Hands the next chunk of the document to the driver, reading pauses if no driver accepts it.
+static bool SpeakDocumentChunk(bool interrupt, size_t maxLength) {
+  static std::wstring chunk;
+  g_documentSpeaking = false;
+  if (!g_document || g_documentPaused || !g_document->Next(chunk, maxLength)) return false;
+  if (interrupt) g_speechMarks.Clear();
+  const PreparedText text = PrepareText(chunk.c_str(), DRIVER_SPEAK);
+  g_documentWord = 0;
+  g_documentExact = (text.speech == chunk.c_str());
+  if (!Deliver(DRIVER_SPEAK, text.speech, interrupt)) {
+    g_document->Seek(g_document->GetChunkPosition(0));
+    g_documentPaused = true;
+    return false;
+  }
+  g_documentSpeaking = true;
+  g_documentChunkStart = GetTickCount64();
+  g_documentChunkDuration = g_speech.Estimate(g_deliveringDriver, text.speech);
+  g_documentChunkLength = chunk.size();
+  // Feeds the rest of the document once the chunk has been spoken.
+  StartSpeechMonitor();
+  return true;
+}
+
+// Expects the lock to be held.
+static bool StartDocument(std::unique_ptr<DocumentReader> &document, unsigned long long position) {
+  g_document = std::move(document);
+  g_document->Seek(position);
+  g_documentPaused = false;
+  g_speechQueue.Clear();
+  return SpeakDocumentChunk(true, SPEECH_CHUNK_FIRST);
+}
+
+// Drops the speech queue and the marks not reached yet, and pauses a document that is being read.
+static void InterruptSpeech() {
+  g_speechQueue.Clear();
+  g_speechMarks.Clear();
+  PauseDocument();
+}
+
+// Long text goes into the speech queue, as does any text that comes after it
+// while the queue is being spoken, so it is not spoken in the middle of it.
+static bool QueuesSpeech(const wchar_t *str, bool interrupt) {
+  if (interrupt) InterruptSpeech();
+  if (!g_speechQueue.IsEmpty()) return true;
+  return (g_longTextThreshold && wcsnlen(str, (size_t)g_longTextThreshold + 1) > g_longTextThreshold);
+}
+
+// The first chunk is spoken right away if the queue was empty.
+static bool QueueSpeech(const wchar_t *str, bool interrupt) {
+  const bool idle = g_speechQueue.IsEmpty();
+  g_speechQueue.Add(str);
+  if (idle) return SpeakNextChunk(interrupt, SPEECH_CHUNK_FIRST);
+  return true;
+}
+
+static bool DeliverSpeech(const wchar_t *str, bool interrupt) {
+  if (QueuesSpeech(str, interrupt)) return QueueSpeech(str, interrupt);
+  return Deliver(DRIVER_SPEAK, str, interrupt);
+}
+
+static bool DeliverOutput(const PreparedText &text, bool interrupt) {
+  if (QueuesSpeech(text.speech, interrupt)) {
+    // Braille gets the whole text at once.
+    bool result = QueueSpeech(text.speech, interrupt);
+    if (Tolk_HasBraille()) result = DeliverBraille(text.braille) || result;
+    return result;
+  }
+  if (text.speech == text.braille && !g_braillePaging) return Deliver(DRIVER_OUTPUT, text.speech, interrupt);
+  // Spoken and brailled text differ, so the screen reader gets them one at a time.
+  bool result = Deliver(DRIVER_SPEAK, text.speech, interrupt);
+  if (Tolk_HasBraille()) result = DeliverBraille(text.braille) || result;
+  return result;
+}
+
+// Text for Tolk_SpeakWithMarks, prepared a piece at a time so the marks stay in place.
+struct MarkedText {
+  std::wstring speech;
+  // Positions of the marks in speech.
+  std::vector<size_t> marks;
+};
+
+// Runs before the lock is taken, like PrepareText.
+static void PrepareMarkedText(const wchar_t *str, size_t length, const unsigned int *marks, unsigned int count, MarkedText &text) {
+  std::wstring piece;
+  size_t start = 0;
+  for (unsigned int i = 0; i <= count; ++i) {
+    const size_t end = (i < count) ? marks[i] : length;
+    if (end > start) {
+      piece.assign(str + start, end - start);
+      const wchar_t *prepared = PrepareText(piece.c_str(), DRIVER_SPEAK).speech;
+      // Normalization trims each piece, the space between them is put back.
+      if (*prepared && !text.speech.empty() && !iswspace(text.speech.back()) && !iswspace(*prepared) && (iswspace(str[start - 1]) || iswspace(str[start])))
+        text.speech += L' ';
+      text.speech += prepared;
+      start = end;
+    }
+    if (i < count) text.marks.push_back(text.speech.size());
+  }
+}
+
+// Escapes the text and puts a mark named after its bookmark at each of the positions.
+static std::wstring MakeMarkedSsml(const MarkedText &text, unsigned long bookmark) {
+  std::wstring ssml;
+  ssml.reserve(text.speech.size() + text.marks.size() * 24);
+  size_t mark = 0;
+  for (size_t i = 0;; ++i) {
+    for (; mark < text.marks.size() && text.marks[mark] == i; ++mark)
+      ssml += L"<mark name=\"" + std::to_wstring(bookmark + mark) + L"\"/>";
+    if (i == text.speech.size()) break;
+    const wchar_t c = text.speech[i];
+    if (c == L'&') ssml += L"&amp;";
+    else if (c == L'<') ssml += L"&lt;";
+    else if (c == L'>') ssml += L"&gt;";
+    // Not allowed anywhere in XML.
+    else if (c < 0x20 && c != L'\t' && c != L'\n' && c != L'\r') ssml += L' ';
+    else ssml += c;
+  }
+  return ssml;
+}
+
+// Screen readers that take SSML report the marks as bookmarks. For the others they
+// are timed from the speaking time estimated for the text before them. The text is
+// spoken as a whole, between two chunks of long text if it doesn't interrupt.
+static bool DeliverMarked(const MarkedText &text, bool interrupt, Tolk_MarkCallback callback, void *userData) {
+  if (interrupt) InterruptSpeech();
+  const unsigned int count = (unsigned int)text.marks.size();
+  if (count && Tolk_DetectScreenReader() && CanDeliver(g_currentScreenReaderDriver, DRIVER_SPEAK_SSML)) {
+    // Added first, the engine may reach a mark before the call returns.
+    const unsigned long bookmark = g_speechMarks.AddBookmarked(count, callback, userData);
+    if (Deliver(DRIVER_SPEAK_SSML, MakeMarkedSsml(text, bookmark).c_str(), interrupt, text.speech.c_str())) {
+      StartSpeechMonitor();
+      return true;
+    }
+    g_speechMarks.RemoveLast();
+  }
+  if (!Deliver(DRIVER_SPEAK, text.speech.c_str(), interrupt)) return false;
+  if (count) {
+    std::vector<DWORD> offsets(count);
+    g_speech.EstimatePositions(g_deliveringDriver, text.speech.c_str(), text.marks.data(), count, offsets.data());
+    // The estimate for the driver ends with this text, which tells when it starts.
+    const DWORD duration = g_speech.Estimate(g_deliveringDriver, text.speech.c_str());
+    const DWORD remaining = g_speech.GetRemaining(g_deliveringDriver);
+    const ULONGLONG start = GetTickCount64() + remaining - std::min(duration, remaining);
+    g_speechMarks.AddTimed(start, std::move(offsets), callback, userData);
+    StartSpeechMonitor();
+  }
+  return true;
+}
+
+// Runs on the speech monitor's thread.
+static DWORD CheckSpeech(HANDLE &event) {
+  EnterCriticalSection(&g_cs);
+  ScreenReaderDriver *driver = g_speakingDriver;
+  DWORD wait = INFINITE;
+  if (driver && driver->HasStatus()) {
+    const bool speaking = Invoke(driver, DRIVER_IS_SPEAKING);
+    g_speech.Observe(driver, speaking);
+    if (speaking) {
+      g_speechStarted = true;
+      event = (HANDLE)driver->GetSpeechEvent();
+      wait = event ? SPEECH_EVENT_RECHECK : SPEECH_POLL_INTERVAL;
+    }
+    else if (!g_speechStarted && GetTickCount64() - g_speechSince < SPEECH_START_GRACE) {
+      wait = SPEECH_POLL_INTERVAL;
+    }
+  }
+  else if (driver) {
+    wait = g_speech.GetRemaining(driver);
+    if (!wait) wait = INFINITE;
+  }
+  // The next chunk of long text is handed over as soon as the one before has been spoken.
+  if (wait == INFINITE && !g_speechQueue.IsEmpty() && SpeakNextChunk(false, SPEECH_CHUNK_MAX))
+    wait = SPEECH_POLL_INTERVAL;
+  else if (wait == INFINITE && g_documentSpeaking && SpeakDocumentChunk(false, SPEECH_CHUNK_MAX))
+    wait = SPEECH_POLL_INTERVAL;
+  // Timed marks are reached as their time comes, the marks that are left once speech has ended.
+  std::vector<SpeechMarks::Reached> reached;
+  const DWORD due = g_speechMarks.Due(reached);
+  if (wait == INFINITE) {
+    g_speechMarks.Finished(reached);
+    g_speakingDriver = nullptr;
+    SetEvent(g_speechDone);
+  }
+  else if (due < wait) {
+    wait = due;
+  }
+  LeaveCriticalSection(&g_cs);
+  SpeechMarks::Report(reached);
+  return wait;
+}
+
+static void StartSpeechMonitor() {
+  if (g_speechMonitor || !g_speechDone) return;
+  g_speechMonitor = std::make_unique<SpeechMonitor>(CheckSpeech);
+  if (!g_speechMonitor->IsRunning()) {
+    g_speechMonitor.reset();
+    return;
+  }
+  // Text spoken before the monitor started is still being waited for.
+  if (g_speakingDriver) ResetEvent(g_speechDone);
+}
+
+// The monitor's thread may be waiting for the lock, so it must be stopped without holding it.
+static void StopSpeechMonitor() {
+  EnterCriticalSection(&g_cs);
+  std::unique_ptr<SpeechMonitor> monitor = std::move(g_speechMonitor);
+  LeaveCriticalSection(&g_cs);
+  monitor.reset();
+}
+
+// Keeps the current driver while it is active, otherwise tries every driver in order.
+static ScreenReaderDriver *DetectDriver() {
+  if (g_currentScreenReaderDriver && (g_preferSAPI || g_currentScreenReaderDriver != g_sapi.get()) && Invoke(g_currentScreenReaderDriver, DRIVER_IS_ACTIVE))
+    return g_currentScreenReaderDriver;
+  if (g_trySAPI && g_preferSAPI && g_sapi && Invoke(g_sapi.get(), DRIVER_IS_ACTIVE))
+    return (g_currentScreenReaderDriver = g_sapi.get());
+  for (const auto &driver : g_screenReaderDrivers) {
+    if (driver.get() != g_currentScreenReaderDriver && Invoke(driver.get(), DRIVER_IS_ACTIVE))
+      return (g_currentScreenReaderDriver = driver.get());
+  }
+  if (g_trySAPI && !g_preferSAPI && g_sapi && Invoke(g_sapi.get(), DRIVER_IS_ACTIVE))
+    return (g_currentScreenReaderDriver = g_sapi.get());
+  return (g_currentScreenReaderDriver = nullptr);
+}
+
+// Runs on the presence watcher's thread once screen readers may have started or stopped.
+static void OnPresenceChanged() {
+  EnterCriticalSection(&g_cs);
+  const Tolk_ScreenReaderChangedCallback callback = g_changedCallback;
+  void *userData = g_changedUserData;
+  if (!callback || !Tolk_IsLoaded()) {
+    LeaveCriticalSection(&g_cs);
+    return;
+  }
+  const wchar_t *name = Tolk_DetectScreenReader();
+  const std::wstring detected = name ? name : L"";
+  const bool changed = (detected != g_announcedName);
+  g_announcedName = detected;
+  LeaveCriticalSection(&g_cs);
+  // Called without holding the lock, the callback is free to use Tolk.
+  if (changed) callback(detected.empty() ? nullptr : detected.c_str(), userData);
+}
+
+static void StartPresenceWatcher() {
+  if (g_presenceWatcher) return;
+  g_presenceWatcher = std::make_unique<PresenceWatcher>(OnPresenceChanged);
+  if (!g_presenceWatcher->IsRunning()) g_presenceWatcher.reset();
+  g_detectionValid = false;
+}
+
+// The watcher's thread may be waiting for the lock, so it must be stopped without holding it.
+static void StopPresenceWatcher() {
+  EnterCriticalSection(&g_cs);
+  std::unique_ptr<PresenceWatcher> watcher = std::move(g_presenceWatcher);
+  g_detectionValid = false;
+  LeaveCriticalSection(&g_cs);
+  watcher.reset();
+}
+
+// Expects the lock to be held. The old cache is returned to be released outside of it,
+// saving its store and stopping its thread may take a while.
+static std::shared_ptr<PhraseCache> SwapPhraseCache(const std::shared_ptr<PhraseCache> &cache) {
+#ifdef TOLK_WITH_SAPI
+  if (g_sapi) static_cast<ScreenReaderDriverSAPI *>(g_sapi.get())->SetPhraseCache(cache);
+#endif
+  return std::atomic_exchange(&g_phraseCache, cache);
+}
+
+#ifdef TOLK_WITH_SAPI
+// Maps the store and starts the cache's thread. Rendered phrases only match the voice and rate they were rendered with.
+static std::shared_ptr<PhraseCache> CreatePhraseCache(const wchar_t *path, unsigned int maxKilobytes) {
+  const std::wstring voice = GetDefaultVoiceKey();
+  if (voice.empty()) return nullptr;
+  return std::make_shared<PhraseCache>(path, (size_t)maxKilobytes * 1024, voice, RenderSpeech);
+}
+#endif
+
+// A driver that is stuck in a call on its worker thread is leaked rather than destroyed under it.
+static void DestroyDriver(std::unique_ptr<ScreenReaderDriver> &driver) {
+  if (!driver) return;
+  g_health.Forget(driver.get());
+  g_speech.Forget(driver.get());
+  g_markupCache.Forget(driver.get());
+  if (g_speakingDriver == driver.get()) {
+    g_speakingDriver = nullptr;
+    if (g_speechDone) SetEvent(g_speechDone);
+  }
+  if (!g_watchdog.Release(driver.get())) driver.release();
+  driver.reset();
+}
 
 BOOL WINAPI DllMain(HINSTANCE, DWORD reason, LPVOID) {
   switch (reason) {
   case DLL_PROCESS_ATTACH:
     InitializeCriticalSection(&g_cs);
+    InitializeCriticalSection(&g_progressLock);
+    g_speechDone = CreateEventW(nullptr, TRUE, TRUE, nullptr);
     break;
   case DLL_PROCESS_DETACH:
+    if (g_speechDone) CloseHandle(g_speechDone);
+    DeleteCriticalSection(&g_progressLock);
     DeleteCriticalSection(&g_cs);
     break;
   }
@@ -58,27 +776,40 @@ TOLK_DLL_DECLSPEC void TOLK_CALL Tolk_Load() {
     return;
   }
   try {
-    g_screenReaderDrivers.push_back(std::make_unique<ScreenReaderDriverZDSR>());
-    g_screenReaderDrivers.push_back(std::make_unique<ScreenReaderDriverBOY>());
-    g_screenReaderDrivers.push_back(std::make_unique<ScreenReaderDriverNVDA>());
-    g_screenReaderDrivers.push_back(std::make_unique<ScreenReaderDriverJAWS>());
-    g_screenReaderDrivers.push_back(std::make_unique<ScreenReaderDriverWE>());
-#ifndef _WIN64
-    // This driver does not have 64-bit support.
-    g_screenReaderDrivers.push_back(std::make_unique<ScreenReaderDriverSNova>());
+    if (g_useBroker) {
+      // The broker owns the real drivers, so we don't load any of them ourselves.
+      auto broker = std::make_unique<ScreenReaderDriverBroker>();
+      broker->SetPriority(g_brokerPriority);
+      g_broker = broker.get();
+      g_screenReaderDrivers.push_back(std::move(broker));
+    }
+    else {
+      // The list of built-in drivers is generated by CMake, see TOLK_DRIVERS.
+#define TOLK_DRIVER(name) g_screenReaderDrivers.push_back(std::make_unique<ScreenReaderDriver##name>());
+#define TOLK_BRIDGED_DRIVER(name) g_screenReaderDrivers.push_back(std::make_unique<ScreenReaderDriverBridge>(L"" #name, GetModuleDirectory() + TOLK_BRIDGE_HELPER_32));
+      TOLK_DRIVER_LIST
+#undef TOLK_BRIDGED_DRIVER
+#undef TOLK_DRIVER
+      AddPluginDrivers();
+      for (const auto &driver : g_screenReaderDrivers) driver->SetProgressListener(OnDriverProgress);
+    }
+#ifdef TOLK_WITH_SAPI
+    // Tolk_Unload dropped the phrase cache, the one the application set up comes back.
+    if (g_phraseCacheKilobytes)
+      std::atomic_store(&g_phraseCache, CreatePhraseCache(g_phraseCacheInFile ? g_phraseCachePath.c_str() : nullptr, g_phraseCacheKilobytes));
 #endif
-    g_screenReaderDrivers.push_back(std::make_unique<ScreenReaderDriverSA>());
-    g_screenReaderDrivers.push_back(std::make_unique<ScreenReaderDriverZT>());
     if (g_trySAPI)
-      g_sapi = std::make_unique<ScreenReaderDriverSAPI>();
+      g_sapi = CreateSAPIDriver();
   }
   catch (...) {
+    g_broker = nullptr;
     g_sapi.reset();
     g_screenReaderDrivers.clear();
     LeaveCriticalSection(&g_cs);
     return;
   }
   g_isLoaded = true;
+  if (g_watchPresence) StartPresenceWatcher();
   LeaveCriticalSection(&g_cs);
 }
 
@@ -87,11 +818,27 @@ TOLK_DLL_DECLSPEC bool TOLK_CALL Tolk_IsLoaded() {
 }
 
 TOLK_DLL_DECLSPEC void TOLK_CALL Tolk_Unload() {
+  StopPresenceWatcher();
+  StopSpeechMonitor();
+  EnterCriticalSection(&g_cs);
+  std::shared_ptr<PhraseCache> cache = SwapPhraseCache(nullptr);
+  LeaveCriticalSection(&g_cs);
+  cache.reset();
   EnterCriticalSection(&g_cs);
   if (Tolk_IsLoaded()) {
     g_isLoaded = false;
-    g_currentScreenReaderDriver = nullptr;
-    g_sapi.reset();
+    g_speechQueue.Clear();
+    g_speechMarks.Clear();
+    // After loading again the screen reader may be another, it hasn't spoken the old texts.
+    g_textDiff.Clear();
+    g_document.reset();
+    g_documentSpeaking = false;
+    ForgetCurrentDriver();
+    g_announcedName.clear();
+    g_deliveringDriver = nullptr;
+    g_broker = nullptr;
+    DestroyDriver(g_sapi);
+    for (auto &driver : g_screenReaderDrivers) DestroyDriver(driver);
     g_screenReaderDrivers.clear();
   }
   if (g_comInitializedByUs) {
@@ -110,10 +857,12 @@ TOLK_DLL_DECLSPEC void TOLK_CALL Tolk_TrySAPI(bool trySAPI) {
   g_trySAPI = trySAPI;
   if (Tolk_IsLoaded()) {
     if (g_trySAPI && !g_sapi)
-      g_sapi = std::make_unique<ScreenReaderDriverSAPI>();
-    else if (!g_trySAPI && g_sapi)
-      g_sapi.reset();
-    g_currentScreenReaderDriver = nullptr;
+      g_sapi = CreateSAPIDriver();
+    else if (!g_trySAPI && g_sapi) {
+      if (g_deliveringDriver == g_sapi.get()) g_deliveringDriver = nullptr;
+      DestroyDriver(g_sapi);
+    }
+    ForgetCurrentDriver();
   }
   LeaveCriticalSection(&g_cs);
 }
@@ -126,44 +875,365 @@ TOLK_DLL_DECLSPEC void TOLK_CALL Tolk_PreferSAPI(bool preferSAPI) {
   }
   g_preferSAPI = preferSAPI;
   if (Tolk_IsLoaded() && g_trySAPI && g_sapi)
-    g_currentScreenReaderDriver = nullptr;
+    ForgetCurrentDriver();
   LeaveCriticalSection(&g_cs);
 }
 
-TOLK_DLL_DECLSPEC const wchar_t * TOLK_CALL Tolk_DetectScreenReader() {
+TOLK_DLL_DECLSPEC void TOLK_CALL Tolk_SetPluginDirectory(const wchar_t *path) {
   EnterCriticalSection(&g_cs);
-  if (!Tolk_IsLoaded()) {
+  if (path) g_pluginDirectory = path;
+  else g_pluginDirectory.clear();
+  LeaveCriticalSection(&g_cs);
+}
+
+TOLK_DLL_DECLSPEC void TOLK_CALL Tolk_UseBroker(bool useBroker) {
+  EnterCriticalSection(&g_cs);
+  g_useBroker = useBroker;
+  LeaveCriticalSection(&g_cs);
+}
+
+TOLK_DLL_DECLSPEC void TOLK_CALL Tolk_SetBrokerPriority(int priority) {
+  EnterCriticalSection(&g_cs);
+  g_brokerPriority = priority;
+  if (g_broker) g_broker->SetPriority(priority);
+  LeaveCriticalSection(&g_cs);
+}
+
+TOLK_DLL_DECLSPEC void TOLK_CALL Tolk_SetDriverTimeout(unsigned int milliseconds) {
+  EnterCriticalSection(&g_cs);
+  g_driverTimeout = milliseconds;
+  LeaveCriticalSection(&g_cs);
+}
+
+TOLK_DLL_DECLSPEC void TOLK_CALL Tolk_SetCircuitBreaker(unsigned int failureThreshold, unsigned int backoffMilliseconds, unsigned int maxBackoffMilliseconds) {
+  EnterCriticalSection(&g_cs);
+  g_health.Configure(failureThreshold, backoffMilliseconds, maxBackoffMilliseconds);
+  LeaveCriticalSection(&g_cs);
+}
+
+TOLK_DLL_DECLSPEC bool TOLK_CALL Tolk_GetDriverStats(const wchar_t *name, unsigned int *calls, unsigned int *failures, unsigned int *trips, unsigned int *rejected) {
+  EnterCriticalSection(&g_cs);
+  DriverStats stats = {};
+  const bool found = name && g_health.GetStats(name, stats);
+  LeaveCriticalSection(&g_cs);
+  if (calls) *calls = stats.calls;
+  if (failures) *failures = stats.failures;
+  if (trips) *trips = stats.trips;
+  if (rejected) *rejected = stats.rejected;
+  return found;
+}
+
+TOLK_DLL_DECLSPEC void TOLK_CALL Tolk_SetFailover(bool failover, unsigned int budgetMilliseconds) {
+  EnterCriticalSection(&g_cs);
+  g_failover = failover;
+  g_failoverBudget = budgetMilliseconds;
+  LeaveCriticalSection(&g_cs);
+}
+
+TOLK_DLL_DECLSPEC void TOLK_CALL Tolk_SetHedging(unsigned int budgetMilliseconds, const wchar_t *secondary) {
+  EnterCriticalSection(&g_cs);
+  g_hedgingBudget = budgetMilliseconds;
+  if (secondary) g_hedgingDriverName = secondary;
+  else g_hedgingDriverName.clear();
+  LeaveCriticalSection(&g_cs);
+}
+
+TOLK_DLL_DECLSPEC void TOLK_CALL Tolk_SetTextNormalization(bool normalize) {
+  g_normalizeText = normalize;
+  ++g_textGeneration;
+}
+
+TOLK_DLL_DECLSPEC bool TOLK_CALL Tolk_SetSymbolNames(const wchar_t *language) {
+#ifdef _WITH_SYMBOL_NAMES
+  const SymbolTable *table = nullptr;
+  if (language) {
+    table = FindSymbolTable(language);
+    if (!table) return false;
+  }
+  g_symbolTable = table;
+  ++g_textGeneration;
+  return true;
+#else
+  return !language;
+#endif
+}
+
+TOLK_DLL_DECLSPEC bool TOLK_CALL Tolk_LoadDictionary(const wchar_t *path) {
+  // Built before the swap, output carries on with the old dictionary meanwhile.
+  std::shared_ptr<const PronunciationDictionary> dictionary;
+  if (path) {
+    dictionary = PronunciationDictionary::Load(path);
+    if (!dictionary) return false;
+  }
+  std::atomic_store(&g_dictionary, dictionary);
+  ++g_textGeneration;
+  return true;
+}
+
+TOLK_DLL_DECLSPEC void TOLK_CALL Tolk_SetDictionaryForBraille(bool braille) {
+  g_dictionaryForBraille = braille;
+}
+
+TOLK_DLL_DECLSPEC void TOLK_CALL Tolk_SetDuplicateWindow(unsigned int milliseconds) {
+  g_duplicateWindow = milliseconds;
+}
+
+TOLK_DLL_DECLSPEC void TOLK_CALL Tolk_GetDuplicateStats(unsigned int *speech, unsigned int *braille) {
+  if (speech) *speech = g_speechRepeats.GetDropped();
+  if (braille) *braille = g_brailleRepeats.GetDropped();
+}
+
+TOLK_DLL_DECLSPEC void TOLK_CALL Tolk_WatchScreenReaders(bool watch) {
+  EnterCriticalSection(&g_cs);
+  g_watchPresence = watch;
+  if (watch && Tolk_IsLoaded()) StartPresenceWatcher();
+  LeaveCriticalSection(&g_cs);
+  if (!watch) StopPresenceWatcher();
+}
+
+TOLK_DLL_DECLSPEC void TOLK_CALL Tolk_SetScreenReaderChangedCallback(Tolk_ScreenReaderChangedCallback callback, void *userData) {
+  EnterCriticalSection(&g_cs);
+  g_changedCallback = callback;
+  g_changedUserData = userData;
+  // Changes are reported relative to what the client could have seen so far.
+  const wchar_t *name = g_currentScreenReaderDriver ? g_currentScreenReaderDriver->GetName() : nullptr;
+  g_announcedName = name ? name : L"";
+  LeaveCriticalSection(&g_cs);
+}
+
+TOLK_DLL_DECLSPEC void TOLK_CALL Tolk_SetLongTextThreshold(unsigned int characters) {
+  EnterCriticalSection(&g_cs);
+  g_longTextThreshold = characters;
+  LeaveCriticalSection(&g_cs);
+}
+
+TOLK_DLL_DECLSPEC bool TOLK_CALL Tolk_ReadDocument(const wchar_t *path, unsigned long long position) {
+  // Opened before the lock is taken, mapping a large file may take a moment.
+  std::unique_ptr<DocumentReader> document = DocumentReader::Open(path);
+  if (!document) return false;
+  EnterCriticalSection(&g_cs);
+  const bool result = StartDocument(document, position);
+  LeaveCriticalSection(&g_cs);
+  return result;
+}
+
+TOLK_DLL_DECLSPEC bool TOLK_CALL Tolk_ReadDocumentBuffer(const void *data, unsigned int size, unsigned long long position) {
+  std::unique_ptr<DocumentReader> document = DocumentReader::Open(data, size);
+  if (!document) return false;
+  EnterCriticalSection(&g_cs);
+  const bool result = StartDocument(document, position);
+  LeaveCriticalSection(&g_cs);
+  return result;
+}
+
+TOLK_DLL_DECLSPEC bool TOLK_CALL Tolk_PauseDocument() {
+  EnterCriticalSection(&g_cs);
+  if (!g_document || g_documentPaused) {
     LeaveCriticalSection(&g_cs);
-    return nullptr;
+    return false;
   }
-  if (g_currentScreenReaderDriver && (g_preferSAPI || g_currentScreenReaderDriver != g_sapi.get()) && g_currentScreenReaderDriver->IsActive()) {
-    const wchar_t *name = g_currentScreenReaderDriver->GetName();
+  const bool speaking = g_documentSpeaking;
+  PauseDocument();
+  if (speaking) Tolk_Silence();
+  LeaveCriticalSection(&g_cs);
+  return true;
+}
+
+TOLK_DLL_DECLSPEC bool TOLK_CALL Tolk_ResumeDocument() {
+  EnterCriticalSection(&g_cs);
+  bool result = false;
+  if (g_document && g_documentPaused) {
+    g_documentPaused = false;
+    result = SpeakDocumentChunk(false, SPEECH_CHUNK_FIRST);
+  }
+  LeaveCriticalSection(&g_cs);
+  return result;
+}
+
+TOLK_DLL_DECLSPEC bool TOLK_CALL Tolk_SkipDocument(int unit) {
+  EnterCriticalSection(&g_cs);
+  if (!g_document || (unit != TOLK_DOCUMENT_SENTENCE && unit != TOLK_DOCUMENT_PARAGRAPH)) {
     LeaveCriticalSection(&g_cs);
-    return name;
+    return false;
   }
-  if (g_trySAPI && g_preferSAPI && g_sapi && g_sapi->IsActive()) {
-    g_currentScreenReaderDriver = g_sapi.get();
-    const wchar_t *name = g_currentScreenReaderDriver->GetName();
+  g_document->Seek(g_document->FindNext(GetDocumentReadPosition(), (DocumentUnit)unit));
+  // A paused document only moves, it is read from there once resumed.
+  bool result = true;
+  if (!g_documentPaused) result = SpeakDocumentChunk(true, SPEECH_CHUNK_FIRST);
+  LeaveCriticalSection(&g_cs);
+  return result;
+}
+
+TOLK_DLL_DECLSPEC bool TOLK_CALL Tolk_GetDocumentPosition(unsigned long long *position, unsigned long long *size) {
+  EnterCriticalSection(&g_cs);
+  if (!g_document) {
     LeaveCriticalSection(&g_cs);
-    return name;
+    return false;
   }
-  for (const auto &driver : g_screenReaderDrivers) {
-    if (driver.get() != g_currentScreenReaderDriver && driver->IsActive()) {
-      g_currentScreenReaderDriver = driver.get();
-      const wchar_t *name = g_currentScreenReaderDriver->GetName();
-      LeaveCriticalSection(&g_cs);
-      return name;
-    }
+  if (position) *position = GetDocumentReadPosition();
+  if (size) *size = g_document->GetSize();
+  LeaveCriticalSection(&g_cs);
+  return true;
+}
+
+TOLK_DLL_DECLSPEC void TOLK_CALL Tolk_StopDocument() {
+  EnterCriticalSection(&g_cs);
+  const bool speaking = g_documentSpeaking;
+  g_document.reset();
+  g_documentPaused = false;
+  g_documentSpeaking = false;
+  if (speaking) Tolk_Silence();
+  LeaveCriticalSection(&g_cs);
+}
+
+TOLK_DLL_DECLSPEC void TOLK_CALL Tolk_SetSpeechRate(unsigned int wordsPerMinute) {
+  EnterCriticalSection(&g_cs);
+  g_speech.SetRate(wordsPerMinute);
+  LeaveCriticalSection(&g_cs);
+}
+
+TOLK_DLL_DECLSPEC void * TOLK_CALL Tolk_GetSpeechEventHandle() {
+  EnterCriticalSection(&g_cs);
+  if (Tolk_IsLoaded()) StartSpeechMonitor();
+  const HANDLE event = g_speechMonitor ? g_speechDone : nullptr;
+  LeaveCriticalSection(&g_cs);
+  return event;
+}
+
+TOLK_DLL_DECLSPEC bool TOLK_CALL Tolk_WaitForSpeechEnd(unsigned int milliseconds) {
+  const HANDLE event = (HANDLE)Tolk_GetSpeechEventHandle();
+  if (!event) return false;
+  return (WaitForSingleObject(event, milliseconds) == WAIT_OBJECT_0);
+}
+
+TOLK_DLL_DECLSPEC void TOLK_CALL Tolk_SetSpeechProgressCallback(Tolk_SpeechProgressCallback callback, void *userData) {
+  EnterCriticalSection(&g_progressLock);
+  g_progressCallback = callback;
+  g_progressUserData = userData;
+  LeaveCriticalSection(&g_progressLock);
+}
+
+TOLK_DLL_DECLSPEC bool TOLK_CALL Tolk_SpeakWithMarks(const wchar_t *str, const unsigned int *marks, unsigned int count, bool interrupt, Tolk_MarkCallback callback, void *userData) {
+  if (!str || (count && (!marks || !callback))) return false;
+  const size_t length = wcslen(str);
+  for (unsigned int i = 0; i < count; ++i) {
+    if (marks[i] > length || (i && marks[i] < marks[i - 1])) return false;
+  }
+  MarkedText text;
+  PrepareMarkedText(str, length, marks, count, text);
+  EnterCriticalSection(&g_cs);
+  const bool result = DeliverMarked(text, interrupt, callback, userData);
+  LeaveCriticalSection(&g_cs);
+  return result;
+}
+
+TOLK_DLL_DECLSPEC bool TOLK_CALL Tolk_SpeakMarkup(const wchar_t *markup, bool interrupt) {
+  if (!markup) return false;
+  EnterCriticalSection(&g_cs);
+  // Parsed once and lowered once per driver, repeated markup skips both.
+  const SpeechMarkup *program = g_markupCache.Parse(markup, g_textGeneration, PrepareMarkup);
+  bool result = false;
+  if (program) {
+    // Spoken as a whole, like marked text.
+    if (interrupt) InterruptSpeech();
+    result = Deliver(DRIVER_SPEAK_MARKUP, markup, interrupt, program->GetPlainText());
+  }
+  LeaveCriticalSection(&g_cs);
+  return result;
+}
+
+TOLK_DLL_DECLSPEC bool TOLK_CALL Tolk_Synthesize(const wchar_t *str, unsigned int samplesPerSecond, unsigned int bitsPerSample, unsigned int channels, Tolk_AudioCallback callback, void *userData) {
+#ifdef TOLK_WITH_SAPI
+  if (!str || !callback || !samplesPerSecond || (bitsPerSample != 8 && bitsPerSample != 16) || (channels != 1 && channels != 2))
+    return false;
+  // Needs no driver or lock, every call renders with a voice of its own.
+  const WAVEFORMATEX format = MakePcmFormat(samplesPerSecond, (WORD)bitsPerSample, (WORD)channels);
+  const std::shared_ptr<PhraseCache> cache = std::atomic_load(&g_phraseCache);
+  if (!cache || !PhraseCache::IsCacheable(str)) return SynthesizeSpeech(str, format, callback, userData);
+  const std::shared_ptr<const PhraseAudio> audio = cache->Find(str, format);
+  if (audio) return callback(audio->GetData(), (unsigned int)audio->GetSize(), userData);
+  PhraseRecording recording = { callback, userData, {} };
+  if (!SynthesizeSpeech(str, format, RecordPhrase, &recording)) return false;
+  cache->Insert(str, format, std::move(recording.audio));
+  return true;
+#else
+  return false;
+#endif
+}
+
+TOLK_DLL_DECLSPEC bool TOLK_CALL Tolk_SetPhraseCache(const wchar_t *path, unsigned int maxKilobytes) {
+#ifdef TOLK_WITH_SAPI
+  // The old cache is saved before the new one loads, they may share a store.
+  EnterCriticalSection(&g_cs);
+  std::shared_ptr<PhraseCache> cache = SwapPhraseCache(nullptr);
+  const bool loaded = Tolk_IsLoaded();
+  if (loaded) {
+    g_phraseCacheKilobytes = maxKilobytes;
+    g_phraseCacheInFile = !!path;
+    g_phraseCachePath = path ? path : L"";
   }
-  if (g_trySAPI && !g_preferSAPI && g_sapi && g_sapi->IsActive()) {
-    g_currentScreenReaderDriver = g_sapi.get();
-    const wchar_t *name = g_currentScreenReaderDriver->GetName();
+  LeaveCriticalSection(&g_cs);
+  cache.reset();
+  if (!loaded || !maxKilobytes) return (loaded && !maxKilobytes);
+  cache = CreatePhraseCache(path, maxKilobytes);
+  if (!cache) return false;
+  EnterCriticalSection(&g_cs);
+  const bool installed = Tolk_IsLoaded();
+  if (installed) cache = SwapPhraseCache(cache);
+  LeaveCriticalSection(&g_cs);
+  cache.reset();
+  return installed;
+#else
+  return false;
+#endif
+}
+
+TOLK_DLL_DECLSPEC bool TOLK_CALL Tolk_PrefetchPhrases(const wchar_t *const *phrases, unsigned int count) {
+#ifdef TOLK_WITH_SAPI
+  const std::shared_ptr<PhraseCache> cache = std::atomic_load(&g_phraseCache);
+  if (!cache || (count && !phrases)) return false;
+  // In the format the SAPI driver plays, which Tolk_Synthesize callers can ask for as well.
+  const WAVEFORMATEX format = MakePcmFormat(PHRASE_SAMPLES_PER_SECOND, PHRASE_BITS_PER_SAMPLE, PHRASE_CHANNELS);
+  for (unsigned int i = 0; i < count; ++i) cache->Prefetch(phrases[i], format);
+  return true;
+#else
+  return false;
+#endif
+}
+
+TOLK_DLL_DECLSPEC bool TOLK_CALL Tolk_GetPhraseCacheStats(unsigned int *hits, unsigned int *misses) {
+  const std::shared_ptr<PhraseCache> cache = std::atomic_load(&g_phraseCache);
+  if (!cache) return false;
+  unsigned long cacheHits = 0, cacheMisses = 0;
+  cache->GetStats(cacheHits, cacheMisses);
+  if (hits) *hits = cacheHits;
+  if (misses) *misses = cacheMisses;
+  return true;
+}
+
+TOLK_DLL_DECLSPEC const wchar_t * TOLK_CALL Tolk_GetLastOutputDriver() {
+  EnterCriticalSection(&g_cs);
+  const wchar_t *name = g_deliveringDriver ? g_deliveringDriver->GetName() : nullptr;
+  LeaveCriticalSection(&g_cs);
+  return name;
+}
+
+TOLK_DLL_DECLSPEC const wchar_t * TOLK_CALL Tolk_DetectScreenReader() {
+  EnterCriticalSection(&g_cs);
+  if (!Tolk_IsLoaded()) {
     LeaveCriticalSection(&g_cs);
-    return name;
+    return nullptr;
   }
-  g_currentScreenReaderDriver = nullptr;
+  // With the presence watcher running, the last result holds until it reports a change.
+  const LONG serial = g_presenceWatcher ? g_presenceWatcher->GetSerial() : 0;
+  if (!g_presenceWatcher || !g_detectionValid || serial != g_detectedSerial) {
+    DetectDriver();
+    g_detectedSerial = serial;
+    g_detectionValid = !!g_presenceWatcher;
+  }
+  const wchar_t *name = g_currentScreenReaderDriver ? g_currentScreenReaderDriver->GetName() : nullptr;
   LeaveCriticalSection(&g_cs);
-  return nullptr;
+  return name;
 }
 
 TOLK_DLL_DECLSPEC bool TOLK_CALL Tolk_HasSpeech() {
@@ -189,42 +1259,121 @@ TOLK_DLL_DECLSPEC bool TOLK_CALL Tolk_HasBraille() {
 }
 
 TOLK_DLL_DECLSPEC bool TOLK_CALL Tolk_Output(const wchar_t *str, bool interrupt) {
+  // Speech and braille are filtered apart, text that was only spoken before is still brailled.
+  const DWORD window = g_duplicateWindow.load(std::memory_order_relaxed);
+  const DWORD hash = window ? DuplicateFilter::Hash(str) : 0;
+  const bool speak = !g_speechRepeats.IsRepeat(hash, window);
+  const bool braille = !g_brailleRepeats.IsRepeat(hash, window);
+  if (!speak && !braille) return true;
+  const PreparedText text = PrepareText(str, DRIVER_OUTPUT);
   EnterCriticalSection(&g_cs);
-  if (str && Tolk_DetectScreenReader()) {
-    bool result = g_currentScreenReaderDriver->Output(str, interrupt);
-    LeaveCriticalSection(&g_cs);
-    return result;
+  bool result = false;
+  if (str) {
+    if (!braille) result = DeliverSpeech(text.speech, interrupt);
+    else if (!speak) result = DeliverBraille(text.braille);
+    else result = DeliverOutput(text, interrupt);
   }
   LeaveCriticalSection(&g_cs);
-  return false;
+  if (result) {
+    if (speak) g_speechRepeats.Record(hash);
+    if (braille) g_brailleRepeats.Record(hash);
+  }
+  // The half that was a repeat counts as delivered, as with Output either half is enough.
+  return (result || !speak || !braille);
 }
 
-TOLK_DLL_DECLSPEC bool TOLK_CALL Tolk_Speak(const wchar_t *str, bool interrupt) {
+TOLK_DLL_DECLSPEC bool TOLK_CALL Tolk_OutputDiff(const wchar_t *key, const wchar_t *str, bool interrupt) {
+  if (!key || !str) return false;
   EnterCriticalSection(&g_cs);
-  if (str && Tolk_DetectScreenReader()) {
-    bool result = g_currentScreenReaderDriver->Speak(str, interrupt);
-    LeaveCriticalSection(&g_cs);
-    return result;
+  std::wstring changed;
+  bool result = true;
+  if (g_textDiff.Update(key, str, changed)) {
+    // Prepared under the lock and one after the other, both use the thread's buffers.
+    result = DeliverSpeech(PrepareText(changed.c_str(), DRIVER_SPEAK).speech, interrupt);
+    // Braille gets the whole line.
+    if (Tolk_HasBraille()) result = DeliverBraille(PrepareText(str, DRIVER_BRAILLE).braille) || result;
   }
   LeaveCriticalSection(&g_cs);
-  return false;
+  return result;
+}
+
+TOLK_DLL_DECLSPEC bool TOLK_CALL Tolk_Speak(const wchar_t *str, bool interrupt) {
+  const DWORD window = g_duplicateWindow.load(std::memory_order_relaxed);
+  const DWORD hash = window ? DuplicateFilter::Hash(str) : 0;
+  if (g_speechRepeats.IsRepeat(hash, window)) return true;
+  const PreparedText text = PrepareText(str, DRIVER_SPEAK);
+  EnterCriticalSection(&g_cs);
+  const bool result = str && DeliverSpeech(text.speech, interrupt);
+  LeaveCriticalSection(&g_cs);
+  // Only text that got through counts, a failed attempt may be retried straight away.
+  if (result) g_speechRepeats.Record(hash);
+  return result;
 }
 
 TOLK_DLL_DECLSPEC bool TOLK_CALL Tolk_Braille(const wchar_t *str) {
+  const DWORD window = g_duplicateWindow.load(std::memory_order_relaxed);
+  const DWORD hash = window ? DuplicateFilter::Hash(str) : 0;
+  if (g_brailleRepeats.IsRepeat(hash, window)) return true;
+  const PreparedText text = PrepareText(str, DRIVER_BRAILLE);
   EnterCriticalSection(&g_cs);
-  if (str && Tolk_DetectScreenReader()) {
-    bool result = g_currentScreenReaderDriver->Braille(str);
-    LeaveCriticalSection(&g_cs);
-    return result;
-  }
+  const bool result = str && DeliverBraille(text.braille);
   LeaveCriticalSection(&g_cs);
-  return false;
+  if (result) g_brailleRepeats.Record(hash);
+  return result;
+}
+
+TOLK_DLL_DECLSPEC void TOLK_CALL Tolk_SetBraillePaging(bool paging) {
+  EnterCriticalSection(&g_cs);
+  g_braillePaging = paging;
+  LeaveCriticalSection(&g_cs);
+}
+
+TOLK_DLL_DECLSPEC void TOLK_CALL Tolk_SetBrailleWidth(unsigned int cells) {
+  EnterCriticalSection(&g_cs);
+  g_brailleCells = cells;
+  LeaveCriticalSection(&g_cs);
+}
+
+TOLK_DLL_DECLSPEC bool TOLK_CALL Tolk_PanBrailleForward() {
+  EnterCriticalSection(&g_cs);
+  // Only the page now in view is sent again.
+  const bool result = g_braillePager.Forward() && Deliver(DRIVER_BRAILLE, g_braillePager.GetPage().c_str(), false);
+  LeaveCriticalSection(&g_cs);
+  return result;
+}
+
+TOLK_DLL_DECLSPEC bool TOLK_CALL Tolk_PanBrailleBack() {
+  EnterCriticalSection(&g_cs);
+  const bool result = g_braillePager.Back() && Deliver(DRIVER_BRAILLE, g_braillePager.GetPage().c_str(), false);
+  LeaveCriticalSection(&g_cs);
+  return result;
+}
+
+TOLK_DLL_DECLSPEC bool TOLK_CALL Tolk_GetBraillePage(unsigned int *page, unsigned int *count) {
+  EnterCriticalSection(&g_cs);
+  unsigned int current = 0, total = 0;
+  g_braillePager.GetPosition(current, total);
+  LeaveCriticalSection(&g_cs);
+  if (page) *page = current;
+  if (count) *count = total;
+  return (total > 0);
 }
 
 TOLK_DLL_DECLSPEC bool TOLK_CALL Tolk_IsSpeaking() {
   EnterCriticalSection(&g_cs);
   if (Tolk_DetectScreenReader()) {
-    bool result = g_currentScreenReaderDriver->IsSpeaking();
+    ScreenReaderDriver *driver = g_currentScreenReaderDriver;
+    bool result;
+    if (driver->HasStatus()) {
+      result = Invoke(driver, DRIVER_IS_SPEAKING);
+      g_speech.Observe(driver, result);
+    }
+    else {
+      // The screen reader can't tell, so estimate from what it was given to speak.
+      result = g_speech.IsSpeaking(driver);
+    }
+    // Between two chunks of long text or a document.
+    if (!g_speechQueue.IsEmpty() || g_documentSpeaking) result = true;
     LeaveCriticalSection(&g_cs);
     return result;
   }
@@ -232,10 +1381,26 @@ TOLK_DLL_DECLSPEC bool TOLK_CALL Tolk_IsSpeaking() {
   return false;
 }
 
+TOLK_DLL_DECLSPEC bool TOLK_CALL Tolk_GetQueuedUtterances(unsigned int *count) {
+  EnterCriticalSection(&g_cs);
+  unsigned int queued = 0;
+  // Only reads what the driver counted, so no need to go through Invoke.
+  const bool result = Tolk_DetectScreenReader() && g_currentScreenReaderDriver->GetQueuedUtterances(queued);
+  LeaveCriticalSection(&g_cs);
+  if (count) *count = queued;
+  return result;
+}
+
 TOLK_DLL_DECLSPEC bool TOLK_CALL Tolk_Silence() {
   EnterCriticalSection(&g_cs);
+  InterruptSpeech();
   if (Tolk_DetectScreenReader()) {
-    bool result = g_currentScreenReaderDriver->Silence();
+    ScreenReaderDriver *driver = g_currentScreenReaderDriver;
+    bool result = Invoke(driver, DRIVER_SILENCE);
+    if (result) {
+      g_speech.Silenced(driver);
+      if (g_speechMonitor) g_speechMonitor->Wake();
+    }
     LeaveCriticalSection(&g_cs);
     return result;
   }
@@ -63,6 +63,352 @@ TOLK_DLL_DECLSPEC void TOLK_CALL Tolk_TrySAPI(bool trySAPI);
  */
 TOLK_DLL_DECLSPEC void TOLK_CALL Tolk_PreferSAPI(bool preferSAPI);
 
+/**
+ *  Name:         Tolk_SetPluginDirectory
+ *  Description:  Sets the directory that is searched for screen reader driver plugins (see TolkPlugin.h). By default, Tolk searches the TolkPlugins directory next to Tolk.dll. Plugin drivers are placed after the built-in screen reader drivers and before SAPI in the detection list. Plugins are only enumerated by Tolk_Load, a plugin DLL is not loaded until the auto-detection process first needs it. You should call this function before calling Tolk_Load.
+ *  Parameters:   path: full path of the plugin directory, or NULL to restore the default.
+ *  Returns:      None.
+ */
+TOLK_DLL_DECLSPEC void TOLK_CALL Tolk_SetPluginDirectory(const wchar_t *path);
+
+/**
+ *  Name:         Tolk_UseBroker
+ *  Description:  Sets if Tolk should send all output through the Tolk broker (TolkBroker.exe) instead of loading the screen reader drivers in this process. The broker owns the drivers and serializes output from all client processes in the session, so helper processes don't load every driver and don't cut off each other's speech. If the broker is not running, no screen reader is detected (except SAPI, if enabled), and Tolk connects as soon as the broker is started. The default is not to use the broker. This setting takes effect the next time Tolk_Load initializes Tolk, so you should call this function before calling Tolk_Load.
+ *  Parameters:   useBroker: whether or not to use the broker.
+ *  Returns:      None.
+ */
+TOLK_DLL_DECLSPEC void TOLK_CALL Tolk_UseBroker(bool useBroker);
+
+/**
+ *  Name:         Tolk_SetBrokerPriority
+ *  Description:  Sets the priority of output sent through the Tolk broker from this process. Pending output with a higher priority is delivered first, and a request to interrupt speech is ignored while text with a higher priority from another process is likely still being spoken. The default priority is 0.
+ *  Parameters:   priority: the priority, higher values are more important.
+ *  Returns:      None.
+ */
+TOLK_DLL_DECLSPEC void TOLK_CALL Tolk_SetBrokerPriority(int priority);
+
+/**
+ *  Name:         Tolk_SetDriverTimeout
+ *  Description:  Sets a deadline for every call into a screen reader driver. With a deadline set, each driver runs its calls on a worker thread of its own. If a call does not return in time, for example because the screen reader hangs, the calling function gives up and returns false, the driver is skipped by auto-detection until the hung call finally returns, and Tolk moves on to the next active screen reader. By default there is no deadline and drivers are called directly on the calling thread. Drivers that use COM create their COM objects again on their worker thread, so the calling thread may be in any apartment. Once a driver has a worker thread, its calls keep going through it after the deadline is removed.
+ *  Parameters:   milliseconds: the deadline in milliseconds, or 0 for no deadline.
+ *  Returns:      None.
+ */
+TOLK_DLL_DECLSPEC void TOLK_CALL Tolk_SetDriverTimeout(unsigned int milliseconds);
+
+/**
+ *  Name:         Tolk_SetCircuitBreaker
+ *  Description:  Enables or disables the circuit breaker for failing screen reader drivers. Some screen readers report being active while every attempt to output text fails, for example while they are restarting. With the circuit breaker enabled, a driver that fails failureThreshold times in a row is skipped, auto-detection included, for backoffMilliseconds. Output goes to the next active screen reader (or SAPI) in the meantime. Once the backoff has passed the driver is tried again: if it succeeds it is used as normal, if it fails the backoff doubles, up to maxBackoffMilliseconds. The circuit breaker is disabled by default.
+ *  Parameters:   failureThreshold: number of consecutive failures before a driver is skipped, or 0 to disable the circuit breaker.
+ *                backoffMilliseconds: initial time to skip a failing driver.
+ *                maxBackoffMilliseconds: upper limit for the time to skip a failing driver.
+ *  Returns:      None.
+ */
+TOLK_DLL_DECLSPEC void TOLK_CALL Tolk_SetCircuitBreaker(unsigned int failureThreshold, unsigned int backoffMilliseconds, unsigned int maxBackoffMilliseconds);
+
+/**
+ *  Name:         Tolk_GetDriverStats
+ *  Description:  Retrieves the health counters for a screen reader driver. Only output calls (speech, braille, silence) are counted, and only for drivers that have been used since Tolk_Load. You should call Tolk_Load once before using this function.
+ *  Parameters:   name: common name of the screen reader, as returned by Tolk_DetectScreenReader.
+ *                calls: receives the number of output calls, may be NULL.
+ *                failures: receives the number of failed output calls, including calls that missed the deadline set by Tolk_SetDriverTimeout, may be NULL.
+ *                trips: receives the number of times the driver was taken out of use by the circuit breaker, may be NULL.
+ *                rejected: receives the number of calls skipped because the circuit breaker had taken the driver out of use, may be NULL.
+ *  Returns:      true if counters were found for the driver, false otherwise (the counters are then set to 0).
+ */
+TOLK_DLL_DECLSPEC bool TOLK_CALL Tolk_GetDriverStats(const wchar_t *name, unsigned int *calls, unsigned int *failures, unsigned int *trips, unsigned int *rejected);
+
+/**
+ *  Name:         Tolk_SetFailover
+ *  Description:  Enables or disables failover for Tolk_Output, Tolk_Speak and Tolk_Braille. By default, if the current screen reader driver fails to output the text the function returns false and the text is lost. With failover enabled, Tolk runs the auto-detection process again, skipping the driver that failed, and retries the same text on the next active screen reader (or SAPI). This is repeated until a driver succeeds, every active driver has been tried once, or the latency budget runs out. The current screen reader driver is left unchanged, so the next call tries the preferred screen reader first again. If a deadline has been set with Tolk_SetDriverTimeout, retries are cut off at the end of the budget, otherwise a retry that has started runs to completion. Failover is disabled by default.
+ *  Parameters:   failover: whether or not to retry failed output on other screen readers.
+ *                budgetMilliseconds: time after the first failure within which retries may start, or 0 for no limit.
+ *  Returns:      None.
+ */
+TOLK_DLL_DECLSPEC void TOLK_CALL Tolk_SetFailover(bool failover, unsigned int budgetMilliseconds);
+
+/**
+ *  Name:         Tolk_SetHedging
+ *  Description:  Enables or disables hedged output for Tolk_Output and Tolk_Speak. Some screen readers take a long time to accept text, which matters for time-critical cues. With hedging enabled, the current screen reader driver gets budgetMilliseconds to accept the text. If it has not returned by then, the text is also sent to a secondary driver. If the current driver accepts the text later after all, its speech is silenced so the text is not heard twice, and if it had not started on the text yet the text is dropped. Use Tolk_GetLastOutputDriver to find out which driver delivered the text. The current driver is called on a worker thread of its own, as with Tolk_SetDriverTimeout. All later calls to that driver go through the same thread, and every Tolk function skips the driver while a late call is still running. Hedging is disabled by default. You should call Tolk_Load once before using this function.
+ *  Parameters:   budgetMilliseconds: time the current driver gets before the secondary driver is used, or 0 to disable hedging.
+ *                secondary: common name of the secondary driver, for example L"SAPI", or NULL to use the next active screen reader in the auto-detection order.
+ *  Returns:      None.
+ */
+TOLK_DLL_DECLSPEC void TOLK_CALL Tolk_SetHedging(unsigned int budgetMilliseconds, const wchar_t *secondary);
+
+/**
+ *  Name:         Tolk_SetTextNormalization
+ *  Description:  Enables or disables cleaning up text before it is passed to the screen reader by Tolk_Output, Tolk_Speak and Tolk_Braille. Runs of whitespace, including line breaks and non-breaking spaces, are collapsed into one space and removed from the start and end of the text. Control characters, soft hyphens and zero-width characters are dropped, and letters followed by combining accents are composed (Unicode normalization form C). This avoids odd pauses in speech and makes the text smaller to send. Text that needs no cleaning up is passed on as it is, without being copied. Normalization is disabled by default.
+ *  Parameters:   normalize: true to clean up text, false to pass it on unchanged.
+ *  Returns:      None.
+ */
+TOLK_DLL_DECLSPEC void TOLK_CALL Tolk_SetTextNormalization(bool normalize);
+
+/**
+ *  Name:         Tolk_SetSymbolNames
+ *  Description:  Enables or disables naming emoji and symbols in text passed to Tolk_Output, Tolk_Speak and Tolk_Braille. Each emoji or symbol is replaced by its short name from the Unicode Common Locale Data Repository (CLDR), for example "thumbs up" for the thumbs up emoji, the same way with every screen reader. Emoji joined into one by zero-width joiners, flags and keycaps are named as a whole, and skin tones are added to the name. Emoji without a name are left alone. The names are compiled into Tolk, which ships with English names. Names are applied after text normalization and before the pronunciation dictionary. Symbol naming is disabled by default.
+ *  Parameters:   language: language tag of the names to use, for example L"en", or NULL to disable symbol naming. A tag with a region, such as L"en-US", falls back to the language if there are no names for the region.
+ *  Returns:      true on success, false if there are no names in the given language, in which case the current setting is kept.
+ */
+TOLK_DLL_DECLSPEC bool TOLK_CALL Tolk_SetSymbolNames(const wchar_t *language);
+
+/**
+ *  Name:         Tolk_LoadDictionary
+ *  Description:  Loads a pronunciation dictionary, which replaces words and phrases in text before it is spoken by Tolk_Output and Tolk_Speak, the same way with every screen reader. The file is UTF-8 text with one entry per line: the text to replace, a tab and the replacement. Empty lines and lines starting with # are skipped, as is anything after a second tab. Matching ignores case. Text to replace that starts or ends with a letter or digit only matches whole words on that side. Where entries overlap, the one that starts first wins, and of those the longest. If an entry is listed twice, the last one is used. All entries are applied in a single pass over the text, so large dictionaries do not slow output down. Calling this function again replaces the dictionary; output continues with the old one while the new one loads. Braille is left alone unless enabled with Tolk_SetDictionaryForBraille. Text normalization, if enabled, happens first.
+ *  Parameters:   path: the dictionary file, or NULL to stop using a dictionary.
+ *  Returns:      true on success, false if the file could not be read, in which case the dictionary in use is kept.
+ */
+TOLK_DLL_DECLSPEC bool TOLK_CALL Tolk_LoadDictionary(const wchar_t *path);
+
+/**
+ *  Name:         Tolk_SetDictionaryForBraille
+ *  Description:  Sets whether the pronunciation dictionary also applies to text shown in braille by Tolk_Output and Tolk_Braille. By default it does not, since braille readers usually want the text as it was written. When only speech is affected and the dictionary changes the text, Tolk_Output sends speech and braille to the screen reader separately. See Tolk_LoadDictionary.
+ *  Parameters:   braille: true to apply the dictionary to braille as well, false to apply it to speech only.
+ *  Returns:      None.
+ */
+TOLK_DLL_DECLSPEC void TOLK_CALL Tolk_SetDictionaryForBraille(bool braille);
+
+/**
+ *  Name:         Tolk_SetDuplicateWindow
+ *  Description:  Sets a time window within which Tolk_Output, Tolk_Speak and Tolk_Braille drop text that exactly repeats text passed to them before, for when several events announce the same thing in quick succession. Speech and braille are checked separately: text that was spoken by Tolk_Speak is still brailled by a following Tolk_Output, but not spoken again. The window starts when text has been delivered, repeats do not extend it. Text that could not be delivered is not remembered, so it can be retried right away. Only the last 16 different texts are remembered. Dropped text counts as output, the functions return true. Checking takes no lock. Duplicates are let through by default.
+ *  Parameters:   milliseconds: the window, or 0 to let duplicates through.
+ *  Returns:      None.
+ */
+TOLK_DLL_DECLSPEC void TOLK_CALL Tolk_SetDuplicateWindow(unsigned int milliseconds);
+
+/**
+ *  Name:         Tolk_GetDuplicateStats
+ *  Description:  Retrieves how many texts were dropped as duplicates since Tolk was loaded into the process, see Tolk_SetDuplicateWindow.
+ *  Parameters:   speech: receives the number of texts not spoken, may be NULL.
+ *                braille: receives the number of texts not brailled, may be NULL.
+ *  Returns:      None.
+ */
+TOLK_DLL_DECLSPEC void TOLK_CALL Tolk_GetDuplicateStats(unsigned int *speech, unsigned int *braille);
+
+/**
+ *  Name:         Tolk_WatchScreenReaders
+ *  Description:  Starts or stops watching for screen readers starting and stopping. Normally every function that needs a screen reader first checks that the current one is still active, which costs a system call or a round trip to the screen reader each time. With watching enabled, a thread of Tolk's own listens for top-level windows being created and destroyed, and the result of the auto-detection process is reused until something changes (or for a few seconds at most). The watcher calls the screen reader drivers from its own thread, so Tolk should be loaded on a thread in the multi-threaded apartment (which is what Tolk_Load sets up if COM has not been initialized yet). Watching is disabled by default. If Tolk is not loaded yet, the watcher starts when it is.
+ *  Parameters:   watch: whether or not to watch for screen readers starting and stopping.
+ *  Returns:      None.
+ */
+TOLK_DLL_DECLSPEC void TOLK_CALL Tolk_WatchScreenReaders(bool watch);
+
+/**
+ *  Name:         Tolk_ScreenReaderChangedCallback
+ *  Description:  Called when the active screen reader changes, see Tolk_SetScreenReaderChangedCallback.
+ *  Parameters:   name: common name of the new screen reader, as Tolk_DetectScreenReader would return it, or NULL if none is active. The string is only valid during the call.
+ *                userData: the pointer passed to Tolk_SetScreenReaderChangedCallback.
+ *  Returns:      None.
+ */
+typedef void (TOLK_CALL *Tolk_ScreenReaderChangedCallback)(const wchar_t *name, void *userData);
+
+/**
+ *  Name:         Tolk_SetScreenReaderChangedCallback
+ *  Description:  Registers a function to call when the active screen reader changes. Changes are only detected while Tolk_WatchScreenReaders is enabled. The callback runs on the watcher's thread, without any of Tolk's locks held, so it may call other Tolk functions, with the exception of Tolk_Unload and Tolk_WatchScreenReaders.
+ *  Parameters:   callback: the function to call, or NULL to stop being notified.
+ *                userData: pointer passed to the callback as-is, may be NULL.
+ *  Returns:      None.
+ */
+TOLK_DLL_DECLSPEC void TOLK_CALL Tolk_SetScreenReaderChangedCallback(Tolk_ScreenReaderChangedCallback callback, void *userData);
+
+/**
+ *  Name:         Tolk_SetLongTextThreshold
+ *  Description:  Enables or disables speaking long text in chunks. Some screen readers take a long time to start speaking when they are given a large text, such as a help page, in one go. Text passed to Tolk_Output or Tolk_Speak that is longer than the threshold is split at sentence and clause boundaries instead. The first chunk is short and sent right away, and each next chunk is sent once the one before has been spoken, as reported by the screen reader or estimated (see Tolk_WaitForSpeechEnd). Text that is output without interrupting while a long text is being spoken is spoken after it, interrupting drops what is left of the long text, as does Tolk_Silence. Braille still gets the whole text at once. Tolk_IsSpeaking returns true until the last chunk has been spoken. Long text is spoken in one go by default.
+ *  Parameters:   characters: length above which text is spoken in chunks, or 0 to disable chunking.
+ *  Returns:      None.
+ */
+TOLK_DLL_DECLSPEC void TOLK_CALL Tolk_SetLongTextThreshold(unsigned int characters);
+
+/**
+ *  Name:         Tolk_ReadDocument
+ *  Description:  Starts reading a document aloud, for example an in-game book or a log file. The file is mapped into memory and only the part being spoken is decoded, so documents of any size can be read. It is spoken in chunks at sentence boundaries as with Tolk_SetLongTextThreshold, interrupting any speech. Files starting with a UTF-16 byte order mark are read as UTF-16, others as UTF-8. Use Tolk_PauseDocument, Tolk_ResumeDocument and Tolk_SkipDocument to control reading, and Tolk_GetDocumentPosition to find out how far it got, for example to continue from there later. Interrupting output and Tolk_Silence pause reading. Reading a new document replaces the current one. You should call Tolk_Load once before using this function.
+ *  Parameters:   path: the file to read.
+ *                position: where to start reading, 0 for the beginning or a position returned by Tolk_GetDocumentPosition.
+ *  Returns:      true if reading started, false otherwise. If the file could be opened but no screen reader accepted the text, the document is kept, paused at the given position.
+ */
+TOLK_DLL_DECLSPEC bool TOLK_CALL Tolk_ReadDocument(const wchar_t *path, unsigned long long position);
+
+/**
+ *  Name:         Tolk_ReadDocumentBuffer
+ *  Description:  Starts reading a document from memory aloud, the same way as Tolk_ReadDocument. The document is copied, so the buffer can be freed once this function returns.
+ *  Parameters:   data: the document, UTF-8 or UTF-16 with a byte order mark.
+ *                size: the size of the document in bytes.
+ *                position: where to start reading, 0 for the beginning or a position returned by Tolk_GetDocumentPosition.
+ *  Returns:      true if reading started, false otherwise.
+ */
+TOLK_DLL_DECLSPEC bool TOLK_CALL Tolk_ReadDocumentBuffer(const void *data, unsigned int size, unsigned long long position);
+
+/**
+ *  Name:         Tolk_PauseDocument
+ *  Description:  Pauses reading the document started with Tolk_ReadDocument and silences the screen reader. Reading continues from the word that was being spoken once it is resumed. The word is known exactly for drivers that report speech progress (currently SAPI) and estimated otherwise.
+ *  Parameters:   None.
+ *  Returns:      true if the document was paused, false if no document is being read.
+ */
+TOLK_DLL_DECLSPEC bool TOLK_CALL Tolk_PauseDocument();
+
+/**
+ *  Name:         Tolk_ResumeDocument
+ *  Description:  Resumes reading a document that was paused, see Tolk_PauseDocument.
+ *  Parameters:   None.
+ *  Returns:      true if reading resumed, false if there is no paused document, it was read to the end, or no screen reader accepted the text.
+ */
+TOLK_DLL_DECLSPEC bool TOLK_CALL Tolk_ResumeDocument();
+
+/**
+ *  Name:         Tolk_SkipDocument
+ *  Description:  Skips the rest of the sentence or paragraph being read in the document, and continues reading at the start of the next one. A paused document only moves ahead, it stays paused. Paragraphs end at line breaks.
+ *  Parameters:   unit: TOLK_DOCUMENT_SENTENCE or TOLK_DOCUMENT_PARAGRAPH.
+ *  Returns:      true on success, false if there is no document, the unit is unknown, or the end of the document was reached.
+ */
+#define TOLK_DOCUMENT_SENTENCE 0
+#define TOLK_DOCUMENT_PARAGRAPH 1
+TOLK_DLL_DECLSPEC bool TOLK_CALL Tolk_SkipDocument(int unit);
+
+/**
+ *  Name:         Tolk_GetDocumentPosition
+ *  Description:  Retrieves how far reading the document has got. The position is the byte offset of the word being spoken in the file or buffer, which can be passed back to Tolk_ReadDocument to continue from there, also in a later session.
+ *  Parameters:   position: receives the position, may be NULL.
+ *                size: receives the size of the document in bytes, may be NULL.
+ *  Returns:      true on success, false if there is no document.
+ */
+TOLK_DLL_DECLSPEC bool TOLK_CALL Tolk_GetDocumentPosition(unsigned long long *position, unsigned long long *size);
+
+/**
+ *  Name:         Tolk_StopDocument
+ *  Description:  Stops reading the document and closes it, silencing the screen reader if it was reading.
+ *  Parameters:   None.
+ *  Returns:      None.
+ */
+TOLK_DLL_DECLSPEC void TOLK_CALL Tolk_StopDocument();
+
+/**
+ *  Name:         Tolk_SetSpeechRate
+ *  Description:  Tells Tolk how fast the screen reader speaks. Several screen readers cannot report whether they are speaking, so Tolk estimates this from the text they were given, see Tolk_IsSpeaking. The estimate improves if it knows the speech rate. The rate is a hint for the estimate only, it does not change the rate of the screen reader.
+ *  Parameters:   wordsPerMinute: the speech rate in words per minute, or 0 for the default of 180.
+ *  Returns:      None.
+ */
+TOLK_DLL_DECLSPEC void TOLK_CALL Tolk_SetSpeechRate(unsigned int wordsPerMinute);
+
+/**
+ *  Name:         Tolk_WaitForSpeechEnd
+ *  Description:  Waits until the screen reader has finished speaking the text it was last given, without using the processor in the meantime. The end of speech is taken from the screen reader where possible: SAPI and BoyPCReader signal it, ZDSR and ZoomText are asked every 50 milliseconds. For screen readers that cannot report their status, the estimate described under Tolk_IsSpeaking is used. The first call starts a background thread that tracks speech from then on. You should call Tolk_Load once before using this function.
+ *  Parameters:   milliseconds: the maximum time to wait in milliseconds, or TOLK_WAIT_INFINITE to wait until speech ends.
+ *  Returns:      true if speech has ended, false on timeout or if Tolk is not loaded.
+ */
+#define TOLK_WAIT_INFINITE 0xFFFFFFFF
+TOLK_DLL_DECLSPEC bool TOLK_CALL Tolk_WaitForSpeechEnd(unsigned int milliseconds);
+
+/**
+ *  Name:         Tolk_GetSpeechEventHandle
+ *  Description:  Returns a Win32 event handle that is signaled while the screen reader is not speaking, and reset while it speaks text passed to Tolk_Output or Tolk_Speak. Use this to wait for the end of speech in your own event loop, for example with WaitForMultipleObjects or MsgWaitForMultipleObjects, see Tolk_WaitForSpeechEnd for how the end of speech is detected. The handle is owned by Tolk and stays valid until Tolk is unloaded from the process, do not close it or change its state. You should call Tolk_Load once before using this function.
+ *  Parameters:   None.
+ *  Returns:      The event handle (a HANDLE) on success, NULL otherwise.
+ */
+TOLK_DLL_DECLSPEC void * TOLK_CALL Tolk_GetSpeechEventHandle();
+
+/**
+ *  Name:         Tolk_SpeechProgressCallback
+ *  Description:  Called as the screen reader makes progress through text passed to Tolk_Output or Tolk_Speak, see Tolk_SetSpeechProgressCallback.
+ *  Parameters:   event: one of the TOLK_SPEECH_* constants below.
+ *                position: for TOLK_SPEECH_WORD, the position of the word in the text, in characters. For TOLK_SPEECH_BOOKMARK, the number of the bookmark. 0 otherwise.
+ *                length: for TOLK_SPEECH_WORD, the length of the word in characters, 0 otherwise.
+ *                userData: the pointer passed to Tolk_SetSpeechProgressCallback.
+ *  Returns:      None.
+ */
+#define TOLK_SPEECH_STARTED 0
+#define TOLK_SPEECH_WORD 1
+#define TOLK_SPEECH_BOOKMARK 2
+#define TOLK_SPEECH_FINISHED 3
+typedef void (TOLK_CALL *Tolk_SpeechProgressCallback)(int event, unsigned int position, unsigned int length, void *userData);
+
+/**
+ *  Name:         Tolk_SetSpeechProgressCallback
+ *  Description:  Registers a function to call when speech starts, reaches a word or bookmark, or finishes. Only screen reader drivers that receive these events from the speech engine report them, currently SAPI. Use Tolk_WaitForSpeechEnd to find out when other screen readers finish speaking. The callback runs on a thread of the speech engine, so it must return quickly and must not call Tolk functions.
+ *  Parameters:   callback: the function to call, or NULL to stop being notified.
+ *                userData: pointer passed to the callback as-is, may be NULL.
+ *  Returns:      None.
+ */
+TOLK_DLL_DECLSPEC void TOLK_CALL Tolk_SetSpeechProgressCallback(Tolk_SpeechProgressCallback callback, void *userData);
+
+/**
+ *  Name:         Tolk_MarkCallback
+ *  Description:  Called when speech reaches a mark passed to Tolk_SpeakWithMarks, see there.
+ *  Parameters:   mark: the index of the mark in the array passed to Tolk_SpeakWithMarks.
+ *                userData: the pointer passed to Tolk_SpeakWithMarks.
+ *  Returns:      None.
+ */
+typedef void (TOLK_CALL *Tolk_MarkCallback)(unsigned int mark, void *userData);
+
+/**
+ *  Name:         Tolk_SpeakWithMarks
+ *  Description:  Speaks text like Tolk_Speak and calls back as speech reaches each of the given positions in it, for example to find out how far the user listened before interrupting it, or to highlight the text being spoken. Screen readers that accept SSML with marks, currently SAPI and NVDA 2024.1 or later, report the marks as the speech engine reaches them. For other screen readers each mark is reached at the time estimated for the text before it (see Tolk_IsSpeaking), and marks that are left when speech ends are reached then. Marks that have not been reached when speech is interrupted or silenced are not reported. The text is spoken as a whole, even if it is longer than the threshold set with Tolk_SetLongTextThreshold. Normalization, symbol names and the pronunciation dictionary apply to the text between marks. The callback runs on a thread of the speech engine or of Tolk, so it must return quickly and must not call Tolk functions. You should call Tolk_Load once before using this function.
+ *  Parameters:   str: text to speak.
+ *                marks: positions in the text in characters, in ascending order. A mark is reached just before the character at its position is spoken, a mark at the length of the text once all of it has been spoken.
+ *                count: the number of marks, may be 0.
+ *                interrupt: whether or not to first cancel any previous speech.
+ *                callback: the function to call for each mark.
+ *                userData: pointer passed to the callback as-is, may be NULL.
+ *  Returns:      true on success, false otherwise.
+ */
+TOLK_DLL_DECLSPEC bool TOLK_CALL Tolk_SpeakWithMarks(const wchar_t *str, const unsigned int *marks, unsigned int count, bool interrupt, Tolk_MarkCallback callback, void *userData);
+
+/**
+ *  Name:         Tolk_AudioCallback
+ *  Description:  Receives the audio rendered by Tolk_Synthesize, one chunk at a time as the speech engine produces it.
+ *  Parameters:   data: PCM samples in the format passed to Tolk_Synthesize. The memory belongs to the speech engine and is only valid during the call.
+ *                size: the size of data in bytes, always a whole number of sample frames.
+ *                userData: the pointer passed to Tolk_Synthesize.
+ *  Returns:      true to continue, false to stop synthesizing.
+ */
+typedef bool (TOLK_CALL *Tolk_AudioCallback)(const void *data, unsigned int size, void *userData);
+
+/**
+ *  Name:         Tolk_Synthesize
+ *  Description:  Renders text to PCM audio with the default SAPI voice and hands it to a callback instead of playing it, so you can mix it into your own audio. Chunks are passed on as soon as the speech engine writes them, without being copied. A voice is created for each call and is separate from the SAPI screen reader driver, so this works without Tolk_TrySAPI and does not disturb speech output. This function does not return until the last chunk has been handed over, and may be called from any thread, including several at once. The callback may run on a thread of the speech engine. Only available if Tolk was built with the SAPI driver.
+ *  Parameters:   str: text to synthesize.
+ *                samplesPerSecond: sample rate of the audio, for example 22050 or 44100.
+ *                bitsPerSample: 8 or 16.
+ *                channels: 1 for mono or 2 for stereo.
+ *                callback: the function that receives the audio.
+ *                userData: pointer passed to the callback as-is, may be NULL.
+ *  Returns:      true if all text was rendered, false on failure or when the callback stopped it.
+ */
+TOLK_DLL_DECLSPEC bool TOLK_CALL Tolk_Synthesize(const wchar_t *str, unsigned int samplesPerSecond, unsigned int bitsPerSample, unsigned int channels, Tolk_AudioCallback callback, void *userData);
+
+/**
+ *  Name:         Tolk_SetPhraseCache
+ *  Description:  Sets up a cache of rendered audio for short, frequently spoken phrases like menu items and labels. The SAPI screen reader driver plays cached phrases without synthesizing them again and renders phrases it has not seen before on a background thread, so they are cached the next time. Tolk_Synthesize is served from the cache as well. Phrases are kept per voice, rate and audio format, and phrases of up to 256 characters are cached. The least recently used phrases are dropped when the cache is full. The cache can be kept in a file, which is mapped into memory when the cache is set up and rewritten when it is replaced or Tolk is unloaded, so it persists across runs. After Tolk_Unload, the next Tolk_Load sets the cache up again with the same settings. Note that word and bookmark progress events are not reported for cached phrases. Only available if Tolk was built with the SAPI driver. You should call Tolk_Load once before using this function.
+ *  Parameters:   path: the file to keep the cache in, or NULL to keep it in memory only. It does not have to exist.
+ *                maxKilobytes: the maximum size of the cached audio in kilobytes, or 0 to turn the cache off.
+ *  Returns:      true on success, false otherwise.
+ */
+TOLK_DLL_DECLSPEC bool TOLK_CALL Tolk_SetPhraseCache(const wchar_t *path, unsigned int maxKilobytes);
+
+/**
+ *  Name:         Tolk_PrefetchPhrases
+ *  Description:  Queues phrases to be rendered into the phrase cache on a background thread, for example while your application is loading. This function returns right away. Phrases are rendered in the format the SAPI screen reader driver plays, 22050 Hz 16-bit mono, so Tolk_Synthesize only benefits when asked for the same format. Phrases that are already cached or too long are skipped, as are phrases beyond the first 256 waiting to be rendered. See Tolk_SetPhraseCache.
+ *  Parameters:   phrases: array of phrases to render.
+ *                count: the number of phrases in the array.
+ *  Returns:      true if the phrases were queued, false if the phrase cache is off.
+ */
+TOLK_DLL_DECLSPEC bool TOLK_CALL Tolk_PrefetchPhrases(const wchar_t *const *phrases, unsigned int count);
+
+/**
+ *  Name:         Tolk_GetPhraseCacheStats
+ *  Description:  Retrieves how often a phrase was found in the phrase cache since it was set up, see Tolk_SetPhraseCache. Phrases that are too long to be cached are not counted.
+ *  Parameters:   hits: receives the number of phrases found in the cache, may be NULL.
+ *                misses: receives the number of phrases that had to be synthesized, may be NULL.
+ *  Returns:      true on success, false if the phrase cache is off.
+ */
+TOLK_DLL_DECLSPEC bool TOLK_CALL Tolk_GetPhraseCacheStats(unsigned int *hits, unsigned int *misses);
+
+/**
+ *  Name:         Tolk_GetLastOutputDriver
+ *  Description:  Returns the common name of the screen reader driver that delivered the text passed to the last call of Tolk_Output, Tolk_Speak or Tolk_Braille. With failover enabled this may differ from the current screen reader driver. You should call Tolk_Load once before using this function.
+ *  Parameters:   None.
+ *  Returns:      A Unicode string representation of the common name if the last call succeeded, NULL otherwise.
+ */
+TOLK_DLL_DECLSPEC const wchar_t * TOLK_CALL Tolk_GetLastOutputDriver();
+
 /**
  *  Name:         Tolk_DetectScreenReader
  *  Description:  Returns the common name for the currently active screen reader driver, if one is set. If none is set, tries to detect the currently active screen reader before looking up the name. If no screen reader is active, NULL is returned. Note that the drivers hard-code the common name, it is not requested from the screen reader itself. You should call Tolk_Load once before using this function.
@@ -100,6 +446,20 @@ TOLK_DLL_DECLSPEC bool TOLK_CALL Tolk_Output(const wchar_t *str, bool interrupt
 TOLK_DLL_DECLSPEC bool TOLK_CALL Tolk_Output(const wchar_t *str, bool interrupt);
 #endif // __cplusplus
 
+/**
+ *  Name:         Tolk_OutputDiff
+ *  Description:  Outputs text that replaces the text last output under the same key, such as a progress or status line, speaking only what changed. The texts are compared word by word: when "Downloading 41%" becomes "Downloading 42%" only "42%" is spoken, and when a line is added to a chat only the new line is spoken. If the words that changed are followed by more than a unit such as %, only the changed words are spoken. Text with the same words as before is not spoken again, text without any words or punctuation is not output at all, and text that only lost words is spoken whole. Braille always gets the whole text. Up to 64 keys are remembered, the ones used least recently are forgotten first, and text longer than 4096 characters is not remembered. You should call Tolk_Load once before using this function. This function is asynchronous.
+ *  Parameters:   key: identifies the line, for example L"download".
+ *                str: the new text of the line.
+ *                interrupt: whether or not to first cancel any previous speech.
+ *  Returns:      true on success or if nothing changed, false otherwise.
+ */
+#ifdef __cplusplus
+TOLK_DLL_DECLSPEC bool TOLK_CALL Tolk_OutputDiff(const wchar_t *key, const wchar_t *str, bool interrupt = false);
+#else
+TOLK_DLL_DECLSPEC bool TOLK_CALL Tolk_OutputDiff(const wchar_t *key, const wchar_t *str, bool interrupt);
+#endif // __cplusplus
+
 /**
  *  Name:         Tolk_Speak
  *  Description:  Speaks text through the current screen reader driver, if one is set and supports speech output. If none is set or if it encountered an error, tries to detect the currently active screen reader before speaking the text. Use this function only if you specifically need to speak text through the current screen reader without also brailling it. Not all screen reader drivers may support this functionality. Therefore, use Tolk_Output whenever possible. You should call Tolk_Load once before using this function. This function is asynchronous.
@@ -113,6 +473,19 @@ TOLK_DLL_DECLSPEC bool TOLK_CALL Tolk_Speak(const wchar_t *str, bool interrupt =
 TOLK_DLL_DECLSPEC bool TOLK_CALL Tolk_Speak(const wchar_t *str, bool interrupt);
 #endif // __cplusplus
 
+/**
+ *  Name:         Tolk_SpeakMarkup
+ *  Description:  Speaks text with pauses, spelled-out words, emphasis and language switches marked up in it, for example L"Press {spell}F1{/spell} for help.{pause 300}". The tags are {pause} or {pause milliseconds}, {spell}...{/spell}, {em}...{/em} and {lang tag}...{/lang} with a language tag such as de or pt-BR. Write {{ for a literal {. Screen readers that accept SSML, SAPI and NVDA 2024.1 or later, get the markup as SSML. JAWS spells through its own scripts. Other screen readers get plain text, with pauses turned into punctuation and spelled words into separate letters. The markup is parsed once and converted once per screen reader, repeated markup is looked up. Normalization, symbol names and the pronunciation dictionary apply to the text outside of spell tags. The text is spoken as a whole, even if it is longer than the threshold set with Tolk_SetLongTextThreshold. You should call Tolk_Load once before using this function. This function is asynchronous.
+ *  Parameters:   markup: text to speak, with tags.
+ *                interrupt: whether or not to first cancel any previous speech.
+ *  Returns:      true on success, false if the markup is malformed or speaking failed.
+ */
+#ifdef __cplusplus
+TOLK_DLL_DECLSPEC bool TOLK_CALL Tolk_SpeakMarkup(const wchar_t *markup, bool interrupt = false);
+#else
+TOLK_DLL_DECLSPEC bool TOLK_CALL Tolk_SpeakMarkup(const wchar_t *markup, bool interrupt);
+#endif // __cplusplus
+
 /**
  *  Name:         Tolk_Braille
  *  Description:  Brailles text through the current screen reader driver, if one is set and supports braille output. If none is set or if it encountered an error, tries to detect the currently active screen reader before brailling the given text. Use this function only if you specifically need to braille text through the current screen reader without also speaking it. Not all screen reader drivers may support this functionality. Therefore, use Tolk_Output whenever possible. You should call Tolk_Load once before using this function.
@@ -121,17 +494,66 @@ TOLK_DLL_DECLSPEC bool TOLK_CALL Tolk_Speak(const wchar_t *str, bool interrupt);
  */
 TOLK_DLL_DECLSPEC bool TOLK_CALL Tolk_Braille(const wchar_t *str);
 
+/**
+ *  Name:         Tolk_SetBraillePaging
+ *  Description:  Enables or disables splitting braille into pages that fit the braille display. Without paging the screen reader gets the whole text, and long text is cut off or scrolled in a way that differs between screen readers. With paging, Tolk_Output, Tolk_OutputDiff and Tolk_Braille send the first page only, and Tolk_PanBrailleForward and Tolk_PanBrailleBack show the other pages. Pages end at a line break or after the last word that fits, only words wider than the display are cut. Each cell is taken to hold one character, so contracted braille may fill less of the display. The pages of recent texts are remembered, so showing the same text again does not split it again. Paging is disabled by default. You should call Tolk_Load once before using this function.
+ *  Parameters:   paging: whether or not to split braille into pages.
+ *  Returns:      None.
+ */
+TOLK_DLL_DECLSPEC void TOLK_CALL Tolk_SetBraillePaging(bool paging);
+
+/**
+ *  Name:         Tolk_SetBrailleWidth
+ *  Description:  Sets the number of cells of the braille display, for paging (see Tolk_SetBraillePaging). By default the width the screen reader reports is used, and 40 cells if it does not report one. Of the screen reader drivers, only plugins can report the width.
+ *  Parameters:   cells: the number of cells, or 0 to use the width the screen reader reports.
+ *  Returns:      None.
+ */
+TOLK_DLL_DECLSPEC void TOLK_CALL Tolk_SetBrailleWidth(unsigned int cells);
+
+/**
+ *  Name:         Tolk_PanBrailleForward
+ *  Description:  Shows the next page of the text last brailled with paging enabled, see Tolk_SetBraillePaging. Only that page is sent to the screen reader. You should call Tolk_Load once before using this function.
+ *  Parameters:   None.
+ *  Returns:      true on success, false if the last page is shown already or brailling failed.
+ */
+TOLK_DLL_DECLSPEC bool TOLK_CALL Tolk_PanBrailleForward();
+
+/**
+ *  Name:         Tolk_PanBrailleBack
+ *  Description:  Shows the previous page of the text last brailled with paging enabled, see Tolk_SetBraillePaging. Only that page is sent to the screen reader. You should call Tolk_Load once before using this function.
+ *  Parameters:   None.
+ *  Returns:      true on success, false if the first page is shown already or brailling failed.
+ */
+TOLK_DLL_DECLSPEC bool TOLK_CALL Tolk_PanBrailleBack();
+
+/**
+ *  Name:         Tolk_GetBraillePage
+ *  Description:  Retrieves which page of the text last brailled with paging enabled is shown, for example to let the user know there is more. See Tolk_SetBraillePaging.
+ *  Parameters:   page: receives the index of the page shown, starting at 0, may be NULL.
+ *                count: receives the number of pages, may be NULL.
+ *  Returns:      true on success, false if no text has been brailled with paging enabled.
+ */
+TOLK_DLL_DECLSPEC bool TOLK_CALL Tolk_GetBraillePage(unsigned int *page, unsigned int *count);
+
 /**
  *  Name:         Tolk_IsSpeaking
- *  Description:  Tests if the screen reader associated with the current screen reader driver is speaking, if one is set and supports querying for status information. If none is set, tries to detect the currently active screen reader before testing if it is speaking. You should call Tolk_Load once before using this function.
+ *  Description:  Tests if the screen reader associated with the current screen reader driver is speaking, if one is set and supports querying for status information. If none is set, tries to detect the currently active screen reader before testing if it is speaking. If the screen reader cannot report its status, Tolk estimates whether it is still speaking from the text it was given, the number of words and characters in it, and the rate set with Tolk_SetSpeechRate. The estimate is calibrated against the screen readers and SAPI voices that can report their status whenever they are used. You should call Tolk_Load once before using this function.
  *  Parameters:   None.
  *  Returns:      true if text is being spoken by the screen reader, false otherwise.
  */
 TOLK_DLL_DECLSPEC bool TOLK_CALL Tolk_IsSpeaking();
 
+/**
+ *  Name:         Tolk_GetQueuedUtterances
+ *  Description:  Retrieves how many texts the screen reader associated with the current screen reader driver has been given and not finished speaking, for example to hold back output while it lags behind. If none is set, tries to detect the currently active screen reader first. Currently only BoyPCReader reports this. Chunks of long text Tolk has not sent yet are not counted. You should call Tolk_Load once before using this function.
+ *  Parameters:   count: receives the number of texts queued, may be NULL.
+ *  Returns:      true on success, false if no screen reader is active or it cannot report this.
+ */
+TOLK_DLL_DECLSPEC bool TOLK_CALL Tolk_GetQueuedUtterances(unsigned int *count);
+
 /**
  *  Name:         Tolk_Silence
- *  Description:  Silences the screen reader associated with the current screen reader driver, if one is set and supports speech output. If none is set or if it encountered an error, tries to detect the currently active screen reader before silencing it. You should call Tolk_Load once before using this function.
+ *  Description:  Silences the screen reader associated with the current screen reader driver, if one is set and supports speech output. If none is set or if it encountered an error, tries to detect the currently active screen reader before silencing it. What is left of a long text being spoken in chunks is dropped, see Tolk_SetLongTextThreshold. You should call Tolk_Load once before using this function.
  *  Parameters:   None.
  *  Returns:      true on success, false otherwise.
  */
@@ -0,0 +1,92 @@
+/**
+ *  Product:        Tolk
+ *  File:           TolkBridge.h
+ *  Description:    Shared memory channel between a bridged driver and its helper process.
+ *  Copyright:      (c) 2026, Davy Kager <mail@davykager.nl>
+ *  License:        LGPLv3
+ */
+
+#ifndef _TOLK_BRIDGE_H_
+#define _TOLK_BRIDGE_H_
+
+#include <windows.h>
+
+// Bump when the layout below changes.
+#define TOLK_BRIDGE_VERSION 2
+// Text that does not fit is sent in several TOLK_BRIDGE_OP_APPEND requests.
+#define TOLK_BRIDGE_MAX_TEXT 4096
+#define TOLK_BRIDGE_MAX_NAME 64
+// Iterations to busy-wait before sleeping on the event. A round trip to a helper
+// that is already running normally completes well within this.
+#define TOLK_BRIDGE_SPIN_COUNT 4000
+
+#define TOLK_BRIDGE_HELPER_32 L"TolkBridge32.exe"
+
+// Channel states, the client owns the channel in IDLE and RESPONSE, the helper in REQUEST.
+#define TOLK_BRIDGE_STATE_IDLE 0
+#define TOLK_BRIDGE_STATE_REQUEST 1
+#define TOLK_BRIDGE_STATE_RESPONSE 2
+
+#define TOLK_BRIDGE_OP_SPEAK 0
+#define TOLK_BRIDGE_OP_BRAILLE 1
+#define TOLK_BRIDGE_OP_OUTPUT 2
+#define TOLK_BRIDGE_OP_SILENCE 3
+#define TOLK_BRIDGE_OP_IS_SPEAKING 4
+#define TOLK_BRIDGE_OP_IS_ACTIVE 5
+#define TOLK_BRIDGE_OP_APPEND 6
+#define TOLK_BRIDGE_OP_QUIT 7
+
+struct TolkBridgeChannel {
+  LONG version;
+  volatile LONG state;
+  // Set by a side that is about to sleep, so the other side knows to signal the event.
+  volatile LONG clientWaiting;
+  volatile LONG helperWaiting;
+  // Filled in by the helper before its first response.
+  LONG hasSpeech;
+  LONG hasBraille;
+  LONG hasStatus;
+  wchar_t name[TOLK_BRIDGE_MAX_NAME];
+  // The current request and its result.
+  LONG operation;
+  LONG interrupt;
+  LONG length;
+  LONG result;
+  wchar_t text[TOLK_BRIDGE_MAX_TEXT];
+};
+
+// Waits for the channel to reach the given state, spinning before sleeping on the event.
+// Returns false on timeout or when the peer process exits.
+inline bool TolkBridgeWait(TolkBridgeChannel *channel, LONG state, volatile LONG *waiting, HANDLE event, HANDLE peer, DWORD timeout) {
+  for (int i = 0; i < TOLK_BRIDGE_SPIN_COUNT; ++i) {
+    if (channel->state == state) return true;
+    YieldProcessor();
+  }
+  const ULONGLONG start = GetTickCount64();
+  for (;;) {
+    // Announce we are going to sleep before checking one last time, the full
+    // barrier pairs with the one in TolkBridgeSignal so no wakeup is lost.
+    InterlockedExchange(waiting, 1);
+    if (channel->state == state) {
+      InterlockedExchange(waiting, 0);
+      return true;
+    }
+    DWORD remaining = INFINITE;
+    if (timeout != INFINITE) {
+      const ULONGLONG elapsed = GetTickCount64() - start;
+      remaining = (elapsed >= timeout) ? 0 : (DWORD)(timeout - elapsed);
+    }
+    const HANDLE handles[] = { event, peer };
+    const DWORD result = WaitForMultipleObjects(2, handles, FALSE, remaining);
+    InterlockedExchange(waiting, 0);
+    if (result != WAIT_OBJECT_0) return (channel->state == state);
+  }
+}
+
+// Moves the channel to the given state and wakes the peer if it went to sleep.
+inline void TolkBridgeSignal(TolkBridgeChannel *channel, LONG state, volatile LONG *waiting, HANDLE event) {
+  InterlockedExchange(&channel->state, state);
+  if (*waiting) SetEvent(event);
+}
+
+#endif // _TOLK_BRIDGE_H_
@@ -0,0 +1,73 @@
+/**
+ *  Product:        Tolk
+ *  File:           TolkBroker.h
+ *  Description:    Shared memory layout used between Tolk clients and the Tolk broker.
+ *  Copyright:      (c) 2026, Davy Kager <mail@davykager.nl>
+ *  License:        LGPLv3
+ */
+
+#ifndef _TOLK_BROKER_H_
+#define _TOLK_BROKER_H_
+
+#include <windows.h>
+
+// Names are in the Local namespace, so there is one broker per session.
+#define TOLK_BROKER_MAPPING_NAME L"Local\\TolkBroker"
+#define TOLK_BROKER_WAKEUP_NAME L"Local\\TolkBrokerWakeup"
+
+// Bump when the layout below changes.
+#define TOLK_BROKER_VERSION 2
+// Must be a power of two.
+#define TOLK_BROKER_SLOT_COUNT 32
+// Text that does not fit in one slot is split over consecutive slots.
+#define TOLK_BROKER_SLOT_TEXT 2048
+#define TOLK_BROKER_MAX_NAME 64
+
+#define TOLK_BROKER_OP_OUTPUT 0
+#define TOLK_BROKER_OP_SPEAK 1
+#define TOLK_BROKER_OP_BRAILLE 2
+#define TOLK_BROKER_OP_SILENCE 3
+
+#define TOLK_BROKER_FLAG_INTERRUPT 0x0001
+// More text for the same request follows in a later slot from the same process.
+#define TOLK_BROKER_FLAG_MORE 0x0002
+// The first slot of a request. Text left over from an earlier request of the same
+// process, one that could not be queued in full, is dropped when it arrives.
+#define TOLK_BROKER_FLAG_FIRST 0x0004
+
+// A client that claimed a slot and has not published it after this many milliseconds
+// is taken to have died or hung. The broker then hands the slot back and moves on.
+// Publishing is a compare-exchange of the sequence number, so a client that comes
+// back later finds its request dropped instead of publishing over the next one.
+#define TOLK_BROKER_CLAIM_TIMEOUT 500
+
+struct TolkBrokerSlot {
+  // Bounded multi-producer queue (Vyukov), the sequence number tells
+  // producers and the consumer whose turn it is to use the slot.
+  volatile LONG sequence;
+  DWORD processId;
+  LONG priority;
+  LONG operation;
+  LONG flags;
+  LONG length;
+  wchar_t text[TOLK_BROKER_SLOT_TEXT];
+};
+
+struct TolkBrokerRing {
+  // Written once by the broker before the wakeup event is created.
+  LONG version;
+  DWORD brokerProcessId;
+  // Published by the broker for clients to read without a round trip.
+  volatile LONG active;
+  volatile LONG hasSpeech;
+  volatile LONG hasBraille;
+  volatile LONG speaking;
+  volatile LONG nameSerial;
+  wchar_t name[TOLK_BROKER_MAX_NAME];
+  // Keep the producer and consumer positions on separate cache lines.
+  __declspec(align(64)) volatile LONG enqueuePosition;
+  __declspec(align(64)) volatile LONG dequeuePosition;
+  __declspec(align(64)) TolkBrokerSlot slots[TOLK_BROKER_SLOT_COUNT];
+};
+
+#endif // _TOLK_BROKER_H_
@@ -0,0 +1,78 @@
+/**
+ *  Product:        Tolk
+ *  File:           TolkPlugin.h
+ *  Description:    C ABI for external screen reader driver plugins.
+ *  Copyright:      (c) 2026, Davy Kager <mail@davykager.nl>
+ *  License:        LGPLv3
+ */
+
+#ifndef _TOLK_PLUGIN_H_
+#define _TOLK_PLUGIN_H_
+
+#define TOLK_PLUGIN_CALL __cdecl
+#define TOLK_PLUGIN_EXPORT __declspec(dllexport)
+
+#ifdef __cplusplus
+extern "C" {
+#else
+#include <stdbool.h>
+#include <wchar.h>
+#endif // __cplusplus
+
+/**
+ *  The ABI version implemented by this header. Tolk passes it to the plugin entry point and refuses drivers that report a newer version than its own. Members appended to TolkPluginDriver do not change the version, Tolk only reads the members that fit in structSize, so tables built against older and newer headers both work.
+ */
+#define TOLK_PLUGIN_ABI_VERSION 1
+
+/**
+ *  Capability flags for TolkPluginDriver::capabilities.
+ *  TOLK_PLUGIN_CAP_SPEECH:   the driver supports speech output (Tolk_HasSpeech).
+ *  TOLK_PLUGIN_CAP_BRAILLE:  the driver supports braille output (Tolk_HasBraille).
+ *  TOLK_PLUGIN_CAP_STATUS:   the driver can report if it is speaking (Tolk_IsSpeaking).
+ */
+#define TOLK_PLUGIN_CAP_SPEECH 0x0001
+#define TOLK_PLUGIN_CAP_BRAILLE 0x0002
+#define TOLK_PLUGIN_CAP_STATUS 0x0004
+
+/**
+ *  Name:         TolkPluginDriver
+ *  Description:  Function table describing a plugin screen reader driver. It mirrors Tolk's internal screen reader driver interface. The table must remain valid until Finalize has been called. Any function pointer other than Speak and IsActive may be NULL, in which case Tolk uses a sensible default (false for queries and failed operations, Speak plus Braille for Output).
+ *  Members:      abiVersion: set to TOLK_PLUGIN_ABI_VERSION.
+ *                structSize: set to sizeof(TolkPluginDriver).
+ *                name: common name of the screen reader, returned by Tolk_DetectScreenReader.
+ *                capabilities: combination of TOLK_PLUGIN_CAP_* flags.
+ *                Initialize: called once after the plugin has been loaded, return false to disable the driver.
+ *                Finalize: called once before the plugin is unloaded.
+ *                Speak, Braille, IsSpeaking, Silence, IsActive, Output: see the functions of the same name in Tolk.h.
+ *                GetBrailleCells: returns the number of cells of the braille display, or 0 if unknown. Used to split braille into pages, see Tolk_SetBraillePaging. Versions of Tolk that don't know this member don't read it.
+ */
+typedef struct TolkPluginDriver {
+  unsigned int abiVersion;
+  unsigned int structSize;
+  const wchar_t *name;
+  unsigned int capabilities;
+  bool (TOLK_PLUGIN_CALL *Initialize)(void);
+  void (TOLK_PLUGIN_CALL *Finalize)(void);
+  bool (TOLK_PLUGIN_CALL *Speak)(const wchar_t *str, bool interrupt);
+  bool (TOLK_PLUGIN_CALL *Braille)(const wchar_t *str);
+  bool (TOLK_PLUGIN_CALL *IsSpeaking)(void);
+  bool (TOLK_PLUGIN_CALL *Silence)(void);
+  bool (TOLK_PLUGIN_CALL *IsActive)(void);
+  bool (TOLK_PLUGIN_CALL *Output)(const wchar_t *str, bool interrupt);
+  unsigned int (TOLK_PLUGIN_CALL *GetBrailleCells)(void);
+} TolkPluginDriver;
+
+/**
+ *  Name:         TolkPlugin_GetDriver
+ *  Description:  Entry point every plugin DLL must export under this exact name. Tolk resolves it only when the driver is first needed by the auto-detection process, so installed but unused plugins are never loaded.
+ *  Parameters:   hostAbiVersion: the TOLK_PLUGIN_ABI_VERSION Tolk was built with.
+ *  Returns:      A pointer to the driver function table, or NULL if the plugin cannot work with this version of Tolk.
+ */
+typedef const TolkPluginDriver * (TOLK_PLUGIN_CALL *TolkPlugin_GetDriverFunc)(unsigned int hostAbiVersion);
+#define TOLK_PLUGIN_ENTRY_POINT "TolkPlugin_GetDriver"
+
+#ifdef __cplusplus
+} // extern "C"
+#endif // __cplusplus
+
+#endif // _TOLK_PLUGIN_H_
@@ -0,0 +1,94 @@
+/**
+ *  Product:        Tolk
+ *  File:           TolkBridge.cpp
+ *  Description:    Helper process that hosts a screen reader driver for a process of the other bitness.
+ *  Copyright:      (c) 2026, Davy Kager <mail@davykager.nl>
+ *  License:        LGPLv3
+ */
+
+// Started by ScreenReaderDriverBridge, never by users.
+// Usage: TolkBridge32 <driver> <channel name> <client process ID>
+
+#include <windows.h>
+#include <memory>
+#include <string>
+#include "TolkBridge.h"
+#include "ScreenReaderDriverSNova.h"
+
+// Drivers that only exist for this bitness.
+static std::unique_ptr<ScreenReaderDriver> CreateDriver(const wchar_t *name) {
+  if (_wcsicmp(name, L"SNova") == 0) return std::make_unique<ScreenReaderDriverSNova>();
+  return nullptr;
+}
+
+static bool Dispatch(ScreenReaderDriver *driver, TolkBridgeChannel *channel, std::wstring &text) {
+  const LONG length = (channel->length >= 0 && channel->length < TOLK_BRIDGE_MAX_TEXT) ? channel->length : 0;
+  // Long text arrives in pieces, the last piece comes with the real operation.
+  text.append(channel->text, length);
+  if (channel->operation == TOLK_BRIDGE_OP_APPEND) return true;
+  const bool interrupt = !!channel->interrupt;
+  bool result = false;
+  switch (channel->operation) {
+  case TOLK_BRIDGE_OP_SPEAK:
+    result = driver->Speak(text.c_str(), interrupt);
+    break;
+  case TOLK_BRIDGE_OP_BRAILLE:
+    result = driver->Braille(text.c_str());
+    break;
+  case TOLK_BRIDGE_OP_OUTPUT:
+    result = driver->Output(text.c_str(), interrupt);
+    break;
+  case TOLK_BRIDGE_OP_SILENCE:
+    result = driver->Silence();
+    break;
+  case TOLK_BRIDGE_OP_IS_SPEAKING:
+    result = driver->IsSpeaking();
+    break;
+  case TOLK_BRIDGE_OP_IS_ACTIVE:
+    result = driver->IsActive();
+    break;
+  }
+  text.clear();
+  return result;
+}
+
+int wmain(int argc, wchar_t *argv[]) {
+  if (argc != 4) return 1;
+  const std::wstring base(argv[2]);
+  const HANDLE client = OpenProcess(SYNCHRONIZE, FALSE, wcstoul(argv[3], nullptr, 10));
+  const HANDLE mapping = OpenFileMappingW(FILE_MAP_ALL_ACCESS, FALSE, base.c_str());
+  TolkBridgeChannel *channel = mapping ? (TolkBridgeChannel *)MapViewOfFile(mapping, FILE_MAP_ALL_ACCESS, 0, 0, sizeof(TolkBridgeChannel)) : nullptr;
+  const HANDLE requestEvent = OpenEventW(SYNCHRONIZE, FALSE, (base + L"-Request").c_str());
+  const HANDLE responseEvent = OpenEventW(EVENT_MODIFY_STATE, FALSE, (base + L"-Response").c_str());
+  if (!client || !channel || !requestEvent || !responseEvent || channel->version != TOLK_BRIDGE_VERSION) return 1;
+  const HRESULT hr = CoInitializeEx(nullptr, COINIT_MULTITHREADED);
+  std::unique_ptr<ScreenReaderDriver> driver;
+  try {
+    driver = CreateDriver(argv[1]);
+  }
+  catch (...) {
+  }
+  if (driver) {
+    wcsncpy_s(channel->name, driver->GetName(), _TRUNCATE);
+    channel->hasSpeech = driver->HasSpeech();
+    channel->hasBraille = driver->HasBraille();
+    channel->hasStatus = driver->HasStatus();
+  }
+  channel->result = (driver != nullptr);
+  TolkBridgeSignal(channel, TOLK_BRIDGE_STATE_RESPONSE, &channel->clientWaiting, responseEvent);
+  std::wstring text;
+  // Runs until told to quit or until the client goes away.
+  while (driver && TolkBridgeWait(channel, TOLK_BRIDGE_STATE_REQUEST, &channel->helperWaiting, requestEvent, client, INFINITE)) {
+    if (channel->operation == TOLK_BRIDGE_OP_QUIT) break;
+    channel->result = Dispatch(driver.get(), channel, text);
+    TolkBridgeSignal(channel, TOLK_BRIDGE_STATE_RESPONSE, &channel->clientWaiting, responseEvent);
+  }
+  driver.reset();
+  if (SUCCEEDED(hr)) CoUninitialize();
+  CloseHandle(responseEvent);
+  CloseHandle(requestEvent);
+  UnmapViewOfFile(channel);
+  CloseHandle(mapping);
+  CloseHandle(client);
+  return 0;
+}
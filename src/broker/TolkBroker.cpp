@@ -0,0 +1,245 @@
+/**
+ *  Product:        Tolk
+ *  File:           TolkBroker.cpp
+ *  Description:    Broker process that owns the screen reader drivers for all Tolk clients in a session.
+ *  Copyright:      (c) 2026, Davy Kager <mail@davykager.nl>
+ *  License:        LGPLv3
+ */
+
+// Clients that called Tolk_UseBroker(true) write their requests into the shared
+// memory ring described in TolkBroker.h and signal the wakeup event. The broker
+// drains whatever is pending, orders it by priority and passes it on to Tolk.
+// Usage: TolkBroker [-sapi] [-prefer-sapi]
+
+#include <windows.h>
+#include <algorithm>
+#include <cstdio>
+#include <map>
+#include <string>
+#include <vector>
+#include "Tolk.h"
+#include "TolkBroker.h"
+
+// How often to refresh the published screen reader state while idle or speaking.
+#define BROKER_IDLE_INTERVAL 500
+#define BROKER_SPEAKING_INTERVAL 50
+
+struct BrokerRequest {
+  DWORD processId;
+  LONG priority;
+  LONG operation;
+  bool interrupt;
+  std::wstring text;
+};
+
+static HANDLE g_wakeup = nullptr;
+static volatile LONG g_quit = 0;
+// Text from clients that did not fit in one slot, keyed by process ID.
+static std::map<DWORD, std::wstring> g_partial;
+static ULONGLONG g_partialChecked = 0;
+// Set while the next slot has been claimed by a client but not published yet.
+static bool g_stalled = false;
+static LONG g_stalledPosition = 0;
+static ULONGLONG g_stalledSince = 0;
+// The request that currently holds off interrupts from other clients.
+static DWORD g_holder = 0;
+static LONG g_holderPriority = 0;
+static ULONGLONG g_holdUntil = 0;
+
+static BOOL WINAPI OnConsoleControl(DWORD) {
+  InterlockedExchange(&g_quit, 1);
+  SetEvent(g_wakeup);
+  return TRUE;
+}
+
+// Returns false once nothing more can be taken from the ring.
+static bool Dequeue(TolkBrokerRing *ring, BrokerRequest &request, bool &complete) {
+  // There is only one consumer, so the dequeue position needs no atomics.
+  const LONG position = ring->dequeuePosition;
+  TolkBrokerSlot &slot = ring->slots[position & (TOLK_BROKER_SLOT_COUNT - 1)];
+  complete = false;
+  if (slot.sequence - (position + 1) != 0) {
+    // Claimed but not published yet. The client normally finishes within microseconds,
+    // one that died or hung in between would hold up every other client for good.
+    if (ring->enqueuePosition - position <= 0) return false;
+    const ULONGLONG now = GetTickCount64();
+    if (!g_stalled || g_stalledPosition != position) {
+      g_stalled = true;
+      g_stalledPosition = position;
+      g_stalledSince = now;
+      return false;
+    }
+    if (now - g_stalledSince < TOLK_BROKER_CLAIM_TIMEOUT) return false;
+    // Skipped and handed back, unless the client published it after all.
+    if (InterlockedCompareExchange(&slot.sequence, position + TOLK_BROKER_SLOT_COUNT, position) == position) {
+      ring->dequeuePosition = position + 1;
+      g_stalled = false;
+    }
+    return true;
+  }
+  g_stalled = false;
+  ring->dequeuePosition = position + 1;
+  auto partial = g_partial.find(slot.processId);
+  if (slot.flags & TOLK_BROKER_FLAG_FIRST) {
+    // A client that failed to queue all of a request leaves the start of it behind.
+    if (partial == g_partial.end()) partial = g_partial.emplace(slot.processId, std::wstring()).first;
+    else partial->second.clear();
+  }
+  // The rest of a request whose start was dropped is dropped as well.
+  if (partial != g_partial.end()) {
+    std::wstring &text = partial->second;
+    const LONG length = std::min<LONG>(std::max<LONG>(slot.length, 0), TOLK_BROKER_SLOT_TEXT - 1);
+    text.append(slot.text, length);
+    complete = !(slot.flags & TOLK_BROKER_FLAG_MORE);
+  }
+  if (complete) {
+    std::wstring &text = partial->second;
+    request.processId = slot.processId;
+    request.priority = slot.priority;
+    request.operation = slot.operation;
+    request.interrupt = !!(slot.flags & TOLK_BROKER_FLAG_INTERRUPT);
+    request.text.swap(text);
+    g_partial.erase(partial);
+  }
+  // Hands the slot back to the producers.
+  InterlockedExchange(&slot.sequence, position + TOLK_BROKER_SLOT_COUNT);
+  return true;
+}
+
+// Drops the text of clients that exited before sending the rest of it.
+static void DropExitedClients(ULONGLONG now) {
+  if (g_partial.empty() || now - g_partialChecked < BROKER_IDLE_INTERVAL) return;
+  g_partialChecked = now;
+  for (auto it = g_partial.begin(); it != g_partial.end();) {
+    const HANDLE process = OpenProcess(SYNCHRONIZE, FALSE, it->first);
+    // Access may be denied to a process that is running just fine.
+    const bool exited = process ? (WaitForSingleObject(process, 0) == WAIT_OBJECT_0) : (GetLastError() == ERROR_INVALID_PARAMETER);
+    if (process) CloseHandle(process);
+    if (exited) it = g_partial.erase(it);
+    else ++it;
+  }
+}
+
+static bool MayInterrupt(const BrokerRequest &request, ULONGLONG now) {
+  if (!request.interrupt) return true;
+  return (request.processId == g_holder || request.priority >= g_holderPriority || now >= g_holdUntil);
+}
+
+static void Hold(const BrokerRequest &request, ULONGLONG now) {
+  // Roughly as long as it takes to speak the text, we have no better estimate here.
+  const ULONGLONG duration = std::min<ULONGLONG>(5000, 500 + 60 * request.text.size());
+  if (request.processId == g_holder || request.priority >= g_holderPriority || now >= g_holdUntil) {
+    g_holder = request.processId;
+    g_holderPriority = request.priority;
+    g_holdUntil = now + duration;
+  }
+}
+
+static void Deliver(const BrokerRequest &request) {
+  const ULONGLONG now = GetTickCount64();
+  // Lower priority clients may queue behind, but not cut off, more important speech.
+  const bool interrupt = request.interrupt && MayInterrupt(request, now);
+  switch (request.operation) {
+  case TOLK_BROKER_OP_OUTPUT:
+    Tolk_Output(request.text.c_str(), interrupt);
+    Hold(request, now);
+    break;
+  case TOLK_BROKER_OP_SPEAK:
+    Tolk_Speak(request.text.c_str(), interrupt);
+    Hold(request, now);
+    break;
+  case TOLK_BROKER_OP_BRAILLE:
+    Tolk_Braille(request.text.c_str());
+    break;
+  case TOLK_BROKER_OP_SILENCE:
+    if (interrupt) Tolk_Silence();
+    break;
+  }
+}
+
+static void Publish(TolkBrokerRing *ring) {
+  const wchar_t *name = Tolk_DetectScreenReader();
+  ring->hasSpeech = Tolk_HasSpeech();
+  ring->hasBraille = Tolk_HasBraille();
+  ring->speaking = Tolk_IsSpeaking();
+  if (name && wcsncmp(name, ring->name, TOLK_BROKER_MAX_NAME) != 0) {
+    // Odd while writing, see ScreenReaderDriverBroker::UpdateDescription.
+    InterlockedIncrement(&ring->nameSerial);
+    wcsncpy_s(ring->name, name, _TRUNCATE);
+    InterlockedIncrement(&ring->nameSerial);
+  }
+  ring->active = (name != nullptr);
+}
+
+int wmain(int argc, wchar_t *argv[]) {
+  for (int i = 1; i < argc; ++i) {
+    if (_wcsicmp(argv[i], L"-sapi") == 0) {
+      Tolk_TrySAPI(true);
+    }
+    else if (_wcsicmp(argv[i], L"-prefer-sapi") == 0) {
+      Tolk_TrySAPI(true);
+      Tolk_PreferSAPI(true);
+    }
+    else {
+      fwprintf_s(stderr, L"Usage: TolkBroker [-sapi] [-prefer-sapi]\n");
+      return 1;
+    }
+  }
+  HANDLE mapping = CreateFileMappingW(INVALID_HANDLE_VALUE, nullptr, PAGE_READWRITE, 0, sizeof(TolkBrokerRing), TOLK_BROKER_MAPPING_NAME);
+  if (!mapping) {
+    fwprintf_s(stderr, L"TolkBroker: failed to create shared memory\n");
+    return 1;
+  }
+  if (GetLastError() == ERROR_ALREADY_EXISTS) {
+    fwprintf_s(stderr, L"TolkBroker: another broker is already running in this session\n");
+    CloseHandle(mapping);
+    return 1;
+  }
+  TolkBrokerRing *ring = (TolkBrokerRing *)MapViewOfFile(mapping, FILE_MAP_ALL_ACCESS, 0, 0, sizeof(TolkBrokerRing));
+  if (!ring) {
+    CloseHandle(mapping);
+    return 1;
+  }
+  // New mappings are zero-filled, only the sequence numbers need setting up.
+  for (LONG i = 0; i < TOLK_BROKER_SLOT_COUNT; ++i)
+    ring->slots[i].sequence = i;
+  ring->brokerProcessId = GetCurrentProcessId();
+  ring->version = TOLK_BROKER_VERSION;
+  Tolk_Load();
+  Publish(ring);
+  // Clients only connect once this exists, so the ring is ready by then.
+  g_wakeup = CreateEventW(nullptr, FALSE, FALSE, TOLK_BROKER_WAKEUP_NAME);
+  if (!g_wakeup) {
+    Tolk_Unload();
+    UnmapViewOfFile(ring);
+    CloseHandle(mapping);
+    return 1;
+  }
+  SetConsoleCtrlHandler(OnConsoleControl, TRUE);
+  std::vector<BrokerRequest> pending;
+  while (!g_quit) {
+    // A stalled slot is looked at again soon, the clients behind it are waiting.
+    WaitForSingleObject(g_wakeup, (ring->speaking || g_stalled) ? BROKER_SPEAKING_INTERVAL : BROKER_IDLE_INTERVAL);
+    BrokerRequest request;
+    bool complete = false;
+    while (Dequeue(ring, request, complete)) {
+      if (complete) pending.push_back(std::move(request));
+    }
+    DropExitedClients(GetTickCount64());
+    if (!pending.empty()) {
+      // Stable, so requests of equal priority keep their submission order.
+      std::stable_sort(pending.begin(), pending.end(), [](const BrokerRequest &a, const BrokerRequest &b) { return a.priority > b.priority; });
+      for (const BrokerRequest &item : pending)
+        Deliver(item);
+      pending.clear();
+    }
+    Publish(ring);
+  }
+  SetConsoleCtrlHandler(OnConsoleControl, FALSE);
+  ring->active = 0;
+  Tolk_Unload();
+  CloseHandle(g_wakeup);
+  UnmapViewOfFile(ring);
+  CloseHandle(mapping);
+  return 0;
+}
@@ -7,6 +7,7 @@
  */
 
 using System;
+using System.Collections.Generic;
 using System.Runtime.InteropServices;
 
 namespace DavyKager {
@@ -25,6 +26,113 @@ namespace DavyKager {
     [DllImport("Tolk.dll", CharSet=CharSet.Unicode, CallingConvention=CallingConvention.Cdecl, SetLastError=true)]
       private static extern void Tolk_PreferSAPI(
         [MarshalAs(UnmanagedType.I1)]bool preferSAPI);
+    [DllImport("Tolk.dll", CharSet=CharSet.Unicode, CallingConvention=CallingConvention.Cdecl, SetLastError=true)]
+      private static extern void Tolk_SetPluginDirectory(
+        [MarshalAs(UnmanagedType.LPWStr)]String path);
+    [DllImport("Tolk.dll", CharSet=CharSet.Unicode, CallingConvention=CallingConvention.Cdecl, SetLastError=true)]
+      private static extern void Tolk_UseBroker(
+        [MarshalAs(UnmanagedType.I1)]bool useBroker);
+    [DllImport("Tolk.dll", CharSet=CharSet.Unicode, CallingConvention=CallingConvention.Cdecl, SetLastError=true)]
+      private static extern void Tolk_SetBrokerPriority(int priority);
+    [DllImport("Tolk.dll", CharSet=CharSet.Unicode, CallingConvention=CallingConvention.Cdecl, SetLastError=true)]
+      private static extern void Tolk_SetDriverTimeout(uint milliseconds);
+    [DllImport("Tolk.dll", CharSet=CharSet.Unicode, CallingConvention=CallingConvention.Cdecl, SetLastError=true)]
+      private static extern void Tolk_SetCircuitBreaker(uint failureThreshold, uint backoffMilliseconds, uint maxBackoffMilliseconds);
+    [DllImport("Tolk.dll", CharSet=CharSet.Unicode, CallingConvention=CallingConvention.Cdecl, SetLastError=true)]
+      [return: MarshalAs(UnmanagedType.I1)]
+      private static extern bool Tolk_GetDriverStats(
+        [MarshalAs(UnmanagedType.LPWStr)]String name,
+        out uint calls, out uint failures, out uint trips, out uint rejected);
+    [DllImport("Tolk.dll", CharSet=CharSet.Unicode, CallingConvention=CallingConvention.Cdecl, SetLastError=true)]
+      private static extern void Tolk_SetFailover(
+        [MarshalAs(UnmanagedType.I1)]bool failover, uint budgetMilliseconds);
+    [DllImport("Tolk.dll", CharSet=CharSet.Unicode, CallingConvention=CallingConvention.Cdecl, SetLastError=true)]
+      private static extern void Tolk_SetHedging(uint budgetMilliseconds,
+        [MarshalAs(UnmanagedType.LPWStr)]String secondary);
+    [DllImport("Tolk.dll", CharSet=CharSet.Unicode, CallingConvention=CallingConvention.Cdecl, SetLastError=true)]
+      private static extern void Tolk_SetTextNormalization(
+        [MarshalAs(UnmanagedType.I1)]bool normalize);
+    [DllImport("Tolk.dll", CharSet=CharSet.Unicode, CallingConvention=CallingConvention.Cdecl, SetLastError=true)]
+      [return: MarshalAs(UnmanagedType.I1)]
+      private static extern bool Tolk_SetSymbolNames(String language);
+    [DllImport("Tolk.dll", CharSet=CharSet.Unicode, CallingConvention=CallingConvention.Cdecl, SetLastError=true)]
+      [return: MarshalAs(UnmanagedType.I1)]
+      private static extern bool Tolk_LoadDictionary(String path);
+    [DllImport("Tolk.dll", CharSet=CharSet.Unicode, CallingConvention=CallingConvention.Cdecl, SetLastError=true)]
+      private static extern void Tolk_SetDictionaryForBraille(
+        [MarshalAs(UnmanagedType.I1)]bool braille);
+    [DllImport("Tolk.dll", CharSet=CharSet.Unicode, CallingConvention=CallingConvention.Cdecl, SetLastError=true)]
+      private static extern void Tolk_SetDuplicateWindow(uint milliseconds);
+    [DllImport("Tolk.dll", CharSet=CharSet.Unicode, CallingConvention=CallingConvention.Cdecl, SetLastError=true)]
+      private static extern void Tolk_GetDuplicateStats(out uint speech, out uint braille);
+    [DllImport("Tolk.dll", CharSet=CharSet.Unicode, CallingConvention=CallingConvention.Cdecl, SetLastError=true)]
+      private static extern void Tolk_WatchScreenReaders(
+        [MarshalAs(UnmanagedType.I1)]bool watch);
+    [UnmanagedFunctionPointer(CallingConvention.Cdecl)]
+      private delegate void ScreenReaderChangedCallback(IntPtr name, IntPtr userData);
+    [DllImport("Tolk.dll", CharSet=CharSet.Unicode, CallingConvention=CallingConvention.Cdecl, SetLastError=true)]
+      private static extern void Tolk_SetScreenReaderChangedCallback(ScreenReaderChangedCallback callback, IntPtr userData);
+    [DllImport("Tolk.dll", CharSet=CharSet.Unicode, CallingConvention=CallingConvention.Cdecl, SetLastError=true)]
+      private static extern void Tolk_SetSpeechRate(uint wordsPerMinute);
+    [DllImport("Tolk.dll", CharSet=CharSet.Unicode, CallingConvention=CallingConvention.Cdecl, SetLastError=true)]
+      private static extern void Tolk_SetLongTextThreshold(uint characters);
+    [DllImport("Tolk.dll", CharSet=CharSet.Unicode, CallingConvention=CallingConvention.Cdecl, SetLastError=true)]
+      [return: MarshalAs(UnmanagedType.I1)]
+      private static extern bool Tolk_ReadDocument(String path, ulong position);
+    [DllImport("Tolk.dll", CharSet=CharSet.Unicode, CallingConvention=CallingConvention.Cdecl, SetLastError=true)]
+      [return: MarshalAs(UnmanagedType.I1)]
+      private static extern bool Tolk_ReadDocumentBuffer(byte[] data, uint size, ulong position);
+    [DllImport("Tolk.dll", CharSet=CharSet.Unicode, CallingConvention=CallingConvention.Cdecl, SetLastError=true)]
+      [return: MarshalAs(UnmanagedType.I1)]
+      private static extern bool Tolk_PauseDocument();
+    [DllImport("Tolk.dll", CharSet=CharSet.Unicode, CallingConvention=CallingConvention.Cdecl, SetLastError=true)]
+      [return: MarshalAs(UnmanagedType.I1)]
+      private static extern bool Tolk_ResumeDocument();
+    [DllImport("Tolk.dll", CharSet=CharSet.Unicode, CallingConvention=CallingConvention.Cdecl, SetLastError=true)]
+      [return: MarshalAs(UnmanagedType.I1)]
+      private static extern bool Tolk_SkipDocument(int unit);
+    [DllImport("Tolk.dll", CharSet=CharSet.Unicode, CallingConvention=CallingConvention.Cdecl, SetLastError=true)]
+      [return: MarshalAs(UnmanagedType.I1)]
+      private static extern bool Tolk_GetDocumentPosition(out ulong position, out ulong size);
+    [DllImport("Tolk.dll", CharSet=CharSet.Unicode, CallingConvention=CallingConvention.Cdecl, SetLastError=true)]
+      private static extern void Tolk_StopDocument();
+    [DllImport("Tolk.dll", CharSet=CharSet.Unicode, CallingConvention=CallingConvention.Cdecl, SetLastError=true)]
+      [return: MarshalAs(UnmanagedType.I1)]
+      private static extern bool Tolk_WaitForSpeechEnd(uint milliseconds);
+    [DllImport("Tolk.dll", CharSet=CharSet.Unicode, CallingConvention=CallingConvention.Cdecl, SetLastError=true)]
+      private static extern IntPtr Tolk_GetSpeechEventHandle();
+    [UnmanagedFunctionPointer(CallingConvention.Cdecl)]
+      private delegate void SpeechProgressCallback(int speechEvent, uint position, uint length, IntPtr userData);
+    [DllImport("Tolk.dll", CharSet=CharSet.Unicode, CallingConvention=CallingConvention.Cdecl, SetLastError=true)]
+      private static extern void Tolk_SetSpeechProgressCallback(SpeechProgressCallback callback, IntPtr userData);
+    [UnmanagedFunctionPointer(CallingConvention.Cdecl)]
+      private delegate void MarkCallback(uint mark, IntPtr userData);
+    [DllImport("Tolk.dll", CharSet=CharSet.Unicode, CallingConvention=CallingConvention.Cdecl, SetLastError=true)]
+      [return: MarshalAs(UnmanagedType.I1)]
+      private static extern bool Tolk_SpeakWithMarks(
+        [MarshalAs(UnmanagedType.LPWStr)]String str,
+        uint[] marks,
+        uint count,
+        [MarshalAs(UnmanagedType.I1)]bool interrupt,
+        MarkCallback callback,
+        IntPtr userData);
+    [UnmanagedFunctionPointer(CallingConvention.Cdecl)]
+      [return: MarshalAs(UnmanagedType.I1)]
+      private delegate bool AudioCallback(IntPtr data, uint size, IntPtr userData);
+    [DllImport("Tolk.dll", CharSet=CharSet.Unicode, CallingConvention=CallingConvention.Cdecl, SetLastError=true)]
+      [return: MarshalAs(UnmanagedType.I1)]
+      private static extern bool Tolk_Synthesize(String str, uint samplesPerSecond, uint bitsPerSample, uint channels, AudioCallback callback, IntPtr userData);
+    [DllImport("Tolk.dll", CharSet=CharSet.Unicode, CallingConvention=CallingConvention.Cdecl, SetLastError=true)]
+      [return: MarshalAs(UnmanagedType.I1)]
+      private static extern bool Tolk_SetPhraseCache(String path, uint maxKilobytes);
+    [DllImport("Tolk.dll", CharSet=CharSet.Unicode, CallingConvention=CallingConvention.Cdecl, SetLastError=true)]
+      [return: MarshalAs(UnmanagedType.I1)]
+      private static extern bool Tolk_PrefetchPhrases([MarshalAs(UnmanagedType.LPArray, ArraySubType=UnmanagedType.LPWStr)] String[] phrases, uint count);
+    [DllImport("Tolk.dll", CharSet=CharSet.Unicode, CallingConvention=CallingConvention.Cdecl, SetLastError=true)]
+      [return: MarshalAs(UnmanagedType.I1)]
+      private static extern bool Tolk_GetPhraseCacheStats(out uint hits, out uint misses);
+    [DllImport("Tolk.dll", CharSet=CharSet.Unicode, CallingConvention=CallingConvention.Cdecl, SetLastError=true)]
+      private static extern IntPtr Tolk_GetLastOutputDriver();
     [DllImport("Tolk.dll", CharSet=CharSet.Unicode, CallingConvention=CallingConvention.Cdecl, SetLastError=true)]
       private static extern IntPtr Tolk_DetectScreenReader();
     [DllImport("Tolk.dll", CharSet=CharSet.Unicode, CallingConvention=CallingConvention.Cdecl, SetLastError=true)]
@@ -43,13 +151,41 @@ namespace DavyKager {
       private static extern bool Tolk_Speak(
         [MarshalAs(UnmanagedType.LPWStr)]String str,
         [MarshalAs(UnmanagedType.I1)]bool interrupt);
+    [DllImport("Tolk.dll", CharSet=CharSet.Unicode, CallingConvention=CallingConvention.Cdecl, SetLastError=true)]
+      [return: MarshalAs(UnmanagedType.I1)]
+      private static extern bool Tolk_OutputDiff(
+        [MarshalAs(UnmanagedType.LPWStr)]String key,
+        [MarshalAs(UnmanagedType.LPWStr)]String str,
+        [MarshalAs(UnmanagedType.I1)]bool interrupt);
+    [DllImport("Tolk.dll", CharSet=CharSet.Unicode, CallingConvention=CallingConvention.Cdecl, SetLastError=true)]
+      [return: MarshalAs(UnmanagedType.I1)]
+      private static extern bool Tolk_SpeakMarkup(
+        [MarshalAs(UnmanagedType.LPWStr)]String markup,
+        [MarshalAs(UnmanagedType.I1)]bool interrupt);
     [DllImport("Tolk.dll", CharSet=CharSet.Unicode, CallingConvention=CallingConvention.Cdecl, SetLastError=true)]
       [return: MarshalAs(UnmanagedType.I1)]
       private static extern bool Tolk_Braille(
         [MarshalAs(UnmanagedType.LPWStr)]String str);
+    [DllImport("Tolk.dll", CharSet=CharSet.Unicode, CallingConvention=CallingConvention.Cdecl, SetLastError=true)]
+      private static extern void Tolk_SetBraillePaging(
+        [MarshalAs(UnmanagedType.I1)]bool paging);
+    [DllImport("Tolk.dll", CharSet=CharSet.Unicode, CallingConvention=CallingConvention.Cdecl, SetLastError=true)]
+      private static extern void Tolk_SetBrailleWidth(uint cells);
+    [DllImport("Tolk.dll", CharSet=CharSet.Unicode, CallingConvention=CallingConvention.Cdecl, SetLastError=true)]
+      [return: MarshalAs(UnmanagedType.I1)]
+      private static extern bool Tolk_PanBrailleForward();
+    [DllImport("Tolk.dll", CharSet=CharSet.Unicode, CallingConvention=CallingConvention.Cdecl, SetLastError=true)]
+      [return: MarshalAs(UnmanagedType.I1)]
+      private static extern bool Tolk_PanBrailleBack();
+    [DllImport("Tolk.dll", CharSet=CharSet.Unicode, CallingConvention=CallingConvention.Cdecl, SetLastError=true)]
+      [return: MarshalAs(UnmanagedType.I1)]
+      private static extern bool Tolk_GetBraillePage(out uint page, out uint count);
     [DllImport("Tolk.dll", CharSet=CharSet.Unicode, CallingConvention=CallingConvention.Cdecl, SetLastError=true)]
       [return: MarshalAs(UnmanagedType.I1)]
       private static extern bool Tolk_IsSpeaking();
+    [DllImport("Tolk.dll", CharSet=CharSet.Unicode, CallingConvention=CallingConvention.Cdecl, SetLastError=true)]
+      [return: MarshalAs(UnmanagedType.I1)]
+      private static extern bool Tolk_GetQueuedUtterances(out uint count);
     [DllImport("Tolk.dll", CharSet=CharSet.Unicode, CallingConvention=CallingConvention.Cdecl, SetLastError=true)]
       [return: MarshalAs(UnmanagedType.I1)]
       private static extern bool Tolk_Silence();
@@ -62,14 +198,110 @@ namespace DavyKager {
     public static void Unload() { Tolk_Unload(); }
     public static void TrySAPI(bool trySAPI) { Tolk_TrySAPI(trySAPI); }
     public static void PreferSAPI(bool preferSAPI) { Tolk_PreferSAPI(preferSAPI); }
+    public static void SetPluginDirectory(String path) { Tolk_SetPluginDirectory(path); }
+    public static void UseBroker(bool useBroker) { Tolk_UseBroker(useBroker); }
+    public static void SetBrokerPriority(int priority) { Tolk_SetBrokerPriority(priority); }
+    public static void SetDriverTimeout(uint milliseconds) { Tolk_SetDriverTimeout(milliseconds); }
+    public static void SetCircuitBreaker(uint failureThreshold, uint backoffMilliseconds, uint maxBackoffMilliseconds) { Tolk_SetCircuitBreaker(failureThreshold, backoffMilliseconds, maxBackoffMilliseconds); }
+    public static bool GetDriverStats(String name, out uint calls, out uint failures, out uint trips, out uint rejected) { return Tolk_GetDriverStats(name, out calls, out failures, out trips, out rejected); }
     // Prevent the marshaller from freeing the unmanaged string
+    public static void SetFailover(bool failover, uint budgetMilliseconds) { Tolk_SetFailover(failover, budgetMilliseconds); }
+    public static void SetHedging(uint budgetMilliseconds, String secondary) { Tolk_SetHedging(budgetMilliseconds, secondary); }
+    public static void SetTextNormalization(bool normalize) { Tolk_SetTextNormalization(normalize); }
+    public static bool SetSymbolNames(String language) { return Tolk_SetSymbolNames(language); }
+    public static bool LoadDictionary(String path) { return Tolk_LoadDictionary(path); }
+    public static void SetDictionaryForBraille(bool braille) { Tolk_SetDictionaryForBraille(braille); }
+    public static void SetDuplicateWindow(uint milliseconds) { Tolk_SetDuplicateWindow(milliseconds); }
+    public static void GetDuplicateStats(out uint speech, out uint braille) { Tolk_GetDuplicateStats(out speech, out braille); }
+    public static void WatchScreenReaders(bool watch) { Tolk_WatchScreenReaders(watch); }
+    public delegate void ScreenReaderChangedHandler(String name);
+    // Referenced here so the garbage collector leaves it alone while Tolk holds on to it.
+    private static ScreenReaderChangedCallback screenReaderChanged;
+    public static void SetScreenReaderChangedCallback(ScreenReaderChangedHandler handler) {
+      ScreenReaderChangedCallback callback = null;
+      if (handler != null) callback = (name, userData) => handler(Marshal.PtrToStringUni(name));
+      Tolk_SetScreenReaderChangedCallback(callback, IntPtr.Zero);
+      screenReaderChanged = callback;
+    }
+    public static void SetSpeechRate(uint wordsPerMinute) { Tolk_SetSpeechRate(wordsPerMinute); }
+    public static void SetLongTextThreshold(uint characters) { Tolk_SetLongTextThreshold(characters); }
+    public const int DocumentSentence = 0;
+    public const int DocumentParagraph = 1;
+    public static bool ReadDocument(String path, ulong position = 0) { return Tolk_ReadDocument(path, position); }
+    public static bool ReadDocumentBuffer(byte[] data, ulong position = 0) { return Tolk_ReadDocumentBuffer(data, (uint)data.Length, position); }
+    public static bool PauseDocument() { return Tolk_PauseDocument(); }
+    public static bool ResumeDocument() { return Tolk_ResumeDocument(); }
+    public static bool SkipDocument(int unit) { return Tolk_SkipDocument(unit); }
+    public static bool GetDocumentPosition(out ulong position, out ulong size) { return Tolk_GetDocumentPosition(out position, out size); }
+    public static void StopDocument() { Tolk_StopDocument(); }
+    public const uint WaitInfinite = 0xFFFFFFFF;
+    public static bool WaitForSpeechEnd(uint milliseconds) { return Tolk_WaitForSpeechEnd(milliseconds); }
+    public static IntPtr GetSpeechEventHandle() { return Tolk_GetSpeechEventHandle(); }
+    public const int SpeechStarted = 0;
+    public const int SpeechWord = 1;
+    public const int SpeechBookmark = 2;
+    public const int SpeechFinished = 3;
+    public delegate void SpeechProgressHandler(int speechEvent, uint position, uint length);
+    // Referenced here so the garbage collector leaves it alone while Tolk holds on to it.
+    private static SpeechProgressCallback speechProgress;
+    public static void SetSpeechProgressCallback(SpeechProgressHandler handler) {
+      SpeechProgressCallback callback = null;
+      if (handler != null) callback = (speechEvent, position, length, userData) => handler(speechEvent, position, length);
+      Tolk_SetSpeechProgressCallback(callback, IntPtr.Zero);
+      speechProgress = callback;
+    }
+    public delegate void MarkHandler(uint mark);
+    // One callback serves every call, the user data tells which handler a mark is for.
+    private static readonly MarkCallback markCallback = OnMark;
+    private static readonly Dictionary<IntPtr, Tuple<MarkHandler, uint>> markHandlers = new Dictionary<IntPtr, Tuple<MarkHandler, uint>>();
+    private static int lastMarkCall = 0;
+    private static void OnMark(uint mark, IntPtr userData) {
+      Tuple<MarkHandler, uint> call;
+      lock (markHandlers) {
+        if (!markHandlers.TryGetValue(userData, out call)) return;
+        if (mark == call.Item2) markHandlers.Remove(userData);
+      }
+      call.Item1(mark);
+    }
+    public static bool SpeakWithMarks(String str, uint[] marks, MarkHandler handler, bool interrupt = false) {
+      IntPtr key;
+      lock (markHandlers) {
+        // Marks of earlier calls are never reached once speech is interrupted.
+        if (interrupt) markHandlers.Clear();
+        key = new IntPtr(++lastMarkCall);
+        if (marks.Length > 0) markHandlers[key] = Tuple.Create(handler, (uint)marks.Length - 1);
+      }
+      bool result = Tolk_SpeakWithMarks(str, marks, (uint)marks.Length, interrupt, markCallback, key);
+      if (!result) lock (markHandlers) markHandlers.Remove(key);
+      return result;
+    }
+    // The data is only valid during the call, copy it out with Marshal.Copy to keep it.
+    public delegate bool AudioHandler(IntPtr data, uint size);
+    public static bool Synthesize(String str, uint samplesPerSecond, uint bitsPerSample, uint channels, AudioHandler handler) {
+      AudioCallback callback = (data, size, userData) => handler(data, size);
+      bool result = Tolk_Synthesize(str, samplesPerSecond, bitsPerSample, channels, callback, IntPtr.Zero);
+      GC.KeepAlive(callback);
+      return result;
+    }
+    public static bool SetPhraseCache(String path, uint maxKilobytes) { return Tolk_SetPhraseCache(path, maxKilobytes); }
+    public static bool PrefetchPhrases(String[] phrases) { return Tolk_PrefetchPhrases(phrases, (uint)phrases.Length); }
+    public static bool GetPhraseCacheStats(out uint hits, out uint misses) { return Tolk_GetPhraseCacheStats(out hits, out misses); }
+    public static String GetLastOutputDriver() { return Marshal.PtrToStringUni(Tolk_GetLastOutputDriver()); }
     public static String DetectScreenReader() { return Marshal.PtrToStringUni(Tolk_DetectScreenReader()); }
     public static bool HasSpeech() { return Tolk_HasSpeech(); }
     public static bool HasBraille() { return Tolk_HasBraille(); }
     public static bool Output(String str, bool interrupt = false) { return Tolk_Output(str, interrupt); }
+    public static bool OutputDiff(String key, String str, bool interrupt = false) { return Tolk_OutputDiff(key, str, interrupt); }
     public static bool Speak(String str, bool interrupt = false) { return Tolk_Speak(str, interrupt); }
+    public static bool SpeakMarkup(String markup, bool interrupt = false) { return Tolk_SpeakMarkup(markup, interrupt); }
     public static bool Braille(String str) { return Tolk_Braille(str); }
+    public static void SetBraillePaging(bool paging) { Tolk_SetBraillePaging(paging); }
+    public static void SetBrailleWidth(uint cells) { Tolk_SetBrailleWidth(cells); }
+    public static bool PanBrailleForward() { return Tolk_PanBrailleForward(); }
+    public static bool PanBrailleBack() { return Tolk_PanBrailleBack(); }
+    public static bool GetBraillePage(out uint page, out uint count) { return Tolk_GetBraillePage(out page, out count); }
     public static bool IsSpeaking() { return Tolk_IsSpeaking(); }
+    public static bool GetQueuedUtterances(out uint count) { return Tolk_GetQueuedUtterances(out count); }
     public static bool Silence() { return Tolk_Silence(); }
   }
 }
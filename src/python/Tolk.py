@@ -6,7 +6,7 @@
  #  License:        LGPLv3
  ##
 
-from ctypes import cdll, CFUNCTYPE, c_bool, c_wchar_p
+from ctypes import cdll, string_at, CFUNCTYPE, POINTER, c_bool, c_char_p, c_int, c_uint, c_ulonglong, c_void_p, c_wchar_p
 
 try:
   _tolk = cdll.Tolk
@@ -30,6 +30,214 @@ _proto_prefer_sapi = CFUNCTYPE(None, c_bool)
 _param_prefer_sapi = (1, "prefer_sapi"),
 prefer_sapi = _proto_prefer_sapi(("Tolk_PreferSAPI", _tolk), _param_prefer_sapi)
 
+_proto_set_plugin_directory = CFUNCTYPE(None, c_wchar_p)
+_param_set_plugin_directory = (1, "path"),
+set_plugin_directory = _proto_set_plugin_directory(("Tolk_SetPluginDirectory", _tolk), _param_set_plugin_directory)
+
+_proto_use_broker = CFUNCTYPE(None, c_bool)
+_param_use_broker = (1, "use_broker"),
+use_broker = _proto_use_broker(("Tolk_UseBroker", _tolk), _param_use_broker)
+
+_proto_set_broker_priority = CFUNCTYPE(None, c_int)
+_param_set_broker_priority = (1, "priority"),
+set_broker_priority = _proto_set_broker_priority(("Tolk_SetBrokerPriority", _tolk), _param_set_broker_priority)
+
+_proto_set_driver_timeout = CFUNCTYPE(None, c_uint)
+_param_set_driver_timeout = (1, "milliseconds"),
+set_driver_timeout = _proto_set_driver_timeout(("Tolk_SetDriverTimeout", _tolk), _param_set_driver_timeout)
+
+_proto_set_circuit_breaker = CFUNCTYPE(None, c_uint, c_uint, c_uint)
+_param_set_circuit_breaker = (1, "failure_threshold"), (1, "backoff_milliseconds"), (1, "max_backoff_milliseconds")
+set_circuit_breaker = _proto_set_circuit_breaker(("Tolk_SetCircuitBreaker", _tolk), _param_set_circuit_breaker)
+
+# Returns (calls, failures, trips, rejected).
+_proto_get_driver_stats = CFUNCTYPE(c_bool, c_wchar_p, POINTER(c_uint), POINTER(c_uint), POINTER(c_uint), POINTER(c_uint))
+_param_get_driver_stats = (1, "name"), (2, "calls"), (2, "failures"), (2, "trips"), (2, "rejected")
+get_driver_stats = _proto_get_driver_stats(("Tolk_GetDriverStats", _tolk), _param_get_driver_stats)
+
+_proto_set_failover = CFUNCTYPE(None, c_bool, c_uint)
+_param_set_failover = (1, "failover"), (1, "budget_milliseconds")
+set_failover = _proto_set_failover(("Tolk_SetFailover", _tolk), _param_set_failover)
+
+_proto_set_hedging = CFUNCTYPE(None, c_uint, c_wchar_p)
+_param_set_hedging = (1, "budget_milliseconds"), (1, "secondary")
+set_hedging = _proto_set_hedging(("Tolk_SetHedging", _tolk), _param_set_hedging)
+
+_proto_set_text_normalization = CFUNCTYPE(None, c_bool)
+_param_set_text_normalization = (1, "normalize"),
+set_text_normalization = _proto_set_text_normalization(("Tolk_SetTextNormalization", _tolk), _param_set_text_normalization)
+
+_proto_set_symbol_names = CFUNCTYPE(c_bool, c_wchar_p)
+_param_set_symbol_names = (1, "language"),
+set_symbol_names = _proto_set_symbol_names(("Tolk_SetSymbolNames", _tolk), _param_set_symbol_names)
+
+_proto_load_dictionary = CFUNCTYPE(c_bool, c_wchar_p)
+_param_load_dictionary = (1, "path"),
+load_dictionary = _proto_load_dictionary(("Tolk_LoadDictionary", _tolk), _param_load_dictionary)
+
+_proto_set_dictionary_for_braille = CFUNCTYPE(None, c_bool)
+_param_set_dictionary_for_braille = (1, "braille"),
+set_dictionary_for_braille = _proto_set_dictionary_for_braille(("Tolk_SetDictionaryForBraille", _tolk), _param_set_dictionary_for_braille)
+
+_proto_set_duplicate_window = CFUNCTYPE(None, c_uint)
+_param_set_duplicate_window = (1, "milliseconds"),
+set_duplicate_window = _proto_set_duplicate_window(("Tolk_SetDuplicateWindow", _tolk), _param_set_duplicate_window)
+
+# Returns (speech, braille).
+_proto_get_duplicate_stats = CFUNCTYPE(None, POINTER(c_uint), POINTER(c_uint))
+_param_get_duplicate_stats = (2, "speech"), (2, "braille")
+get_duplicate_stats = _proto_get_duplicate_stats(("Tolk_GetDuplicateStats", _tolk), _param_get_duplicate_stats)
+
+_proto_watch_screen_readers = CFUNCTYPE(None, c_bool)
+_param_watch_screen_readers = (1, "watch"),
+watch_screen_readers = _proto_watch_screen_readers(("Tolk_WatchScreenReaders", _tolk), _param_watch_screen_readers)
+
+# Callback type, called with the name of the new screen reader (or None) and the user data.
+screen_reader_changed_callback = CFUNCTYPE(None, c_wchar_p, c_void_p)
+_proto_set_screen_reader_changed_callback = CFUNCTYPE(None, screen_reader_changed_callback, c_void_p)
+_param_set_screen_reader_changed_callback = (1, "callback"), (1, "user_data")
+_set_screen_reader_changed_callback = _proto_set_screen_reader_changed_callback(("Tolk_SetScreenReaderChangedCallback", _tolk), _param_set_screen_reader_changed_callback)
+_screen_reader_changed = None
+
+# Takes a Python function receiving the name, or None to stop being notified.
+def set_screen_reader_changed_callback(callback):
+  global _screen_reader_changed
+  wrapped = screen_reader_changed_callback(lambda name, user_data: callback(name)) if callback else screen_reader_changed_callback()
+  _set_screen_reader_changed_callback(wrapped, None)
+  _screen_reader_changed = wrapped
+
+_proto_set_speech_rate = CFUNCTYPE(None, c_uint)
+_param_set_speech_rate = (1, "words_per_minute"),
+set_speech_rate = _proto_set_speech_rate(("Tolk_SetSpeechRate", _tolk), _param_set_speech_rate)
+
+_proto_set_long_text_threshold = CFUNCTYPE(None, c_uint)
+_param_set_long_text_threshold = (1, "characters"),
+set_long_text_threshold = _proto_set_long_text_threshold(("Tolk_SetLongTextThreshold", _tolk), _param_set_long_text_threshold)
+
+DOCUMENT_SENTENCE = 0
+DOCUMENT_PARAGRAPH = 1
+
+_proto_read_document = CFUNCTYPE(c_bool, c_wchar_p, c_ulonglong)
+_param_read_document = (1, "path"), (1, "position", 0)
+read_document = _proto_read_document(("Tolk_ReadDocument", _tolk), _param_read_document)
+
+_proto_read_document_buffer = CFUNCTYPE(c_bool, c_char_p, c_uint, c_ulonglong)
+_read_document_buffer = _proto_read_document_buffer(("Tolk_ReadDocumentBuffer", _tolk))
+
+def read_document_buffer(data, position=0):
+  return _read_document_buffer(data, len(data), position)
+
+_proto_pause_document = CFUNCTYPE(c_bool)
+pause_document = _proto_pause_document(("Tolk_PauseDocument", _tolk))
+
+_proto_resume_document = CFUNCTYPE(c_bool)
+resume_document = _proto_resume_document(("Tolk_ResumeDocument", _tolk))
+
+_proto_skip_document = CFUNCTYPE(c_bool, c_int)
+_param_skip_document = (1, "unit"),
+skip_document = _proto_skip_document(("Tolk_SkipDocument", _tolk), _param_skip_document)
+
+# Returns (position, size).
+_proto_get_document_position = CFUNCTYPE(c_bool, POINTER(c_ulonglong), POINTER(c_ulonglong))
+_param_get_document_position = (2, "position"), (2, "size")
+get_document_position = _proto_get_document_position(("Tolk_GetDocumentPosition", _tolk), _param_get_document_position)
+
+_proto_stop_document = CFUNCTYPE(None)
+stop_document = _proto_stop_document(("Tolk_StopDocument", _tolk))
+
+WAIT_INFINITE = 0xFFFFFFFF
+
+_proto_wait_for_speech_end = CFUNCTYPE(c_bool, c_uint)
+_param_wait_for_speech_end = (1, "milliseconds"),
+wait_for_speech_end = _proto_wait_for_speech_end(("Tolk_WaitForSpeechEnd", _tolk), _param_wait_for_speech_end)
+
+_proto_get_speech_event_handle = CFUNCTYPE(c_void_p)
+get_speech_event_handle = _proto_get_speech_event_handle(("Tolk_GetSpeechEventHandle", _tolk))
+
+SPEECH_STARTED = 0
+SPEECH_WORD = 1
+SPEECH_BOOKMARK = 2
+SPEECH_FINISHED = 3
+
+# Callback type, called with the event, position, length and the user data.
+speech_progress_callback = CFUNCTYPE(None, c_int, c_uint, c_uint, c_void_p)
+_proto_set_speech_progress_callback = CFUNCTYPE(None, speech_progress_callback, c_void_p)
+_param_set_speech_progress_callback = (1, "callback"), (1, "user_data")
+_set_speech_progress_callback = _proto_set_speech_progress_callback(("Tolk_SetSpeechProgressCallback", _tolk), _param_set_speech_progress_callback)
+_speech_progress = None
+
+# Takes a Python function receiving the event, position and length, or None to stop being notified.
+def set_speech_progress_callback(callback):
+  global _speech_progress
+  wrapped = speech_progress_callback(lambda event, position, length, user_data: callback(event, position, length)) if callback else speech_progress_callback()
+  _set_speech_progress_callback(wrapped, None)
+  _speech_progress = wrapped
+
+# Callback type, called with the index of the mark and the user data.
+mark_callback = CFUNCTYPE(None, c_uint, c_void_p)
+_proto_speak_with_marks = CFUNCTYPE(c_bool, c_wchar_p, POINTER(c_uint), c_uint, c_bool, mark_callback, c_void_p)
+_param_speak_with_marks = (1, "str"), (1, "marks"), (1, "count"), (1, "interrupt"), (1, "callback"), (1, "user_data")
+_speak_with_marks = _proto_speak_with_marks(("Tolk_SpeakWithMarks", _tolk), _param_speak_with_marks)
+# Python functions of the calls whose marks have not all been reached, by user data.
+_mark_handlers = {}
+_last_mark_call = 0
+
+def _on_mark(mark, user_data):
+  handler, last = _mark_handlers.get(user_data, (None, 0))
+  if handler is None:
+    return
+  if mark == last:
+    _mark_handlers.pop(user_data, None)
+  handler(mark)
+
+_mark = mark_callback(_on_mark)
+
+# Takes a list of positions and a Python function receiving the index of each mark reached.
+def speak_with_marks(str, marks, callback, interrupt=False):
+  global _last_mark_call
+  # Marks of earlier calls are never reached once speech is interrupted.
+  if interrupt:
+    _mark_handlers.clear()
+  _last_mark_call += 1
+  key = _last_mark_call
+  if marks:
+    _mark_handlers[key] = (callback, len(marks) - 1)
+  result = _speak_with_marks(str, (c_uint * len(marks))(*marks), len(marks), interrupt, _mark, key)
+  if not result:
+    _mark_handlers.pop(key, None)
+  return result
+
+# Callback type, called with the audio data, its size in bytes and the user data.
+audio_callback = CFUNCTYPE(c_bool, c_void_p, c_uint, c_void_p)
+_proto_synthesize = CFUNCTYPE(c_bool, c_wchar_p, c_uint, c_uint, c_uint, audio_callback, c_void_p)
+_param_synthesize = (1, "str"), (1, "samples_per_second"), (1, "bits_per_sample"), (1, "channels"), (1, "callback"), (1, "user_data")
+_synthesize = _proto_synthesize(("Tolk_Synthesize", _tolk), _param_synthesize)
+
+# Takes a Python function receiving each chunk of audio as bytes, returning False stops synthesis.
+def synthesize(str, samples_per_second, bits_per_sample, channels, callback):
+  wrapped = audio_callback(lambda data, size, user_data: callback(string_at(data, size)) is not False)
+  return _synthesize(str, samples_per_second, bits_per_sample, channels, wrapped, None)
+
+_proto_set_phrase_cache = CFUNCTYPE(c_bool, c_wchar_p, c_uint)
+_param_set_phrase_cache = (1, "path"), (1, "max_kilobytes")
+set_phrase_cache = _proto_set_phrase_cache(("Tolk_SetPhraseCache", _tolk), _param_set_phrase_cache)
+
+_proto_prefetch_phrases = CFUNCTYPE(c_bool, POINTER(c_wchar_p), c_uint)
+_param_prefetch_phrases = (1, "phrases"), (1, "count")
+_prefetch_phrases = _proto_prefetch_phrases(("Tolk_PrefetchPhrases", _tolk), _param_prefetch_phrases)
+
+# Takes a list of strings.
+def prefetch_phrases(phrases):
+  return _prefetch_phrases((c_wchar_p * len(phrases))(*phrases), len(phrases))
+
+# Returns (hits, misses).
+_proto_get_phrase_cache_stats = CFUNCTYPE(c_bool, POINTER(c_uint), POINTER(c_uint))
+_param_get_phrase_cache_stats = (2, "hits"), (2, "misses")
+get_phrase_cache_stats = _proto_get_phrase_cache_stats(("Tolk_GetPhraseCacheStats", _tolk), _param_get_phrase_cache_stats)
+
+_proto_get_last_output_driver = CFUNCTYPE(c_wchar_p)
+get_last_output_driver = _proto_get_last_output_driver(("Tolk_GetLastOutputDriver", _tolk))
+
 _proto_detect_screen_reader = CFUNCTYPE(c_wchar_p)
 detect_screen_reader = _proto_detect_screen_reader(("Tolk_DetectScreenReader", _tolk))
 
@@ -47,12 +255,44 @@ _proto_speak = CFUNCTYPE(c_bool, c_wchar_p, c_bool)
 _param_speak = (1, "str"), (1, "interrupt", False)
 speak = _proto_speak(("Tolk_Speak", _tolk), _param_speak)
 
+_proto_output_diff = CFUNCTYPE(c_bool, c_wchar_p, c_wchar_p, c_bool)
+_param_output_diff = (1, "key"), (1, "str"), (1, "interrupt", False)
+output_diff = _proto_output_diff(("Tolk_OutputDiff", _tolk), _param_output_diff)
+
+_proto_speak_markup = CFUNCTYPE(c_bool, c_wchar_p, c_bool)
+_param_speak_markup = (1, "markup"), (1, "interrupt", False)
+speak_markup = _proto_speak_markup(("Tolk_SpeakMarkup", _tolk), _param_speak_markup)
+
 _proto_braille = CFUNCTYPE(c_bool, c_wchar_p)
 _param_braille = (1, "str"),
 braille = _proto_braille(("Tolk_Braille", _tolk), _param_braille)
 
+_proto_set_braille_paging = CFUNCTYPE(None, c_bool)
+_param_set_braille_paging = (1, "paging"),
+set_braille_paging = _proto_set_braille_paging(("Tolk_SetBraillePaging", _tolk), _param_set_braille_paging)
+
+_proto_set_braille_width = CFUNCTYPE(None, c_uint)
+_param_set_braille_width = (1, "cells"),
+set_braille_width = _proto_set_braille_width(("Tolk_SetBrailleWidth", _tolk), _param_set_braille_width)
+
+_proto_pan_braille_forward = CFUNCTYPE(c_bool)
+pan_braille_forward = _proto_pan_braille_forward(("Tolk_PanBrailleForward", _tolk))
+
+_proto_pan_braille_back = CFUNCTYPE(c_bool)
+pan_braille_back = _proto_pan_braille_back(("Tolk_PanBrailleBack", _tolk))
+
+# Returns (page, count).
+_proto_get_braille_page = CFUNCTYPE(c_bool, POINTER(c_uint), POINTER(c_uint))
+_param_get_braille_page = (2, "page"), (2, "count")
+get_braille_page = _proto_get_braille_page(("Tolk_GetBraillePage", _tolk), _param_get_braille_page)
+
 _proto_is_speaking = CFUNCTYPE(c_bool)
 is_speaking = _proto_is_speaking(("Tolk_IsSpeaking", _tolk))
 
+# Returns the count.
+_proto_get_queued_utterances = CFUNCTYPE(c_bool, POINTER(c_uint))
+_param_get_queued_utterances = (2, "count"),
+get_queued_utterances = _proto_get_queued_utterances(("Tolk_GetQueuedUtterances", _tolk), _param_get_queued_utterances)
+
 _proto_silence = CFUNCTYPE(c_bool)
 silence = _proto_silence(("Tolk_Silence", _tolk))
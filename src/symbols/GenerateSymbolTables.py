@@ -0,0 +1,147 @@
+###
+ #  Product:        Tolk
+ #  File:           GenerateSymbolTables.py
+ #  Description:    Compiles the symbol name files into perfect hash tables, run by the build.
+ #  Copyright:      (c) 2026, Davy Kager <mail@davykager.nl>
+ #  License:        LGPLv3
+ ##
+
+# Usage: GenerateSymbolTables.py <output header> <language files>
+# Every language file is named after its language tag, for example en.txt. Each
+# line holds the code points of an emoji or symbol in hexadecimal, separated by
+# spaces, then a tab and the name. Empty lines and lines starting with # are
+# skipped. Variation selector 16 (FE0F) is left out of the keys, as is done
+# when looking them up.
+
+import os
+import sys
+
+# Must match HashSymbol in SymbolNames.h.
+FNV_OFFSET = 2166136261
+FNV_PRIME = 16777619
+
+def hash_symbol(code_points, seed):
+  hash = FNV_OFFSET ^ seed
+  for code_point in code_points:
+    hash ^= code_point
+    hash = (hash * FNV_PRIME) & 0xFFFFFFFF
+  return hash
+
+def read_names(path):
+  names = {}
+  with open(path, encoding="utf-8-sig") as file:
+    for number, line in enumerate(file, 1):
+      line = line.rstrip("\r\n")
+      if not line or line.startswith("#"):
+        continue
+      try:
+        sequence, name = line.split("\t")
+        code_points = tuple(c for c in (int(c, 16) for c in sequence.split()) if c != 0xFE0F)
+      except ValueError:
+        sys.exit("%s:%d: expected code points and a name separated by a tab" % (path, number))
+      if not code_points or not name:
+        sys.exit("%s:%d: empty code points or name" % (path, number))
+      if code_points in names:
+        sys.exit("%s:%d: code points listed twice" % (path, number))
+      names[code_points] = name
+  if not names:
+    sys.exit("%s: no names" % path)
+  return names
+
+# Hash and displace: keys are spread over as many buckets as there are slots,
+# then the biggest buckets first get the smallest seed that puts all their keys
+# in free slots. A lookup hashes twice and compares one key.
+def build_table(names):
+  keys = sorted(names)
+  size = len(keys)
+  buckets = [[] for _ in range(size)]
+  for key in keys:
+    buckets[hash_symbol(key, 0) % size].append(key)
+  slots = [None] * size
+  displacements = [0] * size
+  for bucket in sorted(range(size), key=lambda b: (-len(buckets[b]), b)):
+    if not buckets[bucket]:
+      break
+    seed = 1
+    while True:
+      positions = [hash_symbol(key, seed) % size for key in buckets[bucket]]
+      if len(set(positions)) == len(positions) and all(slots[p] is None for p in positions):
+        break
+      seed += 1
+    displacements[bucket] = seed
+    for key, position in zip(buckets[bucket], positions):
+      slots[position] = key
+  return slots, displacements
+
+# One bit for each UTF-16 code unit that starts a key, the high surrogate for
+# code points past the BMP. Lets NameSymbols skip text that can't be named.
+def build_starts(names):
+  starts = [0] * (0x10000 // 32)
+  for key in names:
+    unit = key[0] if key[0] <= 0xFFFF else 0xD800 + ((key[0] - 0x10000) >> 10)
+    starts[unit >> 5] |= 1 << (unit & 31)
+  return starts
+
+def wide_string(text):
+  result = []
+  for character in text:
+    value = ord(character)
+    if character in "\\\"":
+      result.append("\\" + character)
+    elif 0x20 <= value < 0x7F:
+      result.append(character)
+    elif value <= 0xFFFF:
+      result.append("\\u%04X" % value)
+    else:
+      result.append("\\U%08X" % value)
+  return "L\"" + "".join(result) + "\""
+
+def main():
+  if len(sys.argv) < 3:
+    sys.exit("Usage: GenerateSymbolTables.py <output header> <language files>")
+  lines = [
+    "// Generated by GenerateSymbolTables.py from the files in src/symbols, do not edit.",
+    "",
+    "#ifndef _SYMBOL_TABLES_H_",
+    "#define _SYMBOL_TABLES_H_",
+    "",
+  ]
+  tables = []
+  for path in sorted(sys.argv[2:]):
+    language = os.path.splitext(os.path.basename(path))[0]
+    identifier = language.replace("-", "_")
+    names = read_names(path)
+    slots, displacements = build_table(names)
+    code_points = []
+    entries = []
+    for key in slots:
+      entries.append("  { %d, %d, %s }," % (len(code_points), len(key), wide_string(names[key])))
+      code_points.extend(key)
+    lines.append("static constexpr char32_t g_symbolCodePoints_%s[] = {" % identifier)
+    for i in range(0, len(code_points), 8):
+      lines.append("  " + " ".join("0x%X," % c for c in code_points[i:i + 8]))
+    lines.append("};")
+    lines.append("static constexpr SymbolEntry g_symbolEntries_%s[] = {" % identifier)
+    lines.extend(entries)
+    lines.append("};")
+    lines.append("static constexpr unsigned int g_symbolDisplacements_%s[] = {" % identifier)
+    for i in range(0, len(displacements), 16):
+      lines.append("  " + " ".join("%d," % d for d in displacements[i:i + 16]))
+    lines.append("};")
+    starts = build_starts(names)
+    lines.append("static constexpr unsigned int g_symbolStarts_%s[] = {" % identifier)
+    for i in range(0, len(starts), 8):
+      lines.append("  " + " ".join("0x%X," % b for b in starts[i:i + 8]))
+    lines.append("};")
+    lines.append("")
+    tables.append("  { %s, g_symbolCodePoints_%s, g_symbolEntries_%s, g_symbolDisplacements_%s, g_symbolStarts_%s, %d }," % (wide_string(language), identifier, identifier, identifier, identifier, len(slots)))
+  lines.append("static constexpr SymbolTable g_symbolTables[] = {")
+  lines.extend(tables)
+  lines.append("};")
+  lines.append("")
+  lines.append("#endif // _SYMBOL_TABLES_H_")
+  with open(sys.argv[1], "w", encoding="ascii", newline="\n") as file:
+    file.write("\n".join(lines) + "\n")
+
+if __name__ == "__main__":
+  main()
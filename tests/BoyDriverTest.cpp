@@ -0,0 +1,149 @@
+/**
+ *  Product:        Tolk
+ *  File:           BoyDriverTest.cpp
+ *  Description:    Tests of tracking BoyPCReader's utterances until they are spoken.
+ *  Copyright:      (c) 2026, Davy Kager <mail@davykager.nl>
+ *  License:        LGPLv3
+ */
+
+#include "ScreenReaderDriverBOY.h"
+#include "TolkTest.h"
+
+#ifdef _WIN64
+#define FAKE_BYCTRL L"byctrl-x64.dll"
+#else
+#define FAKE_BYCTRL L"byctrl.dll"
+#endif
+
+typedef bool (__stdcall *FinishFunc)();
+typedef void (__stdcall *ReportDroppedFunc)();
+typedef void (__stdcall *SetSpeakResultFunc)(int result);
+
+// The driver's own handle to the fake library is private, a second one reaches the same library.
+static HINSTANCE g_byctrl;
+static FinishFunc Finish;
+static ReportDroppedFunc ReportDropped;
+static SetSpeakResultFunc SetSpeakResult;
+
+static unsigned int Queued(ScreenReaderDriverBOY &driver) {
+  unsigned int count = 0;
+  CHECK(driver.GetQueuedUtterances(count));
+  return count;
+}
+
+static bool Signaled(ScreenReaderDriverBOY &driver) {
+  return (WaitForSingleObject((HANDLE)driver.GetSpeechEvent(), 0) == WAIT_OBJECT_0);
+}
+
+static void TestCompletion() {
+  ScreenReaderDriverBOY driver;
+  CHECK(driver.IsActive());
+  CHECK(!driver.IsSpeaking());
+  CHECK(driver.Speak(L"one", false));
+  CHECK(driver.Speak(L"two", false));
+  CHECK(driver.Speak(L"three", false));
+  CHECK(driver.IsSpeaking());
+  CHECK(Queued(driver) == 3);
+  CHECK(!Signaled(driver));
+  CHECK(Finish());
+  CHECK(Queued(driver) == 2);
+  CHECK(Signaled(driver));
+  CHECK(Finish() && Finish());
+  CHECK(!driver.IsSpeaking());
+  CHECK(Queued(driver) == 0);
+}
+
+static void TestInterrupt() {
+  ScreenReaderDriverBOY driver;
+  driver.Speak(L"one", false);
+  driver.Speak(L"two", false);
+  CHECK(driver.Speak(L"three", true));
+  CHECK(Queued(driver) == 1);
+  // Late callbacks of the interrupted utterances don't count twice.
+  ReportDropped();
+  CHECK(Queued(driver) == 1);
+  CHECK(driver.Silence());
+  CHECK(Queued(driver) == 0);
+  ReportDropped();
+  CHECK(Queued(driver) == 0);
+  CHECK(!driver.IsSpeaking());
+}
+
+static void TestFailure() {
+  ScreenReaderDriverBOY driver;
+  SetSpeakResult(e_bcerr_unavailable);
+  CHECK(!driver.Speak(L"lost", false));
+  SetSpeakResult(e_bcerr_success);
+  CHECK(Queued(driver) == 0);
+  CHECK(!driver.Speak(L"", false));
+  CHECK(Queued(driver) == 0);
+}
+
+static void TestManyQueued() {
+  // More utterances than there are completion slots, the rest are spoken untracked.
+  ScreenReaderDriverBOY driver;
+  for (int i = 0; i < 40; ++i) driver.Speak(L"text", false);
+  CHECK(Queued(driver) == 32);
+  while (Finish()) {}
+  CHECK(Queued(driver) == 0);
+}
+
+static void TestLateCallback() {
+  ScreenReaderDriverBOY driver;
+  // Interrupted, its callback is still to come.
+  CHECK(driver.Speak(L"old", false));
+  CHECK(driver.Speak(L"new", true));
+  CHECK(Finish());
+  // Enough utterances for the sequence to come round to the old slot, and to fill all of them.
+  for (int i = 0; i < 40; ++i) {
+    CHECK(driver.Speak(L"passing", false));
+    CHECK(Finish());
+  }
+  for (int i = 0; i < 32; ++i) CHECK(driver.Speak(L"queued", false));
+  // The old slot was passed over, so the late callback completes nothing.
+  CHECK(Queued(driver) == 31);
+  Signaled(driver);
+  ReportDropped();
+  CHECK(Queued(driver) == 31);
+  CHECK(!Signaled(driver));
+  // And the slot is free again.
+  while (Finish()) {}
+  CHECK(Queued(driver) == 0);
+  for (int i = 0; i < 32; ++i) CHECK(driver.Speak(L"again", false));
+  CHECK(Queued(driver) == 32);
+  while (Finish()) {}
+}
+
+static void TestEventLifetime() {
+  HANDLE event;
+  {
+    ScreenReaderDriverBOY first;
+    event = (HANDLE)first.GetSpeechEvent();
+    CHECK(event != nullptr);
+    {
+      ScreenReaderDriverBOY second;
+      CHECK(second.GetSpeechEvent() == event);
+    }
+    // Still there for the first driver.
+    CHECK(first.GetSpeechEvent() == event);
+  }
+  ScreenReaderDriverBOY again;
+  CHECK(again.GetSpeechEvent() != nullptr);
+}
+
+int main() {
+  g_byctrl = LoadLibraryW(FAKE_BYCTRL);
+  CHECK(g_byctrl != nullptr);
+  if (!g_byctrl) return TEST_RESULT();
+  Finish = (FinishFunc)GetProcAddress(g_byctrl, "FakeByCtrl_Finish");
+  ReportDropped = (ReportDroppedFunc)GetProcAddress(g_byctrl, "FakeByCtrl_ReportDropped");
+  SetSpeakResult = (SetSpeakResultFunc)GetProcAddress(g_byctrl, "FakeByCtrl_SetSpeakResult");
+  TestCompletion();
+  TestInterrupt();
+  TestFailure();
+  TestManyQueued();
+  TestLateCallback();
+  TestEventLifetime();
+  FreeLibrary(g_byctrl);
+  return TEST_RESULT();
+}
@@ -0,0 +1,107 @@
+/**
+ *  Product:        Tolk
+ *  File:           BraillePagerTest.cpp
+ *  Description:    Tests of splitting braille into pages and panning through them.
+ *  Copyright:      (c) 2026, Davy Kager <mail@davykager.nl>
+ *  License:        LGPLv3
+ */
+
+#include <vector>
+#include "BraillePager.h"
+#include "MockDriver.h"
+#include "TolkTest.h"
+
+// Shows the text on the display like Tolk does with paging enabled, then pans to the end.
+static std::vector<std::wstring> ShowAll(BraillePager &pager, MockDriver &driver, const wchar_t *str) {
+  pager.Show(str, driver.GetBrailleCells());
+  driver.Braille(pager.GetPage().c_str());
+  while (pager.Forward()) driver.Braille(pager.GetPage().c_str());
+  std::vector<std::wstring> pages;
+  pages.swap(driver.brailled);
+  return pages;
+}
+
+static void TestWords() {
+  BraillePager pager;
+  MockDriver driver(L"Display");
+  driver.cells = 20;
+  const std::vector<std::wstring> pages = ShowAll(pager, driver, L"The quick brown fox jumps over the lazy dog");
+  CHECK(pages.size() == 3);
+  if (pages.size() != 3) return;
+  CHECK_TEXT(pages[0], L"The quick brown fox");
+  CHECK_TEXT(pages[1], L"jumps over the lazy");
+  CHECK_TEXT(pages[2], L"dog");
+  for (const std::wstring &page : pages) CHECK(page.size() <= driver.cells);
+}
+
+static void TestLinesAndLongWords() {
+  BraillePager pager;
+  MockDriver driver(L"Display");
+  driver.cells = 10;
+  const std::vector<std::wstring> pages = ShowAll(pager, driver, L"Hi\nSupercalifragilistic");
+  CHECK(pages.size() == 3);
+  if (pages.size() != 3) return;
+  CHECK_TEXT(pages[0], L"Hi");
+  // Only a word wider than the display is cut.
+  CHECK_TEXT(pages[1], L"Supercalif");
+  CHECK_TEXT(pages[2], L"ragilistic");
+}
+
+static void TestPanning() {
+  BraillePager pager;
+  unsigned int page = 0, count = 0;
+  pager.GetPosition(page, count);
+  CHECK(count == 0);
+  CHECK(!pager.Forward());
+  pager.Show(L"one two three four", 9);
+  pager.GetPosition(page, count);
+  // "three four" is one cell too wide.
+  CHECK(page == 0 && count == 3);
+  CHECK(!pager.Back());
+  CHECK(pager.Forward());
+  CHECK_TEXT(pager.GetPage(), L"three");
+  CHECK(pager.Forward());
+  CHECK_TEXT(pager.GetPage(), L"four");
+  CHECK(!pager.Forward());
+  CHECK(pager.Back());
+  CHECK(pager.Back());
+  CHECK_TEXT(pager.GetPage(), L"one two");
+  // Shown again from the cache, at its first page.
+  pager.Forward();
+  pager.Show(L"something else", 9);
+  pager.Show(L"one two three four", 9);
+  pager.GetPosition(page, count);
+  CHECK(page == 0 && count == 3);
+}
+
+static void TestBlank() {
+  BraillePager pager;
+  pager.Show(L"   ", BRAILLE_DEFAULT_CELLS);
+  unsigned int page = 0, count = 0;
+  pager.GetPosition(page, count);
+  CHECK(count <= 1);
+  CHECK_TEXT(pager.GetPage(), L"");
+}
+
+static void TestNoCells() {
+  // A display of unknown width gets the text whole.
+  std::vector<std::pair<DWORD, DWORD>> pages;
+  BraillePager::Segment(L"one two", 7, 0, pages);
+  CHECK(pages.size() == 1 && pages[0].first == 0 && pages[0].second == 7);
+  BraillePager pager;
+  pager.Show(L"one two\nthree", 0);
+  unsigned int page = 0, count = 0;
+  pager.GetPosition(page, count);
+  CHECK(page == 0 && count == 1);
+  CHECK_TEXT(pager.GetPage(), L"one two\nthree");
+  CHECK(!pager.Forward());
+}
+
+int main() {
+  TestWords();
+  TestLinesAndLongWords();
+  TestPanning();
+  TestBlank();
+  TestNoCells();
+  return TEST_RESULT();
+}
@@ -0,0 +1,185 @@
+/**
+ *  Product:        Tolk
+ *  File:           BridgeTest.cpp
+ *  Description:    Tests of the bridge driver, with the helper process hosting a mock screen reader.
+ *  Copyright:      (c) 2026, Davy Kager <mail@davykager.nl>
+ *  License:        LGPLv3
+ */
+
+// TestBridge is TolkBridge built against bridge/ScreenReaderDriverSNova.h, a mock
+// that writes what it is given to the test log. The test maps the channel as well,
+// to see which side went to sleep on its event.
+
+#include <windows.h>
+#include <algorithm>
+#include <string>
+#include <vector>
+#include "ScreenReaderDriverBridge.h"
+#include "TolkTest.h"
+
+#define LOG_FILE "BridgeTest.log"
+// What the bridge allows a call and a restart, see ScreenReaderDriverBridge.cpp.
+#define CALL_TIMEOUT 2000
+#define RESTART_INTERVAL 10000
+// Longer than the bridge spins, shorter than it waits.
+#define PAUSE 100
+#define ROUND_TRIPS 1000
+// Leeway for the scheduler.
+#define SLACK 500
+
+// The texts the mock spoke, in order.
+static std::vector<std::wstring> Spoken() {
+  std::vector<std::wstring> spoken;
+  for (const std::wstring &line : ReadTestLog(LOG_FILE)) {
+    if (line.compare(0, 6, L"SNova\t") == 0) spoken.push_back(line.substr(6));
+  }
+  return spoken;
+}
+
+// The process ID of the helper started last.
+static DWORD LastHelper() {
+  DWORD id = 0;
+  for (const std::wstring &line : ReadTestLog(LOG_FILE)) {
+    if (line.compare(0, 8, L"started\t") == 0) id = wcstoul(line.c_str() + 8, nullptr, 10);
+  }
+  return id;
+}
+
+static bool HasExited(DWORD id) {
+  const HANDLE process = OpenProcess(SYNCHRONIZE, FALSE, id);
+  if (!process) return true;
+  const bool exited = (WaitForSingleObject(process, SLACK) == WAIT_OBJECT_0);
+  CloseHandle(process);
+  return exited;
+}
+
+// The channel the bridge created, named as in ScreenReaderDriverBridge::Initialize.
+class Channel {
+public:
+  explicit Channel(ScreenReaderDriverBridge *bridge) : mapping(nullptr), channel(nullptr) {
+    wchar_t name[128];
+    swprintf_s(name, L"Local\\TolkBridge-%lu-%p", GetCurrentProcessId(), (void *)bridge);
+    mapping = OpenFileMappingW(FILE_MAP_ALL_ACCESS, FALSE, name);
+    if (mapping) channel = (TolkBridgeChannel *)MapViewOfFile(mapping, FILE_MAP_ALL_ACCESS, 0, 0, sizeof(TolkBridgeChannel));
+  }
+  ~Channel() {
+    if (channel) UnmapViewOfFile(channel);
+    if (mapping) CloseHandle(mapping);
+  }
+
+public:
+  TolkBridgeChannel *operator->() const { return channel; }
+  explicit operator bool() const { return channel != nullptr; }
+
+private:
+  HANDLE mapping;
+  TolkBridgeChannel *channel;
+};
+
+static void TestUnknown() {
+  // The helper has no such driver and says so before it exits.
+  ScreenReaderDriverBridge bridge(L"Unknown", L"" TOLK_TEST_BRIDGE);
+  CHECK(!bridge.IsActive());
+  CHECK_TEXT(bridge.GetName(), L"Unknown");
+  CHECK(!bridge.Speak(L"nobody", false));
+}
+
+static void TestRoundTrip() {
+  ScreenReaderDriverBridge bridge(L"SNova", L"" TOLK_TEST_BRIDGE);
+  // Nothing is known until the helper runs.
+  CHECK_TEXT(bridge.GetName(), L"SNova");
+  CHECK(!bridge.HasSpeech() && !bridge.HasBraille());
+  CHECK(!bridge.Speak(L"too early", false));
+  CHECK(bridge.IsActive());
+  CHECK(bridge.HasSpeech() && bridge.HasBraille() && bridge.HasStatus());
+  const DWORD helper = LastHelper();
+  CHECK(helper && helper != GetCurrentProcessId());
+  CHECK(bridge.Speak(L"hello", false));
+  CHECK(bridge.Braille(L"hello"));
+  CHECK(!bridge.IsSpeaking());
+  CHECK(bridge.Silence());
+  // Text longer than the channel is sent in pieces and put back together.
+  std::wstring text;
+  for (int i = 0; text.size() < 3 * TOLK_BRIDGE_MAX_TEXT; ++i) text += std::to_wstring(i) + L' ';
+  CHECK(bridge.Output(text.c_str(), false));
+  // Back to back, each side finds the other's answer while it spins.
+  for (int i = 0; i < ROUND_TRIPS; ++i) {
+    if (!bridge.IsActive()) {
+      CHECK(!"round trip failed");
+      break;
+    }
+  }
+  Channel channel(&bridge);
+  CHECK(channel);
+  if (!channel) return;
+  // Idle for longer than it spins, the helper sleeps on its event and the next request wakes it.
+  Sleep(PAUSE);
+  CHECK(channel->helperWaiting == 1);
+  ULONGLONG start = GetTickCount64();
+  CHECK(bridge.Speak(L"woken", false));
+  CHECK(GetTickCount64() - start < PAUSE);
+  CHECK(channel->helperWaiting == 0 || channel->state == TOLK_BRIDGE_STATE_IDLE);
+  // An answer that takes longer than the client spins wakes the client from its event.
+  start = GetTickCount64();
+  CHECK(bridge.Speak(L"slow", false));
+  CHECK(GetTickCount64() - start >= PAUSE - 20);
+  CHECK(GetTickCount64() - start < CALL_TIMEOUT);
+  CHECK(channel->clientWaiting == 0);
+  const std::vector<std::wstring> spoken = Spoken();
+  const std::vector<std::wstring> expected = { L"hello", text, L"woken", L"slow" };
+  CHECK(spoken == expected);
+  CHECK(bridge.IsActive());
+  CHECK(LastHelper() == helper);
+}
+
+static void TestQuit() {
+  DWORD helper = 0;
+  {
+    ScreenReaderDriverBridge bridge(L"SNova", L"" TOLK_TEST_BRIDGE);
+    CHECK(bridge.IsActive());
+    helper = LastHelper();
+  }
+  // Told to quit, the helper exits by itself.
+  CHECK(HasExited(helper));
+}
+
+static void TestHang() {
+  ScreenReaderDriverBridge bridge(L"SNova", L"" TOLK_TEST_BRIDGE);
+  const ULONGLONG started = GetTickCount64();
+  CHECK(bridge.IsActive());
+  const DWORD helper = LastHelper();
+  // A call the helper never answers fails once the call times out, and the helper is killed.
+  ULONGLONG start = GetTickCount64();
+  CHECK(!bridge.Speak(L"hang", false));
+  CHECK(GetTickCount64() - start >= CALL_TIMEOUT - 20);
+  CHECK(GetTickCount64() - start < CALL_TIMEOUT + SLACK);
+  CHECK(HasExited(helper));
+  CHECK(!bridge.Speak(L"lost", false));
+  // Not started again right away, a helper that keeps hanging would stall every detection.
+  start = GetTickCount64();
+  CHECK(!bridge.IsActive());
+  CHECK(GetTickCount64() - start < SLACK);
+  CHECK(LastHelper() == helper);
+  // But once the interval is up.
+  CHECK(WaitUntil([&]() { return bridge.IsActive(); }, RESTART_INTERVAL + SLACK));
+  CHECK(GetTickCount64() - started >= RESTART_INTERVAL - 20);
+  CHECK(LastHelper() != helper);
+  CHECK_TEXT(bridge.GetName(), L"SNova");
+  CHECK(bridge.Speak(L"restarted", false));
+  const std::vector<std::wstring> spoken = Spoken();
+  CHECK(std::find(spoken.begin(), spoken.end(), L"hang") == spoken.end());
+  CHECK(std::find(spoken.begin(), spoken.end(), L"lost") == spoken.end());
+  CHECK(!spoken.empty() && spoken.back() == L"restarted");
+}
+
+int main() {
+  SetTestEnvironment("TOLK_COMPAT_SESSION", "BridgeTest-" + std::to_string(GetCurrentProcessId()));
+  SetTestEnvironment("TOLK_TEST_LOG", LOG_FILE);
+  remove(LOG_FILE);
+  TestUnknown();
+  TestRoundTrip();
+  TestQuit();
+  TestHang();
+  remove(LOG_FILE);
+  return TEST_RESULT();
+}
@@ -0,0 +1,221 @@
+/**
+ *  Product:        Tolk
+ *  File:           BrokerTest.cpp
+ *  Description:    Tests of the broker, with the broker process running the mock screen readers.
+ *  Copyright:      (c) 2026, Davy Kager <mail@davykager.nl>
+ *  License:        LGPLv3
+ */
+
+// TestBroker is TolkBroker built against the mock drivers. It speaks through the
+// first of them, which writes what it is given to the test log.
+
+#include <windows.h>
+#include <algorithm>
+#include <atomic>
+#include <string>
+#include <thread>
+#include <vector>
+#include "Tolk.h"
+#include "ScreenReaderDriverBroker.h"
+#include "TolkBroker.h"
+#include "TolkTest.h"
+
+#define LOG_FILE "BrokerTest.log"
+// Time the broker gets to start, stop and deliver.
+#define PATIENCE 5000
+#define PRODUCERS 4
+#define PRODUCED 100
+
+static HANDLE g_broker;
+static DWORD g_brokerId;
+
+static std::wstring DetectedDriver() {
+  const wchar_t *name = Tolk_DetectScreenReader();
+  return name ? name : L"";
+}
+
+// The texts the broker's screen reader spoke, in order.
+static std::vector<std::wstring> Spoken() {
+  std::vector<std::wstring> spoken;
+  for (const std::wstring &line : ReadTestLog(LOG_FILE)) {
+    if (line.compare(0, 6, L"First\t") == 0) spoken.push_back(line.substr(6));
+  }
+  return spoken;
+}
+
+static bool WaitForSpoken(const std::wstring &text) {
+  return WaitUntil([&]() {
+    const std::vector<std::wstring> spoken = Spoken();
+    return std::find(spoken.begin(), spoken.end(), text) != spoken.end();
+  }, PATIENCE);
+}
+
+static bool StartBroker() {
+  wchar_t commandLine[] = L"TestBroker";
+  STARTUPINFOW startup = {};
+  startup.cb = sizeof(startup);
+  PROCESS_INFORMATION process = {};
+  if (!CreateProcessW(L"" TOLK_TEST_BROKER, commandLine, nullptr, nullptr, FALSE, CREATE_NEW_PROCESS_GROUP, nullptr, nullptr, &startup, &process))
+    return false;
+  CloseHandle(process.hThread);
+  g_broker = process.hProcess;
+  g_brokerId = process.dwProcessId;
+  return true;
+}
+
+// Stopped the way a user stops it, so it unloads Tolk and takes the ring down.
+static void StopBroker() {
+  CHECK(GenerateConsoleCtrlEvent(CTRL_BREAK_EVENT, g_brokerId));
+  CHECK(WaitForSingleObject(g_broker, PATIENCE) == WAIT_OBJECT_0);
+  DWORD code = STILL_ACTIVE;
+  CHECK(GetExitCodeProcess(g_broker, &code) && code == 0);
+  CloseHandle(g_broker);
+}
+
+// Publishes the name the way the broker does, see TolkBroker.cpp.
+static void PublishName(TolkBrokerRing *ring, const wchar_t *name) {
+  InterlockedIncrement(&ring->nameSerial);
+  wcsncpy_s(ring->name, name, _TRUNCATE);
+  InterlockedIncrement(&ring->nameSerial);
+}
+
+static void TestName() {
+  // The test stands in for the broker and publishes the names itself.
+  const HANDLE mapping = CreateFileMappingW(INVALID_HANDLE_VALUE, nullptr, PAGE_READWRITE, 0, sizeof(TolkBrokerRing), TOLK_BROKER_MAPPING_NAME);
+  CHECK(mapping);
+  TolkBrokerRing *ring = (TolkBrokerRing *)MapViewOfFile(mapping, FILE_MAP_ALL_ACCESS, 0, 0, sizeof(TolkBrokerRing));
+  CHECK(ring);
+  if (!ring) return;
+  for (LONG i = 0; i < TOLK_BROKER_SLOT_COUNT; ++i) ring->slots[i].sequence = i;
+  ring->brokerProcessId = GetCurrentProcessId();
+  ring->version = TOLK_BROKER_VERSION;
+  ring->hasSpeech = ring->hasBraille = 1;
+  ring->active = 1;
+  PublishName(ring, L"First");
+  const HANDLE wakeup = CreateEventW(nullptr, FALSE, FALSE, TOLK_BROKER_WAKEUP_NAME);
+  {
+    ScreenReaderDriverBroker driver;
+    CHECK(driver.IsActive());
+    const wchar_t *first = driver.GetName();
+    CHECK_TEXT(first, L"First");
+    // A name handed out earlier stays as it was when the screen reader changes.
+    PublishName(ring, L"Second");
+    CHECK(driver.IsActive());
+    CHECK_TEXT(driver.GetName(), L"Second");
+    CHECK_TEXT(first, L"First");
+    // And is handed out again when it comes back.
+    PublishName(ring, L"First");
+    CHECK(driver.IsActive());
+    CHECK(driver.GetName() == first);
+    // Not while the broker is writing it.
+    InterlockedIncrement(&ring->nameSerial);
+    wcsncpy_s(ring->name, L"Third", _TRUNCATE);
+    CHECK(driver.IsActive());
+    CHECK_TEXT(driver.GetName(), L"First");
+    InterlockedIncrement(&ring->nameSerial);
+    CHECK(driver.IsActive());
+    CHECK_TEXT(driver.GetName(), L"Third");
+  }
+  CloseHandle(wakeup);
+  UnmapViewOfFile(ring);
+  CloseHandle(mapping);
+}
+
+static void TestDelivery() {
+  // The broker is found once it is up, even though it started after Tolk was loaded.
+  CHECK(WaitUntil([]() { return !DetectedDriver().empty(); }, PATIENCE));
+  CHECK_TEXT(DetectedDriver(), L"First");
+  CHECK(Tolk_HasSpeech() && Tolk_HasBraille());
+  CHECK(Tolk_Speak(L"hello", false));
+  CHECK(WaitForSpoken(L"hello"));
+  // Text longer than a slot is spread over several and put back together.
+  std::wstring text;
+  for (int i = 0; text.size() < 3 * TOLK_BROKER_SLOT_TEXT; ++i) text += std::to_wstring(i) + L' ';
+  CHECK(Tolk_Output(text.c_str(), false));
+  CHECK(WaitForSpoken(text));
+}
+
+static void TestProducers() {
+  // Each thread is a client of its own, they all claim slots in the same ring. Far more
+  // is sent than fits in the ring, so producers also wait for the broker to catch up.
+  std::atomic<int> failed(0);
+  std::vector<std::thread> producers;
+  for (int p = 0; p < PRODUCERS; ++p) {
+    producers.emplace_back([p, &failed]() {
+      ScreenReaderDriverBroker client;
+      for (int i = 0; i < PRODUCED; ++i) {
+        const std::wstring text = L"producer " + std::to_wstring(p) + L" text " + std::to_wstring(i);
+        if (!client.Speak(text.c_str(), false)) ++failed;
+      }
+    });
+  }
+  for (std::thread &producer : producers) producer.join();
+  CHECK(failed == 0);
+  const std::wstring last = L"producer " + std::to_wstring(PRODUCERS - 1) + L" text " + std::to_wstring(PRODUCED - 1);
+  CHECK(WaitForSpoken(last));
+  CHECK(WaitUntil([]() { return Spoken().size() >= 2 + PRODUCERS * PRODUCED; }, PATIENCE));
+  // Every text arrives once, and the texts of each producer in the order it sent them.
+  int next[PRODUCERS] = {};
+  size_t count = 0;
+  for (const std::wstring &text : Spoken()) {
+    int p = 0, i = 0;
+    if (swscanf(text.c_str(), L"producer %d text %d", &p, &i) != 2) continue;
+    ++count;
+    CHECK(p >= 0 && p < PRODUCERS && i == next[p]);
+    if (p >= 0 && p < PRODUCERS) next[p] = i + 1;
+  }
+  CHECK(count == PRODUCERS * PRODUCED);
+}
+
+static void TestClaimTimeout() {
+  const HANDLE mapping = OpenFileMappingW(FILE_MAP_ALL_ACCESS, FALSE, TOLK_BROKER_MAPPING_NAME);
+  CHECK(mapping);
+  TolkBrokerRing *ring = (TolkBrokerRing *)MapViewOfFile(mapping, FILE_MAP_ALL_ACCESS, 0, 0, sizeof(TolkBrokerRing));
+  CHECK(ring);
+  if (!ring) return;
+  // A client that dies between claiming a slot and publishing it.
+  const LONG position = ring->enqueuePosition;
+  TolkBrokerSlot &slot = ring->slots[position & (TOLK_BROKER_SLOT_COUNT - 1)];
+  CHECK(slot.sequence == position);
+  CHECK(InterlockedCompareExchange(&ring->enqueuePosition, position + 1, position) == position);
+  // The next request waits behind it until the broker gives up on the slot.
+  const ULONGLONG start = GetTickCount64();
+  CHECK(Tolk_Speak(L"behind", false));
+  CHECK(WaitForSpoken(L"behind"));
+  CHECK(GetTickCount64() - start >= TOLK_BROKER_CLAIM_TIMEOUT - 20);
+  // Coming back, the client finds the slot handed back and can't publish over it.
+  CHECK(slot.sequence == position + TOLK_BROKER_SLOT_COUNT);
+  CHECK(InterlockedCompareExchange(&slot.sequence, position + 1, position) != position);
+  // The ring goes on, through the skipped slot as well.
+  for (int i = 0; i < 2 * TOLK_BROKER_SLOT_COUNT; ++i) {
+    const std::wstring text = L"after " + std::to_wstring(i);
+    CHECK(Tolk_Speak(text.c_str(), false));
+  }
+  CHECK(WaitForSpoken(L"after " + std::to_wstring(2 * TOLK_BROKER_SLOT_COUNT - 1)));
+  const std::vector<std::wstring> spoken = Spoken();
+  const auto after = std::find(spoken.begin(), spoken.end(), L"after 0");
+  CHECK(spoken.end() - after == 2 * TOLK_BROKER_SLOT_COUNT);
+  UnmapViewOfFile(ring);
+  CloseHandle(mapping);
+}
+
+int main() {
+  SetTestEnvironment("TOLK_COMPAT_SESSION", "BrokerTest-" + std::to_string(GetCurrentProcessId()));
+  SetTestEnvironment("TOLK_TEST_LOG", LOG_FILE);
+  remove(LOG_FILE);
+  TestName();
+  Tolk_UseBroker(true);
+  Tolk_Load();
+  CHECK(!Tolk_DetectScreenReader());
+  CHECK(StartBroker());
+  TestDelivery();
+  TestProducers();
+  TestClaimTimeout();
+  StopBroker();
+  // Gone with the broker.
+  CHECK(!Tolk_DetectScreenReader());
+  Tolk_Unload();
+  Tolk_UseBroker(false);
+  remove(LOG_FILE);
+  return TEST_RESULT();
+}
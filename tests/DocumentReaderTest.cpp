@@ -0,0 +1,156 @@
+/**
+ *  Product:        Tolk
+ *  File:           DocumentReaderTest.cpp
+ *  Description:    Tests of reading documents aloud a chunk at a time.
+ *  Copyright:      (c) 2026, Davy Kager <mail@davykager.nl>
+ *  License:        LGPLv3
+ */
+
+#include <cstdio>
+#include <string>
+#include "DocumentReader.h"
+#include "MockDriver.h"
+#include "SpeechQueue.h"
+#include "TolkTest.h"
+
+#define TEST_DOCUMENT "DocumentReaderTest.txt"
+#define TEST_DOCUMENT_SIZE (100u * 1024 * 1024)
+
+static const char g_paragraph[] = "Chapter one begins here. The knight rode east, past the old mill; the river was high! Did he care? No. Caf\xC3\xA9 au lait.\nA second paragraph follows, short.\n\n";
+
+static std::unique_ptr<DocumentReader> OpenText(const std::string &text) {
+  return DocumentReader::Open(text.data(), text.size());
+}
+
+static std::string Utf16(const char *text, bool bigEndian) {
+  std::string bytes = bigEndian ? "\xFE\xFF" : "\xFF\xFE";
+  for (; *text; ++text) {
+    if (bigEndian) bytes += '\0';
+    bytes += *text;
+    if (!bigEndian) bytes += '\0';
+  }
+  return bytes;
+}
+
+// Characters other than spaces, which is what reaches the screen reader of a document.
+static size_t CountSpoken(const std::wstring &text) {
+  size_t count = 0;
+  for (const wchar_t c : text) count += (c != L' ' && c != L'\n');
+  return count;
+}
+
+static void TestLargeDocument() {
+  // Written to a file so it is mapped rather than copied, like documents opened by path.
+  FILE *file = fopen(TEST_DOCUMENT, "wb");
+  CHECK(file != nullptr);
+  if (!file) return;
+  const size_t paragraphLength = sizeof(g_paragraph) - 1;
+  const size_t paragraphs = TEST_DOCUMENT_SIZE / paragraphLength;
+  for (size_t i = 0; i < paragraphs; ++i) fwrite(g_paragraph, 1, paragraphLength, file);
+  fclose(file);
+  size_t perParagraph = 0;
+  for (const char *c = g_paragraph; *c; ++c) perParagraph += (*c != ' ' && *c != '\n' && (*c & 0xC0) != 0x80);
+
+  std::unique_ptr<DocumentReader> reader = DocumentReader::Open(L"" TEST_DOCUMENT);
+  CHECK(reader != nullptr);
+  if (reader) {
+    CHECK(reader->GetSize() == paragraphs * paragraphLength);
+    // Read through the mock driver the way Tolk_SpeakDocument does, without keeping what was spoken.
+    MockDriver driver(L"Mock");
+    std::wstring chunk;
+    size_t chunks = 0, spoken = 0;
+    ULONGLONG resume = 0;
+    std::wstring resumed;
+    for (size_t maxLength = SPEECH_CHUNK_FIRST; reader->Next(chunk, maxLength); maxLength = SPEECH_CHUNK_MAX) {
+      CHECK(chunk.size() <= maxLength);
+      driver.Speak(chunk.c_str(), false);
+      spoken += CountSpoken(driver.spoken.back());
+      driver.spoken.clear();
+      // Remembers where a chunk halfway through starts, to come back to it.
+      if (++chunks == 50000) resume = reader->GetChunkPosition(0);
+      if (chunks == 50000) resumed = chunk;
+    }
+    CHECK(spoken == paragraphs * perParagraph);
+    CHECK(reader->GetPosition() == reader->GetSize());
+    CHECK(!reader->Next(chunk, SPEECH_CHUNK_MAX));
+    reader->Seek(resume);
+    CHECK(reader->Next(chunk, SPEECH_CHUNK_MAX));
+    CHECK_TEXT(chunk, resumed);
+    reader.reset();
+  }
+  remove(TEST_DOCUMENT);
+}
+
+static void TestPositions() {
+  const std::string text = g_paragraph;
+  std::unique_ptr<DocumentReader> reader = OpenText(text);
+  std::wstring chunk;
+  CHECK(reader->Next(chunk, SPEECH_CHUNK_MAX));
+  CHECK_TEXT(chunk.substr(0, 24), L"Chapter one begins here.");
+  // The word holding character 30 starts at "knight".
+  CHECK(reader->GetChunkPosition(30) == text.find("knight"));
+  CHECK(reader->FindNext(0, DOCUMENT_SENTENCE) == text.find("The knight"));
+  CHECK(reader->FindNext(0, DOCUMENT_PARAGRAPH) == text.find("A second"));
+  reader->Seek(reader->FindNext(0, DOCUMENT_PARAGRAPH));
+  CHECK(reader->Next(chunk, SPEECH_CHUNK_MAX));
+  CHECK_TEXT(chunk, L"A second paragraph follows, short.\n\n");
+  CHECK(!reader->Next(chunk, SPEECH_CHUNK_MAX));
+}
+
+static void TestUtf8() {
+  const std::string text = "ab\xC3(\xF0\x9F\x98\x80 ok caf\xC3\xA9";
+  std::unique_ptr<DocumentReader> reader = OpenText(text);
+  std::wstring chunk;
+  CHECK(reader->Next(chunk, 100));
+  // A malformed sequence is one U+FFFD, a code point beyond the BMP two units.
+  CHECK_TEXT(chunk, L"ab\xFFFD(\xD83D\xDE00 ok caf\xE9");
+  // Into the middle of a character, reading goes on after it.
+  reader->Seek(text.find("\xF0") + 2);
+  CHECK(reader->Next(chunk, 100));
+  CHECK_TEXT(chunk, L"ok caf\xE9");
+  // A byte order mark is not part of the text.
+  reader = OpenText("\xEF\xBB\xBFHi.");
+  CHECK(reader->Next(chunk, 100));
+  CHECK_TEXT(chunk, L"Hi.");
+}
+
+static void TestUtf16() {
+  std::unique_ptr<DocumentReader> reader = OpenText(Utf16("Hi there. Bye.", false));
+  std::wstring chunk;
+  CHECK(reader->Next(chunk, 100));
+  CHECK_TEXT(chunk, L"Hi there. Bye.");
+  reader = OpenText(Utf16("Hi there. Bye.", true));
+  CHECK(reader->Next(chunk, 100));
+  CHECK_TEXT(chunk, L"Hi there. Bye.");
+  // Seeking to an odd byte goes back to the start of its unit.
+  reader->Seek(2 + 2 * 3 + 1);
+  CHECK(reader->GetPosition() == 2 + 2 * 3);
+  // A trailing odd byte is the end of the document, also when seeking to it.
+  const std::string odd = Utf16("Hi", false) + "x";
+  reader = OpenText(odd);
+  reader->Seek(odd.size() - 1);
+  CHECK(reader->GetPosition() == odd.size());
+  CHECK(!reader->Next(chunk, 100));
+  reader->Seek(0);
+  CHECK(reader->Next(chunk, 100));
+  CHECK_TEXT(chunk, L"Hi");
+}
+
+static void TestEmpty() {
+  std::unique_ptr<DocumentReader> reader = DocumentReader::Open(nullptr, 0);
+  CHECK(reader != nullptr);
+  std::wstring chunk;
+  if (reader) CHECK(!reader->Next(chunk, 100));
+  reader = OpenText("   \n\n  ");
+  CHECK(!reader->Next(chunk, 100));
+  CHECK(DocumentReader::Open(L"does-not-exist.txt") == nullptr);
+}
+
+int main() {
+  TestLargeDocument();
+  TestPositions();
+  TestUtf8();
+  TestUtf16();
+  TestEmpty();
+  return TEST_RESULT();
+}
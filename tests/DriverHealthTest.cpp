@@ -0,0 +1,172 @@
+/**
+ *  Product:        Tolk
+ *  File:           DriverHealthTest.cpp
+ *  Description:    Tests of the circuit breaker, with a driver that keeps failing.
+ *  Copyright:      (c) 2026, Davy Kager <mail@davykager.nl>
+ *  License:        LGPLv3
+ */
+
+#include <windows.h>
+#include "Tolk.h"
+#include "DriverHealth.h"
+#include "FlakyDriver.h"
+#include "TolkTest.h"
+
+#define THRESHOLD 2
+#define BACKOFF 100
+#define MAX_BACKOFF 300
+
+static FlakyDriver *g_first;
+
+static DriverStats Stats(const wchar_t *name) {
+  DriverStats stats = {};
+  CHECK(Tolk_GetDriverStats(name, &stats.calls, &stats.failures, &stats.trips, &stats.rejected));
+  return stats;
+}
+
+// Only the first driver is active, so speech fails while its circuit is open.
+static void Load() {
+  Tolk_Load();
+  g_first = FlakyDriver::Find(L"First");
+  CHECK(g_first);
+  FlakyDriver::Find(L"Second")->active = false;
+  FlakyDriver::Find(L"Third")->active = false;
+}
+
+// Speaks once the time has come, returns when the speech was handed over.
+static ULONGLONG SpeakAt(ULONGLONG time, bool &spoken) {
+  while (GetTickCount64() < time) Sleep(1);
+  spoken = Tolk_Speak(L"text", false);
+  return GetTickCount64();
+}
+
+// Checks that the open circuit holds for the backoff and no longer, starting from a trip at tripped.
+static ULONGLONG CheckBackoff(ULONGLONG tripped, DWORD backoff, unsigned int &trips) {
+  bool spoken = true;
+  const unsigned int rejected = Stats(L"First").rejected;
+  SpeakAt(tripped + backoff - 40, spoken);
+  CHECK(!spoken);
+  CHECK(Stats(L"First").rejected == rejected + 1);
+  // Half-open, the probe fails and the circuit opens again.
+  const ULONGLONG probed = SpeakAt(tripped + backoff + 20, spoken);
+  CHECK(!spoken);
+  CHECK(Stats(L"First").trips == ++trips);
+  return probed;
+}
+
+static void TestCircuit() {
+  Tolk_SetCircuitBreaker(THRESHOLD, BACKOFF, MAX_BACKOFF);
+  Load();
+  CHECK(Tolk_Speak(L"closed", false));
+  g_first->SetFault(FlakyDriver::FAULT_FAIL);
+  // Closed until the threshold is reached.
+  CHECK(!Tolk_Speak(L"one", false));
+  CHECK(Stats(L"First").trips == 0);
+  CHECK(!Tolk_Speak(L"two", false));
+  const ULONGLONG tripped = GetTickCount64();
+  DriverStats stats = Stats(L"First");
+  CHECK(stats.calls == 3 && stats.failures == 2 && stats.trips == 1 && stats.rejected == 0);
+  // Open, the driver is not called.
+  const int calls = g_first->calls;
+  CHECK(!Tolk_Speak(L"three", false));
+  CHECK(g_first->calls == calls);
+  CHECK(Stats(L"First").rejected == 1);
+  // Each failed probe doubles the backoff, up to the limit.
+  unsigned int trips = 1;
+  ULONGLONG probed = CheckBackoff(tripped, BACKOFF, trips);
+  probed = CheckBackoff(probed, 2 * BACKOFF, trips);
+  probed = CheckBackoff(probed, MAX_BACKOFF, trips);
+  probed = CheckBackoff(probed, MAX_BACKOFF, trips);
+  // A probe that succeeds closes the circuit.
+  g_first->SetFault(FlakyDriver::FAULT_NONE);
+  bool spoken = false;
+  SpeakAt(probed + MAX_BACKOFF + 20, spoken);
+  CHECK(spoken);
+  CHECK(Tolk_Speak(L"closed again", false));
+  stats = Stats(L"First");
+  CHECK(stats.trips == trips && stats.failures == 2 + trips - 1);
+  // The backoff starts over, and so does the count of failures.
+  g_first->SetFault(FlakyDriver::FAULT_FAIL, 1);
+  CHECK(!Tolk_Speak(L"once", false));
+  CHECK(Tolk_Speak(L"fine", false));
+  g_first->SetFault(FlakyDriver::FAULT_FAIL, THRESHOLD);
+  CHECK(!Tolk_Speak(L"one", false));
+  CHECK(!Tolk_Speak(L"two", false));
+  CHECK(Stats(L"First").trips == trips + 1);
+  SpeakAt(GetTickCount64() + BACKOFF + 20, spoken);
+  CHECK(spoken);
+  Tolk_Unload();
+  Tolk_SetCircuitBreaker(0, 0, 0);
+}
+
+static void TestFlapping() {
+  Tolk_SetCircuitBreaker(THRESHOLD, BACKOFF, MAX_BACKOFF);
+  Load();
+  // Failures that don't follow each other never open the circuit.
+  for (int i = 0; i < 10; ++i) {
+    g_first->SetFault(FlakyDriver::FAULT_FAIL, 1);
+    CHECK(!Tolk_Speak(L"down", false));
+    CHECK(Tolk_Speak(L"up", false));
+  }
+  const DriverStats stats = Stats(L"First");
+  CHECK(stats.calls == 20 && stats.failures == 10 && stats.trips == 0 && stats.rejected == 0);
+  Tolk_Unload();
+  Tolk_SetCircuitBreaker(0, 0, 0);
+}
+
+static void TestReconfigure() {
+  Tolk_SetCircuitBreaker(THRESHOLD, 10 * BACKOFF, 10 * BACKOFF);
+  Load();
+  g_first->SetFault(FlakyDriver::FAULT_FAIL, THRESHOLD);
+  CHECK(!Tolk_Speak(L"one", false));
+  CHECK(!Tolk_Speak(L"two", false));
+  CHECK(!Tolk_Speak(L"open", false));
+  // Configuring the breaker again closes the circuit at once.
+  Tolk_SetCircuitBreaker(THRESHOLD, BACKOFF, MAX_BACKOFF);
+  CHECK(Tolk_Speak(L"closed", false));
+  // The new backoff applies to the next trip, the old deadline is gone.
+  g_first->SetFault(FlakyDriver::FAULT_FAIL, THRESHOLD);
+  CHECK(!Tolk_Speak(L"one", false));
+  CHECK(!Tolk_Speak(L"two", false));
+  bool spoken = false;
+  SpeakAt(GetTickCount64() + BACKOFF + 20, spoken);
+  CHECK(spoken);
+  // Disabling the breaker lets an open circuit through as well.
+  g_first->SetFault(FlakyDriver::FAULT_FAIL, THRESHOLD);
+  CHECK(!Tolk_Speak(L"one", false));
+  CHECK(!Tolk_Speak(L"two", false));
+  CHECK(!Tolk_Speak(L"open", false));
+  Tolk_SetCircuitBreaker(0, 0, 0);
+  CHECK(Tolk_Speak(L"disabled", false));
+  // Counters are kept regardless.
+  const DriverStats stats = Stats(L"First");
+  CHECK(stats.failures == 3 * THRESHOLD && stats.trips == 3 && stats.rejected == 2);
+  Tolk_Unload();
+}
+
+static void TestStats() {
+  unsigned int calls = 1, failures = 1, trips = 1, rejected = 1;
+  CHECK(!Tolk_GetDriverStats(L"First", &calls, &failures, &trips, &rejected));
+  CHECK(!calls && !failures && !trips && !rejected);
+  Load();
+  CHECK(!Tolk_GetDriverStats(L"First", nullptr, nullptr, nullptr, nullptr));
+  // Only output is counted, detection is not.
+  CHECK(Tolk_DetectScreenReader());
+  CHECK(!Tolk_GetDriverStats(L"First", nullptr, nullptr, nullptr, nullptr));
+  CHECK(Tolk_Output(L"output", false));
+  CHECK(Tolk_Braille(L"braille"));
+  CHECK(Tolk_Silence());
+  CHECK(Tolk_GetDriverStats(L"First", &calls, nullptr, nullptr, nullptr));
+  CHECK(calls == 3);
+  CHECK(!Tolk_GetDriverStats(L"Second", nullptr, nullptr, nullptr, nullptr));
+  CHECK(!Tolk_GetDriverStats(nullptr, nullptr, nullptr, nullptr, nullptr));
+  Tolk_Unload();
+}
+
+int main() {
+  TestCircuit();
+  TestFlapping();
+  TestReconfigure();
+  TestStats();
+  return TEST_RESULT();
+}
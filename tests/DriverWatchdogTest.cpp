@@ -0,0 +1,128 @@
+/**
+ *  Product:        Tolk
+ *  File:           DriverWatchdogTest.cpp
+ *  Description:    Tests of the deadline on driver calls, with drivers that hang or throw.
+ *  Copyright:      (c) 2026, Davy Kager <mail@davykager.nl>
+ *  License:        LGPLv3
+ */
+
+#include <windows.h>
+#include "Tolk.h"
+#include "FlakyDriver.h"
+#include "TolkTest.h"
+
+#define TIMEOUT 100
+
+static FlakyDriver *g_first;
+static FlakyDriver *g_second;
+
+static void Load() {
+  Tolk_Load();
+  g_first = FlakyDriver::Find(L"First");
+  g_second = FlakyDriver::Find(L"Second");
+  CHECK(g_first && g_second);
+}
+
+static std::wstring LastOutputDriver() {
+  const wchar_t *name = Tolk_GetLastOutputDriver();
+  return name ? name : L"";
+}
+
+static std::wstring DetectedDriver() {
+  const wchar_t *name = Tolk_DetectScreenReader();
+  return name ? name : L"";
+}
+
+static ULONGLONG Elapsed(ULONGLONG start) {
+  return GetTickCount64() - start;
+}
+
+static void TestTimeout() {
+  Tolk_SetDriverTimeout(TIMEOUT);
+  Load();
+  CHECK(Tolk_Speak(L"before", false));
+  CHECK_TEXT(LastOutputDriver(), L"First");
+  g_first->SetFault(FlakyDriver::FAULT_HANG);
+  const ULONGLONG start = GetTickCount64();
+  CHECK(!Tolk_Speak(L"hung", false));
+  CHECK(Elapsed(start) >= TIMEOUT - 10 && Elapsed(start) < 10 * TIMEOUT);
+  CHECK(g_first->IsHanging());
+  unsigned int calls = 0, failures = 0;
+  CHECK(Tolk_GetDriverStats(L"First", &calls, &failures, nullptr, nullptr));
+  CHECK(calls == 2 && failures == 1);
+  // The call was abandoned on the worker. While it is stuck, detection skips the driver without waiting for it.
+  const ULONGLONG next = GetTickCount64();
+  CHECK_TEXT(DetectedDriver(), L"Second");
+  CHECK(Tolk_Speak(L"after", false));
+  CHECK(Elapsed(next) < TIMEOUT);
+  CHECK_TEXT(LastOutputDriver(), L"Second");
+  CHECK(g_second->GetSpoken().back() == L"after");
+  CHECK(g_first->GetSpoken().back() == L"before");
+  // The hung call delivers once it returns, after that the driver is used again.
+  g_first->Unblock();
+  CHECK(WaitUntil([]() { return g_first->GetSpoken().back() == L"hung"; }, 1000));
+  g_second->active = false;
+  CHECK(WaitUntil([]() { return DetectedDriver() == L"First"; }, 1000));
+  CHECK(Tolk_Speak(L"recovered", false));
+  CHECK_TEXT(LastOutputDriver(), L"First");
+  Tolk_Unload();
+  Tolk_SetDriverTimeout(0);
+}
+
+static void TestRedispatch() {
+  Tolk_SetDriverTimeout(TIMEOUT);
+  Tolk_SetFailover(true, 0);
+  Load();
+  CHECK(Tolk_Output(L"before", false));
+  g_first->SetFault(FlakyDriver::FAULT_HANG);
+  // Sent on to the next driver by the same call, once the deadline has passed.
+  const ULONGLONG start = GetTickCount64();
+  CHECK(Tolk_Output(L"redispatched", false));
+  CHECK(Elapsed(start) >= TIMEOUT - 10 && Elapsed(start) < 10 * TIMEOUT);
+  CHECK_TEXT(LastOutputDriver(), L"Second");
+  CHECK(g_second->GetSpoken().back() == L"redispatched");
+  CHECK(g_second->GetBrailled().back() == L"redispatched");
+  // Detection still prefers the first driver, but skips it while it hangs.
+  CHECK(Tolk_Output(L"skipped", false));
+  CHECK_TEXT(LastOutputDriver(), L"Second");
+  g_first->Unblock();
+  CHECK(WaitUntil([]() { return !g_first->IsHanging(); }, 1000));
+  Tolk_Unload();
+  Tolk_SetFailover(false, 0);
+  Tolk_SetDriverTimeout(0);
+}
+
+static void TestThrow() {
+  // Called directly.
+  Load();
+  g_first->SetFault(FlakyDriver::FAULT_THROW, 1);
+  CHECK(!Tolk_Speak(L"thrown", false));
+  CHECK(g_first->failures == 1);
+  CHECK(Tolk_Speak(L"direct", false));
+  CHECK_TEXT(LastOutputDriver(), L"First");
+  Tolk_Unload();
+  // Called on the worker, which has to survive it.
+  Tolk_SetDriverTimeout(TIMEOUT);
+  Load();
+  g_first->SetFault(FlakyDriver::FAULT_THROW, 1);
+  CHECK(!Tolk_Speak(L"thrown", false));
+  CHECK(g_first->failures == 1);
+  CHECK(Tolk_Speak(L"worker", false));
+  CHECK_TEXT(LastOutputDriver(), L"First");
+  CHECK(g_first->GetSpoken().back() == L"worker");
+  // With failover, the text goes to the next driver instead.
+  Tolk_SetFailover(true, 0);
+  g_first->SetFault(FlakyDriver::FAULT_THROW, 1);
+  CHECK(Tolk_Speak(L"caught", false));
+  CHECK_TEXT(LastOutputDriver(), L"Second");
+  Tolk_Unload();
+  Tolk_SetFailover(false, 0);
+  Tolk_SetDriverTimeout(0);
+}
+
+int main() {
+  TestTimeout();
+  TestRedispatch();
+  TestThrow();
+  return TEST_RESULT();
+}
@@ -0,0 +1,81 @@
+/**
+ *  Product:        Tolk
+ *  File:           DuplicateFilterTest.cpp
+ *  Description:    Tests of dropping text that repeats within the window.
+ *  Copyright:      (c) 2026, Davy Kager <mail@davykager.nl>
+ *  License:        LGPLv3
+ */
+
+#include <string>
+#include <thread>
+#include <vector>
+#include "DuplicateFilter.h"
+#include "TolkTest.h"
+
+static void TestHash() {
+  CHECK(DuplicateFilter::Hash(nullptr) == 0);
+  CHECK(DuplicateFilter::Hash(L"") != 0);
+  CHECK(DuplicateFilter::Hash(L"Saved") == DuplicateFilter::Hash(L"Saved"));
+  CHECK(DuplicateFilter::Hash(L"Saved") != DuplicateFilter::Hash(L"Saved."));
+}
+
+static void TestWindow() {
+  DuplicateFilter filter;
+  const DWORD saved = DuplicateFilter::Hash(L"Saved");
+  CHECK(!filter.IsRepeat(saved, 200));
+  filter.Record(saved);
+  CHECK(filter.IsRepeat(saved, 200));
+  CHECK(!filter.IsRepeat(DuplicateFilter::Hash(L"Other"), 200));
+  // No window, no filtering.
+  CHECK(!filter.IsRepeat(saved, 0));
+  CHECK(filter.GetDropped() == 1);
+  Sleep(300);
+  CHECK(!filter.IsRepeat(saved, 200));
+}
+
+static void TestOnlyDelivered() {
+  // Text that wasn't delivered isn't recorded, so trying again gets through.
+  DuplicateFilter filter;
+  const DWORD hash = DuplicateFilter::Hash(L"Connecting");
+  CHECK(!filter.IsRepeat(hash, 500));
+  CHECK(!filter.IsRepeat(hash, 500));
+  CHECK(filter.GetDropped() == 0);
+}
+
+static void TestSlots() {
+  DuplicateFilter filter;
+  const DWORD first = DuplicateFilter::Hash(L"first");
+  filter.Record(first);
+  for (int i = 0; i < DUPLICATE_FILTER_SLOTS - 1; ++i) filter.Record(DuplicateFilter::Hash(std::to_wstring(i).c_str()));
+  CHECK(filter.IsRepeat(first, 1000));
+  // One text more and the first is let through.
+  filter.Record(DuplicateFilter::Hash(L"one more"));
+  CHECK(!filter.IsRepeat(first, 1000));
+}
+
+static void TestThreads() {
+  DuplicateFilter filter;
+  const DWORD hash = DuplicateFilter::Hash(L"Saved");
+  filter.Record(hash);
+  std::vector<std::thread> threads;
+  for (int i = 0; i < 4; ++i) {
+    threads.emplace_back([&filter, hash]() {
+      for (int j = 0; j < 10000; ++j) {
+        if (!filter.IsRepeat(hash, 60000)) filter.Record(hash);
+        filter.Record(DuplicateFilter::Hash(L"Other"));
+        filter.Record(hash);
+      }
+    });
+  }
+  for (std::thread &thread : threads) thread.join();
+  CHECK(filter.IsRepeat(hash, 60000));
+}
+
+int main() {
+  TestHash();
+  TestWindow();
+  TestOnlyDelivered();
+  TestSlots();
+  TestThreads();
+  return TEST_RESULT();
+}
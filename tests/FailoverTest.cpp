@@ -0,0 +1,176 @@
+/**
+ *  Product:        Tolk
+ *  File:           FailoverTest.cpp
+ *  Description:    Tests of retrying failed output on the next driver, with drivers that fail now and then.
+ *  Copyright:      (c) 2026, Davy Kager <mail@davykager.nl>
+ *  License:        LGPLv3
+ */
+
+#include <windows.h>
+#include "Tolk.h"
+#include "FlakyDriver.h"
+#include "TolkTest.h"
+
+static FlakyDriver *g_first;
+static FlakyDriver *g_second;
+static FlakyDriver *g_third;
+
+static void Load() {
+  Tolk_Load();
+  g_first = FlakyDriver::Find(L"First");
+  g_second = FlakyDriver::Find(L"Second");
+  g_third = FlakyDriver::Find(L"Third");
+  CHECK(g_first && g_second && g_third);
+}
+
+static std::wstring LastOutputDriver() {
+  const wchar_t *name = Tolk_GetLastOutputDriver();
+  return name ? name : L"";
+}
+
+static std::wstring DetectedDriver() {
+  const wchar_t *name = Tolk_DetectScreenReader();
+  return name ? name : L"";
+}
+
+static unsigned int Rejected(const wchar_t *name) {
+  unsigned int rejected = 0;
+  Tolk_GetDriverStats(name, nullptr, nullptr, nullptr, &rejected);
+  return rejected;
+}
+
+static void TestOrder() {
+  Load();
+  // Without failover the text is lost.
+  g_first->SetFault(FlakyDriver::FAULT_FAIL, 1);
+  CHECK(!Tolk_Output(L"lost", false));
+  Tolk_SetFailover(true, 0);
+  // Tried in the order of auto-detection.
+  g_first->SetFault(FlakyDriver::FAULT_FAIL, 1);
+  CHECK(Tolk_Output(L"second", false));
+  CHECK_TEXT(LastOutputDriver(), L"Second");
+  CHECK(g_second->GetSpoken().back() == L"second");
+  g_first->SetFault(FlakyDriver::FAULT_FAIL, 1);
+  g_second->SetFault(FlakyDriver::FAULT_FAIL, 1);
+  CHECK(Tolk_Speak(L"third", false));
+  CHECK_TEXT(LastOutputDriver(), L"Third");
+  CHECK(g_third->GetSpoken().back() == L"third");
+  // The current driver stays, the next text goes to it first.
+  CHECK_TEXT(DetectedDriver(), L"First");
+  CHECK(Tolk_Speak(L"first", false));
+  CHECK_TEXT(LastOutputDriver(), L"First");
+  // Each driver is tried once.
+  g_first->Clear();
+  g_second->Clear();
+  g_third->Clear();
+  g_first->SetFault(FlakyDriver::FAULT_FAIL, 1);
+  g_second->SetFault(FlakyDriver::FAULT_FAIL, 1);
+  g_third->SetFault(FlakyDriver::FAULT_FAIL, 1);
+  CHECK(!Tolk_Speak(L"lost", false));
+  CHECK(g_first->calls == 1 && g_second->calls == 1 && g_third->calls == 1);
+  CHECK(LastOutputDriver().empty());
+  // Inactive drivers are passed over.
+  g_first->SetFault(FlakyDriver::FAULT_FAIL, 1);
+  g_second->active = false;
+  CHECK(Tolk_Braille(L"third"));
+  CHECK_TEXT(LastOutputDriver(), L"Third");
+  CHECK(g_second->calls == 1);
+  g_second->active = true;
+  Tolk_Unload();
+  Tolk_SetFailover(false, 0);
+}
+
+static void TestIntermittent() {
+  Tolk_SetFailover(true, 0);
+  Load();
+  // The first driver fails every other call, the second every third. Nothing is lost
+  // and every text is delivered once, by the first driver in line that took it.
+  int delivered[3] = {};
+  for (int i = 0; i < 12; ++i) {
+    if (i % 2) g_first->SetFault(FlakyDriver::FAULT_FAIL, 1);
+    if (i % 3 == 0) g_second->SetFault(FlakyDriver::FAULT_FAIL, 1);
+    const std::wstring text = L"text " + std::to_wstring(i);
+    CHECK(Tolk_Speak(text.c_str(), false));
+    const std::wstring expected = !(i % 2) ? L"First" : (i % 3) ? L"Second" : L"Third";
+    CHECK_TEXT(LastOutputDriver(), expected);
+    ++delivered[!(i % 2) ? 0 : (i % 3) ? 1 : 2];
+    // A fault not used up by this text would hit the next one.
+    g_first->SetFault(FlakyDriver::FAULT_NONE);
+    g_second->SetFault(FlakyDriver::FAULT_NONE);
+  }
+  CHECK(g_first->GetSpoken().size() == (size_t)delivered[0]);
+  CHECK(g_second->GetSpoken().size() == (size_t)delivered[1]);
+  CHECK(g_third->GetSpoken().size() == (size_t)delivered[2]);
+  CHECK(delivered[0] == 6 && delivered[1] == 4 && delivered[2] == 2);
+  Tolk_Unload();
+  Tolk_SetFailover(false, 0);
+}
+
+static void TestOpenCircuit() {
+  Tolk_SetFailover(true, 0);
+  Tolk_SetCircuitBreaker(1, 10000, 10000);
+  Load();
+  // Open the second driver's circuit while it is the one in use.
+  g_first->active = false;
+  g_second->SetFault(FlakyDriver::FAULT_FAIL, 1);
+  CHECK(Tolk_Speak(L"tripped", false));
+  CHECK_TEXT(LastOutputDriver(), L"Third");
+  g_first->active = true;
+  // Failover from the first driver skips the second without calling it.
+  const int calls = g_second->calls;
+  const unsigned int rejected = Rejected(L"Second");
+  g_first->SetFault(FlakyDriver::FAULT_FAIL, 1);
+  CHECK(Tolk_Speak(L"skipped", false));
+  CHECK_TEXT(LastOutputDriver(), L"Third");
+  CHECK(g_second->calls == calls);
+  CHECK(Rejected(L"Second") > rejected);
+  Tolk_Unload();
+  Tolk_SetCircuitBreaker(0, 0, 0);
+  Tolk_SetFailover(false, 0);
+}
+
+static void TestSAPI() {
+  Tolk_SetFailover(true, 0);
+  Tolk_TrySAPI(true);
+  Load();
+  FlakyDriver *sapi = FlakyDriver::Find(L"SAPI");
+  CHECK(sapi);
+  // Last in line.
+  g_first->SetFault(FlakyDriver::FAULT_FAIL, 1);
+  g_second->SetFault(FlakyDriver::FAULT_FAIL, 1);
+  g_third->SetFault(FlakyDriver::FAULT_FAIL, 1);
+  CHECK(Tolk_Speak(L"sapi", false));
+  CHECK_TEXT(LastOutputDriver(), L"SAPI");
+  CHECK(sapi->GetSpoken().back() == L"sapi");
+  // Also with no screen reader running at all.
+  g_first->active = g_second->active = g_third->active = false;
+  CHECK_TEXT(DetectedDriver(), L"SAPI");
+  sapi->SetFault(FlakyDriver::FAULT_FAIL, 1);
+  CHECK(!Tolk_Speak(L"lost", false));
+  g_first->active = g_second->active = g_third->active = true;
+  // First in line when preferred, the screen readers follow in order.
+  Tolk_PreferSAPI(true);
+  CHECK(Tolk_Speak(L"preferred", false));
+  CHECK_TEXT(LastOutputDriver(), L"SAPI");
+  sapi->SetFault(FlakyDriver::FAULT_FAIL, 1);
+  CHECK(Tolk_Speak(L"first", false));
+  CHECK_TEXT(LastOutputDriver(), L"First");
+  Tolk_PreferSAPI(false);
+  // Left out once SAPI is no longer tried.
+  Tolk_TrySAPI(false);
+  CHECK(!FlakyDriver::Find(L"SAPI"));
+  g_first->SetFault(FlakyDriver::FAULT_FAIL, 1);
+  g_second->SetFault(FlakyDriver::FAULT_FAIL, 1);
+  g_third->SetFault(FlakyDriver::FAULT_FAIL, 1);
+  CHECK(!Tolk_Speak(L"lost", false));
+  Tolk_Unload();
+  Tolk_SetFailover(false, 0);
+}
+
+int main() {
+  TestOrder();
+  TestIntermittent();
+  TestOpenCircuit();
+  TestSAPI();
+  return TEST_RESULT();
+}
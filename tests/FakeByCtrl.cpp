@@ -0,0 +1,79 @@
+/**
+ *  Product:        Tolk
+ *  File:           FakeByCtrl.cpp
+ *  Description:    Stands in for BoyPCReader's control library in the BOY driver tests.
+ *  Copyright:      (c) 2026, Davy Kager <mail@davykager.nl>
+ *  License:        LGPLv3
+ */
+
+// Queues what it is asked to speak and finishes it when the test says so,
+// calling the completion callback of each utterance like BOY does.
+
+#include <windows.h>
+#include <deque>
+#include "ScreenReaderDriverBOY.h"
+
+#define FAKE_BYCTRL_EXPORT extern "C" __declspec(dllexport)
+
+namespace {
+
+std::deque<BoyCtrlSpeakCompleteFunc> g_queue;
+// Callbacks of utterances that were dropped, BOY still calls them.
+std::deque<BoyCtrlSpeakCompleteFunc> g_dropped;
+bool g_initialized = false;
+int g_speakResult = e_bcerr_success;
+
+} // namespace
+
+FAKE_BYCTRL_EXPORT int __stdcall BoyCtrlInitialize(const wchar_t *) {
+  g_initialized = true;
+  return e_bcerr_success;
+}
+
+FAKE_BYCTRL_EXPORT void __stdcall BoyCtrlUninitialize() {
+  g_initialized = false;
+  g_queue.clear();
+  g_dropped.clear();
+}
+
+FAKE_BYCTRL_EXPORT bool __stdcall BoyCtrlIsReaderRunning() {
+  return g_initialized;
+}
+
+FAKE_BYCTRL_EXPORT int __stdcall BoyCtrlSpeak(const wchar_t *, bool append, BoyCtrlSpeakCompleteFunc onCompletion) {
+  if (g_speakResult != e_bcerr_success) return g_speakResult;
+  if (!append) {
+    g_dropped.insert(g_dropped.end(), g_queue.begin(), g_queue.end());
+    g_queue.clear();
+  }
+  g_queue.push_back(onCompletion);
+  return e_bcerr_success;
+}
+
+FAKE_BYCTRL_EXPORT int __stdcall BoyCtrlStopSpeaking() {
+  g_dropped.insert(g_dropped.end(), g_queue.begin(), g_queue.end());
+  g_queue.clear();
+  return e_bcerr_success;
+}
+
+// For the tests: finishes the utterance being spoken, returns false if there is none.
+FAKE_BYCTRL_EXPORT bool __stdcall FakeByCtrl_Finish() {
+  if (g_queue.empty()) return false;
+  const BoyCtrlSpeakCompleteFunc onCompletion = g_queue.front();
+  g_queue.pop_front();
+  if (onCompletion) onCompletion(0);
+  return true;
+}
+
+// Calls back for the dropped utterances, late, as BOY may.
+FAKE_BYCTRL_EXPORT void __stdcall FakeByCtrl_ReportDropped() {
+  while (!g_dropped.empty()) {
+    const BoyCtrlSpeakCompleteFunc onCompletion = g_dropped.front();
+    g_dropped.pop_front();
+    if (onCompletion) onCompletion(1);
+  }
+}
+
+FAKE_BYCTRL_EXPORT void __stdcall FakeByCtrl_SetSpeakResult(int result) {
+  g_speakResult = result;
+}
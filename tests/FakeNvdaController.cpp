@@ -0,0 +1,63 @@
+/**
+ *  Product:        Tolk
+ *  File:           FakeNvdaController.cpp
+ *  Description:    Stands in for NVDA's controller client in the NVDA driver tests.
+ *  Copyright:      (c) 2026, Davy Kager <mail@davykager.nl>
+ *  License:        LGPLv3
+ */
+
+// Keeps the mark callback it is given and calls it when the test says so, from
+// the test's thread like an RPC thread of the real client would.
+
+#include <windows.h>
+#include <atomic>
+#include <string>
+
+#define FAKE_NVDA_EXPORT extern "C" __declspec(dllexport)
+
+typedef error_status_t (__stdcall *OnSsmlMarkReachedFunc)(const wchar_t *);
+
+namespace {
+
+std::atomic<OnSsmlMarkReachedFunc> g_onMarkReached(nullptr);
+std::wstring g_ssml;
+
+} // namespace
+
+FAKE_NVDA_EXPORT error_status_t __stdcall nvdaController_speakText(const wchar_t *) {
+  return 0;
+}
+
+FAKE_NVDA_EXPORT error_status_t __stdcall nvdaController_brailleMessage(const wchar_t *) {
+  return 0;
+}
+
+FAKE_NVDA_EXPORT error_status_t __stdcall nvdaController_cancelSpeech() {
+  return 0;
+}
+
+FAKE_NVDA_EXPORT error_status_t __stdcall nvdaController_testIfRunning() {
+  return 0;
+}
+
+FAKE_NVDA_EXPORT error_status_t __stdcall nvdaController_speakSsml(const wchar_t *ssml, int, int, BOOL) {
+  g_ssml = ssml;
+  return 0;
+}
+
+FAKE_NVDA_EXPORT error_status_t __stdcall nvdaController_setOnSsmlMarkReachedCallback(OnSsmlMarkReachedFunc callback) {
+  g_onMarkReached = callback;
+  return 0;
+}
+
+// For the tests: reports the mark if a callback is set, returns whether one was.
+FAKE_NVDA_EXPORT bool __stdcall FakeNvda_ReachMark(const wchar_t *name) {
+  const OnSsmlMarkReachedFunc callback = g_onMarkReached;
+  if (!callback) return false;
+  callback(name);
+  return true;
+}
+
+FAKE_NVDA_EXPORT const wchar_t *__stdcall FakeNvda_GetSsml() {
+  return g_ssml.c_str();
+}
@@ -0,0 +1,127 @@
+/**
+ *  Product:        Tolk
+ *  File:           HedgingTest.cpp
+ *  Description:    Tests of hedged output, with a screen reader that is slow to accept text.
+ *  Copyright:      (c) 2026, Davy Kager <mail@davykager.nl>
+ *  License:        LGPLv3
+ */
+
+#include <windows.h>
+#include "Tolk.h"
+#include "FlakyDriver.h"
+#include "TolkTest.h"
+
+#define BUDGET 50
+#define SLOW 300
+
+static FlakyDriver *g_first;
+static FlakyDriver *g_second;
+
+static void Load() {
+  Tolk_Load();
+  g_first = FlakyDriver::Find(L"First");
+  g_second = FlakyDriver::Find(L"Second");
+  CHECK(g_first && g_second);
+}
+
+static std::wstring LastOutputDriver() {
+  const wchar_t *name = Tolk_GetLastOutputDriver();
+  return name ? name : L"";
+}
+
+static ULONGLONG Elapsed(ULONGLONG start) {
+  return GetTickCount64() - start;
+}
+
+static bool HasSpoken(FlakyDriver *driver, const wchar_t *text) {
+  const std::vector<std::wstring> spoken = driver->GetSpoken();
+  return (!spoken.empty() && spoken.back() == text);
+}
+
+static void TestFast() {
+  Tolk_SetHedging(BUDGET, L"Second");
+  Load();
+  CHECK(Tolk_Speak(L"fast", false));
+  CHECK_TEXT(LastOutputDriver(), L"First");
+  CHECK(HasSpoken(g_first, L"fast"));
+  CHECK(g_second->GetSpoken().empty());
+  CHECK(g_first->silences == 0);
+  Tolk_Unload();
+  Tolk_SetHedging(0, nullptr);
+}
+
+static void TestLate() {
+  Tolk_SetHedging(BUDGET, L"Second");
+  Load();
+  g_first->delay = SLOW;
+  // The secondary gets the text once the budget has run out.
+  ULONGLONG start = GetTickCount64();
+  CHECK(Tolk_Speak(L"hedged", false));
+  CHECK(Elapsed(start) >= BUDGET - 10 && Elapsed(start) < SLOW - 50);
+  CHECK_TEXT(LastOutputDriver(), L"Second");
+  CHECK(HasSpoken(g_second, L"hedged"));
+  // While the abandoned call is still inside the primary, the next text goes straight to the secondary.
+  start = GetTickCount64();
+  CHECK(Tolk_Output(L"skipped", false));
+  CHECK(Elapsed(start) < BUDGET);
+  CHECK_TEXT(LastOutputDriver(), L"Second");
+  // The primary speaks the text late after all, the worker finds the job abandoned and silences it.
+  CHECK(WaitUntil([]() { return g_first->silences == 1; }, 2 * SLOW));
+  CHECK(HasSpoken(g_first, L"hedged"));
+  CHECK(g_first->calls == 1);
+  // Detection moved on when the primary was skipped, it comes back once the call has returned.
+  g_first->delay = 0;
+  g_second->active = false;
+  CHECK(WaitUntil([]() { return Tolk_Speak(L"back", false) && LastOutputDriver() == L"First"; }, SLOW));
+  CHECK(g_first->silences == 1);
+  Tolk_Unload();
+  Tolk_SetHedging(0, nullptr);
+}
+
+static void TestLateFailure() {
+  Tolk_SetHedging(BUDGET, L"Second");
+  Load();
+  // Nothing to silence when the late call failed.
+  g_first->delay = SLOW;
+  g_first->SetFault(FlakyDriver::FAULT_FAIL, 1);
+  CHECK(Tolk_Speak(L"hedged", false));
+  CHECK_TEXT(LastOutputDriver(), L"Second");
+  CHECK(WaitUntil([]() { return g_first->failures == 1; }, 2 * SLOW));
+  Sleep(BUDGET);
+  CHECK(g_first->silences == 0);
+  Tolk_Unload();
+  Tolk_SetHedging(0, nullptr);
+}
+
+static void TestSecondary() {
+  // Without a name the next active driver in line.
+  Tolk_SetHedging(BUDGET, nullptr);
+  Load();
+  g_first->delay = SLOW;
+  g_second->active = false;
+  CHECK(Tolk_Speak(L"third", false));
+  CHECK_TEXT(LastOutputDriver(), L"Third");
+  CHECK(WaitUntil([]() { return g_first->silences == 1; }, 2 * SLOW));
+  // The worker is done with the call right after the silence.
+  Sleep(BUDGET);
+  // Braille is not hedged, the primary gets all the time it needs.
+  const ULONGLONG start = GetTickCount64();
+  CHECK(Tolk_Braille(L"braille"));
+  CHECK(Elapsed(start) >= SLOW - 10);
+  CHECK_TEXT(LastOutputDriver(), L"First");
+  // A secondary that is not active is no hedge, the primary is waited for.
+  Tolk_SetHedging(BUDGET, L"Second");
+  CHECK(Tolk_Speak(L"waited", false));
+  CHECK_TEXT(LastOutputDriver(), L"First");
+  CHECK(g_first->silences == 1);
+  Tolk_Unload();
+  Tolk_SetHedging(0, nullptr);
+}
+
+int main() {
+  TestFast();
+  TestLate();
+  TestLateFailure();
+  TestSecondary();
+  return TEST_RESULT();
+}
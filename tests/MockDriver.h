@@ -0,0 +1,87 @@
+/**
+ *  Product:        Tolk
+ *  File:           MockDriver.h
+ *  Description:    Screen reader driver that records what it is given, for tests.
+ *  Copyright:      (c) 2026, Davy Kager <mail@davykager.nl>
+ *  License:        LGPLv3
+ */
+
+#ifndef _MOCK_DRIVER_H_
+#define _MOCK_DRIVER_H_
+
+#include <string>
+#include <vector>
+#include "ScreenReaderDriver.h"
+
+// Speech is finished as soon as it is given unless speaking is set. With
+// bookmarks set it takes SSML and reports the marks in it through onMark,
+// all at once or as the test finishes each mark.
+class MockDriver final : public ScreenReaderDriver {
+public:
+  typedef void (*MarkListener)(unsigned long bookmark);
+
+public:
+  explicit MockDriver(const wchar_t *name, bool bookmarks = false) :
+    ScreenReaderDriver(name, true, true, true),
+    bookmarks(bookmarks),
+    speaking(false),
+    cells(0),
+    onMark(nullptr)
+    {}
+
+public:
+  bool Speak(const wchar_t *str, bool interrupt) override {
+    if (interrupt) spoken.clear();
+    spoken.emplace_back(str);
+    return true;
+  }
+  bool Braille(const wchar_t *str) override {
+    brailled.emplace_back(str);
+    return true;
+  }
+  bool IsSpeaking() override { return speaking; }
+  bool Silence() override {
+    spoken.clear();
+    pendingMarks.clear();
+    return true;
+  }
+  bool IsActive() override { return true; }
+  bool Output(const wchar_t *str, bool interrupt) override {
+    const bool speak = Speak(str, interrupt);
+    const bool braille = Braille(str);
+    return (speak || braille);
+  }
+  unsigned int GetBrailleCells() override { return cells; }
+  bool SpeakSsml(const wchar_t *ssml, bool interrupt) override {
+    if (interrupt) pendingMarks.clear();
+    // Marks are <mark name="N"/>, as Tolk writes them.
+    const std::wstring text(ssml);
+    for (size_t at = text.find(L"<mark name=\""); at != std::wstring::npos; at = text.find(L"<mark name=\"", at + 1)) {
+      pendingMarks.push_back(wcstoul(text.c_str() + at + 12, nullptr, 10));
+    }
+    return Speak(ssml, interrupt);
+  }
+  bool HasSsml() const override { return bookmarks; }
+  bool HasBookmarks() const override { return bookmarks; }
+
+public:
+  // Reports the next mark the speech has reached, returns false if there is none.
+  bool ReachMark() {
+    if (pendingMarks.empty()) return false;
+    const unsigned long bookmark = pendingMarks.front();
+    pendingMarks.erase(pendingMarks.begin());
+    if (onMark) onMark(bookmark);
+    return true;
+  }
+
+public:
+  const bool bookmarks;
+  bool speaking;
+  unsigned int cells;
+  MarkListener onMark;
+  std::vector<std::wstring> spoken;
+  std::vector<std::wstring> brailled;
+  std::vector<unsigned long> pendingMarks;
+};
+
+#endif // _MOCK_DRIVER_H_
@@ -0,0 +1,100 @@
+/**
+ *  Product:        Tolk
+ *  File:           NvdaDriverTest.cpp
+ *  Description:    Tests of NVDA's SSML marks reaching Tolk, and of the driver going while they do.
+ *  Copyright:      (c) 2026, Davy Kager <mail@davykager.nl>
+ *  License:        LGPLv3
+ */
+
+#include <windows.h>
+#include <atomic>
+#include <memory>
+#include <thread>
+#include "ScreenReaderDriverNVDA.h"
+#include "SpeechProgress.h"
+#include "TolkTest.h"
+
+#ifdef _WIN64
+#define FAKE_NVDA L"nvdaControllerClient64.dll"
+#else
+#define FAKE_NVDA L"nvdaControllerClient32.dll"
+#endif
+
+// Time the progress listener takes over a mark.
+#define SLOW_LISTENER 200
+
+typedef bool (__stdcall *ReachMarkFunc)(const wchar_t *name);
+typedef const wchar_t *(__stdcall *GetSsmlFunc)();
+
+// The driver's own handle to the fake library is private, a second one reaches the same library.
+static HINSTANCE g_controller;
+static ReachMarkFunc ReachMark;
+static GetSsmlFunc GetSsml;
+
+static std::atomic<long> g_bookmark(-1);
+static std::atomic<bool> g_inListener(false);
+static std::atomic<bool> g_listenerDone(false);
+
+static void OnProgress(ScreenReaderDriver *, int event, unsigned long position, unsigned long) {
+  if (event == SPEECH_PROGRESS_BOOKMARK) g_bookmark = (long)position;
+}
+
+static void OnProgressSlowly(ScreenReaderDriver *, int, unsigned long, unsigned long) {
+  g_inListener = true;
+  Sleep(SLOW_LISTENER);
+  g_listenerDone = true;
+}
+
+static void TestMarks() {
+  ScreenReaderDriverNVDA driver;
+  driver.SetProgressListener(OnProgress);
+  CHECK(driver.HasSsml() && driver.HasBookmarks());
+  CHECK(driver.SpeakSsml(L"<mark name=\"7\"/>Hello", false));
+  CHECK_TEXT(GetSsml(), L"<speak version=\"1.0\" xmlns=\"http://www.w3.org/2001/10/synthesis\"><mark name=\"7\"/>Hello</speak>");
+  CHECK(ReachMark(L"7"));
+  CHECK(g_bookmark == 7);
+  // Marks Tolk didn't name are not reported.
+  g_bookmark = -1;
+  CHECK(ReachMark(L"seven"));
+  CHECK(ReachMark(L"7a"));
+  CHECK(ReachMark(L""));
+  CHECK(g_bookmark == -1);
+  // Only one driver listens.
+  {
+    ScreenReaderDriverNVDA second;
+    CHECK(!second.HasBookmarks());
+  }
+  CHECK(ReachMark(L"8"));
+  CHECK(g_bookmark == 8);
+}
+
+static void TestDestroyDuringMark() {
+  auto driver = std::make_unique<ScreenReaderDriverNVDA>();
+  driver->SetProgressListener(OnProgressSlowly);
+  // A mark is being reported when the driver goes.
+  std::thread rpc([]() { ReachMark(L"1"); });
+  CHECK(WaitUntil([]() { return g_inListener.load(); }, 1000));
+  driver.reset();
+  // The driver waited for the mark, and stopped listening.
+  CHECK(g_listenerDone);
+  rpc.join();
+  CHECK(!ReachMark(L"2"));
+  // Another driver listens in its place.
+  ScreenReaderDriverNVDA again;
+  again.SetProgressListener(OnProgress);
+  CHECK(again.HasBookmarks());
+  CHECK(ReachMark(L"3"));
+  CHECK(g_bookmark == 3);
+}
+
+int main() {
+  g_controller = LoadLibraryW(FAKE_NVDA);
+  CHECK(g_controller != nullptr);
+  if (!g_controller) return TEST_RESULT();
+  ReachMark = (ReachMarkFunc)GetProcAddress(g_controller, "FakeNvda_ReachMark");
+  GetSsml = (GetSsmlFunc)GetProcAddress(g_controller, "FakeNvda_GetSsml");
+  TestMarks();
+  TestDestroyDuringMark();
+  FreeLibrary(g_controller);
+  return TEST_RESULT();
+}
@@ -0,0 +1,70 @@
+/**
+ *  Product:        Tolk
+ *  File:           PluginTest.cpp
+ *  Description:    Tests of loading screen reader drivers from plugin libraries.
+ *  Copyright:      (c) 2026, Davy Kager <mail@davykager.nl>
+ *  License:        LGPLv3
+ */
+
+#include "ScreenReaderDriverPlugin.h"
+#include "TolkTest.h"
+
+typedef const wchar_t * (TOLK_PLUGIN_CALL *TakeLogFunc)();
+
+// The loader's own handle is private, a second one reaches the same loaded plugin.
+static std::wstring TakeLog(HINSTANCE plugin) {
+  const TakeLogFunc takeLog = plugin ? (TakeLogFunc)GetProcAddress(plugin, "TestPlugin_TakeLog") : nullptr;
+  const wchar_t *log = takeLog ? takeLog() : nullptr;
+  return log ? log : L"(not initialized)";
+}
+
+static void TestLoading() {
+  ScreenReaderDriverPlugin driver(L"TestPlugin.dll");
+  // Named after the file and not loaded until auto-detection gets to it.
+  CHECK_TEXT(driver.GetName(), L"TestPlugin");
+  CHECK(!driver.HasSpeech());
+  CHECK(!driver.Speak(L"early", false));
+  CHECK(driver.IsActive());
+  CHECK_TEXT(driver.GetName(), L"Test Plugin");
+  CHECK(driver.HasSpeech() && driver.HasBraille() && !driver.HasStatus());
+  HINSTANCE plugin = LoadLibraryExW(L"TestPlugin.dll", nullptr, LOAD_WITH_ALTERED_SEARCH_PATH);
+  CHECK(plugin != nullptr);
+  CHECK(driver.Speak(L"one", true));
+  // Output falls back to Speak and Braille.
+  CHECK(driver.Output(L"two", false));
+  CHECK_TEXT(TakeLog(plugin), L"speak! one;speak two;braille two;");
+  // Members the plugin left out.
+  CHECK(!driver.IsSpeaking());
+  CHECK(!driver.Silence());
+  CHECK(driver.GetBrailleCells() == 32);
+  if (plugin) FreeLibrary(plugin);
+}
+
+static void TestFinalize() {
+  HINSTANCE plugin = LoadLibraryExW(L"TestPlugin.dll", nullptr, LOAD_WITH_ALTERED_SEARCH_PATH);
+  {
+    ScreenReaderDriverPlugin driver(L"TestPlugin.dll");
+    CHECK(driver.IsActive());
+    CHECK_TEXT(TakeLog(plugin), L"");
+  }
+  CHECK_TEXT(TakeLog(plugin), L"(not initialized)");
+  if (plugin) FreeLibrary(plugin);
+}
+
+static void TestRefused() {
+  // A plugin for a newer ABI is refused, and not tried again.
+  ScreenReaderDriverPlugin newer(L"TestPluginNewer.dll");
+  CHECK(!newer.IsActive());
+  CHECK(!newer.IsActive());
+  CHECK_TEXT(newer.GetName(), L"TestPluginNewer");
+  ScreenReaderDriverPlugin missing(L"NoSuchPlugin.dll");
+  CHECK(!missing.IsActive());
+  CHECK(!missing.Output(L"text", false));
+}
+
+int main() {
+  TestLoading();
+  TestFinalize();
+  TestRefused();
+  return TEST_RESULT();
+}
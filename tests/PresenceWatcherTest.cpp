@@ -0,0 +1,95 @@
+/**
+ *  Product:        Tolk
+ *  File:           PresenceWatcherTest.cpp
+ *  Description:    Tests of the watcher for screen readers starting and stopping.
+ *  Copyright:      (c) 2026, Davy Kager <mail@davykager.nl>
+ *  License:        LGPLv3
+ */
+
+// Only built with compat/windows.h: on Windows the watcher skips the windows of
+// its own process, which are the only ones a test can make.
+
+#include <windows.h>
+#include <atomic>
+#include "PresenceWatcher.h"
+#include "TolkTest.h"
+
+// Leeway for the scheduler, well below the refresh interval.
+#define SLACK 300
+
+static std::atomic<int> g_changes(0);
+
+static void OnChanged() {
+  ++g_changes;
+}
+
+// Whether the listener was called exactly count times, and not again after it
+// settled. A phase calls this at most three times, staying below the refresh.
+static bool Changed(int count) {
+  if (!WaitUntil([count]() { return g_changes >= count; }, PRESENCE_SETTLE_DELAY + SLACK)) return false;
+  Sleep(PRESENCE_SETTLE_DELAY + SLACK);
+  return (g_changes == count);
+}
+
+static void TestCreate() {
+  g_changes = 0;
+  PresenceWatcher watcher(OnChanged);
+  CHECK(watcher.IsRunning());
+  CHECK(watcher.GetSerial() == 0);
+  // A burst of windows makes for a single call.
+  const HWND first = CompatCreateWindow(nullptr);
+  CompatCreateWindow(nullptr);
+  CHECK(Changed(1));
+  CHECK(watcher.GetSerial() == 1);
+  // Child windows don't count.
+  CompatCreateWindow(first);
+  CHECK(Changed(1));
+}
+
+static void TestDestroy() {
+  const HWND window = CompatCreateWindow(nullptr);
+  g_changes = 0;
+  PresenceWatcher watcher(OnChanged);
+  // Child windows don't count when they go either.
+  const HWND child = CompatCreateWindow(window);
+  CompatDestroyWindow(child);
+  CHECK(Changed(0));
+  // Top-level windows do, made before the watcher started or not. Their children
+  // go with them and don't add to it.
+  CompatCreateWindow(window);
+  const HWND later = CompatCreateWindow(nullptr);
+  CHECK(Changed(1));
+  CompatDestroyWindow(window);
+  CompatDestroyWindow(later);
+  CHECK(Changed(2));
+}
+
+static void TestDestroyedTwice() {
+  const HWND window = CompatCreateWindow(nullptr);
+  g_changes = 0;
+  PresenceWatcher watcher(OnChanged);
+  CompatDestroyWindow(window);
+  CHECK(Changed(1));
+  // Only the first destroy is of a window that was known.
+  CompatDestroyWindow(window);
+  CHECK(Changed(1));
+}
+
+static void TestRefresh() {
+  g_changes = 0;
+  PresenceWatcher watcher(OnChanged);
+  // Only one watcher at a time.
+  PresenceWatcher other(OnChanged);
+  CHECK(!other.IsRunning());
+  // Without windows, the listener is still called now and then.
+  CHECK(WaitUntil([]() { return g_changes >= 1; }, PRESENCE_REFRESH_INTERVAL + SLACK));
+  CHECK(watcher.GetSerial() == 1);
+}
+
+int main() {
+  TestCreate();
+  TestDestroy();
+  TestDestroyedTwice();
+  TestRefresh();
+  return TEST_RESULT();
+}
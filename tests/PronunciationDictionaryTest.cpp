@@ -0,0 +1,92 @@
+/**
+ *  Product:        Tolk
+ *  File:           PronunciationDictionaryTest.cpp
+ *  Description:    Tests of loading a pronunciation dictionary and applying it.
+ *  Copyright:      (c) 2026, Davy Kager <mail@davykager.nl>
+ *  License:        LGPLv3
+ */
+
+#include <cstdio>
+#include <string>
+#include "PronunciationDictionary.h"
+#include "TolkTest.h"
+
+#define TEST_DICTIONARY "PronunciationDictionaryTest.txt"
+
+static std::shared_ptr<const PronunciationDictionary> Load(const std::string &contents) {
+  FILE *file = fopen(TEST_DICTIONARY, "wb");
+  if (!file) return nullptr;
+  fwrite(contents.data(), 1, contents.size(), file);
+  fclose(file);
+  std::shared_ptr<const PronunciationDictionary> dictionary = PronunciationDictionary::Load(L"" TEST_DICTIONARY);
+  remove(TEST_DICTIONARY);
+  return dictionary;
+}
+
+static void TestMatching() {
+  const std::shared_ptr<const PronunciationDictionary> dictionary = Load(
+    "# Games\n"
+    "hp\thit points\n"
+    "hpc\thigh performance\n"
+    "gg\tgood game\tignored\n"
+    "c++\tc plus plus\r\n"
+    "he\tHE\n"
+    "she\tSHE\n"
+    "hers\tHERS\n"
+    "\n"
+    "xp\texperience\n"
+    "xp\tEXP\n"
+    "\xC3\xA9" "a\tEA\n");
+  CHECK(dictionary != nullptr);
+  if (!dictionary) return;
+  CHECK(dictionary->GetSize() == 9);
+  CHECK_TEXT(dictionary->Apply(L"You have 10 HP left"), L"You have 10 hit points left");
+  // The longest of the patterns that start at the same place.
+  CHECK_TEXT(dictionary->Apply(L"HPC cluster"), L"high performance cluster");
+  // Only whole words, on the sides that are letters or digits.
+  CHECK_TEXT(dictionary->Apply(L"HPX"), L"HPX");
+  CHECK_TEXT(dictionary->Apply(L"ushers"), L"ushers");
+  CHECK_TEXT(dictionary->Apply(L"I like C++."), L"I like c plus plus.");
+  CHECK_TEXT(dictionary->Apply(L"gg, she said"), L"good game, SHE said");
+  // Of patterns listed twice the last one wins.
+  CHECK_TEXT(dictionary->Apply(L"xp"), L"EXP");
+  CHECK_TEXT(dictionary->Apply(L"\xC9" L"A"), L"EA");
+  const wchar_t *unchanged = L"nothing to replace";
+  CHECK(dictionary->Apply(unchanged) == unchanged);
+}
+
+static void TestByteOrderMark() {
+  const std::shared_ptr<const PronunciationDictionary> dictionary = Load("\xEF\xBB\xBF" "brb\tbe right back\n");
+  CHECK(dictionary != nullptr);
+  if (!dictionary) return;
+  CHECK_TEXT(dictionary->Apply(L"brb"), L"be right back");
+}
+
+static void TestEmptyAndMissing() {
+  const std::shared_ptr<const PronunciationDictionary> dictionary = Load("");
+  CHECK(dictionary != nullptr);
+  if (dictionary) CHECK(dictionary->GetSize() == 0);
+  CHECK(PronunciationDictionary::Load(L"does-not-exist.txt") == nullptr);
+}
+
+static void TestLargeDictionary() {
+  std::string contents;
+  for (int i = 0; i < 20000; ++i) {
+    std::string pattern = "w";
+    for (int x = i; pattern.size() == 1 || x; x /= 26) pattern += (char)('a' + x % 26);
+    contents += pattern + "\tR\n";
+  }
+  const std::shared_ptr<const PronunciationDictionary> dictionary = Load(contents);
+  CHECK(dictionary != nullptr);
+  if (!dictionary) return;
+  CHECK(dictionary->GetSize() == 20000);
+  CHECK_TEXT(dictionary->Apply(L"say wab now, wzzzz"), L"say R now, wzzzz");
+}
+
+int main() {
+  TestMatching();
+  TestByteOrderMark();
+  TestEmptyAndMissing();
+  TestLargeDictionary();
+  return TEST_RESULT();
+}
@@ -0,0 +1,136 @@
+/**
+ *  Product:        Tolk
+ *  File:           SpeechEndTest.cpp
+ *  Description:    Tests of waiting for the end of speech, with drivers that signal it, are asked for it or can't tell.
+ *  Copyright:      (c) 2026, Davy Kager <mail@davykager.nl>
+ *  License:        LGPLv3
+ */
+
+#include <windows.h>
+#include <thread>
+#include "Tolk.h"
+#include "FlakyDriver.h"
+#include "SpeechEstimator.h"
+#include "SpeechMonitor.h"
+#include "TolkTest.h"
+
+// Time the mock driver speaks for.
+#define SPEECH 300
+// Leeway for the scheduler.
+#define SLACK 100
+// Estimated at the default rate: a lead, a word and five letters.
+#define SAVED_ESTIMATE 420
+
+static FlakyDriver *g_first;
+
+static void Load(bool status, bool signal) {
+  Tolk_Load();
+  g_first = FlakyDriver::Find(L"First");
+  CHECK(g_first);
+  g_first->SetStatus(status, signal);
+}
+
+static ULONGLONG Elapsed(ULONGLONG start) {
+  return GetTickCount64() - start;
+}
+
+// Speaks until the speech is finished from another thread after SPEECH, returns how long the wait took.
+static ULONGLONG WaitForFinish(const wchar_t *text) {
+  g_first->holdSpeech = true;
+  CHECK(Tolk_Speak(text, false));
+  const ULONGLONG start = GetTickCount64();
+  std::thread finisher([]() {
+    Sleep(SPEECH);
+    g_first->FinishSpeech();
+  });
+  CHECK(!Tolk_WaitForSpeechEnd(SPEECH / 3));
+  CHECK(Tolk_WaitForSpeechEnd(TOLK_WAIT_INFINITE));
+  const ULONGLONG elapsed = Elapsed(start);
+  finisher.join();
+  g_first->holdSpeech = false;
+  return elapsed;
+}
+
+static void TestUnloaded() {
+  CHECK(!Tolk_WaitForSpeechEnd(0));
+  CHECK(!Tolk_GetSpeechEventHandle());
+}
+
+// Runs before the drivers with status, what they report calibrates the estimate.
+static void TestEstimated() {
+  Load(false, false);
+  // Nothing spoken yet.
+  CHECK(Tolk_WaitForSpeechEnd(0));
+  ULONGLONG start = GetTickCount64();
+  CHECK(Tolk_Speak(L"Saved", false));
+  CHECK(!Tolk_WaitForSpeechEnd(SAVED_ESTIMATE / 2));
+  CHECK(Tolk_WaitForSpeechEnd(SAVED_ESTIMATE + SLACK));
+  CHECK(Elapsed(start) >= SAVED_ESTIMATE - 20);
+  CHECK(g_first->statusCalls == 0);
+  // Queued text adds to the estimate, the wait is for the last of it.
+  start = GetTickCount64();
+  CHECK(Tolk_Speak(L"Saved", false));
+  CHECK(Tolk_Speak(L"Saved", false));
+  CHECK(!Tolk_WaitForSpeechEnd(SAVED_ESTIMATE));
+  CHECK(Tolk_WaitForSpeechEnd(SAVED_ESTIMATE + SLACK));
+  CHECK(Elapsed(start) >= 2 * SAVED_ESTIMATE - 20);
+  // A faster rate shortens it.
+  Tolk_SetSpeechRate(2 * SPEECH_DEFAULT_RATE);
+  start = GetTickCount64();
+  CHECK(Tolk_Speak(L"Saved", false));
+  CHECK(Tolk_WaitForSpeechEnd(SAVED_ESTIMATE / 2 + SLACK));
+  CHECK(Elapsed(start) >= SAVED_ESTIMATE / 2 - 20);
+  Tolk_SetSpeechRate(0);
+  // Silencing ends it at once.
+  CHECK(Tolk_Speak(L"A long text that takes several seconds to speak, or so the estimate says.", false));
+  CHECK(!Tolk_WaitForSpeechEnd(0));
+  CHECK(Tolk_Silence());
+  CHECK(Tolk_WaitForSpeechEnd(SLACK));
+  Tolk_Unload();
+}
+
+static void TestSignaled() {
+  Load(true, true);
+  g_first->Clear();
+  const ULONGLONG elapsed = WaitForFinish(L"signaled");
+  CHECK(elapsed >= SPEECH - 20 && elapsed < SPEECH + SLACK);
+  // The event ends the wait, the driver is only asked when the monitor wakes.
+  CHECK(g_first->statusCalls < SPEECH / SPEECH_POLL_INTERVAL / 2);
+  Tolk_Unload();
+}
+
+static void TestPolled() {
+  Load(true, false);
+  g_first->Clear();
+  const ULONGLONG elapsed = WaitForFinish(L"polled");
+  CHECK(elapsed >= SPEECH - 20 && elapsed < SPEECH + SPEECH_POLL_INTERVAL + SLACK);
+  CHECK(g_first->statusCalls >= SPEECH / SPEECH_POLL_INTERVAL - 1);
+  // Silencing ends it without waiting for the next poll.
+  g_first->holdSpeech = true;
+  CHECK(Tolk_Speak(L"silenced", false));
+  CHECK(!Tolk_WaitForSpeechEnd(SPEECH_POLL_INTERVAL));
+  CHECK(Tolk_Silence());
+  CHECK(Tolk_WaitForSpeechEnd(SPEECH_POLL_INTERVAL / 2));
+  g_first->holdSpeech = false;
+  Tolk_Unload();
+}
+
+static void TestGrace() {
+  // A driver that never reports speech is given time to start.
+  Load(true, false);
+  const ULONGLONG start = GetTickCount64();
+  CHECK(Tolk_Speak(L"not started", false));
+  CHECK(!Tolk_WaitForSpeechEnd(SPEECH_START_GRACE / 2));
+  CHECK(Tolk_WaitForSpeechEnd(SPEECH_START_GRACE + SLACK));
+  CHECK(Elapsed(start) >= SPEECH_START_GRACE - 20);
+  Tolk_Unload();
+}
+
+int main() {
+  TestUnloaded();
+  TestEstimated();
+  TestSignaled();
+  TestPolled();
+  TestGrace();
+  return TEST_RESULT();
+}
@@ -0,0 +1,156 @@
+/**
+ *  Product:        Tolk
+ *  File:           SpeechEstimatorTest.cpp
+ *  Description:    Tests of the speaking time estimate and its calibration.
+ *  Copyright:      (c) 2026, Davy Kager <mail@davykager.nl>
+ *  License:        LGPLv3
+ */
+
+#include "MockDriver.h"
+#include "SpeechEstimator.h"
+#include "TolkTest.h"
+
+// Estimated at the default rate: a lead, a word and five letters.
+#define SAVED_COST 420
+// The lead alone.
+#define EMPTY_COST 80
+
+// Reports speech ending right away, which clamps the ratio to its minimum.
+static void ObserveShort(SpeechEstimator &estimator, ScreenReaderDriver *driver) {
+  estimator.Spoke(driver, L"Saved", true);
+  estimator.Observe(driver, true);
+  estimator.Observe(driver, false);
+}
+
+// Reports speech going on for far longer than the estimate, which clamps the ratio to its maximum.
+static void ObserveLong(SpeechEstimator &estimator, ScreenReaderDriver *driver) {
+  estimator.Spoke(driver, L"", true);
+  for (int i = 0; i < 8; ++i) {
+    estimator.Observe(driver, true);
+    Sleep(50);
+  }
+  estimator.Observe(driver, false);
+}
+
+static void TestCost() {
+  SpeechEstimator estimator;
+  MockDriver driver(L"Mock");
+  CHECK(estimator.Estimate(&driver, L"") == EMPTY_COST);
+  CHECK(estimator.Estimate(&driver, L"Saved") == SAVED_COST);
+  // Digits and syllabic characters each take their own time, pauses follow punctuation.
+  CHECK(estimator.Estimate(&driver, L"42") == EMPTY_COST + 2 * 120);
+  CHECK(estimator.Estimate(&driver, L"\x4F60\x597D") == EMPTY_COST + 2 * 210);
+  CHECK(estimator.Estimate(&driver, L"Saved.") == SAVED_COST + 300);
+  CHECK(estimator.Estimate(&driver, L"Saved,") == SAVED_COST + 150);
+  // The rate scales everything.
+  estimator.SetRate(2 * SPEECH_DEFAULT_RATE);
+  CHECK(estimator.Estimate(&driver, L"Saved") == SAVED_COST / 2);
+  estimator.SetRate(0);
+  CHECK(estimator.Estimate(&driver, L"Saved") == SAVED_COST);
+  // Positions are reached in order, the end of the text at the full estimate.
+  const size_t positions[] = { 0, 5, 7, 12 };
+  DWORD offsets[4] = {};
+  estimator.EstimatePositions(&driver, L"Saved again.", positions, 4, offsets);
+  CHECK(offsets[0] == EMPTY_COST && offsets[1] == SAVED_COST);
+  CHECK(offsets[1] < offsets[2] && offsets[2] < offsets[3]);
+  CHECK(offsets[3] == estimator.Estimate(&driver, L"Saved again."));
+}
+
+static void TestRemaining() {
+  SpeechEstimator estimator;
+  MockDriver driver(L"Mock");
+  CHECK(!estimator.IsSpeaking(&driver));
+  estimator.Spoke(&driver, L"Saved", false);
+  CHECK(estimator.GetRemaining(&driver) > SAVED_COST - 20 && estimator.GetRemaining(&driver) <= SAVED_COST);
+  // Queued text starts once the text before it is done, interrupting starts over.
+  estimator.Spoke(&driver, L"Saved", false);
+  CHECK(estimator.GetRemaining(&driver) > 2 * SAVED_COST - 20);
+  estimator.Spoke(&driver, L"Saved", true);
+  CHECK(estimator.GetRemaining(&driver) <= SAVED_COST);
+  estimator.Silenced(&driver);
+  CHECK(!estimator.IsSpeaking(&driver));
+  CHECK(!estimator.GetRemaining(&driver));
+}
+
+static void TestClamp() {
+  SpeechEstimator estimator;
+  MockDriver driver(L"Mock");
+  // Ended at once, the ratio is at least a quarter: 1 * 0.8 + 0.25 * 0.2.
+  ObserveShort(estimator, &driver);
+  CHECK(estimator.Estimate(&driver, L"Saved") == (DWORD)(SAVED_COST * 0.85));
+  // Far longer than estimated, the ratio is at most 4: 0.85 * 0.8 + 4 * 0.2.
+  ObserveLong(estimator, &driver);
+  CHECK(estimator.Estimate(&driver, L"Saved") == (DWORD)(SAVED_COST * 1.48));
+  // The new scale applies to what is spoken next.
+  estimator.Spoke(&driver, L"Saved", true);
+  CHECK(estimator.GetRemaining(&driver) > (DWORD)(SAVED_COST * 1.48) - 20);
+  estimator.Silenced(&driver);
+}
+
+static void TestSmoothing() {
+  SpeechEstimator estimator;
+  MockDriver driver(L"Mock");
+  // Each observation moves the scale a fifth of the way to the ratio: 0.25 + 0.75 * 0.8^n.
+  double scale = 1.0;
+  for (int i = 0; i < 10; ++i) {
+    ObserveShort(estimator, &driver);
+    scale = scale * 0.8 + 0.25 * 0.2;
+    CHECK(estimator.Estimate(&driver, L"Saved") == (DWORD)(SAVED_COST * scale));
+  }
+  CHECK(estimator.Estimate(&driver, L"Saved") > SAVED_COST / 4);
+  CHECK(estimator.Estimate(&driver, L"Saved") < SAVED_COST / 3);
+}
+
+static void TestUntrusted() {
+  SpeechEstimator estimator;
+  MockDriver driver(L"Mock");
+  // The end of speech is not known well enough if the previous poll was too long ago.
+  estimator.Spoke(&driver, L"Saved", true);
+  estimator.Observe(&driver, true);
+  Sleep(200);
+  estimator.Observe(&driver, false);
+  CHECK(!estimator.IsSpeaking(&driver));
+  CHECK(estimator.Estimate(&driver, L"Saved") == SAVED_COST);
+  // Nor is it if speech was never seen, or if the text was queued behind other text.
+  estimator.Spoke(&driver, L"Saved", true);
+  estimator.Observe(&driver, false);
+  estimator.Spoke(&driver, L"Saved", true);
+  estimator.Spoke(&driver, L"Saved", false);
+  estimator.Observe(&driver, true);
+  estimator.Observe(&driver, false);
+  CHECK(estimator.Estimate(&driver, L"Saved") == SAVED_COST);
+  // Nor without text.
+  MockDriver other(L"Other");
+  estimator.Observe(&other, true);
+  estimator.Observe(&other, false);
+  CHECK(estimator.Estimate(&other, L"Saved") == SAVED_COST);
+}
+
+static void TestPerDriver() {
+  SpeechEstimator estimator;
+  MockDriver fast(L"Fast");
+  MockDriver slow(L"Slow");
+  MockDriver unobserved(L"Unobserved");
+  // Each observed driver has its own scale: 1 * 0.8 + 0.25 * 0.2 and 1 * 0.8 + 4 * 0.2.
+  ObserveShort(estimator, &fast);
+  ObserveLong(estimator, &slow);
+  CHECK(estimator.Estimate(&fast, L"Saved") == (DWORD)(SAVED_COST * 0.85));
+  CHECK(estimator.Estimate(&slow, L"Saved") == (DWORD)(SAVED_COST * 1.6));
+  // A driver that can't be observed gets the scale shared by all: 0.85 * 0.8 + 4 * 0.2.
+  CHECK(estimator.Estimate(&unobserved, L"Saved") == (DWORD)(SAVED_COST * 1.48));
+  estimator.Spoke(&unobserved, L"Saved", true);
+  CHECK(estimator.GetRemaining(&unobserved) > (DWORD)(SAVED_COST * 1.48) - 20);
+  // Forgetting a driver drops what was learned for it alone.
+  estimator.Forget(&fast);
+  CHECK(estimator.Estimate(&fast, L"Saved") == (DWORD)(SAVED_COST * 1.48));
+}
+
+int main() {
+  TestCost();
+  TestRemaining();
+  TestClamp();
+  TestSmoothing();
+  TestUntrusted();
+  TestPerDriver();
+  return TEST_RESULT();
+}
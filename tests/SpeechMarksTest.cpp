@@ -0,0 +1,132 @@
+/**
+ *  Product:        Tolk
+ *  File:           SpeechMarksTest.cpp
+ *  Description:    Tests of reporting marks as speech reaches them.
+ *  Copyright:      (c) 2026, Davy Kager <mail@davykager.nl>
+ *  License:        LGPLv3
+ */
+
+#include <string>
+#include <vector>
+#include "MockDriver.h"
+#include "SpeechEstimator.h"
+#include "SpeechMarks.h"
+#include "TolkTest.h"
+
+static SpeechMarks g_marks;
+
+// Marks reported so far, as user data * 100 + mark.
+static std::vector<unsigned int> g_reported;
+
+static void OnMark(unsigned int mark, void *userData) {
+  g_reported.push_back((unsigned int)(size_t)userData * 100 + mark);
+}
+
+// Bookmarks from the mock driver, as the SAPI and NVDA drivers pass them on.
+static void OnBookmark(unsigned long bookmark) {
+  std::vector<SpeechMarks::Reached> reached;
+  g_marks.Bookmark(bookmark, reached);
+  SpeechMarks::Report(reached);
+}
+
+// Speaks the text with marks through the driver like Tolk_SpeakWithMarks does for drivers with SSML.
+static void SpeakMarked(MockDriver &driver, const std::wstring &text, const std::vector<size_t> &marks, size_t userData) {
+  const unsigned long bookmark = g_marks.AddBookmarked((unsigned int)marks.size(), OnMark, (void *)userData);
+  std::wstring ssml;
+  size_t start = 0;
+  for (size_t i = 0; i < marks.size(); ++i) {
+    ssml += text.substr(start, marks[i] - start);
+    ssml += L"<mark name=\"" + std::to_wstring(bookmark + i) + L"\"/>";
+    start = marks[i];
+  }
+  ssml += text.substr(start);
+  driver.SpeakSsml(ssml.c_str(), false);
+}
+
+static void TestBookmarks() {
+  MockDriver driver(L"SSML", true);
+  driver.onMark = OnBookmark;
+  g_reported.clear();
+  SpeakMarked(driver, L"One two three", { 0, 4, 8 }, 1);
+  CHECK(driver.pendingMarks.size() == 3);
+  CHECK(driver.ReachMark());
+  CHECK(driver.ReachMark());
+  CHECK(g_reported == std::vector<unsigned int>({ 100, 101 }));
+  CHECK(driver.ReachMark());
+  CHECK(g_reported.size() == 3);
+  CHECK(g_marks.IsEmpty());
+}
+
+static void TestSkippedAndQueued() {
+  MockDriver driver(L"SSML", true);
+  driver.onMark = OnBookmark;
+  g_reported.clear();
+  SpeakMarked(driver, L"First text", { 0, 6 }, 1);
+  SpeakMarked(driver, L"Second text", { 0, 7 }, 2);
+  // The engine passed over the first text's marks, reaching the second's first mark reaches them too.
+  driver.pendingMarks.erase(driver.pendingMarks.begin(), driver.pendingMarks.begin() + 2);
+  CHECK(driver.ReachMark());
+  CHECK(g_reported == std::vector<unsigned int>({ 100, 101, 200 }));
+  // Speech ended, what is left has been reached.
+  std::vector<SpeechMarks::Reached> reached;
+  g_marks.Finished(reached);
+  SpeechMarks::Report(reached);
+  CHECK(g_reported == std::vector<unsigned int>({ 100, 101, 200, 201 }));
+  // A bookmark the engine sends late is not reported again.
+  CHECK(driver.ReachMark());
+  CHECK(g_reported.size() == 4);
+}
+
+static void TestInterrupted() {
+  MockDriver driver(L"SSML", true);
+  driver.onMark = OnBookmark;
+  g_reported.clear();
+  SpeakMarked(driver, L"Never finished", { 0, 6 }, 1);
+  CHECK(driver.ReachMark());
+  // Marks not reached before speech is interrupted are never reported.
+  g_marks.Clear();
+  CHECK(driver.ReachMark());
+  CHECK(g_reported == std::vector<unsigned int>({ 100 }));
+  // Bookmarks that aren't ours are left alone.
+  std::vector<SpeechMarks::Reached> reached;
+  CHECK(!g_marks.Bookmark(12345, reached));
+  CHECK(reached.empty());
+  // Taken back when no driver accepted the text.
+  g_marks.AddBookmarked(2, OnMark, nullptr);
+  g_marks.RemoveLast();
+  CHECK(g_marks.IsEmpty());
+}
+
+static void TestTimed() {
+  // For drivers without bookmarks the marks are timed from the estimate.
+  SpeechEstimator estimator;
+  MockDriver driver(L"Timed");
+  const wchar_t *text = L"Estimated marks are reached in time.";
+  const size_t positions[] = { 0, 10, 20 };
+  std::vector<DWORD> offsets(3);
+  estimator.EstimatePositions(&driver, text, positions, 3, offsets.data());
+  CHECK(offsets[0] <= offsets[1] && offsets[1] <= offsets[2]);
+  CHECK(offsets[2] <= estimator.Estimate(&driver, text));
+  g_reported.clear();
+  const ULONGLONG start = GetTickCount64();
+  g_marks.AddTimed(start, std::move(offsets), OnMark, (void *)3);
+  std::vector<SpeechMarks::Reached> reached;
+  // Even the first mark comes after the lead-in of the estimate.
+  CHECK(g_marks.Due(reached) != INFINITE);
+  SpeechMarks::Report(reached);
+  CHECK(g_reported.empty());
+  Sleep(estimator.Estimate(&driver, text) + 50);
+  reached.clear();
+  CHECK(g_marks.Due(reached) == INFINITE);
+  SpeechMarks::Report(reached);
+  CHECK(g_reported == std::vector<unsigned int>({ 300, 301, 302 }));
+  CHECK(g_marks.IsEmpty());
+}
+
+int main() {
+  TestBookmarks();
+  TestSkippedAndQueued();
+  TestInterrupted();
+  TestTimed();
+  return TEST_RESULT();
+}
@@ -0,0 +1,111 @@
+/**
+ *  Product:        Tolk
+ *  File:           SpeechMarkupTest.cpp
+ *  Description:    Tests of parsing speech markup and lowering it for drivers.
+ *  Copyright:      (c) 2026, Davy Kager <mail@davykager.nl>
+ *  License:        LGPLv3
+ */
+
+#include "MockDriver.h"
+#include "SpeechMarkup.h"
+#include "TolkTest.h"
+
+// Trims the runs of text, as a stand-in for Tolk's preparation of text for speech.
+static const wchar_t *Prepare(const wchar_t *text) {
+  thread_local std::wstring buffer;
+  buffer = text;
+  buffer.erase(0, buffer.find_first_not_of(L' '));
+  buffer.erase(buffer.find_last_not_of(L' ') + 1);
+  return buffer.c_str();
+}
+
+static const wchar_t *const g_markup = L"Press {spell}F1{/spell} for help.{pause 300} Then {em}go{/em} {lang de}Guten Tag{/lang}";
+
+static void TestLowering() {
+  const std::unique_ptr<const SpeechMarkup> markup = SpeechMarkup::Parse(g_markup, Prepare);
+  CHECK(markup != nullptr);
+  if (!markup) return;
+  CHECK_TEXT(markup->GetPlainText(), L"Press F 1 for help. Then go Guten Tag");
+  CHECK_TEXT(markup->ToSsml(), L"Press <say-as interpret-as=\"characters\">F1</say-as> for help.<break time=\"300ms\"/> Then <emphasis>go</emphasis> <voice xml:lang=\"de\">Guten Tag</voice>");
+}
+
+static void TestPauses() {
+  std::unique_ptr<const SpeechMarkup> markup = SpeechMarkup::Parse(L"Hi{pause}there", Prepare);
+  CHECK(markup != nullptr);
+  if (markup) {
+    // A pause the plain text can only approximate with a full stop.
+    CHECK_TEXT(markup->GetPlainText(), L"Hi. there");
+    CHECK_TEXT(markup->ToSsml(), L"Hi<break time=\"500ms\"/>there");
+  }
+  markup = SpeechMarkup::Parse(L"Ok. {pause 800} yes", Prepare);
+  CHECK(markup != nullptr);
+  if (markup) CHECK_TEXT(markup->GetPlainText(), L"Ok. yes");
+}
+
+static void TestEscapes() {
+  const std::unique_ptr<const SpeechMarkup> markup = SpeechMarkup::Parse(L"a {{b} c <&>", Prepare);
+  CHECK(markup != nullptr);
+  if (!markup) return;
+  CHECK_TEXT(markup->GetPlainText(), L"a {b} c <&>");
+  CHECK_TEXT(markup->ToSsml(), L"a {b} c &lt;&amp;&gt;");
+}
+
+static void TestMalformed() {
+  const wchar_t *const malformed[] = {
+    L"{pause x}",
+    L"{pause 20000}",
+    L"{em}x",
+    L"{lang de}x{/em}",
+    L"{spell}a{b{/spell}",
+    L"{bogus}",
+    L"unclosed {em"
+  };
+  for (const wchar_t *markup : malformed) {
+    if (SpeechMarkup::Parse(markup, Prepare)) {
+      fprintf(stderr, "accepted \"%ls\"\n", markup);
+      CHECK(!"malformed markup is refused");
+    }
+  }
+}
+
+static void TestCache() {
+  SpeechMarkupCache cache;
+  MockDriver plain(L"Plain");
+  MockDriver ssml(L"SSML", true);
+  CHECK(cache.Lower(g_markup, &plain) == nullptr);
+  const SpeechMarkup *parsed = cache.Parse(g_markup, 0, Prepare);
+  CHECK(parsed != nullptr);
+  CHECK(cache.Parse(g_markup, 0, Prepare) == parsed);
+  const std::wstring *lowered = cache.Lower(g_markup, &plain);
+  CHECK(lowered != nullptr);
+  if (lowered) CHECK_TEXT(*lowered, L"Press F 1 for help. Then go Guten Tag");
+  CHECK(cache.Lower(g_markup, &plain) == lowered);
+  lowered = cache.Lower(g_markup, &ssml);
+  CHECK(lowered != nullptr);
+  if (lowered) CHECK(lowered->find(L"<emphasis>") != std::wstring::npos);
+  CHECK(cache.Parse(L"{x", 0, Prepare) == nullptr);
+  // Parsed again for another generation of text preparation, and still lowered.
+  CHECK(cache.Parse(g_markup, 1, Prepare) != nullptr);
+  CHECK(cache.Lower(g_markup, &plain) != nullptr);
+  cache.Forget(&plain);
+  CHECK(cache.Lower(g_markup, &plain) != nullptr);
+}
+
+static void TestCacheSize() {
+  SpeechMarkupCache cache;
+  MockDriver plain(L"Plain");
+  cache.Parse(g_markup, 0, Prepare);
+  for (int i = 0; i < SPEECH_MARKUP_CACHE_SIZE; ++i) cache.Parse((L"text " + std::to_wstring(i)).c_str(), 0, Prepare);
+  // Dropped, least recently used first.
+  CHECK(cache.Lower(g_markup, &plain) == nullptr);
+}
+
+int main() {
+  TestLowering();
+  TestPauses();
+  TestEscapes();
+  TestMalformed();
+  TestCache();
+  TestCacheSize();
+  return TEST_RESULT();
+}
@@ -0,0 +1,132 @@
+/**
+ *  Product:        Tolk
+ *  File:           SpeechProgressTest.cpp
+ *  Description:    Tests of tracking speech progress from recorded SAPI event sequences.
+ *  Copyright:      (c) 2026, Davy Kager <mail@davykager.nl>
+ *  License:        LGPLv3
+ */
+
+#include "SpeechProgress.h"
+#include "TolkTest.h"
+
+// SAPI events as the SAPI driver passes them on, with the stream number of the utterance.
+enum RecordedKind {
+  QUEUED,
+  QUEUED_PURGING,
+  PURGED,
+  START_INPUT_STREAM,
+  WORD_BOUNDARY,
+  BOOKMARK,
+  END_INPUT_STREAM
+};
+
+struct RecordedEvent {
+  RecordedKind kind;
+  unsigned long stream;
+  unsigned long position;
+  unsigned long length;
+};
+
+// Returns how many of the events were taken as current.
+template <size_t Count>
+static int Replay(SpeechProgress &progress, const RecordedEvent (&events)[Count]) {
+  int current = 0;
+  for (const RecordedEvent &event : events) {
+    switch (event.kind) {
+    case QUEUED: progress.Queued(event.stream, false); break;
+    case QUEUED_PURGING: progress.Queued(event.stream, true); break;
+    case PURGED: progress.Purged(); break;
+    case START_INPUT_STREAM: current += progress.Started(event.stream); break;
+    case WORD_BOUNDARY: current += progress.Word(event.stream, event.position, event.length); break;
+    case BOOKMARK: current += progress.Bookmark(event.stream, event.position); break;
+    case END_INPUT_STREAM: current += progress.Ended(event.stream); break;
+    }
+  }
+  return current;
+}
+
+static void TestOneUtterance() {
+  SpeechProgress progress;
+  const RecordedEvent events[] = {
+    { QUEUED, 1, 0, 0 },
+    { START_INPUT_STREAM, 1, 0, 0 },
+    { WORD_BOUNDARY, 1, 0, 5 },
+    { WORD_BOUNDARY, 1, 6, 5 },
+    { BOOKMARK, 1, 7, 0 },
+  };
+  CHECK(!progress.IsSpeaking());
+  CHECK(Replay(progress, events) == 4);
+  CHECK(progress.IsSpeaking());
+  CHECK(progress.GetStream() == 1);
+  CHECK(progress.GetWordPosition() == 6 && progress.GetWordLength() == 5);
+  CHECK(progress.GetBookmark() == 7);
+  const RecordedEvent end[] = { { END_INPUT_STREAM, 1, 0, 0 } };
+  CHECK(Replay(progress, end) == 1);
+  CHECK(!progress.IsSpeaking());
+}
+
+static void TestEndBeforeQueuedReturns() {
+  // The engine finished the utterance before the call that queued it returned.
+  SpeechProgress progress;
+  const RecordedEvent events[] = {
+    { START_INPUT_STREAM, 1, 0, 0 },
+    { END_INPUT_STREAM, 1, 0, 0 },
+    { QUEUED, 1, 0, 0 },
+  };
+  Replay(progress, events);
+  CHECK(!progress.IsSpeaking());
+}
+
+static void TestPurge() {
+  SpeechProgress progress;
+  const RecordedEvent events[] = {
+    { QUEUED, 1, 0, 0 },
+    { QUEUED, 2, 0, 0 },
+    { START_INPUT_STREAM, 1, 0, 0 },
+    { WORD_BOUNDARY, 1, 0, 4 },
+    // Speaking with interrupt purges 1 and 2.
+    { QUEUED_PURGING, 3, 0, 0 },
+    // Late events of the purged utterances.
+    { WORD_BOUNDARY, 1, 5, 4 },
+    { END_INPUT_STREAM, 1, 0, 0 },
+    { START_INPUT_STREAM, 2, 0, 0 },
+    { START_INPUT_STREAM, 3, 0, 0 },
+    { WORD_BOUNDARY, 3, 0, 2 },
+  };
+  CHECK(Replay(progress, events) == 4);
+  CHECK(progress.IsSpeaking());
+  CHECK(progress.GetStream() == 3);
+  CHECK(progress.GetWordPosition() == 0 && progress.GetWordLength() == 2);
+  const RecordedEvent silence[] = {
+    { PURGED, 0, 0, 0 },
+    { WORD_BOUNDARY, 3, 3, 4 },
+    { END_INPUT_STREAM, 3, 0, 0 },
+  };
+  CHECK(Replay(progress, silence) == 0);
+  CHECK(!progress.IsSpeaking());
+}
+
+static void TestQueuedUtterances() {
+  SpeechProgress progress;
+  const RecordedEvent events[] = {
+    { QUEUED, 1, 0, 0 },
+    { QUEUED, 2, 0, 0 },
+    { START_INPUT_STREAM, 1, 0, 0 },
+    { END_INPUT_STREAM, 1, 0, 0 },
+    { START_INPUT_STREAM, 2, 0, 0 },
+  };
+  Replay(progress, events);
+  CHECK(progress.IsSpeaking());
+  CHECK(progress.GetStream() == 2);
+  const RecordedEvent end[] = { { END_INPUT_STREAM, 2, 0, 0 } };
+  Replay(progress, end);
+  CHECK(!progress.IsSpeaking());
+}
+
+int main() {
+  TestOneUtterance();
+  TestEndBeforeQueuedReturns();
+  TestPurge();
+  TestQueuedUtterances();
+  return TEST_RESULT();
+}
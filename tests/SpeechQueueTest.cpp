@@ -0,0 +1,110 @@
+/**
+ *  Product:        Tolk
+ *  File:           SpeechQueueTest.cpp
+ *  Description:    Tests of splitting long text into chunks for speech.
+ *  Copyright:      (c) 2026, Davy Kager <mail@davykager.nl>
+ *  License:        LGPLv3
+ */
+
+#include "SpeechQueue.h"
+#include "TolkTest.h"
+
+static const wchar_t *const g_sentences[] = {
+  L"This is a sentence about help. ",
+  L"Another one, with a clause; and more words here! ",
+  L"Dr. Smith said \"hello.\" ",
+  L"Short? "
+};
+
+static std::wstring MakeText(size_t length) {
+  std::wstring text;
+  for (size_t i = 0; text.size() < length; ++i) text += g_sentences[i % 4];
+  return text;
+}
+
+static std::wstring WithoutSpaces(const std::wstring &text) {
+  std::wstring result;
+  for (const wchar_t c : text) if (c != L' ') result += c;
+  return result;
+}
+
+static void TestShortText() {
+  SpeechQueue queue;
+  std::wstring chunk;
+  CHECK(!queue.Next(chunk, SPEECH_CHUNK_FIRST));
+  queue.Add(L"  Hello there.  ");
+  CHECK(!queue.IsEmpty());
+  CHECK(queue.Next(chunk, SPEECH_CHUNK_FIRST));
+  CHECK_TEXT(chunk, L"Hello there.  ");
+  CHECK(!queue.Next(chunk, SPEECH_CHUNK_MAX));
+  CHECK(queue.IsEmpty());
+}
+
+static void TestSentences() {
+  SpeechQueue queue;
+  const std::wstring text = MakeText(64 * 1024);
+  queue.Add(text.c_str());
+  std::wstring chunk, spoken;
+  CHECK(queue.Next(chunk, SPEECH_CHUNK_FIRST));
+  CHECK(chunk.size() <= SPEECH_CHUNK_FIRST);
+  // The first chunk ends after a sentence, not after "Dr.".
+  CHECK_TEXT(chunk.substr(chunk.size() - 5), L"here!");
+  spoken += chunk;
+  while (queue.Next(chunk, SPEECH_CHUNK_MAX)) {
+    CHECK(chunk.size() <= SPEECH_CHUNK_MAX);
+    const std::wstring end = chunk.substr(0, chunk.find_last_not_of(L' ') + 1);
+    const wchar_t last = end.back();
+    CHECK(last == L'.' || last == L'!' || last == L'?' || last == L'"' || end.size() == text.size() - spoken.size());
+    CHECK(end.compare(end.size() - 3, 3, L"Dr.") != 0);
+    spoken += chunk;
+  }
+  // Nothing is lost but the spaces between chunks.
+  CHECK(WithoutSpaces(spoken) == WithoutSpaces(text));
+}
+
+static void TestClausesAndSpaces() {
+  // No sentence ends within the limit, so the chunk ends after a clause.
+  std::wstring text = L"first part, ";
+  while (text.size() < 300) text += L"word ";
+  size_t end = SpeechQueue::FindChunkEnd(text.c_str(), text.size(), 0, 100);
+  CHECK(end <= 100 && text[end] == L' ');
+  text = std::wstring(60, L'x') + L"; " + std::wstring(20, L'y') + L" " + std::wstring(300, L'z');
+  end = SpeechQueue::FindChunkEnd(text.c_str(), text.size(), 0, 100);
+  CHECK(end == 61);
+  // Without any boundary the text is cut at the limit.
+  text = std::wstring(3000, L'x');
+  CHECK(SpeechQueue::FindChunkEnd(text.c_str(), text.size(), 0, SPEECH_CHUNK_MAX) == SPEECH_CHUNK_MAX);
+}
+
+static void TestFullWidth() {
+  // Chinese sentences end without a space.
+  std::wstring text;
+  while (text.size() < 300) text += L"\x4ECA\x5929\x5929\x6C14\x5F88\x597D\x3002";
+  const size_t end = SpeechQueue::FindChunkEnd(text.c_str(), text.size(), 0, 100);
+  CHECK(end <= 100 && text[end - 1] == 0x3002);
+  CHECK(SpeechQueue::FindSentenceEnd(text.c_str(), text.size(), 0) == 7);
+}
+
+static void TestQueued() {
+  SpeechQueue queue;
+  queue.Add(L"One.");
+  queue.Add(L"   ");
+  queue.Add(L"Two.");
+  std::wstring chunk;
+  CHECK(queue.Next(chunk, SPEECH_CHUNK_MAX));
+  CHECK_TEXT(chunk, L"One.");
+  CHECK(queue.Next(chunk, SPEECH_CHUNK_MAX));
+  CHECK_TEXT(chunk, L"Two.");
+  queue.Add(L"Three.");
+  queue.Clear();
+  CHECK(!queue.Next(chunk, SPEECH_CHUNK_MAX));
+}
+
+int main() {
+  TestShortText();
+  TestSentences();
+  TestClausesAndSpaces();
+  TestFullWidth();
+  TestQueued();
+  return TEST_RESULT();
+}
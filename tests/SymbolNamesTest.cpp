@@ -0,0 +1,88 @@
+/**
+ *  Product:        Tolk
+ *  File:           SymbolNamesTest.cpp
+ *  Description:    Tests of naming emoji and symbols, against the shipped English names.
+ *  Copyright:      (c) 2026, Davy Kager <mail@davykager.nl>
+ *  License:        LGPLv3
+ */
+
+#include <string>
+#include "SymbolNames.h"
+#include "SymbolTables.h"
+#include "TolkTest.h"
+
+// Text from code points, as UTF-16 where wchar_t is.
+static std::wstring Text(std::initializer_list<char32_t> codePoints) {
+  std::wstring text;
+  for (char32_t c : codePoints) {
+    if (sizeof(wchar_t) == 2 && c > 0xFFFF) {
+      text += (wchar_t)(0xD800 + ((c - 0x10000) >> 10));
+      text += (wchar_t)(0xDC00 + ((c - 0x10000) & 0x3FF));
+    }
+    else text += (wchar_t)c;
+  }
+  return text;
+}
+
+static void TestFind() {
+  const SymbolTable *table = FindSymbolTable(L"en");
+  CHECK(table);
+  CHECK(FindSymbolTable(L"EN") == table);
+  // A region falls back to the language.
+  CHECK(FindSymbolTable(L"en-US") == table);
+  CHECK(FindSymbolTable(L"en_GB") == table);
+  CHECK(!FindSymbolTable(L"nl"));
+  CHECK(!FindSymbolTable(nullptr));
+}
+
+static void TestStarts() {
+  const SymbolTable &table = *FindSymbolTable(L"en");
+  // The generated bitmap has the start of every name.
+  bool all = true;
+  for (unsigned int i = 0; i < table.size; ++i) all &= SymbolStartsName(table, table.codePoints[table.entries[i].first]);
+  CHECK(all);
+  CHECK(SymbolStartsName(table, 0x1F44D));
+  CHECK(SymbolStartsName(table, L'#'));
+  // And not of letters, of any script.
+  CHECK(!SymbolStartsName(table, L'a'));
+  CHECK(!SymbolStartsName(table, 0xE9));
+  CHECK(!SymbolStartsName(table, 0x416));
+  CHECK(!SymbolStartsName(table, 0x4F60));
+}
+
+static void TestUnnamed() {
+  const SymbolTable &table = *FindSymbolTable(L"en");
+  // Text without names is given back as it is.
+  const wchar_t *const texts[] = {
+    L"Great game, see you all tomorrow.",
+    L"Caf\xE9 #1",
+    L"\x0425\x043E\x0440\x043E\x0448\x0430\x044F \x0438\x0433\x0440\x0430",
+    L"\x6BD4\x8D5B\x5F88\x7CBE\x5F69\x3002",
+    L"",
+  };
+  for (const wchar_t *text : texts) CHECK(NameSymbols(table, text) == text);
+}
+
+static void TestNamed() {
+  const SymbolTable &table = *FindSymbolTable(L"en");
+  CHECK_TEXT(NameSymbols(table, Text({ 'O', 'K', 0x1F44D }).c_str()), L"OK thumbs up");
+  CHECK_TEXT(NameSymbols(table, Text({ 0x1F44D, '!' }).c_str()), L"thumbs up!");
+  CHECK_TEXT(NameSymbols(table, Text({ 0x1F44D, 'O', 'K' }).c_str()), L"thumbs up OK");
+  CHECK_TEXT(NameSymbols(table, Text({ 0x2764, 0xFE0F }).c_str()), L"red heart");
+  CHECK_TEXT(NameSymbols(table, Text({ 0xA9, ' ', '2', '0', '2', '6' }).c_str()), L"copyright 2026");
+  // Sequences are named as a whole, skin tones after the emoji.
+  CHECK_TEXT(NameSymbols(table, Text({ 0x1F44D, 0x1F3FD }).c_str()), L"thumbs up: medium skin tone");
+  CHECK_TEXT(NameSymbols(table, Text({ 0x1F468, 0x200D, 0x1F469, 0x200D, 0x1F467 }).c_str()), L"family: man, woman, girl");
+  CHECK_TEXT(NameSymbols(table, Text({ 0x1F1F3, 0x1F1F1 }).c_str()), L"flag: Netherlands");
+  CHECK_TEXT(NameSymbols(table, Text({ '#', 0xFE0F, 0x20E3 }).c_str()), L"keycap: #");
+  // In text of another script, found past the letters the bitmap skips.
+  CHECK_TEXT(NameSymbols(table, Text({ 0x6BD4, 0x8D5B, 0x1F44D }).c_str()), Text({ 0x6BD4, 0x8D5B, ' ' }) + L"thumbs up");
+}
+
+int main() {
+  TestFind();
+  TestStarts();
+  TestUnnamed();
+  TestNamed();
+  return TEST_RESULT();
+}
@@ -0,0 +1,79 @@
+/**
+ *  Product:        Tolk
+ *  File:           TestPlugin.cpp
+ *  Description:    Driver plugin that records its calls, for the plugin loader tests.
+ *  Copyright:      (c) 2026, Davy Kager <mail@davykager.nl>
+ *  License:        LGPLv3
+ */
+
+// Built once as written and once with TEST_PLUGIN_NEWER, which claims an ABI
+// version newer than Tolk's and a table with a member Tolk doesn't know.
+
+#include <windows.h>
+#include <string>
+#include "TolkPlugin.h"
+
+namespace {
+
+std::wstring g_log;
+bool g_initialized = false;
+
+bool TOLK_PLUGIN_CALL Initialize() {
+  g_initialized = true;
+  return true;
+}
+
+void TOLK_PLUGIN_CALL Finalize() {
+  g_initialized = false;
+}
+
+bool TOLK_PLUGIN_CALL Speak(const wchar_t *str, bool interrupt) {
+  g_log += (interrupt ? L"speak! " : L"speak ") + std::wstring(str) + L";";
+  return true;
+}
+
+bool TOLK_PLUGIN_CALL Braille(const wchar_t *str) {
+  g_log += L"braille " + std::wstring(str) + L";";
+  return true;
+}
+
+bool TOLK_PLUGIN_CALL IsActive() {
+  return true;
+}
+
+unsigned int TOLK_PLUGIN_CALL GetBrailleCells() {
+  return 32;
+}
+
+#ifdef TEST_PLUGIN_NEWER
+struct NewerDriver {
+  TolkPluginDriver driver;
+  void *appended;
+};
+
+const NewerDriver g_driver = {
+  { TOLK_PLUGIN_ABI_VERSION + 1, sizeof(NewerDriver), L"Newer Plugin", TOLK_PLUGIN_CAP_SPEECH, Initialize, Finalize, Speak, Braille, nullptr, nullptr, IsActive, nullptr, GetBrailleCells },
+  nullptr
+};
+#else
+// Output is left to Tolk, which calls Speak and Braille.
+const TolkPluginDriver g_driver = {
+  TOLK_PLUGIN_ABI_VERSION, sizeof(TolkPluginDriver), L"Test Plugin", TOLK_PLUGIN_CAP_SPEECH | TOLK_PLUGIN_CAP_BRAILLE,
+  Initialize, Finalize, Speak, Braille, nullptr, nullptr, IsActive, nullptr, GetBrailleCells
+};
+#endif // TEST_PLUGIN_NEWER
+
+} // namespace
+
+extern "C" TOLK_PLUGIN_EXPORT const TolkPluginDriver * TOLK_PLUGIN_CALL TolkPlugin_GetDriver(unsigned int) {
+  return reinterpret_cast<const TolkPluginDriver *>(&g_driver);
+}
+
+// For the tests: the calls so far, cleared on every call, or nullptr while not initialized.
+extern "C" TOLK_PLUGIN_EXPORT const wchar_t * TOLK_PLUGIN_CALL TestPlugin_TakeLog() {
+  static std::wstring taken;
+  if (!g_initialized) return nullptr;
+  taken.swap(g_log);
+  g_log.clear();
+  return taken.c_str();
+}
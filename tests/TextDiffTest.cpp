@@ -0,0 +1,81 @@
+/**
+ *  Product:        Tolk
+ *  File:           TextDiffTest.cpp
+ *  Description:    Tests of what Tolk_OutputDiff speaks of a changed text.
+ *  Copyright:      (c) 2026, Davy Kager <mail@davykager.nl>
+ *  License:        LGPLv3
+ */
+
+#include "TextDiff.h"
+#include "TolkTest.h"
+
+// Returns what would be spoken, an empty string if nothing is.
+static std::wstring Update(TextDiff &diff, const wchar_t *key, const wchar_t *str) {
+  std::wstring changed;
+  return diff.Update(key, str, changed) ? changed : std::wstring();
+}
+
+static void TestProgress() {
+  TextDiff diff;
+  CHECK_TEXT(Update(diff, L"progress", L"Downloading 41%"), L"Downloading 41%");
+  CHECK_TEXT(Update(diff, L"progress", L"Downloading 42%"), L"42%");
+  CHECK_TEXT(Update(diff, L"progress", L"Downloading 42.5%"), L"42.5%");
+  // Only spacing differs.
+  CHECK_TEXT(Update(diff, L"progress", L"Downloading  42.5% "), L"");
+}
+
+static void TestEndings() {
+  TextDiff diff;
+  Update(diff, L"health", L"Health 50 of 100");
+  // A longer ending is left out.
+  CHECK_TEXT(Update(diff, L"health", L"Health 40 of 100"), L"40");
+  Update(diff, L"stats", L"HP 50, MP 30");
+  CHECK_TEXT(Update(diff, L"stats", L"HP 45, MP 25"), L"45, MP 25");
+}
+
+static void TestAddedAndRemoved() {
+  TextDiff diff;
+  Update(diff, L"chat", L"a: hi");
+  CHECK_TEXT(Update(diff, L"chat", L"a: hi b: yo"), L"b: yo");
+  // Tokens taken away, what is left is said whole.
+  CHECK_TEXT(Update(diff, L"chat", L"a: hi"), L"a: hi");
+}
+
+static void TestBlank() {
+  TextDiff diff;
+  CHECK_TEXT(Update(diff, L"status", L"  "), L"");
+  Update(diff, L"status", L"Extracting 2%");
+  CHECK_TEXT(Update(diff, L"status", L" \t"), L"");
+  // Compared with nothing, so said whole.
+  CHECK_TEXT(Update(diff, L"status", L"Extracting 3%"), L"Extracting 3%");
+}
+
+static void TestKeys() {
+  TextDiff diff;
+  Update(diff, L"a", L"Level 1");
+  Update(diff, L"b", L"Level 1");
+  CHECK_TEXT(Update(diff, L"a", L"Level 2"), L"2");
+  for (int i = 0; i < TEXT_DIFF_MAX_KEYS; ++i) Update(diff, std::to_wstring(i).c_str(), L"x");
+  // Forgotten, least recently used first.
+  CHECK_TEXT(Update(diff, L"b", L"Level 2"), L"Level 2");
+  diff.Clear();
+  CHECK_TEXT(Update(diff, L"b", L"Level 2"), L"Level 2");
+}
+
+static void TestLongText() {
+  TextDiff diff;
+  const std::wstring text(TEXT_DIFF_MAX_TEXT + 1, L'a');
+  CHECK_TEXT(Update(diff, L"long", text.c_str()), text);
+  // Not remembered.
+  CHECK_TEXT(Update(diff, L"long", text.c_str()), text);
+}
+
+int main() {
+  TestProgress();
+  TestEndings();
+  TestAddedAndRemoved();
+  TestBlank();
+  TestKeys();
+  TestLongText();
+  return TEST_RESULT();
+}
@@ -0,0 +1,77 @@
+/**
+ *  Product:        Tolk
+ *  File:           TextNormalizerTest.cpp
+ *  Description:    Tests of cleaning up text before output.
+ *  Copyright:      (c) 2026, Davy Kager <mail@davykager.nl>
+ *  License:        LGPLv3
+ */
+
+#include <string>
+#include "TextNormalizer.h"
+#include "TolkTest.h"
+
+static void TestClean() {
+  // Clean text is not copied.
+  const wchar_t *const clean = L"Clean text, passed on as it is.";
+  CHECK(NormalizeText(clean) == clean);
+  const wchar_t *const empty = L"";
+  CHECK(NormalizeText(empty) == empty);
+  // Long enough for the blocks of the vector scan, with the non-ASCII in the middle of one.
+  const wchar_t *const accented = L"Caf\x00E9 cr\x00E8me br\x00FBl\x00E9" L"e and more of it";
+  CHECK(NormalizeText(accented) == accented);
+}
+
+static void TestWhitespace() {
+  CHECK_TEXT(NormalizeText(L"  leading and trailing  "), L"leading and trailing");
+  CHECK_TEXT(NormalizeText(L"one  two\tthree\r\nfour"), L"one two three four");
+  CHECK_TEXT(NormalizeText(L"no\x00A0" L"break\x2003" L"em\x3000" L"ideographic"), L"no break em ideographic");
+  CHECK_TEXT(NormalizeText(L" \t\r\n "), L"");
+  // A double space at the end of a vector block, with the second space in the next one.
+  CHECK_TEXT(NormalizeText(L"abcdefg  hijklmnopq"), L"abcdefg hijklmnopq");
+}
+
+static void TestDropped() {
+  CHECK_TEXT(NormalizeText(L"soft\x00ADhyphen"), L"softhyphen");
+  CHECK_TEXT(NormalizeText(L"zero\x200Bwidth\x2060joiner\xFEFF"), L"zerowidthjoiner");
+  CHECK_TEXT(NormalizeText(L"bell\x0007 and\x007F" L" delete\x0085"), L"bell and delete");
+  // Dropping a character between spaces leaves one space.
+  CHECK_TEXT(NormalizeText(L"a \x200B b"), L"a b");
+}
+
+static void TestEmojiJoiner() {
+  // The joiner stays after an emoji, here one ending in a variation selector so
+  // the test does not depend on the width of wchar_t.
+  const wchar_t joined[] = { L'x', L' ', 0x2764, 0xFE0F, 0x200D, 0x2764, 0 };
+  CHECK_TEXT(NormalizeText(joined), joined);
+  const wchar_t dirty[] = { L' ', 0x2764, 0xFE0F, 0x200D, 0x2764, 0 };
+  CHECK_TEXT(NormalizeText(dirty), std::wstring(dirty + 1));
+  // Elsewhere it is dropped.
+  CHECK_TEXT(NormalizeText(L"a\x200D" L"b"), L"ab");
+}
+
+static void TestCombining() {
+#ifdef _WIN32
+  CHECK_TEXT(NormalizeText(L"caf\x0065\x0301"), L"caf\x00E9");
+#else
+  // The compat layer has no composition tables, the marks are kept as they are.
+  CHECK_TEXT(NormalizeText(L"caf\x0065\x0301  au lait"), L"caf\x0065\x0301 au lait");
+#endif
+}
+
+static void TestBuffer() {
+  // The result is a buffer of the thread, overwritten by the next call.
+  const wchar_t *const first = NormalizeText(L" first ");
+  CHECK_TEXT(first, L"first");
+  NormalizeText(L" second ");
+  CHECK_TEXT(first, L"second");
+}
+
+int main() {
+  TestClean();
+  TestWhitespace();
+  TestDropped();
+  TestEmojiJoiner();
+  TestCombining();
+  TestBuffer();
+  return TEST_RESULT();
+}
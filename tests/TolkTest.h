@@ -0,0 +1,99 @@
+/**
+ *  Product:        Tolk
+ *  File:           TolkTest.h
+ *  Description:    Checks shared by the test programs.
+ *  Copyright:      (c) 2026, Davy Kager <mail@davykager.nl>
+ *  License:        LGPLv3
+ */
+
+#ifndef _TOLK_TEST_H_
+#define _TOLK_TEST_H_
+
+#include <windows.h>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+// Every test program is a main that runs its tests one after the other. A failed
+// check is reported and the test goes on, the program fails if any check did.
+#define CHECK(condition) CheckTrue(!!(condition), #condition, __FILE__, __LINE__)
+#define CHECK_TEXT(actual, expected) CheckText((actual), (expected), #actual, __FILE__, __LINE__)
+#define TEST_RESULT() (TestFailures() ? 1 : 0)
+
+inline int &TestFailures() {
+  static int failures = 0;
+  return failures;
+}
+
+inline void CheckTrue(bool passed, const char *condition, const char *file, int line) {
+  if (passed) return;
+  fprintf(stderr, "%s(%d): check failed: %s\n", file, line, condition);
+  ++TestFailures();
+}
+
+inline void CheckText(const std::wstring &actual, const std::wstring &expected, const char *expression, const char *file, int line) {
+  if (actual == expected) return;
+  fprintf(stderr, "%s(%d): check failed: %s is \"%ls\", expected \"%ls\"\n", file, line, expression, actual.c_str(), expected.c_str());
+  ++TestFailures();
+}
+
+// Polls until the condition holds, for what other threads do. Returns false if the time ran out.
+template <typename Condition>
+inline bool WaitUntil(Condition condition, unsigned int milliseconds) {
+  const auto deadline = std::chrono::steady_clock::now() + std::chrono::milliseconds(milliseconds);
+  while (!condition()) {
+    if (std::chrono::steady_clock::now() >= deadline) return false;
+    std::this_thread::sleep_for(std::chrono::milliseconds(5));
+  }
+  return true;
+}
+
+// For the test and the helper processes it starts. Outside of Windows, a test that
+// starts helpers sets TOLK_COMPAT_SESSION so its named objects are its own.
+inline void SetTestEnvironment(const char *name, const std::string &value) {
+#ifdef _WIN32
+  _putenv_s(name, value.c_str());
+#else
+  setenv(name, value.c_str(), 1);
+#endif
+}
+
+// Helper processes of a test have no checks of their own. What their mock drivers
+// speak goes to the file named by TOLK_TEST_LOG, one line of the driver's name, a
+// tab and the text per call, in UTF-8, for the test to read back.
+inline void AppendTestLog(const wchar_t *driver, const wchar_t *text) {
+  const char *path = getenv("TOLK_TEST_LOG");
+  if (!path) return;
+  const std::wstring line = std::wstring(driver) + L'\t' + text + L'\n';
+  std::string bytes(line.size() * 3, '\0');
+  bytes.resize(WideCharToMultiByte(CP_UTF8, 0, line.data(), (int)line.size(), &bytes[0], (int)bytes.size(), nullptr, nullptr));
+  static std::mutex lock;
+  std::lock_guard<std::mutex> guard(lock);
+  FILE *file = fopen(path, "ab");
+  if (!file) return;
+  fwrite(bytes.data(), 1, bytes.size(), file);
+  fclose(file);
+}
+
+// The lines of the log so far. A line still being written is left out.
+inline std::vector<std::wstring> ReadTestLog(const char *path) {
+  std::vector<std::wstring> lines;
+  FILE *file = fopen(path, "rb");
+  if (!file) return lines;
+  std::string bytes;
+  char buffer[4096];
+  for (size_t read; (read = fread(buffer, 1, sizeof(buffer), file)) > 0;) bytes.append(buffer, read);
+  fclose(file);
+  for (size_t start = 0, end; (end = bytes.find('\n', start)) != std::string::npos; start = end + 1) {
+    std::wstring line(end - start, L'\0');
+    line.resize(MultiByteToWideChar(CP_UTF8, 0, bytes.data() + start, (int)(end - start), &line[0], (int)line.size()));
+    lines.push_back(line);
+  }
+  return lines;
+}
+
+#endif // _TOLK_TEST_H_
@@ -0,0 +1,36 @@
+/**
+ *  Product:        Tolk
+ *  File:           ScreenReaderDriverSNova.h
+ *  Description:    Mock SuperNova driver hosted by the bridge helper of the tests.
+ *  Copyright:      (c) 2026, Davy Kager <mail@davykager.nl>
+ *  License:        LGPLv3
+ */
+
+#ifndef _SCREEN_READER_DRIVER_SNOVA_H_
+#define _SCREEN_READER_DRIVER_SNOVA_H_
+
+#include <string>
+#include "FlakyDriver.h"
+
+// Found before the real one when the tests build TolkBridge.cpp. The test can't
+// reach into the helper, so the text says what to do: "hang" never returns and
+// "slow" takes longer than the bridge spins. The helper's process ID goes to the
+// test log when the driver is created.
+class ScreenReaderDriverSNova final : public FlakyDriver {
+public:
+  ScreenReaderDriverSNova() : FlakyDriver(L"SNova") {
+    AppendTestLog(L"started", std::to_wstring(GetCurrentProcessId()).c_str());
+  }
+
+public:
+  bool Speak(const wchar_t *str, bool interrupt) override {
+    if (wcscmp(str, L"hang") == 0) SetFault(FAULT_HANG, 1);
+    delay = (wcscmp(str, L"slow") == 0) ? SLOW : 0;
+    return FlakyDriver::Speak(str, interrupt);
+  }
+
+public:
+  static const DWORD SLOW = 100;
+};
+
+#endif // _SCREEN_READER_DRIVER_SNOVA_H_
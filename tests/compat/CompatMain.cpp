@@ -0,0 +1,25 @@
+/**
+ *  Product:        Tolk
+ *  File:           CompatMain.cpp
+ *  Description:    Entry point for programs that start at wmain, for building them outside of Windows.
+ *  Copyright:      (c) 2026, Davy Kager <mail@davykager.nl>
+ *  License:        LGPLv3
+ */
+
+// Linked into the helper programs of the tests that are built from Tolk's own
+// sources. The arguments are UTF-8 here and handed on as wide strings.
+
+#include <windows.h>
+#include <string>
+#include <vector>
+
+int wmain(int argc, wchar_t *argv[]);
+
+int main(int argc, char *argv[]) {
+  std::vector<std::wstring> arguments;
+  for (int i = 0; i < argc; ++i) arguments.push_back(CompatWiden(argv[i]));
+  std::vector<wchar_t *> wide;
+  for (std::wstring &argument : arguments) wide.push_back(&argument[0]);
+  wide.push_back(nullptr);
+  return wmain(argc, wide.data());
+}
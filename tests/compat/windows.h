@@ -0,0 +1,1348 @@
+/**
+ *  Product:        Tolk
+ *  File:           windows.h
+ *  Description:    The part of the Windows API the tested sources use, for building the tests elsewhere.
+ *  Copyright:      (c) 2026, Davy Kager <mail@davykager.nl>
+ *  License:        LGPLv3
+ */
+
+// Only on the include path when not building for Windows. Types have their
+// Windows sizes, wchar_t aside: it is 32 bits wide here, so the tests keep
+// to text of the Basic Multilingual Plane. Handles are objects of the classes
+// below, closed with CloseHandle as on Windows.
+//
+// Named kernel objects live in POSIX shared memory, so the helper processes
+// of the tests can open them. Events keep their state there behind a process
+// shared mutex. Sessions are stood in for by the TOLK_COMPAT_SESSION variable,
+// tests that run at the same time pick their own so they don't share objects.
+// Windows only exist as entries in a table, made by the tests to raise the
+// WinEvents about that Windows would raise for the windows of other processes.
+
+#ifndef _TOLK_COMPAT_WINDOWS_H_
+#define _TOLK_COMPAT_WINDOWS_H_
+
+#include <dirent.h>
+#include <dlfcn.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <fnmatch.h>
+#include <limits.h>
+#include <locale.h>
+#include <poll.h>
+#include <pthread.h>
+#include <signal.h>
+#include <spawn.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/syscall.h>
+#include <sys/wait.h>
+#include <time.h>
+#include <unistd.h>
+#include <wctype.h>
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdarg>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <cwctype>
+#include <deque>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+extern char **environ;
+
+#define __cdecl
+#define __stdcall
+#define WINAPI
+#define CALLBACK
+// Only the forms Tolk uses.
+#define __declspec(x) __declspec_##x
+#define __declspec_align(n) alignas(n)
+#define __declspec_dllexport __attribute__((visibility("default")))
+#define __declspec_dllimport
+
+typedef int BOOL;
+typedef uint8_t BYTE;
+typedef uint16_t WORD;
+typedef uint32_t DWORD;
+typedef int32_t LONG;
+typedef uint32_t ULONG;
+typedef uint32_t UINT;
+typedef int64_t LONGLONG;
+typedef uint64_t ULONGLONG;
+typedef uintptr_t ULONG_PTR;
+typedef uintptr_t UINT_PTR;
+typedef intptr_t LONG_PTR;
+typedef size_t SIZE_T;
+typedef LONG HRESULT;
+typedef wchar_t *LPWSTR;
+typedef const wchar_t *LPCWSTR;
+typedef void *LPVOID;
+typedef void *HANDLE;
+typedef void *HINSTANCE;
+typedef void *HMODULE;
+typedef void *HWND;
+typedef void *HWINEVENTHOOK;
+typedef UINT_PTR WPARAM;
+typedef LONG_PTR LPARAM;
+typedef LONG_PTR LRESULT;
+typedef intptr_t (*FARPROC)();
+typedef unsigned long error_status_t;
+typedef union {
+  struct {
+    DWORD LowPart;
+    LONG HighPart;
+  };
+  LONGLONG QuadPart;
+} LARGE_INTEGER;
+
+#define TRUE 1
+#define FALSE 0
+#define MAX_PATH 260
+#define MAXLONG 0x7FFFFFFF
+#define MAXDWORD 0xFFFFFFFF
+#define INFINITE 0xFFFFFFFF
+#define WAIT_OBJECT_0 0
+#define WAIT_TIMEOUT 258
+#define WAIT_FAILED 0xFFFFFFFF
+#define INVALID_HANDLE_VALUE ((HANDLE)(intptr_t)-1)
+#define S_OK ((HRESULT)0)
+#define S_FALSE ((HRESULT)1)
+#define E_FAIL ((HRESULT)0x80004005)
+#define SUCCEEDED(hr) (((HRESULT)(hr)) >= 0)
+#define FAILED(hr) (((HRESULT)(hr)) < 0)
+#define ERROR_SUCCESS 0
+#define ERROR_FILE_NOT_FOUND 2
+#define ERROR_ACCESS_DENIED 5
+#define ERROR_INVALID_HANDLE 6
+#define ERROR_INVALID_PARAMETER 87
+#define ERROR_ALREADY_EXISTS 183
+#define ERROR_INVALID_THREAD_ID 1444
+#define GENERIC_READ 0x80000000
+#define GENERIC_WRITE 0x40000000
+#define FILE_SHARE_READ 0x1
+#define FILE_SHARE_WRITE 0x2
+#define FILE_SHARE_DELETE 0x4
+#define CREATE_ALWAYS 2
+#define OPEN_EXISTING 3
+#define FILE_ATTRIBUTE_DIRECTORY 0x10
+#define FILE_ATTRIBUTE_NORMAL 0x80
+#define MOVEFILE_REPLACE_EXISTING 0x1
+#define PAGE_READONLY 0x2
+#define PAGE_READWRITE 0x4
+#define FILE_MAP_READ 0x4
+#define FILE_MAP_ALL_ACCESS 0xF001F
+#define SYNCHRONIZE 0x00100000
+#define EVENT_MODIFY_STATE 0x0002
+#define CREATE_NEW_PROCESS_GROUP 0x00000200
+#define CREATE_NO_WINDOW 0x08000000
+#define STILL_ACTIVE 259
+#define CP_UTF8 65001
+#define LOAD_WITH_ALTERED_SEARCH_PATH 0x8
+#define GET_MODULE_HANDLE_EX_FLAG_UNCHANGED_REFCOUNT 0x2
+#define GET_MODULE_HANDLE_EX_FLAG_FROM_ADDRESS 0x4
+#define DLL_PROCESS_DETACH 0
+#define DLL_PROCESS_ATTACH 1
+#define COINIT_MULTITHREADED 0x0
+#define CTRL_C_EVENT 0
+#define CTRL_BREAK_EVENT 1
+#define WM_NULL 0x0000
+#define WM_QUIT 0x0012
+#define WM_TIMER 0x0113
+#define WM_USER 0x0400
+#define PM_NOREMOVE 0x0000
+#define PM_REMOVE 0x0001
+#define GA_PARENT 1
+#define OBJID_WINDOW ((LONG)0x00000000)
+#define CHILDID_SELF 0
+#define EVENT_OBJECT_CREATE 0x8000
+#define EVENT_OBJECT_DESTROY 0x8001
+#define WINEVENT_OUTOFCONTEXT 0x0000
+#define WINEVENT_SKIPOWNPROCESS 0x0002
+#define WAVE_FORMAT_PCM 1
+#define _TRUNCATE ((size_t)-1)
+#define IS_HIGH_SURROGATE(c) ((c) >= 0xD800 && (c) <= 0xDBFF)
+#define IS_LOW_SURROGATE(c) ((c) >= 0xDC00 && (c) <= 0xDFFF)
+#define YieldProcessor() __builtin_ia32_pause()
+
+#pragma pack(push, 1)
+typedef struct {
+  WORD wFormatTag;
+  WORD nChannels;
+  DWORD nSamplesPerSec;
+  DWORD nAvgBytesPerSec;
+  WORD nBlockAlign;
+  WORD wBitsPerSample;
+  WORD cbSize;
+} WAVEFORMATEX;
+#pragma pack(pop)
+
+typedef struct {
+  LONG x;
+  LONG y;
+} POINT;
+
+typedef struct {
+  HWND hwnd;
+  UINT message;
+  WPARAM wParam;
+  LPARAM lParam;
+  DWORD time;
+  POINT pt;
+} MSG;
+
+typedef struct {
+  DWORD dwFileAttributes;
+  wchar_t cFileName[MAX_PATH];
+} WIN32_FIND_DATAW;
+
+typedef struct {
+  DWORD cb;
+  DWORD dwFlags;
+  WORD wShowWindow;
+} STARTUPINFOW;
+
+typedef struct {
+  HANDLE hProcess;
+  HANDLE hThread;
+  DWORD dwProcessId;
+  DWORD dwThreadId;
+} PROCESS_INFORMATION;
+
+typedef DWORD (WINAPI *LPTHREAD_START_ROUTINE)(LPVOID parameter);
+typedef BOOL (WINAPI *PHANDLER_ROUTINE)(DWORD type);
+typedef BOOL (CALLBACK *WNDENUMPROC)(HWND hwnd, LPARAM lParam);
+typedef void (CALLBACK *WINEVENTPROC)(HWINEVENTHOOK hook, DWORD event, HWND hwnd, LONG idObject, LONG idChild, DWORD eventThread, DWORD eventTime);
+
+inline DWORD &CompatLastError() {
+  thread_local DWORD error = ERROR_SUCCESS;
+  return error;
+}
+inline DWORD GetLastError() { return CompatLastError(); }
+inline void SetLastError(DWORD error) { CompatLastError() = error; }
+
+inline DWORD GetCurrentProcessId() { return (DWORD)getpid(); }
+inline DWORD GetCurrentThreadId() { return (DWORD)syscall(SYS_gettid); }
+
+inline ULONGLONG GetTickCount64() {
+  timespec now;
+  clock_gettime(CLOCK_MONOTONIC, &now);
+  return (ULONGLONG)now.tv_sec * 1000 + (ULONGLONG)now.tv_nsec / 1000000;
+}
+inline DWORD GetTickCount() { return (DWORD)GetTickCount64(); }
+inline void Sleep(DWORD milliseconds) { usleep((useconds_t)milliseconds * 1000); }
+
+typedef struct {
+  std::recursive_mutex mutex;
+} CRITICAL_SECTION;
+
+inline void InitializeCriticalSection(CRITICAL_SECTION *) {}
+inline void DeleteCriticalSection(CRITICAL_SECTION *) {}
+inline void EnterCriticalSection(CRITICAL_SECTION *section) { section->mutex.lock(); }
+inline void LeaveCriticalSection(CRITICAL_SECTION *section) { section->mutex.unlock(); }
+
+typedef struct {
+  pthread_rwlock_t lock;
+} SRWLOCK;
+
+#define SRWLOCK_INIT { PTHREAD_RWLOCK_INITIALIZER }
+
+inline void AcquireSRWLockShared(SRWLOCK *lock) { pthread_rwlock_rdlock(&lock->lock); }
+inline void ReleaseSRWLockShared(SRWLOCK *lock) { pthread_rwlock_unlock(&lock->lock); }
+inline void AcquireSRWLockExclusive(SRWLOCK *lock) { pthread_rwlock_wrlock(&lock->lock); }
+inline void ReleaseSRWLockExclusive(SRWLOCK *lock) { pthread_rwlock_unlock(&lock->lock); }
+
+inline LONG InterlockedIncrement(volatile LONG *value) { return __atomic_add_fetch(value, 1, __ATOMIC_SEQ_CST); }
+inline LONG InterlockedDecrement(volatile LONG *value) { return __atomic_sub_fetch(value, 1, __ATOMIC_SEQ_CST); }
+inline LONG InterlockedExchange(volatile LONG *target, LONG value) { return __atomic_exchange_n(target, value, __ATOMIC_SEQ_CST); }
+inline LONG InterlockedCompareExchange(volatile LONG *target, LONG exchange, LONG comparand) {
+  __atomic_compare_exchange_n(target, &comparand, exchange, false, __ATOMIC_SEQ_CST, __ATOMIC_SEQ_CST);
+  return comparand;
+}
+
+// There is no COM, initialization is only counted so the results match those of Windows.
+inline HRESULT CoInitializeEx(void *, DWORD) {
+  thread_local int count = 0;
+  return (count++ == 0) ? S_OK : S_FALSE;
+}
+inline void CoUninitialize() {}
+
+// Paths and text are UTF-8 outside of Windows.
+inline std::string CompatNarrow(const wchar_t *str) {
+  std::string narrow;
+  for (; *str; ++str) {
+    const uint32_t c = (uint32_t)*str;
+    if (c < 0x80) {
+      narrow += (char)c;
+    }
+    else if (c < 0x800) {
+      narrow += (char)(0xC0 | (c >> 6));
+      narrow += (char)(0x80 | (c & 0x3F));
+    }
+    else if (c < 0x10000) {
+      narrow += (char)(0xE0 | (c >> 12));
+      narrow += (char)(0x80 | ((c >> 6) & 0x3F));
+      narrow += (char)(0x80 | (c & 0x3F));
+    }
+    else {
+      narrow += (char)(0xF0 | (c >> 18));
+      narrow += (char)(0x80 | ((c >> 12) & 0x3F));
+      narrow += (char)(0x80 | ((c >> 6) & 0x3F));
+      narrow += (char)(0x80 | (c & 0x3F));
+    }
+  }
+  return narrow;
+}
+
+// Decodes to UTF-16 code units like Windows does, malformed sequences become U+FFFD.
+inline int MultiByteToWideChar(UINT, DWORD, const char *bytes, int length, wchar_t *wide, int capacity) {
+  int count = 0;
+  const auto put = [&](uint32_t unit) {
+    if (wide && count < capacity) wide[count] = (wchar_t)unit;
+    ++count;
+  };
+  for (int i = 0; i < length;) {
+    const unsigned char lead = (unsigned char)bytes[i];
+    const int size = (lead < 0x80) ? 1 : (lead >= 0xC2 && lead <= 0xDF) ? 2 : (lead >= 0xE0 && lead <= 0xEF) ? 3 : (lead >= 0xF0 && lead <= 0xF4) ? 4 : 0;
+    uint32_t c = (size == 1) ? lead : (size == 2) ? (lead & 0x1F) : (size == 3) ? (lead & 0x0F) : (lead & 0x07);
+    bool valid = (size > 0 && i + size <= length);
+    for (int j = 1; valid && j < size; ++j) {
+      valid = (((unsigned char)bytes[i + j] & 0xC0) == 0x80);
+      c = (c << 6) | ((unsigned char)bytes[i + j] & 0x3F);
+    }
+    if (!valid) {
+      put(0xFFFD);
+      ++i;
+      continue;
+    }
+    if (c >= 0x10000) {
+      put(0xD800 + ((c - 0x10000) >> 10));
+      put(0xDC00 + ((c - 0x10000) & 0x3FF));
+    }
+    else {
+      put(c);
+    }
+    i += size;
+  }
+  return (wide && count > capacity) ? 0 : count;
+}
+
+// The length must be given, there is no default character.
+inline int WideCharToMultiByte(UINT, DWORD, const wchar_t *wide, int length, char *bytes, int capacity, const char *, BOOL *) {
+  const std::string narrow = CompatNarrow(std::wstring(wide, length).c_str());
+  if (!bytes) return (int)narrow.size();
+  if ((int)narrow.size() > capacity) return 0;
+  memcpy(bytes, narrow.data(), narrow.size());
+  return (int)narrow.size();
+}
+
+inline std::wstring CompatWiden(const std::string &narrow) {
+  std::wstring wide(narrow.size(), L'\0');
+  wide.resize(MultiByteToWideChar(CP_UTF8, 0, narrow.data(), (int)narrow.size(), &wide[0], (int)wide.size()));
+  return wide;
+}
+
+// Tolk builds paths with backslashes.
+inline std::string CompatPath(const wchar_t *path) {
+  std::string narrow = CompatNarrow(path);
+  std::replace(narrow.begin(), narrow.end(), '\\', '/');
+  return narrow;
+}
+
+inline std::string CompatObjectName(const wchar_t *name) {
+  const char *session = getenv("TOLK_COMPAT_SESSION");
+  std::string object = std::string("/tolk-") + (session ? session : "0") + "-" + CompatNarrow(name);
+  std::replace(object.begin() + 1, object.end(), '\\', '.');
+  std::replace(object.begin() + 1, object.end(), '/', '.');
+  return object;
+}
+
+// Opens the shared memory of a named object, creating it with the given size if create is
+// set. Returns -1 if that fails. Sets created and the size of memory that already existed,
+// waiting for the process that is creating it to give it its size.
+inline int CompatOpenShared(const std::string &object, bool create, size_t &size, bool &created) {
+  created = false;
+  int descriptor = create ? shm_open(object.c_str(), O_RDWR | O_CREAT | O_EXCL, 0600) : -1;
+  if (descriptor >= 0) {
+    created = true;
+    if (ftruncate(descriptor, (off_t)size) == 0) return descriptor;
+    close(descriptor);
+    shm_unlink(object.c_str());
+    return -1;
+  }
+  descriptor = shm_open(object.c_str(), O_RDWR, 0);
+  if (descriptor < 0) return -1;
+  struct stat status;
+  for (int i = 0; !fstat(descriptor, &status) && !status.st_size && i < 1000; ++i) usleep(1000);
+  if (fstat(descriptor, &status) || !status.st_size) {
+    close(descriptor);
+    return -1;
+  }
+  size = (size_t)status.st_size;
+  return descriptor;
+}
+
+struct CompatHandle {
+  virtual ~CompatHandle() {}
+};
+
+// Handles that can be waited for. A successful wait on an auto-reset event resets it.
+struct CompatWaitable : CompatHandle {
+  virtual DWORD Wait(DWORD milliseconds) = 0;
+};
+
+inline CompatHandle *CompatGetHandle(HANDLE handle) {
+  return (handle && handle != INVALID_HANDLE_VALUE) ? static_cast<CompatHandle *>(handle) : nullptr;
+}
+
+template <typename T>
+inline T *CompatGet(HANDLE handle) {
+  return dynamic_cast<T *>(CompatGetHandle(handle));
+}
+
+// In shared memory for named events. The mutex is robust, a helper process
+// the test kills while it holds the mutex leaves it to the next one.
+struct CompatEventState {
+  pthread_mutex_t mutex;
+  pthread_cond_t changed;
+  int manualReset;
+  int signaled;
+  int ready;
+};
+
+inline void CompatInitEvent(CompatEventState *state, bool manualReset, bool signaled) {
+  pthread_mutexattr_t mutexAttributes;
+  pthread_mutexattr_init(&mutexAttributes);
+  pthread_mutexattr_setpshared(&mutexAttributes, PTHREAD_PROCESS_SHARED);
+  pthread_mutexattr_setrobust(&mutexAttributes, PTHREAD_MUTEX_ROBUST);
+  pthread_mutex_init(&state->mutex, &mutexAttributes);
+  pthread_mutexattr_destroy(&mutexAttributes);
+  pthread_condattr_t condAttributes;
+  pthread_condattr_init(&condAttributes);
+  pthread_condattr_setpshared(&condAttributes, PTHREAD_PROCESS_SHARED);
+  pthread_condattr_setclock(&condAttributes, CLOCK_MONOTONIC);
+  pthread_cond_init(&state->changed, &condAttributes);
+  pthread_condattr_destroy(&condAttributes);
+  state->manualReset = manualReset;
+  state->signaled = signaled;
+  __atomic_store_n(&state->ready, 1, __ATOMIC_RELEASE);
+}
+
+inline void CompatLockEvent(CompatEventState *state) {
+  if (pthread_mutex_lock(&state->mutex) == EOWNERDEAD) pthread_mutex_consistent(&state->mutex);
+}
+
+inline void CompatSetEvent(CompatEventState *state, bool signaled) {
+  CompatLockEvent(state);
+  state->signaled = signaled;
+  if (signaled) pthread_cond_broadcast(&state->changed);
+  pthread_mutex_unlock(&state->mutex);
+}
+
+inline DWORD CompatWaitEvent(CompatEventState *state, DWORD milliseconds) {
+  timespec deadline;
+  clock_gettime(CLOCK_MONOTONIC, &deadline);
+  deadline.tv_sec += milliseconds / 1000;
+  deadline.tv_nsec += (long)(milliseconds % 1000) * 1000000;
+  if (deadline.tv_nsec >= 1000000000) {
+    ++deadline.tv_sec;
+    deadline.tv_nsec -= 1000000000;
+  }
+  CompatLockEvent(state);
+  int error = 0;
+  while (!state->signaled && error != ETIMEDOUT) {
+    error = (milliseconds == INFINITE) ? pthread_cond_wait(&state->changed, &state->mutex) : pthread_cond_timedwait(&state->changed, &state->mutex, &deadline);
+    if (error == EOWNERDEAD) pthread_mutex_consistent(&state->mutex);
+  }
+  const bool signaled = !!state->signaled;
+  if (signaled && !state->manualReset) state->signaled = 0;
+  pthread_mutex_unlock(&state->mutex);
+  return signaled ? WAIT_OBJECT_0 : WAIT_TIMEOUT;
+}
+
+inline std::shared_ptr<CompatEventState> CompatNewEvent(bool manualReset, bool signaled) {
+  const std::shared_ptr<CompatEventState> state = std::make_shared<CompatEventState>();
+  CompatInitEvent(state.get(), manualReset, signaled);
+  return state;
+}
+
+// Shared memory of a named object is unlinked by the process that created it once it closes it.
+struct CompatShared {
+  ~CompatShared() {
+    if (address) munmap(address, size);
+    if (descriptor >= 0) close(descriptor);
+    if (!unlink.empty()) shm_unlink(unlink.c_str());
+  }
+  void *address = nullptr;
+  size_t size = 0;
+  int descriptor = -1;
+  std::string unlink;
+};
+
+struct CompatEvent : CompatWaitable {
+  DWORD Wait(DWORD milliseconds) override { return CompatWaitEvent(state, milliseconds); }
+  CompatEventState *state = nullptr;
+  std::shared_ptr<CompatEventState> local;
+  CompatShared shared;
+};
+
+struct CompatThread : CompatWaitable {
+  DWORD Wait(DWORD milliseconds) override { return CompatWaitEvent(exited.get(), milliseconds); }
+  std::shared_ptr<CompatEventState> exited;
+};
+
+// Waits on a pidfd, which can only be read by the parent once the process has been reaped.
+struct CompatProcess : CompatWaitable {
+  ~CompatProcess() {
+    Reap();
+    close(descriptor);
+  }
+  DWORD Wait(DWORD milliseconds) override {
+    pollfd exit = { descriptor, POLLIN, 0 };
+    if (poll(&exit, 1, (milliseconds == INFINITE) ? -1 : (int)std::min<DWORD>(milliseconds, INT_MAX)) <= 0) return WAIT_TIMEOUT;
+    Reap();
+    return WAIT_OBJECT_0;
+  }
+  // Only the exit code of a child is known, as a signal it is 128 plus the signal number.
+  void Reap() {
+    int status = 0;
+    if (!child || exitCode != STILL_ACTIVE || waitpid(id, &status, WNOHANG) != id) return;
+    exitCode = WIFEXITED(status) ? (DWORD)WEXITSTATUS(status) : (DWORD)(128 + WTERMSIG(status));
+  }
+  pid_t id = 0;
+  int descriptor = -1;
+  bool child = false;
+  DWORD exitCode = STILL_ACTIVE;
+};
+
+struct CompatFile : CompatHandle {
+  ~CompatFile() { close(descriptor); }
+  int descriptor;
+};
+
+struct CompatMapping : CompatHandle {
+  int descriptor = -1;
+  size_t size = 0;
+  bool writable = false;
+  CompatShared shared;
+  ~CompatMapping() { if (shared.descriptor < 0) close(descriptor); }
+};
+
+struct CompatFind : CompatHandle {
+  std::string directory;
+  std::vector<std::string> names;
+  size_t next = 0;
+};
+
+inline HANDLE CompatMakeHandle(CompatHandle *handle) {
+  return static_cast<HANDLE>(handle);
+}
+
+inline HANDLE CreateEventW(void *, BOOL manualReset, BOOL initialState, LPCWSTR name) {
+  CompatEvent *event = new CompatEvent();
+  if (!name) {
+    event->local = CompatNewEvent(!!manualReset, !!initialState);
+    event->state = event->local.get();
+    SetLastError(ERROR_SUCCESS);
+    return CompatMakeHandle(event);
+  }
+  const std::string object = CompatObjectName(name);
+  size_t size = sizeof(CompatEventState);
+  bool created = false;
+  event->shared.descriptor = CompatOpenShared(object, true, size, created);
+  if (event->shared.descriptor >= 0) {
+    event->shared.size = size;
+    event->shared.address = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED, event->shared.descriptor, 0);
+    if (event->shared.address == MAP_FAILED) event->shared.address = nullptr;
+    if (created) event->shared.unlink = object;
+  }
+  if (!event->shared.address || size < sizeof(CompatEventState)) {
+    delete event;
+    SetLastError(ERROR_ACCESS_DENIED);
+    return nullptr;
+  }
+  event->state = (CompatEventState *)event->shared.address;
+  if (created) {
+    CompatInitEvent(event->state, !!manualReset, !!initialState);
+  }
+  else {
+    while (!__atomic_load_n(&event->state->ready, __ATOMIC_ACQUIRE)) usleep(100);
+  }
+  SetLastError(created ? ERROR_SUCCESS : ERROR_ALREADY_EXISTS);
+  return CompatMakeHandle(event);
+}
+
+inline HANDLE OpenEventW(DWORD, BOOL, LPCWSTR name) {
+  CompatEvent *event = new CompatEvent();
+  size_t size = 0;
+  bool created = false;
+  event->shared.descriptor = CompatOpenShared(CompatObjectName(name), false, size, created);
+  if (event->shared.descriptor >= 0 && size >= sizeof(CompatEventState)) {
+    event->shared.size = size;
+    event->shared.address = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED, event->shared.descriptor, 0);
+    if (event->shared.address == MAP_FAILED) event->shared.address = nullptr;
+  }
+  if (!event->shared.address) {
+    delete event;
+    SetLastError(ERROR_FILE_NOT_FOUND);
+    return nullptr;
+  }
+  event->state = (CompatEventState *)event->shared.address;
+  while (!__atomic_load_n(&event->state->ready, __ATOMIC_ACQUIRE)) usleep(100);
+  return CompatMakeHandle(event);
+}
+
+inline BOOL SetEvent(HANDLE handle) {
+  CompatEvent *event = CompatGet<CompatEvent>(handle);
+  if (!event) return FALSE;
+  CompatSetEvent(event->state, true);
+  return TRUE;
+}
+
+inline BOOL ResetEvent(HANDLE handle) {
+  CompatEvent *event = CompatGet<CompatEvent>(handle);
+  if (!event) return FALSE;
+  CompatSetEvent(event->state, false);
+  return TRUE;
+}
+
+inline DWORD WaitForSingleObject(HANDLE handle, DWORD milliseconds) {
+  CompatWaitable *waitable = CompatGet<CompatWaitable>(handle);
+  return waitable ? waitable->Wait(milliseconds) : WAIT_FAILED;
+}
+
+// Only waits for any one of the handles. The first is waited on a millisecond at
+// a time, between those the others are looked at.
+inline DWORD WaitForMultipleObjects(DWORD count, const HANDLE *handles, BOOL, DWORD milliseconds) {
+  std::vector<CompatWaitable *> waitables;
+  for (DWORD i = 0; i < count; ++i) {
+    CompatWaitable *waitable = CompatGet<CompatWaitable>(handles[i]);
+    if (!waitable) return WAIT_FAILED;
+    waitables.push_back(waitable);
+  }
+  if (count == 1) return waitables[0]->Wait(milliseconds);
+  const ULONGLONG start = GetTickCount64();
+  for (;;) {
+    for (DWORD i = 0; i < count; ++i) {
+      if (waitables[i]->Wait(0) == WAIT_OBJECT_0) return WAIT_OBJECT_0 + i;
+    }
+    if (milliseconds != INFINITE && GetTickCount64() - start >= milliseconds) return WAIT_TIMEOUT;
+    if (waitables[0]->Wait(1) == WAIT_OBJECT_0) return WAIT_OBJECT_0;
+  }
+}
+
+inline BOOL CloseHandle(HANDLE handle) {
+  CompatHandle *object = CompatGetHandle(handle);
+  if (!object) return FALSE;
+  delete object;
+  return TRUE;
+}
+
+struct CompatTimer {
+  UINT_PTR id;
+  DWORD interval;
+  ULONGLONG due;
+};
+
+struct CompatWinEvent {
+  WINEVENTPROC proc;
+  HWINEVENTHOOK hook;
+  DWORD event;
+  HWND hwnd;
+  LONG idObject;
+  LONG idChild;
+  DWORD time;
+};
+
+// Every thread that uses the message functions gets a queue, as on Windows.
+struct CompatQueue {
+  std::mutex mutex;
+  std::condition_variable changed;
+  std::deque<MSG> messages;
+  std::deque<CompatWinEvent> events;
+  std::vector<CompatTimer> timers;
+  UINT_PTR nextTimer = 1;
+};
+
+struct CompatQueues {
+  std::mutex mutex;
+  std::map<DWORD, std::shared_ptr<CompatQueue>> queues;
+};
+
+inline CompatQueues &CompatGetQueues() {
+  static CompatQueues queues;
+  return queues;
+}
+
+inline std::shared_ptr<CompatQueue> CompatFindQueue(DWORD thread, bool create) {
+  CompatQueues &queues = CompatGetQueues();
+  std::lock_guard<std::mutex> guard(queues.mutex);
+  const auto found = queues.queues.find(thread);
+  if (found != queues.queues.end()) return found->second;
+  if (!create) return nullptr;
+  return (queues.queues[thread] = std::make_shared<CompatQueue>());
+}
+
+// Thread IDs are reused, so a queue goes when its thread does.
+inline void CompatEndThread() {
+  CompatQueues &queues = CompatGetQueues();
+  std::lock_guard<std::mutex> guard(queues.mutex);
+  queues.queues.erase(GetCurrentThreadId());
+}
+
+// Out-of-context WinEvent procedures run inside the message functions of the thread
+// that set the hook, never as messages of their own. Timer messages come once the
+// queue is empty. Waits at most milliseconds for a message, filters are not supported.
+inline bool CompatNextMessage(MSG *msg, bool remove, DWORD milliseconds) {
+  const std::shared_ptr<CompatQueue> queue = CompatFindQueue(GetCurrentThreadId(), true);
+  std::unique_lock<std::mutex> lock(queue->mutex);
+  const ULONGLONG start = GetTickCount64();
+  for (;;) {
+    while (!queue->events.empty()) {
+      const CompatWinEvent event = queue->events.front();
+      queue->events.pop_front();
+      lock.unlock();
+      event.proc(event.hook, event.event, event.hwnd, event.idObject, event.idChild, 0, event.time);
+      lock.lock();
+    }
+    const ULONGLONG now = GetTickCount64();
+    if (!queue->messages.empty()) {
+      *msg = queue->messages.front();
+      if (remove) queue->messages.pop_front();
+      return true;
+    }
+    CompatTimer *next = nullptr;
+    for (CompatTimer &timer : queue->timers) {
+      if (!next || timer.due < next->due) next = &timer;
+    }
+    if (next && next->due <= now) {
+      *msg = MSG();
+      msg->message = WM_TIMER;
+      msg->wParam = next->id;
+      msg->time = (DWORD)now;
+      if (remove) next->due = now + next->interval;
+      return true;
+    }
+    ULONGLONG wait = ~0ULL;
+    if (milliseconds != INFINITE) wait = (now - start >= milliseconds) ? 0 : start + milliseconds - now;
+    if (next) wait = std::min<ULONGLONG>(wait, next->due - now);
+    if (!wait) return false;
+    if (wait == ~0ULL) queue->changed.wait(lock);
+    else queue->changed.wait_for(lock, std::chrono::milliseconds(wait));
+  }
+}
+
+inline BOOL PeekMessageW(MSG *msg, HWND, UINT, UINT, UINT remove) {
+  return CompatNextMessage(msg, !!(remove & PM_REMOVE), 0) ? TRUE : FALSE;
+}
+
+inline BOOL GetMessageW(MSG *msg, HWND, UINT, UINT) {
+  CompatNextMessage(msg, true, INFINITE);
+  return (msg->message == WM_QUIT) ? FALSE : TRUE;
+}
+
+// Thread messages have no window procedure to go to.
+inline BOOL TranslateMessage(const MSG *) { return FALSE; }
+inline LRESULT DispatchMessageW(const MSG *) { return 0; }
+
+inline BOOL PostThreadMessageW(DWORD thread, UINT message, WPARAM wParam, LPARAM lParam) {
+  const std::shared_ptr<CompatQueue> queue = CompatFindQueue(thread, false);
+  if (!queue) {
+    SetLastError(ERROR_INVALID_THREAD_ID);
+    return FALSE;
+  }
+  MSG msg = MSG();
+  msg.message = message;
+  msg.wParam = wParam;
+  msg.lParam = lParam;
+  msg.time = GetTickCount();
+  std::lock_guard<std::mutex> guard(queue->mutex);
+  queue->messages.push_back(msg);
+  queue->changed.notify_all();
+  return TRUE;
+}
+
+// Thread timers only, without a procedure. An ID that is not a timer of the thread gets a new one.
+inline UINT_PTR SetTimer(HWND, UINT_PTR id, UINT milliseconds, void *) {
+  const std::shared_ptr<CompatQueue> queue = CompatFindQueue(GetCurrentThreadId(), true);
+  std::lock_guard<std::mutex> guard(queue->mutex);
+  const ULONGLONG due = GetTickCount64() + milliseconds;
+  for (CompatTimer &timer : queue->timers) {
+    if (timer.id == id) {
+      timer.interval = milliseconds;
+      timer.due = due;
+      return id;
+    }
+  }
+  const CompatTimer timer = { queue->nextTimer++, milliseconds, due };
+  queue->timers.push_back(timer);
+  return timer.id;
+}
+
+inline BOOL KillTimer(HWND, UINT_PTR id) {
+  const std::shared_ptr<CompatQueue> queue = CompatFindQueue(GetCurrentThreadId(), true);
+  std::lock_guard<std::mutex> guard(queue->mutex);
+  const auto found = std::find_if(queue->timers.begin(), queue->timers.end(), [id](const CompatTimer &timer) { return timer.id == id; });
+  if (found == queue->timers.end()) return FALSE;
+  queue->timers.erase(found);
+  return TRUE;
+}
+
+struct CompatHook {
+  DWORD first;
+  DWORD last;
+  WINEVENTPROC proc;
+  DWORD thread;
+};
+
+struct CompatWindows {
+  std::mutex mutex;
+  std::map<HWINEVENTHOOK, CompatHook> hooks;
+  uintptr_t nextHook = 1;
+  // Parent of each window, in the order they were created.
+  std::map<HWND, HWND> windows;
+  uintptr_t nextWindow = 0x10010;
+};
+
+inline CompatWindows &CompatGetWindows() {
+  static CompatWindows windows;
+  return windows;
+}
+
+inline HWND GetDesktopWindow() { return (HWND)(uintptr_t)0x10000; }
+
+inline HWINEVENTHOOK SetWinEventHook(DWORD first, DWORD last, HMODULE, WINEVENTPROC proc, DWORD, DWORD, DWORD) {
+  CompatWindows &windows = CompatGetWindows();
+  std::lock_guard<std::mutex> guard(windows.mutex);
+  const HWINEVENTHOOK hook = (HWINEVENTHOOK)windows.nextHook++;
+  windows.hooks[hook] = { first, last, proc, GetCurrentThreadId() };
+  return hook;
+}
+
+inline BOOL UnhookWinEvent(HWINEVENTHOOK hook) {
+  CompatWindows &windows = CompatGetWindows();
+  std::lock_guard<std::mutex> guard(windows.mutex);
+  return windows.hooks.erase(hook) ? TRUE : FALSE;
+}
+
+// Everything runs in one process here, so WINEVENT_SKIPOWNPROCESS is not honored.
+inline void NotifyWinEvent(DWORD event, HWND hwnd, LONG idObject, LONG idChild) {
+  CompatWindows &windows = CompatGetWindows();
+  std::lock_guard<std::mutex> guard(windows.mutex);
+  for (const auto &entry : windows.hooks) {
+    const CompatHook &hook = entry.second;
+    if (event < hook.first || event > hook.last) continue;
+    const std::shared_ptr<CompatQueue> queue = CompatFindQueue(hook.thread, false);
+    if (!queue) continue;
+    std::lock_guard<std::mutex> queueGuard(queue->mutex);
+    queue->events.push_back({ hook.proc, entry.first, event, hwnd, idObject, idChild, GetTickCount() });
+    queue->changed.notify_all();
+  }
+}
+
+// Stands in for a window of another process, top-level if it has no parent.
+inline HWND CompatCreateWindow(HWND parent) {
+  CompatWindows &windows = CompatGetWindows();
+  HWND hwnd;
+  {
+    std::lock_guard<std::mutex> guard(windows.mutex);
+    hwnd = (HWND)windows.nextWindow;
+    windows.nextWindow += 4;
+    windows.windows[hwnd] = parent ? parent : GetDesktopWindow();
+  }
+  NotifyWinEvent(EVENT_OBJECT_CREATE, hwnd, OBJID_WINDOW, CHILDID_SELF);
+  return hwnd;
+}
+
+// Children go first, by the time the event arrives the window is gone.
+inline void CompatDestroyWindow(HWND hwnd) {
+  CompatWindows &windows = CompatGetWindows();
+  std::vector<HWND> children;
+  {
+    std::lock_guard<std::mutex> guard(windows.mutex);
+    for (const auto &entry : windows.windows) {
+      if (entry.second == hwnd) children.push_back(entry.first);
+    }
+  }
+  for (HWND child : children) CompatDestroyWindow(child);
+  {
+    std::lock_guard<std::mutex> guard(windows.mutex);
+    windows.windows.erase(hwnd);
+  }
+  NotifyWinEvent(EVENT_OBJECT_DESTROY, hwnd, OBJID_WINDOW, CHILDID_SELF);
+}
+
+inline HWND GetAncestor(HWND hwnd, UINT) {
+  CompatWindows &windows = CompatGetWindows();
+  std::lock_guard<std::mutex> guard(windows.mutex);
+  const auto found = windows.windows.find(hwnd);
+  return (found != windows.windows.end()) ? found->second : nullptr;
+}
+
+// The windows of the table have no class or title.
+inline HWND FindWindowW(LPCWSTR, LPCWSTR) { return nullptr; }
+#define FindWindow FindWindowW
+
+inline BOOL EnumWindows(WNDENUMPROC proc, LPARAM lParam) {
+  std::vector<HWND> topLevel;
+  {
+    CompatWindows &windows = CompatGetWindows();
+    std::lock_guard<std::mutex> guard(windows.mutex);
+    for (const auto &entry : windows.windows) {
+      if (entry.second == GetDesktopWindow()) topLevel.push_back(entry.first);
+    }
+  }
+  for (HWND hwnd : topLevel) {
+    if (!proc(hwnd, lParam)) break;
+  }
+  return TRUE;
+}
+
+inline HANDLE CreateThread(void *, SIZE_T, LPTHREAD_START_ROUTINE start, LPVOID parameter, DWORD, DWORD *threadId) {
+  CompatThread *thread = new CompatThread();
+  thread->exited = CompatNewEvent(true, false);
+  // The thread reports its ID before it starts, it is returned from here.
+  const std::shared_ptr<CompatEventState> started = CompatNewEvent(true, false);
+  const std::shared_ptr<DWORD> id = std::make_shared<DWORD>(0);
+  const std::shared_ptr<CompatEventState> exited = thread->exited;
+  try {
+    std::thread([=]() {
+      *id = GetCurrentThreadId();
+      CompatSetEvent(started.get(), true);
+      start(parameter);
+      CompatEndThread();
+      CompatSetEvent(exited.get(), true);
+    }).detach();
+  }
+  catch (...) {
+    delete thread;
+    return nullptr;
+  }
+  CompatWaitEvent(started.get(), INFINITE);
+  if (threadId) *threadId = *id;
+  return CompatMakeHandle(thread);
+}
+
+inline HANDLE CompatOpenProcess(pid_t id, bool child) {
+  const int descriptor = (int)syscall(SYS_pidfd_open, id, 0);
+  if (descriptor < 0) {
+    SetLastError((errno == ESRCH || errno == EINVAL) ? ERROR_INVALID_PARAMETER : ERROR_ACCESS_DENIED);
+    return nullptr;
+  }
+  CompatProcess *process = new CompatProcess();
+  process->id = id;
+  process->descriptor = descriptor;
+  process->child = child;
+  return CompatMakeHandle(process);
+}
+
+inline HANDLE OpenProcess(DWORD, BOOL, DWORD id) {
+  return CompatOpenProcess((pid_t)id, false);
+}
+
+// Splits the command line the way the C runtime of Windows does.
+inline std::vector<std::string> CompatSplitCommandLine(const wchar_t *commandLine) {
+  std::vector<std::string> arguments;
+  std::wstring argument;
+  bool quoted = false;
+  bool started = false;
+  for (const wchar_t *p = commandLine;; ++p) {
+    if (!*p || (!quoted && (*p == L' ' || *p == L'\t'))) {
+      if (started) arguments.push_back(CompatNarrow(argument.c_str()));
+      argument.clear();
+      started = false;
+      if (!*p) break;
+      continue;
+    }
+    started = true;
+    if (*p == L'\\') {
+      size_t slashes = 0;
+      while (p[slashes] == L'\\') ++slashes;
+      // Backslashes only escape when a quote follows them.
+      if (p[slashes] == L'"') {
+        argument.append(slashes / 2, L'\\');
+        if (slashes % 2) argument += L'"';
+        p += (slashes % 2) ? slashes : slashes - 1;
+      }
+      else {
+        argument.append(slashes, L'\\');
+        p += slashes - 1;
+      }
+    }
+    else if (*p == L'"') {
+      quoted = !quoted;
+    }
+    else {
+      argument += *p;
+    }
+  }
+  return arguments;
+}
+
+// Runs the program with the environment of the caller, the other arguments are not supported.
+inline BOOL CreateProcessW(LPCWSTR application, LPWSTR commandLine, void *, void *, BOOL, DWORD, void *, LPCWSTR, STARTUPINFOW *, PROCESS_INFORMATION *info) {
+  const std::vector<std::string> arguments = CompatSplitCommandLine(commandLine ? commandLine : application);
+  if (arguments.empty()) {
+    SetLastError(ERROR_INVALID_PARAMETER);
+    return FALSE;
+  }
+  std::vector<char *> argv;
+  for (const std::string &argument : arguments) argv.push_back(const_cast<char *>(argument.c_str()));
+  argv.push_back(nullptr);
+  const std::string path = application ? CompatPath(application) : arguments[0];
+  pid_t id = 0;
+  if (posix_spawn(&id, path.c_str(), nullptr, nullptr, argv.data(), environ) != 0) {
+    SetLastError(ERROR_FILE_NOT_FOUND);
+    return FALSE;
+  }
+  info->hProcess = CompatOpenProcess(id, true);
+  if (!info->hProcess) {
+    kill(id, SIGKILL);
+    waitpid(id, nullptr, 0);
+    return FALSE;
+  }
+  info->hThread = CompatMakeHandle(new CompatHandle());
+  info->dwProcessId = (DWORD)id;
+  info->dwThreadId = (DWORD)id;
+  return TRUE;
+}
+
+inline BOOL TerminateProcess(HANDLE handle, UINT) {
+  CompatProcess *process = CompatGet<CompatProcess>(handle);
+  return (process && kill(process->id, SIGKILL) == 0) ? TRUE : FALSE;
+}
+
+inline BOOL GetExitCodeProcess(HANDLE handle, DWORD *code) {
+  CompatProcess *process = CompatGet<CompatProcess>(handle);
+  if (!process) return FALSE;
+  process->Reap();
+  *code = process->exitCode;
+  return TRUE;
+}
+
+// Windows runs console control handlers on a thread of their own, here a thread
+// passes SIGINT and SIGTERM on. Only one handler is supported.
+inline std::atomic<PHANDLER_ROUTINE> &CompatConsoleHandler() {
+  static std::atomic<PHANDLER_ROUTINE> handler(nullptr);
+  return handler;
+}
+
+inline volatile sig_atomic_t &CompatConsoleSignal() {
+  static volatile sig_atomic_t signaled = 0;
+  return signaled;
+}
+
+inline BOOL SetConsoleCtrlHandler(PHANDLER_ROUTINE handler, BOOL add) {
+  CompatConsoleHandler() = add ? handler : nullptr;
+  static std::once_flag started;
+  std::call_once(started, []() {
+    struct sigaction action = {};
+    action.sa_handler = [](int) { CompatConsoleSignal() = 1; };
+    sigaction(SIGINT, &action, nullptr);
+    sigaction(SIGTERM, &action, nullptr);
+    std::thread([]() {
+      for (;;) {
+        usleep(10000);
+        if (!CompatConsoleSignal()) continue;
+        CompatConsoleSignal() = 0;
+        const PHANDLER_ROUTINE current = CompatConsoleHandler();
+        if (current) current(CTRL_C_EVENT);
+      }
+    }).detach();
+  });
+  return TRUE;
+}
+
+// Sent to the one process, not to a process group.
+inline BOOL GenerateConsoleCtrlEvent(DWORD, DWORD process) {
+  return (kill((pid_t)process, SIGINT) == 0) ? TRUE : FALSE;
+}
+
+// The C locale only classifies ASCII, User32 knows all of Unicode.
+inline locale_t CompatLocale() {
+  static const locale_t locale = newlocale(LC_CTYPE_MASK, "C.UTF-8", (locale_t)0);
+  return locale ? locale : LC_GLOBAL_LOCALE;
+}
+
+inline LPWSTR CharLowerW(LPWSTR str) {
+  // With the high word zero, the single character in the low word is converted.
+  if (((ULONG_PTR)str >> 16) == 0) return (LPWSTR)(ULONG_PTR)towlower_l((wint_t)(ULONG_PTR)str, CompatLocale());
+  for (wchar_t *c = str; *c; ++c) *c = (wchar_t)towlower_l((wint_t)*c, CompatLocale());
+  return str;
+}
+
+inline BOOL IsCharAlphaNumericW(wchar_t c) { return !!iswalnum_l((wint_t)c, CompatLocale()); }
+
+inline int _wcsicmp(const wchar_t *a, const wchar_t *b) { return wcscasecmp_l(a, b, CompatLocale()); }
+
+enum NORM_FORM { NormalizationC = 1 };
+
+// There are no composition tables here, the text is passed on as it is.
+inline int NormalizeString(NORM_FORM, LPCWSTR source, int length, LPWSTR destination, int capacity) {
+  if (length < 0) length = (int)wcslen(source) + 1;
+  if (!capacity) return length;
+  if (capacity < length) return 0;
+  wmemcpy(destination, source, length);
+  return length;
+}
+
+template <size_t size>
+inline int swprintf_s(wchar_t (&buffer)[size], const wchar_t *format, ...) {
+  va_list arguments;
+  va_start(arguments, format);
+  const int length = vswprintf(buffer, size, format, arguments);
+  va_end(arguments);
+  if (length < 0) buffer[0] = L'\0';
+  return length;
+}
+
+// Only truncation is supported.
+template <size_t size>
+inline int wcsncpy_s(wchar_t (&destination)[size], const wchar_t *source, size_t) {
+  const size_t length = std::min(wcslen(source), size - 1);
+  wmemcpy(destination, source, length);
+  destination[length] = L'\0';
+  return 0;
+}
+
+#define fwprintf_s fwprintf
+
+inline HANDLE CreateFileW(LPCWSTR path, DWORD access, DWORD, void *, DWORD disposition, DWORD, HANDLE) {
+  const int flags = (access & GENERIC_WRITE) ? (O_WRONLY | ((disposition == CREATE_ALWAYS) ? O_CREAT | O_TRUNC : 0)) : O_RDONLY;
+  const int descriptor = open(CompatPath(path).c_str(), flags, 0644);
+  if (descriptor < 0) {
+    SetLastError(ERROR_FILE_NOT_FOUND);
+    return INVALID_HANDLE_VALUE;
+  }
+  CompatFile *file = new CompatFile();
+  file->descriptor = descriptor;
+  return CompatMakeHandle(file);
+}
+
+inline BOOL GetFileSizeEx(HANDLE handle, LARGE_INTEGER *size) {
+  CompatFile *file = CompatGet<CompatFile>(handle);
+  struct stat status;
+  if (!file || fstat(file->descriptor, &status)) return FALSE;
+  size->QuadPart = status.st_size;
+  return TRUE;
+}
+
+inline BOOL ReadFile(HANDLE handle, void *buffer, DWORD size, DWORD *read, void *) {
+  CompatFile *file = CompatGet<CompatFile>(handle);
+  if (!file) return FALSE;
+  DWORD total = 0;
+  while (total < size) {
+    const ssize_t count = ::read(file->descriptor, (char *)buffer + total, size - total);
+    if (count < 0) return FALSE;
+    if (count == 0) break;
+    total += (DWORD)count;
+  }
+  if (read) *read = total;
+  return TRUE;
+}
+
+inline BOOL WriteFile(HANDLE handle, const void *buffer, DWORD size, DWORD *written, void *) {
+  CompatFile *file = CompatGet<CompatFile>(handle);
+  if (!file) return FALSE;
+  DWORD total = 0;
+  while (total < size) {
+    const ssize_t count = ::write(file->descriptor, (const char *)buffer + total, size - total);
+    if (count <= 0) return FALSE;
+    total += (DWORD)count;
+  }
+  if (written) *written = total;
+  return TRUE;
+}
+
+inline BOOL DeleteFileW(LPCWSTR path) { return (unlink(CompatPath(path).c_str()) == 0) ? TRUE : FALSE; }
+
+inline BOOL MoveFileExW(LPCWSTR from, LPCWSTR to, DWORD) {
+  return (rename(CompatPath(from).c_str(), CompatPath(to).c_str()) == 0) ? TRUE : FALSE;
+}
+
+// Names are sorted, Windows gives no order either.
+inline bool CompatNextFile(CompatFind *find, WIN32_FIND_DATAW *data) {
+  if (find->next >= find->names.size()) return false;
+  const std::string &name = find->names[find->next++];
+  struct stat status;
+  const bool directory = (stat((find->directory + name).c_str(), &status) == 0 && S_ISDIR(status.st_mode));
+  data->dwFileAttributes = directory ? FILE_ATTRIBUTE_DIRECTORY : FILE_ATTRIBUTE_NORMAL;
+  const std::wstring wide = CompatWiden(name);
+  const size_t length = std::min<size_t>(wide.size(), MAX_PATH - 1);
+  wmemcpy(data->cFileName, wide.c_str(), length);
+  data->cFileName[length] = L'\0';
+  return true;
+}
+
+inline HANDLE FindFirstFileW(LPCWSTR pattern, WIN32_FIND_DATAW *data) {
+  const std::string path = CompatPath(pattern);
+  const size_t slash = path.rfind('/');
+  CompatFind *find = new CompatFind();
+  find->directory = (slash == std::string::npos) ? std::string("./") : path.substr(0, slash + 1);
+  const std::string mask = (slash == std::string::npos) ? path : path.substr(slash + 1);
+  if (DIR *directory = opendir(find->directory.c_str())) {
+    while (const dirent *entry = readdir(directory)) {
+      if (strcmp(entry->d_name, ".") && strcmp(entry->d_name, "..") && fnmatch(mask.c_str(), entry->d_name, FNM_CASEFOLD) == 0)
+        find->names.push_back(entry->d_name);
+    }
+    closedir(directory);
+  }
+  std::sort(find->names.begin(), find->names.end());
+  if (!CompatNextFile(find, data)) {
+    delete find;
+    SetLastError(ERROR_FILE_NOT_FOUND);
+    return INVALID_HANDLE_VALUE;
+  }
+  return CompatMakeHandle(find);
+}
+
+inline BOOL FindNextFileW(HANDLE handle, WIN32_FIND_DATAW *data) {
+  CompatFind *find = CompatGet<CompatFind>(handle);
+  return (find && CompatNextFile(find, data)) ? TRUE : FALSE;
+}
+
+inline BOOL FindClose(HANDLE handle) { return CloseHandle(handle); }
+
+// Files are mapped for reading, named memory without a file for reading and writing.
+inline HANDLE CreateFileMappingW(HANDLE handle, void *, DWORD protect, DWORD sizeHigh, DWORD sizeLow, LPCWSTR name) {
+  CompatMapping *mapping = new CompatMapping();
+  if (handle == INVALID_HANDLE_VALUE) {
+    mapping->writable = (protect == PAGE_READWRITE);
+    size_t size = ((size_t)sizeHigh << 32) | sizeLow;
+    bool created = true;
+    if (name) {
+      const std::string object = CompatObjectName(name);
+      mapping->descriptor = CompatOpenShared(object, true, size, created);
+      if (created) mapping->shared.unlink = object;
+    }
+    else {
+      mapping->descriptor = memfd_create("tolk", 0);
+      if (mapping->descriptor >= 0 && ftruncate(mapping->descriptor, (off_t)size)) {
+        close(mapping->descriptor);
+        mapping->descriptor = -1;
+      }
+    }
+    mapping->shared.descriptor = mapping->descriptor;
+    mapping->size = size;
+    if (mapping->descriptor < 0) {
+      delete mapping;
+      SetLastError(ERROR_ACCESS_DENIED);
+      return nullptr;
+    }
+    SetLastError(created ? ERROR_SUCCESS : ERROR_ALREADY_EXISTS);
+    return CompatMakeHandle(mapping);
+  }
+  CompatFile *file = CompatGet<CompatFile>(handle);
+  struct stat status;
+  if (!file || fstat(file->descriptor, &status) || !status.st_size) {
+    delete mapping;
+    return nullptr;
+  }
+  mapping->descriptor = dup(file->descriptor);
+  mapping->size = (size_t)status.st_size;
+  return CompatMakeHandle(mapping);
+}
+
+inline HANDLE OpenFileMappingW(DWORD, BOOL, LPCWSTR name) {
+  size_t size = 0;
+  bool created = false;
+  const int descriptor = CompatOpenShared(CompatObjectName(name), false, size, created);
+  if (descriptor < 0) {
+    SetLastError(ERROR_FILE_NOT_FOUND);
+    return nullptr;
+  }
+  CompatMapping *mapping = new CompatMapping();
+  mapping->descriptor = mapping->shared.descriptor = descriptor;
+  mapping->size = size;
+  mapping->writable = true;
+  return CompatMakeHandle(mapping);
+}
+
+// munmap needs the size of the view, UnmapViewOfFile only gets its address.
+inline std::map<const void *, size_t> &CompatViews() {
+  static std::map<const void *, size_t> views;
+  return views;
+}
+
+inline std::mutex &CompatViewsLock() {
+  static std::mutex lock;
+  return lock;
+}
+
+inline void *MapViewOfFile(HANDLE handle, DWORD, DWORD, DWORD, SIZE_T bytes) {
+  CompatMapping *mapping = CompatGet<CompatMapping>(handle);
+  if (!mapping) return nullptr;
+  const size_t size = bytes ? std::min(bytes, mapping->size) : mapping->size;
+  void *view = mapping->writable
+    ? mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED, mapping->descriptor, 0)
+    : mmap(nullptr, size, PROT_READ, MAP_PRIVATE, mapping->descriptor, 0);
+  if (view == MAP_FAILED) return nullptr;
+  std::lock_guard<std::mutex> guard(CompatViewsLock());
+  CompatViews()[view] = size;
+  return view;
+}
+
+inline BOOL UnmapViewOfFile(const void *view) {
+  std::lock_guard<std::mutex> guard(CompatViewsLock());
+  const auto found = CompatViews().find(view);
+  if (found == CompatViews().end()) return FALSE;
+  munmap(const_cast<void *>(view), found->second);
+  CompatViews().erase(found);
+  return TRUE;
+}
+
+inline std::string CompatExecutable() {
+  char executable[PATH_MAX];
+  const ssize_t length = readlink("/proc/self/exe", executable, sizeof(executable) - 1);
+  return (length > 0) ? std::string(executable, (size_t)length) : std::string();
+}
+
+// Names without a directory are looked for next to the executable first, as on Windows.
+inline HINSTANCE LoadLibraryExW(LPCWSTR path, HANDLE, DWORD) {
+  std::string file = CompatPath(path);
+  if (file.find('/') == std::string::npos) {
+    const std::string executable = CompatExecutable();
+    const std::string beside = executable.substr(0, executable.rfind('/') + 1) + file;
+    if (!executable.empty() && access(beside.c_str(), F_OK) == 0) file = beside;
+  }
+  return dlopen(file.c_str(), RTLD_NOW | RTLD_LOCAL);
+}
+inline HINSTANCE LoadLibraryW(LPCWSTR path) { return LoadLibraryExW(path, nullptr, 0); }
+#define LoadLibrary LoadLibraryW
+inline FARPROC GetProcAddress(HINSTANCE module, const char *name) { return reinterpret_cast<FARPROC>(dlsym(module, name)); }
+inline BOOL FreeLibrary(HINSTANCE module) { return (dlclose(module) == 0); }
+
+inline BOOL GetModuleHandleExW(DWORD flags, LPCWSTR address, HMODULE *module) {
+  Dl_info info;
+  if (!(flags & GET_MODULE_HANDLE_EX_FLAG_FROM_ADDRESS) || !dladdr((const void *)address, &info)) return FALSE;
+  *module = info.dli_fbase;
+  return TRUE;
+}
+
+// In the form Windows gives it, with backslashes. The executable when the module isn't a library.
+inline DWORD GetModuleFileNameW(HMODULE module, LPWSTR path, DWORD size) {
+  Dl_info info;
+  char resolved[PATH_MAX];
+  std::string file;
+  if (module && dladdr(module, &info) && info.dli_fname && strchr(info.dli_fname, '/') && realpath(info.dli_fname, resolved))
+    file = resolved;
+  else
+    file = CompatExecutable();
+  std::replace(file.begin(), file.end(), '/', '\\');
+  const std::wstring wide = CompatWiden(file);
+  if (!size) return 0;
+  const DWORD length = (DWORD)std::min<size_t>(wide.size(), size - 1);
+  wmemcpy(path, wide.c_str(), length);
+  path[length] = L'\0';
+  return (wide.size() >= size) ? size : length;
+}
+
+#endif // _TOLK_COMPAT_WINDOWS_H_
@@ -0,0 +1,37 @@
+/**
+ *  Product:        Tolk
+ *  File:           FakeSpeechSynthesizer.cpp
+ *  Description:    Speech synthesis without a voice, for building Tolk with the fake SAPI driver.
+ *  Copyright:      (c) 2026, Davy Kager <mail@davykager.nl>
+ *  License:        LGPLv3
+ */
+
+#include "SpeechSynthesizer.h"
+
+WAVEFORMATEX MakePcmFormat(DWORD samplesPerSecond, WORD bitsPerSample, WORD channels) {
+  WAVEFORMATEX format = {};
+  format.wFormatTag = WAVE_FORMAT_PCM;
+  format.nChannels = channels;
+  format.nSamplesPerSec = samplesPerSecond;
+  format.wBitsPerSample = bitsPerSample;
+  format.nBlockAlign = (WORD)(channels * bitsPerSample / 8);
+  format.nAvgBytesPerSec = samplesPerSecond * format.nBlockAlign;
+  return format;
+}
+
+// There is no voice, so nothing can be rendered and the phrase cache stays off.
+bool SynthesizeSpeech(const wchar_t *, const WAVEFORMATEX &, SpeechSynthesizerCallback, void *) {
+  return false;
+}
+
+bool RenderSpeech(const wchar_t *, const WAVEFORMATEX &, std::vector<char> &) {
+  return false;
+}
+
+std::wstring GetDefaultVoiceKey() {
+  return std::wstring();
+}
+
+ISpStreamFormat *CreatePhraseStream(const std::shared_ptr<const PhraseAudio> &, const WAVEFORMATEX &) {
+  return nullptr;
+}
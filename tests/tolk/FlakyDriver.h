@@ -0,0 +1,221 @@
+/**
+ *  Product:        Tolk
+ *  File:           FlakyDriver.h
+ *  Description:    Screen reader driver that fails, hangs or throws on demand, for tests.
+ *  Copyright:      (c) 2026, Davy Kager <mail@davykager.nl>
+ *  License:        LGPLv3
+ */
+
+#ifndef _FLAKY_DRIVER_H_
+#define _FLAKY_DRIVER_H_
+
+#include <windows.h>
+#include <atomic>
+#include <condition_variable>
+#include <map>
+#include <mutex>
+#include <stdexcept>
+#include <string>
+#include <vector>
+#include "ScreenReaderDriver.h"
+#include "TolkTest.h"
+
+// Built into Tolk by the test's TolkDrivers.h, so tests reach it through Find. All
+// of it may be used from any thread: Tolk calls drivers on their worker threads.
+// Faults hit Speak, Braille and Output, the calls that deliver text. A hung call
+// returns once the test releases it and then delivers its text after all, like a
+// screen reader that was only slow. Speech is also written to the test log, see
+// AppendTestLog, for tests that run Tolk in a helper process.
+class FlakyDriver : public ScreenReaderDriver {
+public:
+  enum Fault {
+    FAULT_NONE,
+    FAULT_FAIL,
+    FAULT_HANG,
+    FAULT_THROW
+  };
+
+public:
+  explicit FlakyDriver(const wchar_t *name) :
+    ScreenReaderDriver(name, true, true, true),
+    active(true),
+    delay(0),
+    holdSpeech(false),
+    calls(0),
+    failures(0),
+    hangs(0),
+    silences(0),
+    statusCalls(0),
+    fault(FAULT_NONE),
+    faultCalls(0),
+    releases(0),
+    speaking(false),
+    signalSpeech(false)
+  {
+    speechEvent = CreateEventW(nullptr, FALSE, FALSE, nullptr);
+    std::lock_guard<std::mutex> guard(GetRegistryLock());
+    GetRegistry()[name] = this;
+  }
+  ~FlakyDriver() {
+    {
+      std::lock_guard<std::mutex> guard(GetRegistryLock());
+      GetRegistry().erase(GetName());
+    }
+    if (speechEvent) CloseHandle(speechEvent);
+  }
+
+public:
+  bool Speak(const wchar_t *str, bool interrupt) override {
+    if (!Enter()) return false;
+    Record(spoken, str, interrupt);
+    AppendTestLog(GetName(), str);
+    if (holdSpeech) speaking = true;
+    return true;
+  }
+  bool Braille(const wchar_t *str) override {
+    if (!Enter()) return false;
+    Record(brailled, str, false);
+    return true;
+  }
+  bool IsSpeaking() override {
+    ++statusCalls;
+    return speaking;
+  }
+  bool Silence() override {
+    ++silences;
+    speaking = false;
+    return true;
+  }
+  bool IsActive() override { return active; }
+  bool Output(const wchar_t *str, bool interrupt) override {
+    if (!Enter()) return false;
+    Record(spoken, str, interrupt);
+    Record(brailled, str, false);
+    AppendTestLog(GetName(), str);
+    if (holdSpeech) speaking = true;
+    return true;
+  }
+  void *GetSpeechEvent() override { return signalSpeech ? speechEvent : nullptr; }
+
+public:
+  // Every call that delivers text gets the fault, or only the next count of them.
+  void SetFault(Fault newFault, int count = -1) {
+    std::lock_guard<std::mutex> guard(lock);
+    fault = newFault;
+    faultCalls = count;
+  }
+  // Lets the calls that hang go on, later calls no longer hang.
+  void Unblock() {
+    std::lock_guard<std::mutex> guard(lock);
+    if (fault == FAULT_HANG) fault = FAULT_NONE;
+    ++releases;
+    released.notify_all();
+  }
+  // Whether a call is hanging right now.
+  bool IsHanging() {
+    std::lock_guard<std::mutex> guard(lock);
+    return (hangs > 0);
+  }
+  // Whether IsSpeaking reflects the speech, and whether finishing it is signaled through the speech event.
+  void SetStatus(bool status, bool signal) {
+    Describe(GetName(), true, true, status);
+    signalSpeech = signal;
+  }
+  // Ends speech held through holdSpeech.
+  void FinishSpeech() {
+    speaking = false;
+    if (signalSpeech) SetEvent(speechEvent);
+  }
+  std::vector<std::wstring> GetSpoken() {
+    std::lock_guard<std::mutex> guard(lock);
+    return spoken;
+  }
+  std::vector<std::wstring> GetBrailled() {
+    std::lock_guard<std::mutex> guard(lock);
+    return brailled;
+  }
+  void Clear() {
+    std::lock_guard<std::mutex> guard(lock);
+    spoken.clear();
+    brailled.clear();
+    calls = failures = silences = statusCalls = 0;
+  }
+
+public:
+  static FlakyDriver *Find(const wchar_t *name) {
+    std::lock_guard<std::mutex> guard(GetRegistryLock());
+    const auto found = GetRegistry().find(name);
+    return (found != GetRegistry().end()) ? found->second : nullptr;
+  }
+
+public:
+  std::atomic<bool> active;
+  // Milliseconds every call that delivers text takes.
+  std::atomic<DWORD> delay;
+  // Speech goes on until FinishSpeech or Silence.
+  std::atomic<bool> holdSpeech;
+  std::atomic<int> calls;
+  std::atomic<int> failures;
+  std::atomic<int> hangs;
+  std::atomic<int> silences;
+  // Calls of IsSpeaking.
+  std::atomic<int> statusCalls;
+
+private:
+  static std::map<std::wstring, FlakyDriver *> &GetRegistry() {
+    static std::map<std::wstring, FlakyDriver *> registry;
+    return registry;
+  }
+  static std::mutex &GetRegistryLock() {
+    static std::mutex registryLock;
+    return registryLock;
+  }
+
+  // Returns false if the call fails.
+  bool Enter() {
+    ++calls;
+    std::unique_lock<std::mutex> guard(lock);
+    const Fault current = fault;
+    if (current != FAULT_NONE && faultCalls > 0 && --faultCalls == 0) fault = FAULT_NONE;
+    guard.unlock();
+    if (delay) Sleep(delay);
+    switch (current) {
+    case FAULT_NONE:
+      return true;
+    case FAULT_FAIL:
+      ++failures;
+      return false;
+    case FAULT_HANG: {
+      guard.lock();
+      ++hangs;
+      const unsigned long release = releases;
+      released.wait(guard, [&]() { return releases != release; });
+      --hangs;
+      return true;
+    }
+    case FAULT_THROW:
+      ++failures;
+      throw std::runtime_error("fault injected");
+    }
+    return true;
+  }
+  void Record(std::vector<std::wstring> &texts, const wchar_t *str, bool interrupt) {
+    std::lock_guard<std::mutex> guard(lock);
+    if (interrupt) texts.clear();
+    texts.emplace_back(str);
+  }
+
+private:
+  std::mutex lock;
+  std::condition_variable released;
+  Fault fault;
+  int faultCalls;
+  unsigned long releases;
+  std::vector<std::wstring> spoken;
+  std::vector<std::wstring> brailled;
+  std::atomic<bool> speaking;
+  std::atomic<bool> signalSpeech;
+  HANDLE speechEvent;
+};
+
+#endif // _FLAKY_DRIVER_H_
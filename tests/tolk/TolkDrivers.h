@@ -0,0 +1,48 @@
+/**
+ *  Product:        Tolk
+ *  File:           TolkDrivers.h
+ *  Description:    Screen reader drivers built into Tolk for the tests, in place of the generated list.
+ *  Copyright:      (c) 2026, Davy Kager <mail@davykager.nl>
+ *  License:        LGPLv3
+ */
+
+#ifndef _TOLK_DRIVERS_H_
+#define _TOLK_DRIVERS_H_
+
+#include <memory>
+#include "FlakyDriver.h"
+
+class PhraseCache;
+
+// Three screen readers, detected in this order, and SAPI. Tests find them by name.
+class ScreenReaderDriverFirst final : public FlakyDriver {
+public:
+  ScreenReaderDriverFirst() : FlakyDriver(L"First") {}
+};
+
+class ScreenReaderDriverSecond final : public FlakyDriver {
+public:
+  ScreenReaderDriverSecond() : FlakyDriver(L"Second") {}
+};
+
+class ScreenReaderDriverThird final : public FlakyDriver {
+public:
+  ScreenReaderDriverThird() : FlakyDriver(L"Third") {}
+};
+
+class ScreenReaderDriverSAPI final : public FlakyDriver {
+public:
+  ScreenReaderDriverSAPI() : FlakyDriver(L"SAPI") {}
+
+public:
+  void SetPhraseCache(const std::shared_ptr<PhraseCache> &) {}
+};
+
+#define TOLK_WITH_SAPI
+
+#define TOLK_DRIVER_LIST \
+  TOLK_DRIVER(First) \
+  TOLK_DRIVER(Second) \
+  TOLK_DRIVER(Third)
+
+#endif // _TOLK_DRIVERS_H_
@@ -0,0 +1,22 @@
+/**
+ *  Product:        Tolk
+ *  File:           TolkLoader.cpp
+ *  Description:    Does what loading Tolk.dll does, for tests that build Tolk into the test program.
+ *  Copyright:      (c) 2026, Davy Kager <mail@davykager.nl>
+ *  License:        LGPLv3
+ */
+
+#include <windows.h>
+
+BOOL WINAPI DllMain(HINSTANCE, DWORD reason, LPVOID);
+
+namespace {
+
+struct TolkLoader {
+  TolkLoader() { DllMain(nullptr, DLL_PROCESS_ATTACH, nullptr); }
+  ~TolkLoader() { DllMain(nullptr, DLL_PROCESS_DETACH, nullptr); }
+};
+
+const TolkLoader loader;
+
+}
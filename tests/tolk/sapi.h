@@ -0,0 +1,15 @@
+/**
+ *  Product:        Tolk
+ *  File:           sapi.h
+ *  Description:    The SAPI types Tolk names without using them, for building it with the fake SAPI driver.
+ *  Copyright:      (c) 2026, Davy Kager <mail@davykager.nl>
+ *  License:        LGPLv3
+ */
+
+#ifndef _TOLK_TEST_SAPI_H_
+#define _TOLK_TEST_SAPI_H_
+
+struct ISpStreamFormat;
+struct ISpVoice;
+
+#endif // _TOLK_TEST_SAPI_H_